@@ -60,6 +60,10 @@ ifeq ($(strip $(AUDIO_FEATURE_ENABLED_EC_REF_CAPTURE)),true)
 LOCAL_CFLAGS += -DEC_REF_CAPTURE_ENABLED
 endif
 
+ifneq ($(strip $(AUDIO_FEATURE_PAL_LOG_COMPILE_LVL)),)
+LOCAL_CFLAGS += -DPAL_LOG_COMPILE_LVL=$(AUDIO_FEATURE_PAL_LOG_COMPILE_LVL)
+endif
+
 LOCAL_C_INCLUDES              += $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/include
 LOCAL_C_INCLUDES              += $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr/techpack/audio/include
 LOCAL_ADDITIONAL_DEPENDENCIES += $(TARGET_OUT_INTERMEDIATES)/KERNEL_OBJ/usr
@@ -85,6 +89,7 @@ LOCAL_SRC_FILES := \
     device/src/Device.cpp \
     device/src/Speaker.cpp \
     device/src/Bluetooth.cpp \
+    device/src/BtCodecPluginRegistry.cpp \
     device/src/SpeakerMic.cpp \
     device/src/HeadsetMic.cpp \
     device/src/HandsetMic.cpp \
@@ -111,12 +116,18 @@ LOCAL_SRC_FILES := \
     session/src/ContextDetectionEngine.cpp \
     context_manager/src/ContextManager.cpp \
     session/src/ACDEngine.cpp \
+    session/src/ACDModelStore.cpp \
     resource_manager/src/ResourceManager.cpp \
     resource_manager/src/SndCardMonitor.cpp \
+    resource_manager/src/StreamHandleRegistry.cpp \
+    resource_manager/src/ActiveStreamRegistry.cpp \
+    resource_manager/src/FrontEndPool.cpp \
     utils/src/SoundTriggerXmlParser.cpp \
     utils/src/SoundTriggerPlatformInfo.cpp \
     utils/src/ACDPlatformInfo.cpp \
     utils/src/PalRingBuffer.cpp \
+    utils/src/PalLatencyStats.cpp \
+    utils/src/PalTrace.cpp \
     utils/src/SoundTriggerUtils.cpp \
     utils/src/SignalHandler.cpp
 ifeq ($(strip $(AUDIO_FEATURE_ENABLED_EC_REF_CAPTURE)),true)
@@ -197,6 +208,710 @@ include $(BUILD_EXECUTABLE)
 
 include $(CLEAR_VARS)
 
+LOCAL_C_INCLUDES     := $(LOCAL_PATH)/utils/inc \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/PalRingBufferBench.cpp
+
+LOCAL_MODULE               := PalRingBufferBench
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH)/resource_manager/inc \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/FrontEndPoolStress.cpp
+
+LOCAL_MODULE               := FrontEndPoolStress
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/PalStreamOpenStress.cpp
+
+LOCAL_MODULE               := PalStreamOpenStress
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include \
+    $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/SoundModelMergeCacheTest.cpp
+
+LOCAL_MODULE               := SoundModelMergeCacheTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/USBStreamInfoTest.cpp
+
+LOCAL_MODULE               := USBStreamInfoTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH)/resource_manager/inc \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/StreamHandleRegistryTest.cpp
+
+LOCAL_MODULE               := StreamHandleRegistryTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/PalIoControlLatency.cpp
+
+LOCAL_MODULE               := PalIoControlLatency
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include \
+    $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/KVSelectorIndexTest.cpp
+
+LOCAL_MODULE               := KVSelectorIndexTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/TagInfoCacheTest.cpp
+
+LOCAL_MODULE               := TagInfoCacheTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include \
+    $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/MixerCtlCacheTest.cpp
+
+LOCAL_MODULE               := MixerCtlCacheTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+ifneq ($(QCPATH),)
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+LOCAL_LDFLAGS := -rdynamic
+
+LOCAL_SRC_FILES  := test/PalIpcBufferTest.cpp
+
+LOCAL_MODULE               := PalIpcBufferTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+    libhidlbase \
+    libutils \
+    libcutils \
+    liblog \
+    vendor.qti.hardware.pal@1.0 \
+    vendor.qti.hardware.pal@1.0-impl \
+    libar-pal
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+endif
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include \
+    $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+LOCAL_LDFLAGS := -rdynamic
+
+LOCAL_SRC_FILES  := test/SessionAgmEventPoolTest.cpp
+
+LOCAL_MODULE               := SessionAgmEventPoolTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/A2dpSuspendLatencyTest.cpp
+
+LOCAL_MODULE               := A2dpSuspendLatencyTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/PalPauseRampLatency.cpp
+
+LOCAL_MODULE               := PalPauseRampLatency
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include \
+    $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/KVSnapshotTest.cpp
+
+LOCAL_MODULE               := KVSnapshotTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/PalColdStartTest.cpp
+
+LOCAL_MODULE               := PalColdStartTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include \
+    $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/DeviceInfoIndexTest.cpp
+
+LOCAL_MODULE               := DeviceInfoIndexTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH)/resource_manager/inc \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/ActiveStreamRegistryTest.cpp
+
+LOCAL_MODULE               := ActiveStreamRegistryTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH)/utils/inc \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/PalLatencyScopeOverhead.cpp
+
+LOCAL_MODULE               := PalLatencyScopeOverhead
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include \
+    $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/PalTraceTest.cpp
+
+LOCAL_MODULE               := PalTraceTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal \
+                          liblog
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/PalDeviceSwitchLatency.cpp
+
+LOCAL_MODULE               := PalDeviceSwitchLatency
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/A2dpStartLatencyTest.cpp
+
+LOCAL_MODULE               := A2dpStartLatencyTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include \
+    $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/BtCodecPluginRegistryTest.cpp
+
+LOCAL_MODULE               := BtCodecPluginRegistryTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/SoundModelLoadLatencyTest.cpp
+
+LOCAL_MODULE               := SoundModelLoadLatencyTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/SoundModelLoadRssTest.cpp
+
+LOCAL_MODULE               := SoundModelLoadRssTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES := \
+    $(TOP)/system/media/audio_route/include \
+    $(TOP)/system/media/audio/include \
+    $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS := -D_ANDROID_
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+LOCAL_LDFLAGS := -rdynamic
+
+LOCAL_SRC_FILES  := test/ACDModelStoreTest.cpp
+
+LOCAL_MODULE               := ACDModelStoreTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_HEADER_LIBRARIES := \
+    libspf-headers \
+    libcapiv2_headers \
+    libagm_headers \
+    libacdb_headers \
+    libarpal_headers
+
+LOCAL_SHARED_LIBRARIES := \
+                          libar-pal
+ifneq ($(filter 11 R, $(PLATFORM_VERSION)),)
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinyalsa/include
+LOCAL_C_INCLUDES       += $(TOP)/vendor/qcom/opensource/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libqti-tinyalsa
+else
+LOCAL_C_INCLUDES       += $(TOP)/external/tinycompress/include
+LOCAL_SHARED_LIBRARIES += libtinyalsa
+endif
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
+LOCAL_C_INCLUDES     := $(LOCAL_PATH) \
+                        $(LOCAL_PATH)/test
+
+LOCAL_CFLAGS += -Wall -Werror -Wno-unused-variable -Wno-unused-parameter
+
+LOCAL_SRC_FILES  := test/AcdEnableLatencyTest.cpp
+
+LOCAL_MODULE               := AcdEnableLatencyTest
+LOCAL_MODULE_OWNER         := qti
+LOCAL_MODULE_TAGS          := optional
+
+LOCAL_SHARED_LIBRARIES := \
+                          libpalclient
+LOCAL_VENDOR_MODULE := true
+
+include $(BUILD_EXECUTABLE)
+
+include $(CLEAR_VARS)
+
 include $(PAL_BASE_PATH)/plugins/Android.mk
 include $(PAL_BASE_PATH)/ipc/HwBinders/Android.mk
 
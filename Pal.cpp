@@ -38,6 +38,7 @@
 #include "Device.h"
 #include "ResourceManager.h"
 #include "PalCommon.h"
+#include "PalLatencyStats.h"
 class Stream;
 
 /*
@@ -138,6 +139,7 @@ int32_t pal_stream_open(struct pal_stream_attributes *attributes,
                         pal_stream_callback cb, uint64_t cookie,
                         pal_stream_handle_t **stream_handle)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_OPEN);
     uint64_t *stream = NULL;
     Stream *s = NULL;
     int status;
@@ -199,6 +201,7 @@ exit:
 
 int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_CLOSE);
     Stream *s = NULL;
     int status;
     struct pal_stream_attributes sAttr;
@@ -241,14 +244,15 @@ int32_t pal_stream_close(pal_stream_handle_t *stream_handle)
 exit:
     s->getStreamAttributes(&sAttr);
     notify_concurrent_stream(sAttr.type, sAttr.direction, false);
-    delete s;
     rm->eraseStreamUserCounter(s);
+    delete s;
     PAL_INFO(LOG_TAG, "Exit. status %d", status);
     return status;
 }
 
 int32_t pal_stream_start(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_START);
     Stream *s = NULL;
     std::shared_ptr<ResourceManager> rm = NULL;
     int status;
@@ -300,6 +304,7 @@ exit:
 
 int32_t pal_stream_stop(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_STOP);
     Stream *s = NULL;
     std::shared_ptr<ResourceManager> rm = NULL;
     int status;
@@ -351,6 +356,7 @@ exit:
 
 ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *buf)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_WRITE);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -361,32 +367,27 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
         status = -EINVAL;
         return status;
     }
-    rm->lockValidStreamMutex();
-    if (!stream_handle || !rm->isActiveStream(stream_handle) || !buf) {
-        rm->unlockValidStreamMutex();
+    if (!stream_handle || !buf) {
         status = -EINVAL;
         PAL_ERR(LOG_TAG, "Invalid input parameters status %d", status);
         return status;
     }
 
     PAL_VERBOSE(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
+    /* lock free, fails unless the handle is a valid and active stream */
     s =  reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
-        rm->unlockValidStreamMutex();
-        PAL_ERR(LOG_TAG, "failed to increase stream user count");
+        PAL_ERR(LOG_TAG, "Invalid stream handle or inactive stream");
         return status;
     }
-    rm->unlockValidStreamMutex();
 
     status = s->write(buf);
     if (status < 0) {
         PAL_ERR(LOG_TAG, "stream write failed status %d", status);
     }
 
-    rm->lockValidStreamMutex();
     rm->decreaseStreamUserCounter(s);
-    rm->unlockValidStreamMutex();
 
     PAL_VERBOSE(LOG_TAG, "Exit. status %d", status);
     return status;
@@ -394,6 +395,7 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
 
 ssize_t pal_stream_read(pal_stream_handle_t *stream_handle, struct pal_buffer *buf)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_READ);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -404,32 +406,27 @@ ssize_t pal_stream_read(pal_stream_handle_t *stream_handle, struct pal_buffer *b
         status = -EINVAL;
         return status;
     }
-    rm->lockValidStreamMutex();
-    if (!stream_handle || !rm->isActiveStream(stream_handle) || !buf) {
-        rm->unlockValidStreamMutex();
+    if (!stream_handle || !buf) {
         status = -EINVAL;
         PAL_ERR(LOG_TAG, "Invalid input parameters status %d", status);
         return status;
     }
 
     PAL_VERBOSE(LOG_TAG, "Enter. Stream handle :%pK", stream_handle);
+    /* lock free, fails unless the handle is a valid and active stream */
     s =  reinterpret_cast<Stream *>(stream_handle);
     status = rm->increaseStreamUserCounter(s);
     if (0 != status) {
-        rm->unlockValidStreamMutex();
-        PAL_ERR(LOG_TAG, "failed to increase stream user count");
+        PAL_ERR(LOG_TAG, "Invalid stream handle or inactive stream");
         return status;
     }
-    rm->unlockValidStreamMutex();
 
     status = s->read(buf);
     if (status < 0) {
         PAL_ERR(LOG_TAG, "stream read failed status %d", status);
     }
 
-    rm->lockValidStreamMutex();
     rm->decreaseStreamUserCounter(s);
-    rm->unlockValidStreamMutex();
     PAL_VERBOSE(LOG_TAG, "Exit. status %d", status);
     return status;
 }
@@ -437,6 +434,7 @@ ssize_t pal_stream_read(pal_stream_handle_t *stream_handle, struct pal_buffer *b
 int32_t pal_stream_get_param(pal_stream_handle_t *stream_handle,
                              uint32_t param_id, pal_param_payload **param_payload)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_GET_PARAM);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -481,6 +479,7 @@ int32_t pal_stream_get_param(pal_stream_handle_t *stream_handle,
 int32_t pal_stream_set_param(pal_stream_handle_t *stream_handle, uint32_t param_id,
                              pal_param_payload *param_payload)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_SET_PARAM);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -534,6 +533,7 @@ int32_t pal_stream_set_param(pal_stream_handle_t *stream_handle, uint32_t param_
 int32_t pal_stream_set_volume(pal_stream_handle_t *stream_handle,
                               struct pal_volume_data *volume)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_SET_VOLUME);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -583,6 +583,7 @@ int32_t pal_stream_set_volume(pal_stream_handle_t *stream_handle,
 
 int32_t pal_stream_set_mute(pal_stream_handle_t *stream_handle, bool state)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_SET_MUTE);
     Stream *s = NULL;
     std::shared_ptr<ResourceManager> rm = NULL;
     int status = 0;
@@ -635,6 +636,7 @@ exit:
 
 int32_t pal_stream_pause(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_PAUSE);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -677,6 +679,7 @@ int32_t pal_stream_pause(pal_stream_handle_t *stream_handle)
 
 int32_t pal_stream_resume(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_RESUME);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -719,6 +722,7 @@ int32_t pal_stream_resume(pal_stream_handle_t *stream_handle)
 
 int32_t pal_stream_drain(pal_stream_handle_t *stream_handle, pal_drain_type_t type)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_DRAIN);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -771,6 +775,7 @@ exit:
 
 int32_t pal_stream_flush(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_FLUSH);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -814,6 +819,7 @@ int32_t pal_stream_flush(pal_stream_handle_t *stream_handle)
 
 int32_t pal_stream_suspend(pal_stream_handle_t *stream_handle)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_SUSPEND);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -859,6 +865,7 @@ int32_t pal_stream_set_buffer_size (pal_stream_handle_t *stream_handle,
                                     pal_buffer_config *in_buffer_cfg,
                                     pal_buffer_config *out_buffer_cfg)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_SET_BUFFER_SIZE);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -902,6 +909,7 @@ int32_t pal_stream_set_buffer_size (pal_stream_handle_t *stream_handle,
 int32_t pal_get_timestamp(pal_stream_handle_t *stream_handle,
                           struct pal_session_time *stime)
 {
+    PalLatencyScope latency(PAL_LATENCY_GET_TIMESTAMP);
     Stream *s = NULL;
     int status = -EINVAL;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -950,6 +958,7 @@ int32_t pal_get_timestamp(pal_stream_handle_t *stream_handle,
 int32_t pal_add_remove_effect(pal_stream_handle_t *stream_handle,
                        pal_audio_effect_t effect, bool enable)
 {
+    PalLatencyScope latency(PAL_LATENCY_ADD_REMOVE_EFFECT);
     Stream *s = NULL;
     int status = 0;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -995,6 +1004,7 @@ int32_t pal_add_remove_effect(pal_stream_handle_t *stream_handle,
 int32_t pal_stream_set_device(pal_stream_handle_t *stream_handle,
                            uint32_t no_of_devices, struct pal_device *devices)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_SET_DEVICE);
     int status = -EINVAL;
     Stream *s = NULL;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -1154,6 +1164,7 @@ exit:
 int32_t pal_stream_get_tags_with_module_info(pal_stream_handle_t *stream_handle,
                            size_t *size, uint8_t *payload)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_GET_TAGS);
     int status = 0;
     Stream *s = NULL;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -1196,6 +1207,7 @@ int32_t pal_stream_get_tags_with_module_info(pal_stream_handle_t *stream_handle,
 int32_t pal_set_param(uint32_t param_id, void *param_payload,
                       size_t payload_size)
 {
+    PalLatencyScope latency(PAL_LATENCY_SET_PARAM);
     PAL_DBG(LOG_TAG, "Enter: param id %d", param_id);
     int status = 0;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -1218,6 +1230,7 @@ int32_t pal_set_param(uint32_t param_id, void *param_payload,
 int32_t pal_get_param(uint32_t param_id, void **param_payload,
                       size_t *payload_size, void *query)
 {
+    PalLatencyScope latency(PAL_LATENCY_GET_PARAM);
     int status = 0;
     std::shared_ptr<ResourceManager> rm = NULL;
 
@@ -1242,6 +1255,7 @@ int32_t pal_get_param(uint32_t param_id, void **param_payload,
 int32_t pal_stream_get_mmap_position(pal_stream_handle_t *stream_handle,
                               struct pal_mmap_position *position)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_GET_MMAP_POSITION);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -1287,6 +1301,7 @@ int32_t pal_stream_create_mmap_buffer(pal_stream_handle_t *stream_handle,
                               int32_t min_size_frames,
                               struct pal_mmap_buffer *info)
 {
+    PalLatencyScope latency(PAL_LATENCY_STREAM_CREATE_MMAP_BUFFER);
     Stream *s = NULL;
     int status;
     std::shared_ptr<ResourceManager> rm = NULL;
@@ -1347,6 +1362,7 @@ int32_t pal_gef_rw_param(uint32_t param_id, void *param_payload,
                       size_t payload_size, pal_device_id_t pal_device_id,
                       pal_stream_type_t pal_stream_type, unsigned int dir)
 {
+    PalLatencyScope latency(PAL_LATENCY_GEF_RW_PARAM);
     int status = 0;
     std::shared_ptr<ResourceManager> rm = NULL;
 
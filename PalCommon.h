@@ -41,9 +41,22 @@
 #define PAL_LOG_INFO            (0x2) /**< info message, additional info to support debug */
 #define PAL_LOG_DBG             (0x4) /**< debug message, required at minimum for debug.*/
 #define PAL_LOG_VERBOSE         (0x8)/**< verbose message, useful primarily to help developers debug low-level code */
+#define PAL_LOG_TRACE           (0x10)/**< send info/debug/verbose to the binary trace ring instead of logcat */
+
+/* levels built in, anything outside this mask is compiled out */
+#ifndef PAL_LOG_COMPILE_LVL
+#define PAL_LOG_COMPILE_LVL     (PAL_LOG_ERR|PAL_LOG_INFO|PAL_LOG_DBG|PAL_LOG_VERBOSE)
+#endif
 
 extern uint32_t pal_log_lvl;
 
+/* stores a record in the calling thread's trace ring, see PalTrace.h */
+void palTraceLog(uint8_t level, const char *tag, const char *func,
+                 uint32_t line, const char *fmt, ...)
+                 __attribute__((format(printf, 5, 6)));
+
+#define PAL_LOG_ON(lvl) ((PAL_LOG_COMPILE_LVL & (lvl)) && (pal_log_lvl & (lvl)))
+
 #define PAL_FATAL(log_tag, arg,...)                                       \
     if (pal_log_lvl & PAL_LOG_ERR) {                              \
         ALOGE("%s: %d: "  arg, __func__, __LINE__, ##__VA_ARGS__);\
@@ -51,18 +64,30 @@ extern uint32_t pal_log_lvl;
     }
 
 #define PAL_ERR(log_tag, arg,...)                                          \
-    if (pal_log_lvl & PAL_LOG_ERR) {                              \
+    if (PAL_LOG_ON(PAL_LOG_ERR)) {                                 \
         ALOGE("%s: %d: "  arg, __func__, __LINE__, ##__VA_ARGS__);\
     }
 #define PAL_DBG(log_tag,arg,...)                                           \
-    if (pal_log_lvl & PAL_LOG_DBG) {                               \
-        ALOGD("%s: %d: "  arg, __func__, __LINE__, ##__VA_ARGS__); \
+    if (PAL_LOG_ON(PAL_LOG_DBG)) {                                 \
+        if (pal_log_lvl & PAL_LOG_TRACE)                           \
+            palTraceLog(PAL_LOG_DBG, log_tag, __func__, __LINE__,  \
+                        arg, ##__VA_ARGS__);                       \
+        else                                                       \
+            ALOGD("%s: %d: "  arg, __func__, __LINE__, ##__VA_ARGS__); \
     }
 #define PAL_INFO(log_tag,arg,...)                                         \
-    if (pal_log_lvl & PAL_LOG_INFO) {                             \
-        ALOGI("%s: %d: "  arg, __func__, __LINE__, ##__VA_ARGS__);\
+    if (PAL_LOG_ON(PAL_LOG_INFO)) {                               \
+        if (pal_log_lvl & PAL_LOG_TRACE)                          \
+            palTraceLog(PAL_LOG_INFO, log_tag, __func__, __LINE__,\
+                        arg, ##__VA_ARGS__);                      \
+        else                                                      \
+            ALOGI("%s: %d: "  arg, __func__, __LINE__, ##__VA_ARGS__);\
     }
 #define PAL_VERBOSE(log_tag,arg,...)                                      \
-    if (pal_log_lvl & PAL_LOG_VERBOSE) {                          \
-        ALOGV("%s: %d: "  arg, __func__, __LINE__, ##__VA_ARGS__);\
+    if (PAL_LOG_ON(PAL_LOG_VERBOSE)) {                            \
+        if (pal_log_lvl & PAL_LOG_TRACE)                          \
+            palTraceLog(PAL_LOG_VERBOSE, log_tag, __func__, __LINE__,\
+                        arg, ##__VA_ARGS__);                      \
+        else                                                      \
+            ALOGV("%s: %d: "  arg, __func__, __LINE__, ##__VA_ARGS__);\
     }
@@ -920,6 +920,10 @@ typedef enum {
     PAL_PARAM_ID_TIMESTRETCH_PARAMS = 72,
     PAL_PARAM_ID_LATENCY_MODE = 73,
     PAL_PARAM_ID_PROXY_RECORD_SESSION = 74,
+    PAL_PARAM_ID_API_LATENCY_STATS = 75,
+    PAL_PARAM_ID_LOG_TRACE = 76,
+    PAL_PARAM_ID_FE_POOL_STATS = 77,
+    PAL_PARAM_ID_SESSION_CACHE_STATS = 78,
 } pal_param_id_type_t;
 
 /** HDMI/DP */
@@ -1119,6 +1123,126 @@ typedef struct pal_param_bta2dp {
     uint32_t latency;
 } pal_param_bta2dp_t;
 
+/** Call sites timed for PAL_PARAM_ID_API_LATENCY_STATS */
+typedef enum {
+    PAL_LATENCY_STREAM_OPEN = 0,
+    PAL_LATENCY_STREAM_CLOSE,
+    PAL_LATENCY_STREAM_START,
+    PAL_LATENCY_STREAM_STOP,
+    PAL_LATENCY_STREAM_WRITE,
+    PAL_LATENCY_STREAM_READ,
+    PAL_LATENCY_STREAM_GET_PARAM,
+    PAL_LATENCY_STREAM_SET_PARAM,
+    PAL_LATENCY_STREAM_SET_VOLUME,
+    PAL_LATENCY_STREAM_SET_MUTE,
+    PAL_LATENCY_STREAM_PAUSE,
+    PAL_LATENCY_STREAM_RESUME,
+    PAL_LATENCY_STREAM_DRAIN,
+    PAL_LATENCY_STREAM_FLUSH,
+    PAL_LATENCY_STREAM_SUSPEND,
+    PAL_LATENCY_STREAM_SET_BUFFER_SIZE,
+    PAL_LATENCY_GET_TIMESTAMP,
+    PAL_LATENCY_ADD_REMOVE_EFFECT,
+    PAL_LATENCY_STREAM_SET_DEVICE,
+    PAL_LATENCY_STREAM_GET_TAGS,
+    PAL_LATENCY_SET_PARAM,
+    PAL_LATENCY_GET_PARAM,
+    PAL_LATENCY_STREAM_GET_MMAP_POSITION,
+    PAL_LATENCY_STREAM_CREATE_MMAP_BUFFER,
+    PAL_LATENCY_GEF_RW_PARAM,
+    PAL_LATENCY_SESSION_OPEN,
+    PAL_LATENCY_SESSION_START,
+    PAL_LATENCY_SESSION_STOP,
+    PAL_LATENCY_SESSION_CLOSE,
+    PAL_LATENCY_RM_DEVICE_SWITCH,
+    PAL_LATENCY_DEVICE_OPEN,
+    PAL_LATENCY_DEVICE_CLOSE,
+    /* tag table lookups served from the session cache or read from the kernel */
+    PAL_LATENCY_TAG_INFO_HIT,
+    PAL_LATENCY_TAG_INFO_MISS,
+    /* A2DP suspend until streams are switched off A2DP, and the muted
+     * stream drain wait inside it */
+    PAL_LATENCY_A2DP_SUSPEND,
+    PAL_LATENCY_A2DP_SUSPEND_DRAIN,
+    /* ResourceManager construction at pal_init, the config parses run on
+     * async tasks and the time the constructor blocks joining them */
+    PAL_LATENCY_RM_INIT,
+    PAL_LATENCY_RM_INIT_KV_XML,
+    PAL_LATENCY_RM_INIT_AUDIO_ROUTE,
+    PAL_LATENCY_RM_INIT_JOIN,
+    /* BT codec plugin open and config pack on A2DP/BLE device start */
+    PAL_LATENCY_BT_CODEC_PAYLOAD,
+    /* sound trigger model load/unload on an engine shared by streams,
+     * including the SML merge or delete */
+    PAL_LATENCY_ST_MULTI_MODEL_LOAD,
+    PAL_LATENCY_ST_MULTI_MODEL_UNLOAD,
+    /* ACD model register on context enable */
+    PAL_LATENCY_ACD_MODEL_LOAD,
+    PAL_LATENCY_POINT_MAX,
+} pal_latency_point_t;
+
+/* bucket 0 counts calls under 1us, bucket n calls in [2^(n-1), 2^n) us,
+ * the last bucket also takes everything above */
+#define PAL_LATENCY_HIST_BUCKETS 24
+
+typedef struct pal_latency_hist {
+    uint64_t count;
+    uint64_t total_us;
+    uint64_t max_us;
+    uint64_t buckets[PAL_LATENCY_HIST_BUCKETS];
+} pal_latency_hist_t;
+
+/* Payload For ID: PAL_PARAM_ID_API_LATENCY_STATS
+ * Description   : get returns latency histograms of PAL entry points
+ *                 and device transitions, set clears them
+*/
+typedef struct pal_param_latency_stats {
+    uint32_t num_points;
+    uint32_t num_buckets;
+    pal_latency_hist_t hist[PAL_LATENCY_POINT_MAX];
+} pal_param_latency_stats_t;
+
+/* Payload For ID: PAL_PARAM_ID_LOG_TRACE
+ * Description   : get returns the decoded binary log trace as a NUL
+ *                 terminated string in the caller's char buffer, set
+ *                 clears it. There is no payload struct.
+*/
+
+#define PAL_FE_POOL_STATS_MAX 16
+
+typedef struct pal_fe_pool_stats {
+    uint32_t total;
+    uint32_t in_use;
+    uint32_t peak;
+    uint32_t failures;
+} pal_fe_pool_stats_t;
+
+/* Payload For ID: PAL_PARAM_ID_FE_POOL_STATS
+ * Description   : get returns the occupancy of each front end pool,
+ *                 indexed by the resource manager's pool class
+*/
+typedef struct pal_param_fe_pool_stats {
+    uint32_t num_pools;
+    pal_fe_pool_stats_t pool[PAL_FE_POOL_STATS_MAX];
+} pal_param_fe_pool_stats_t;
+
+/* Payload For ID: PAL_PARAM_ID_SESSION_CACHE_STATS
+ * Description   : get returns the counters of the caches kept by the
+ *                 session layer since boot
+*/
+typedef struct pal_param_session_cache_stats {
+    uint32_t tag_info_entries;
+    uint32_t mixer_ctl_entries;
+    uint64_t tag_info_hits;
+    uint64_t tag_info_misses;
+    uint64_t tag_info_invalidated;
+    uint64_t mixer_ctl_hits;
+    uint64_t mixer_ctl_misses;
+    uint64_t mixer_ctl_dropped;
+    uint64_t be_ctl_writes;      /* backend config writes sent */
+    uint64_t be_ctl_skipped;     /* repeated within a device switch */
+} pal_param_session_cache_stats_t;
+
 typedef struct pal_param_upd_event_detection {
     bool     register_status;
 } pal_param_upd_event_detection_t;
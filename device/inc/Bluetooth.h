@@ -34,6 +34,7 @@
 #include <tinyalsa/asoundlib.h>
 #include <bt_intf.h>
 #include <bt_ble.h>
+#include "BtCodecPluginRegistry.h"
 #include <vector>
 #include <mutex>
 #include <system/audio.h>
@@ -87,7 +88,6 @@ protected:
     struct pal_media_config    codecConfig;
     codec_format_t             codecFormat;
     void                       *codecInfo;
-    void                       *pluginHandler;
     bt_codec_t                 *pluginCodec;
     bool                       isAbrEnabled;
     bool                       isConfigured;
@@ -103,8 +103,8 @@ protected:
     std::mutex                 mAbrMutex;
     int                        totalActiveSessionRequests;
 
-    int getPluginPayload(void **handle, bt_codec_t **btCodec,
-                         bt_enc_payload_t **out_buf,
+    int getPluginPayload(bt_codec_t **btCodec,
+                         std::shared_ptr<BtCodecPayload> &payload,
                          codec_type codecType);
     int configureA2dpEncoderDecoder();
     int configureNrecParameters(bool isNrecEnabled);
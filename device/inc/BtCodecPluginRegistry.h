@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BT_CODEC_PLUGIN_REGISTRY_H
+#define BT_CODEC_PLUGIN_REGISTRY_H
+
+#include <bt_intf.h>
+#include <stdint.h>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#define BT_CODEC_PAYLOAD_CACHE_SIZE 16
+
+/* deep copy of a packed plugin payload, outlives the codec that built it */
+class BtCodecPayload
+{
+public:
+    BtCodecPayload(const bt_enc_payload_t *src);
+    ~BtCodecPayload();
+    bt_enc_payload_t *get() { return payload; };
+
+private:
+    bt_enc_payload_t *payload;
+};
+
+/*
+ * Process wide BT codec plugin state. Each plugin library is loaded once
+ * and stays resident, and packed payloads are cached by codec format,
+ * direction and codec config so reconnects and ABR restarts skip packing.
+ */
+class BtCodecPluginRegistry
+{
+public:
+    static int openCodec(const std::string &libPath, uint32_t codecFmt,
+                         codec_type direction, bt_codec_t **codec);
+    /* key is left empty when the codec config cannot be cached */
+    static void getPayloadKey(uint32_t codecFmt, codec_type direction,
+                              void *codecInfo, std::string &key);
+    static std::shared_ptr<BtCodecPayload> getPayload(const std::string &key);
+    static std::shared_ptr<BtCodecPayload> putPayload(const std::string &key,
+                                                      const bt_enc_payload_t *src);
+
+private:
+    struct payloadEntry {
+        std::shared_ptr<BtCodecPayload> payload;
+        std::list<std::string>::iterator order;
+    };
+    static std::mutex mMutex;
+    static std::unordered_map<std::string, open_fn_t> mPlugins;
+    /* each entry knows its place in mPayloadOrder, least recently used first */
+    static std::unordered_map<std::string, payloadEntry> mPayloads;
+    static std::list<std::string> mPayloadOrder;
+};
+
+#endif /* BT_CODEC_PLUGIN_REGISTRY_H */
@@ -71,6 +71,8 @@
 #include <tinyalsa/asoundlib.h>
 #include <vector>
 #include <map>
+#include <mutex>
+#include <string>
 #include <system/audio.h>
 
 #define USB_BUFF_SIZE           4096
@@ -78,6 +80,12 @@
 #define PLAYBACK_PROFILE_STR    "Playback:"
 #define CAPTURE_PROFILE_STR     "Capture:"
 #define DATA_PACKET_INTERVAL_STR "Data packet interval:"
+#define ALTSET_STR              "Altset "
+#define STATUS_STR              "Status:"
+#define INTERFACE_STR           "Interface "
+#define FORMAT_STR              "Format: "
+#define RATES_STR               "Rates: "
+#define USB_STREAM_INFO_MAX_SIZE (64 * 1024)
 #define USB_SIDETONE_GAIN_STR   "usb_sidetone_gain"
 // Supported sample rates for USB
 #define USBID_SIZE                16
@@ -96,6 +104,25 @@ typedef enum usb_usecase_type{
     USB_PLAYBACK,
 } usb_usecase_type_t;
 
+/* one altset of /proc/asound/cardN/stream0 */
+typedef struct usb_altset_cap {
+    usb_usecase_type_t type;
+    unsigned int bit_width;
+    bool big_endian;
+    unsigned int channels;
+    bool continuous_rates;       // rates holds {min, max} when set
+    std::vector<unsigned int> rates;
+    unsigned long service_interval_us;
+} usb_altset_cap_t;
+
+/* parsed stream0 of a card, both directions */
+typedef struct usb_stream_cap {
+    std::string usbid;           // vendor:product id of the device it was read from
+    std::string header;          // first line of stream0: name, bus path and speed
+    std::string stream_info;     // raw text the altsets were parsed from, for dumps
+    std::vector<usb_altset_cap_t> altsets;
+} usb_stream_cap_t;
+
 // one card supports multiple devices
 class USBDeviceConfig {
 protected:
@@ -116,14 +143,13 @@ public:
     void setInterval(unsigned long interval);
     unsigned long getInterval();
     unsigned int getDefaultRate();
-    int getSampleRates(int type, char *rates_str);
+    int setSampleRates(int type, const usb_altset_cap_t &altset);
     bool isRateSupported(int requested_rate);
     int getBestRate(int requested_rate, int candidate_rate, unsigned int *best_rate);
     void usb_find_sample_rate_candidate(int base, int requested_rate,
                                     int cur_rate, int candidate_rate, unsigned int *best_rate);
     int updateBestChInfo(struct pal_channel_info *requested_ch_info,
                          struct pal_channel_info *best);
-    int getServiceInterval(const char *interval_str_start);
     static const unsigned int supported_sample_rates_[MAX_SAMPLE_RATE_SIZE];
     void setJackStatus(bool jack_status);
     bool getJackStatus();
@@ -138,7 +164,22 @@ protected:
     std::vector <std::shared_ptr<USBDeviceConfig>> usb_device_config_list_;
     unsigned int usb_supported_sample_rates_mask_[2] = {0};
     void usb_info_dump(char* read_buf, int type);
+    static std::mutex stream_cap_mutex_;
+    static std::map<std::pair<int, int>,
+        std::shared_ptr<usb_stream_cap_t>> stream_cap_cache_;
+    static int readUsbId(int card, std::string &usbid);
+    static int readStreamHeader(int card, std::string &header);
+    static int readStreamInfo(int card, std::string &stream_info);
+    static int getStreamCapability(struct pal_usb_device_address addr,
+                                   std::shared_ptr<usb_stream_cap_t> &cap);
 public:
+    static int parseStreamInfo(const char *stream_info,
+                               std::vector<usb_altset_cap_t> &altsets);
+    static std::shared_ptr<usb_stream_cap_t> findStreamCapability(
+        struct pal_usb_device_address addr, const std::string &usbid,
+        const std::string &header);
+    static void cacheStreamCapability(struct pal_usb_device_address addr,
+                                      std::shared_ptr<usb_stream_cap_t> cap);
     USBCardConfig(struct pal_usb_device_address address);
     bool isConfigCached(struct pal_usb_device_address addr);
     void setEndian(int endian);
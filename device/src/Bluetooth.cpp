@@ -35,6 +35,7 @@
 #include "Session.h"
 #include "SessionAlsaUtils.h"
 #include "Device.h"
+#include "PalLatencyStats.h"
 #include <dlfcn.h>
 #include <unistd.h>
 #include <cutils/properties.h>
@@ -132,14 +133,15 @@ bool Bluetooth::isPlaceholderEncoder()
     }
 }
 
-int Bluetooth::getPluginPayload(void **libHandle, bt_codec_t **btCodec,
-              bt_enc_payload_t **out_buf, codec_type codecType)
+int Bluetooth::getPluginPayload(bt_codec_t **btCodec,
+              std::shared_ptr<BtCodecPayload> &payload, codec_type codecType)
 {
     std::string lib_path;
-    open_fn_t plugin_open_fn = NULL;
+    std::string key;
     int status = 0;
     bt_codec_t *codec = NULL;
-    void *handle = NULL;
+    bt_enc_payload_t *out_buf = NULL;
+    PalLatencyScope latency(PAL_LATENCY_BT_CODEC_PAYLOAD);
 
     lib_path = rm->getBtCodecLib(codecFormat, (codecType == ENC ? "enc" : "dec"));
     if (lib_path.empty()) {
@@ -147,41 +149,36 @@ int Bluetooth::getPluginPayload(void **libHandle, bt_codec_t **btCodec,
         return -ENOSYS;
     }
 
-    handle = dlopen(lib_path.c_str(), RTLD_NOW);
-    if (handle == NULL) {
-        PAL_ERR(LOG_TAG, "failed to dlopen lib %s", lib_path.c_str());
-        return -EINVAL;
-    }
+    status = BtCodecPluginRegistry::openCodec(lib_path, codecFormat, codecType, &codec);
+    if (status)
+        return status;
 
-    dlerror();
-    plugin_open_fn = (open_fn_t)dlsym(handle, "plugin_open");
-    if (!plugin_open_fn) {
-        PAL_ERR(LOG_TAG, "dlsym to open fn failed, err = '%s'", dlerror());
-        status = -EINVAL;
-        goto error;
+    /* same codec config as a previous start, reuse its packed payload */
+    BtCodecPluginRegistry::getPayloadKey(codecFormat, codecType, codecInfo, key);
+    payload = BtCodecPluginRegistry::getPayload(key);
+    if (payload) {
+        PAL_DBG(LOG_TAG, "reuse packed payload for codec format %x", codecFormat);
+        *btCodec = codec;
+        goto done;
     }
 
-    status = plugin_open_fn(&codec, codecFormat, codecType);
-    if (status) {
-        PAL_ERR(LOG_TAG, "failed to open plugin %d", status);
+    status = codec->plugin_populate_payload(codec, codecInfo, (void **)&out_buf);
+    if (status != 0) {
+        PAL_ERR(LOG_TAG, "fail to pack the encoder config %d", status);
         goto error;
     }
 
-    status = codec->plugin_populate_payload(codec, codecInfo, (void **)out_buf);
-    if (status != 0) {
-        PAL_ERR(LOG_TAG, "fail to pack the encoder config %d", status);
+    payload = BtCodecPluginRegistry::putPayload(key, out_buf);
+    if (!payload) {
+        status = -ENOMEM;
         goto error;
     }
     *btCodec = codec;
-    *libHandle = handle;
     goto done;
 
 error:
     if (codec)
         codec->close_plugin(codec);
-
-    if (handle)
-        dlclose(handle);
 done:
     return status;
 }
@@ -193,6 +190,7 @@ int Bluetooth::configureA2dpEncoderDecoder()
     Session *session = NULL;
     std::vector<Stream*> activestreams;
     bt_enc_payload_t *out_buf = NULL;
+    std::shared_ptr<BtCodecPayload> codecPayload = nullptr;
     PayloadBuilder* builder = new PayloadBuilder();
     std::string backEndName;
     uint8_t* paramData = NULL;
@@ -223,11 +221,12 @@ int Bluetooth::configureA2dpEncoderDecoder()
     /* Retrieve plugin library from resource manager.
      * Map to interested symbols.
      */
-    status = getPluginPayload(&pluginHandler, &pluginCodec, &out_buf, codecType);
+    status = getPluginPayload(&pluginCodec, codecPayload, codecType);
     if (status) {
         PAL_ERR(LOG_TAG, "failed to payload from plugin");
         goto error;
     }
+    out_buf = codecPayload->get();
 
     codecConfig.sample_rate = out_buf->sample_rate;
     codecConfig.bit_width = out_buf->bit_format;
@@ -660,9 +659,9 @@ void Bluetooth::startAbr()
     std::ostringstream disconnectCtrlName;
     unsigned int flags;
     uint32_t codecTagId = 0, miid = 0;
-    void *pluginLibHandle = NULL;
     bt_codec_t *codec = NULL;
     bt_enc_payload_t *out_buf = NULL;
+    std::shared_ptr<BtCodecPayload> codecPayload = nullptr;
     custom_block_t *blk = NULL;
     uint8_t* paramData = NULL;
     size_t paramSize = 0;
@@ -747,7 +746,7 @@ void Bluetooth::startAbr()
     }
 
     connectCtrlName << "PCM" << fbpcmDevIds.at(0) << " connect";
-    connectCtrl = mixer_get_ctl_by_name(virtualMixerHandle, connectCtrlName.str().data());
+    connectCtrl = SessionAlsaUtils::getMixerControl(virtualMixerHandle, connectCtrlName.str().data());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
         goto free_fe;
@@ -762,7 +761,7 @@ void Bluetooth::startAbr()
 
     // Notify ABR usecase information to BT driver to distinguish
     // between SCO and feedback usecase
-    btSetFeedbackChannelCtrl = mixer_get_ctl_by_name(hwMixerHandle,
+    btSetFeedbackChannelCtrl = SessionAlsaUtils::getMixerControl(hwMixerHandle,
                                         MIXER_SET_FEEDBACK_CHANNEL);
     if (!btSetFeedbackChannelCtrl) {
         PAL_ERR(LOG_TAG, "ERROR %s mixer control not identified",
@@ -800,11 +799,12 @@ void Bluetooth::startAbr()
             goto disconnect_fe;
         }
 
-        ret = getPluginPayload(&pluginLibHandle, &codec, &out_buf, (codecType == DEC ? ENC : DEC));
+        ret = getPluginPayload(&codec, codecPayload, (codecType == DEC ? ENC : DEC));
         if (ret) {
             PAL_ERR(LOG_TAG, "getPluginPayload failed");
             goto disconnect_fe;
         }
+        out_buf = codecPayload->get();
 
         /* SWB Encoder/Decoder has only 1 param, read block 0 */
         if (out_buf->num_blks != 1) {
@@ -821,7 +821,6 @@ void Bluetooth::startAbr()
                   (uint32_t *)blk->payload, blk->payload_sz, miid, blk->param_id);
 
         codec->close_plugin(codec);
-        dlclose(pluginLibHandle);
 
         if (!paramData) {
             PAL_ERR(LOG_TAG, "Failed to populateAPMHeader");
@@ -906,11 +905,12 @@ void Bluetooth::startAbr()
                 goto disconnect_fe;
             }
 
-            ret = getPluginPayload(&pluginLibHandle, &codec, &out_buf, (codecType == DEC ? ENC : DEC));
+            ret = getPluginPayload(&codec, codecPayload, (codecType == DEC ? ENC : DEC));
             if (ret) {
                 PAL_ERR(LOG_TAG, "getPluginPayload failed");
                 goto disconnect_fe;
             }
+            out_buf = codecPayload->get();
 
             if (out_buf->num_blks != 1) {
                 PAL_ERR(LOG_TAG, "incorrect block size %d", out_buf->num_blks);
@@ -936,7 +936,6 @@ void Bluetooth::startAbr()
             }
 
             codec->close_plugin(codec);
-            dlclose(pluginLibHandle);
 
             if (fbDevice.id == PAL_DEVICE_IN_BLUETOOTH_SCO_HEADSET) {
                 /* COP v2 DEPACKETIZER Module Configuration */
@@ -1115,7 +1114,7 @@ err_pcm_open:
     fbPcm = NULL;
 disconnect_fe:
     disconnectCtrlName << "PCM" << fbpcmDevIds.at(0) << " disconnect";
-    disconnectCtrl = mixer_get_ctl_by_name(virtualMixerHandle, disconnectCtrlName.str().data());
+    disconnectCtrl = SessionAlsaUtils::getMixerControl(virtualMixerHandle, disconnectCtrlName.str().data());
     if(disconnectCtrl != NULL){
        mixer_ctl_set_enum_by_string(disconnectCtrl, backEndName.c_str());
     }
@@ -1175,7 +1174,7 @@ void Bluetooth::stopAbr()
         goto free_fe;
     }
     // Reset BT driver mixer control for ABR usecase
-    btSetFeedbackChannelCtrl = mixer_get_ctl_by_name(hwMixerHandle,
+    btSetFeedbackChannelCtrl = SessionAlsaUtils::getMixerControl(hwMixerHandle,
                                         MIXER_SET_FEEDBACK_CHANNEL);
     if (!btSetFeedbackChannelCtrl) {
         PAL_ERR(LOG_TAG, "%s mixer control not identified",
@@ -1258,7 +1257,6 @@ BtA2dp::BtA2dp(struct pal_device *device, std::shared_ptr<ResourceManager> Rm)
 {
     a2dpRole = (device->id == PAL_DEVICE_IN_BLUETOOTH_A2DP) ? SINK : SOURCE;
     codecType = (device->id == PAL_DEVICE_IN_BLUETOOTH_A2DP) ? DEC : ENC;
-    pluginHandler = NULL;
     pluginCodec = NULL;
 
     init();
@@ -1608,10 +1606,6 @@ int BtA2dp::stopPlayback()
             pluginCodec->close_plugin(pluginCodec);
             pluginCodec = NULL;
         }
-        if (pluginHandler) {
-            dlclose(pluginHandler);
-            pluginHandler = NULL;
-        }
     }
 
     PAL_DBG(LOG_TAG, "Stop A2DP playback, total active sessions :%d",
@@ -1773,10 +1767,6 @@ int BtA2dp::stopCapture()
             pluginCodec->close_plugin(pluginCodec);
             pluginCodec = NULL;
         }
-        if (pluginHandler) {
-            dlclose(pluginHandler);
-            pluginHandler = NULL;
-        }
     }
     PAL_DBG(LOG_TAG, "Stop A2DP capture, total active sessions :%d",
             totalActiveSessionRequests);
@@ -2024,7 +2014,6 @@ BtSco::BtSco(struct pal_device *device, std::shared_ptr<ResourceManager> Rm)
     : Bluetooth(device, Rm)
 {
     codecType = (device->id == PAL_DEVICE_OUT_BLUETOOTH_SCO) ? ENC : DEC;
-    pluginHandler = NULL;
     pluginCodec = NULL;
 }
 
@@ -2297,10 +2286,6 @@ int BtSco::stop()
         pluginCodec->close_plugin(pluginCodec);
         pluginCodec = NULL;
     }
-    if (pluginHandler) {
-        dlclose(pluginHandler);
-        pluginHandler = NULL;
-    }
 
     Device::stop_l();
     if (isAbrEnabled == false)
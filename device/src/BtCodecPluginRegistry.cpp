@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "PAL: BtCodecPluginRegistry"
+#include "BtCodecPluginRegistry.h"
+#include "PalCommon.h"
+#include <dlfcn.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <bt_bundle.h>
+#include <bt_aptx.h>
+/* every plugin header counts the codecs of its own library */
+#undef NUM_CODEC
+#include <bt_ble.h>
+
+std::mutex BtCodecPluginRegistry::mMutex;
+std::unordered_map<std::string, open_fn_t> BtCodecPluginRegistry::mPlugins;
+std::unordered_map<std::string, BtCodecPluginRegistry::payloadEntry>
+    BtCodecPluginRegistry::mPayloads;
+std::list<std::string> BtCodecPluginRegistry::mPayloadOrder;
+
+static void freePayload(bt_enc_payload_t *payload)
+{
+    uint32_t i;
+
+    if (!payload)
+        return;
+
+    for (i = 0; i < payload->num_blks; i++) {
+        if (payload->blocks[i]) {
+            free(payload->blocks[i]->payload);
+            free(payload->blocks[i]);
+        }
+    }
+    free(payload);
+}
+
+BtCodecPayload::BtCodecPayload(const bt_enc_payload_t *src)
+    : payload(NULL)
+{
+    custom_block_t *blk = NULL;
+    uint32_t i;
+
+    if (!src)
+        return;
+
+    payload = (bt_enc_payload_t *)calloc(1, sizeof(bt_enc_payload_t) +
+                   src->num_blks * sizeof(custom_block_t *));
+    if (!payload)
+        return;
+
+    memcpy(payload, src, sizeof(bt_enc_payload_t));
+    payload->num_blks = 0;
+    for (i = 0; i < src->num_blks; i++) {
+        if (!src->blocks[i])
+            goto error;
+        blk = (custom_block_t *)calloc(1, sizeof(custom_block_t));
+        if (!blk)
+            goto error;
+        payload->blocks[i] = blk;
+        payload->num_blks = i + 1;
+        blk->param_id = src->blocks[i]->param_id;
+        blk->payload_sz = src->blocks[i]->payload_sz;
+        if (blk->payload_sz) {
+            blk->payload = (uint8_t *)malloc(blk->payload_sz);
+            if (!blk->payload)
+                goto error;
+            memcpy(blk->payload, src->blocks[i]->payload, blk->payload_sz);
+        }
+    }
+    return;
+
+error:
+    PAL_ERR(LOG_TAG, "failed to copy codec payload");
+    freePayload(payload);
+    payload = NULL;
+}
+
+BtCodecPayload::~BtCodecPayload()
+{
+    freePayload(payload);
+}
+
+int BtCodecPluginRegistry::openCodec(const std::string &libPath, uint32_t codecFmt,
+                                     codec_type direction, bt_codec_t **codec)
+{
+    open_fn_t openFn = NULL;
+    void *handle = NULL;
+    int status = 0;
+
+    mMutex.lock();
+    auto it = mPlugins.find(libPath);
+    if (it != mPlugins.end()) {
+        openFn = it->second;
+        mMutex.unlock();
+        goto open;
+    }
+
+    handle = dlopen(libPath.c_str(), RTLD_NOW);
+    if (handle == NULL) {
+        PAL_ERR(LOG_TAG, "failed to dlopen lib %s", libPath.c_str());
+        status = -EINVAL;
+        goto exit;
+    }
+
+    dlerror();
+    openFn = (open_fn_t)dlsym(handle, "plugin_open");
+    if (!openFn) {
+        PAL_ERR(LOG_TAG, "dlsym to open fn failed, err = '%s'", dlerror());
+        dlclose(handle);
+        status = -EINVAL;
+        goto exit;
+    }
+    /* plugin stays loaded for the life of the process */
+    mPlugins[libPath] = openFn;
+    PAL_INFO(LOG_TAG, "loaded codec plugin %s", libPath.c_str());
+    mMutex.unlock();
+
+open:
+    status = openFn(codec, codecFmt, direction);
+    if (status)
+        PAL_ERR(LOG_TAG, "failed to open plugin %d", status);
+    return status;
+
+exit:
+    mMutex.unlock();
+    return status;
+}
+
+static void appendKey(std::string &key, const void *data, size_t size)
+{
+    key.append((const char *)data, size);
+}
+
+/* one field at a time, so struct padding never reaches the key */
+#define APPEND_FIELD(key, cfg, field) \
+    appendKey(key, &(cfg)->field, sizeof((cfg)->field))
+
+static void appendAbrMapKey(std::string &key,
+                            const struct quality_level_to_bitrate_info *map)
+{
+    APPEND_FIELD(key, map, num_levels);
+    for (int i = 0; i < MAX_ABR_QUALITY_LEVELS; i++) {
+        APPEND_FIELD(key, map, bit_rate_level_map[i].link_quality_level);
+        APPEND_FIELD(key, map, bit_rate_level_map[i].bitrate);
+    }
+}
+
+static void appendLc3Key(std::string &key, const lc3_cfg_t *cfg)
+{
+    APPEND_FIELD(key, cfg, api_version);
+    APPEND_FIELD(key, cfg, sampling_freq);
+    APPEND_FIELD(key, cfg, max_octets_per_frame);
+    APPEND_FIELD(key, cfg, frame_duration);
+    APPEND_FIELD(key, cfg, bit_depth);
+    APPEND_FIELD(key, cfg, num_blocks);
+    APPEND_FIELD(key, cfg, default_q_level);
+    APPEND_FIELD(key, cfg, vendor_specific);
+    APPEND_FIELD(key, cfg, mode);
+}
+
+static void appendStreamMapKey(std::string &key, uint8_t size,
+                               const lc3_stream_map_t *map)
+{
+    appendKey(key, &size, sizeof(size));
+    for (uint8_t i = 0; map && i < size; i++) {
+        APPEND_FIELD(key, &map[i], audio_location);
+        APPEND_FIELD(key, &map[i], stream_id);
+        APPEND_FIELD(key, &map[i], direction);
+    }
+}
+
+/*
+ * The key holds every codec config field the plugin packs from, with
+ * pointed to structs inlined. Decoder configs the plugins ignore and
+ * unknown formats are not cached.
+ */
+void BtCodecPluginRegistry::getPayloadKey(uint32_t codecFmt, codec_type direction,
+                                          void *codecInfo, std::string &key)
+{
+    audio_sbc_encoder_config_t *sbc = NULL;
+    audio_celt_encoder_config_t *celt = NULL;
+    audio_ldac_encoder_config_t *ldac = NULL;
+    audio_aptx_encoder_config_t *aptx = NULL;
+    audio_aptx_hd_encoder_config_t *aptxHd = NULL;
+    audio_aptx_dual_mono_config_t *aptxDm = NULL;
+    audio_aptx_ad_encoder_config_t *aptxAd = NULL;
+    audio_aac_encoder_config_t *aac = NULL;
+    audio_lc3_codec_cfg_t *lc3 = NULL;
+    uint8_t present = 0;
+
+    key.clear();
+    if (!codecInfo)
+        return;
+
+    appendKey(key, &codecFmt, sizeof(codecFmt));
+    appendKey(key, &direction, sizeof(direction));
+    switch (codecFmt) {
+    case CODEC_TYPE_SBC:
+        if (direction != ENC)
+            goto uncached;
+        sbc = (audio_sbc_encoder_config_t *)codecInfo;
+        APPEND_FIELD(key, sbc, subband);
+        APPEND_FIELD(key, sbc, blk_len);
+        APPEND_FIELD(key, sbc, sampling_rate);
+        APPEND_FIELD(key, sbc, channels);
+        APPEND_FIELD(key, sbc, alloc);
+        APPEND_FIELD(key, sbc, min_bitpool);
+        APPEND_FIELD(key, sbc, max_bitpool);
+        APPEND_FIELD(key, sbc, bitrate);
+        APPEND_FIELD(key, sbc, bits_per_sample);
+        break;
+    case CODEC_TYPE_CELT:
+        if (direction != ENC)
+            goto uncached;
+        celt = (audio_celt_encoder_config_t *)codecInfo;
+        APPEND_FIELD(key, celt, sampling_rate);
+        APPEND_FIELD(key, celt, channels);
+        APPEND_FIELD(key, celt, frame_size);
+        APPEND_FIELD(key, celt, complexity);
+        APPEND_FIELD(key, celt, prediction_mode);
+        APPEND_FIELD(key, celt, vbr_flag);
+        APPEND_FIELD(key, celt, bitrate);
+        APPEND_FIELD(key, celt, bits_per_sample);
+        break;
+    case CODEC_TYPE_LDAC:
+        if (direction != ENC)
+            goto uncached;
+        ldac = (audio_ldac_encoder_config_t *)codecInfo;
+        APPEND_FIELD(key, ldac, sampling_rate);
+        APPEND_FIELD(key, ldac, bit_rate);
+        APPEND_FIELD(key, ldac, channel_mode);
+        APPEND_FIELD(key, ldac, mtu);
+        APPEND_FIELD(key, ldac, bits_per_sample);
+        APPEND_FIELD(key, ldac, is_abr_enabled);
+        appendAbrMapKey(key, &ldac->level_to_bitrate_map);
+        break;
+    case CODEC_TYPE_APTX:
+        if (direction != ENC)
+            goto uncached;
+        aptx = (audio_aptx_encoder_config_t *)codecInfo;
+        APPEND_FIELD(key, aptx, sampling_rate);
+        APPEND_FIELD(key, aptx, channels);
+        APPEND_FIELD(key, aptx, bitrate);
+        APPEND_FIELD(key, aptx, bits_per_sample);
+        break;
+    case CODEC_TYPE_APTX_HD:
+        if (direction != ENC)
+            goto uncached;
+        aptxHd = (audio_aptx_hd_encoder_config_t *)codecInfo;
+        APPEND_FIELD(key, aptxHd, sampling_rate);
+        APPEND_FIELD(key, aptxHd, channels);
+        APPEND_FIELD(key, aptxHd, bitrate);
+        APPEND_FIELD(key, aptxHd, bits_per_sample);
+        break;
+    case CODEC_TYPE_APTX_DUAL_MONO:
+        if (direction != ENC)
+            goto uncached;
+        aptxDm = (audio_aptx_dual_mono_config_t *)codecInfo;
+        APPEND_FIELD(key, aptxDm, sampling_rate);
+        APPEND_FIELD(key, aptxDm, channels);
+        APPEND_FIELD(key, aptxDm, bitrate);
+        APPEND_FIELD(key, aptxDm, sync_mode);
+        break;
+    case CODEC_TYPE_APTX_AD:
+        if (direction != ENC)
+            goto uncached;
+        aptxAd = (audio_aptx_ad_encoder_config_t *)codecInfo;
+        APPEND_FIELD(key, aptxAd, sampling_rate);
+        APPEND_FIELD(key, aptxAd, mtu);
+        APPEND_FIELD(key, aptxAd, channel_mode);
+        APPEND_FIELD(key, aptxAd, min_sink_modeA);
+        APPEND_FIELD(key, aptxAd, max_sink_modeA);
+        APPEND_FIELD(key, aptxAd, min_sink_modeB);
+        APPEND_FIELD(key, aptxAd, max_sink_modeB);
+        APPEND_FIELD(key, aptxAd, min_sink_modeC);
+        APPEND_FIELD(key, aptxAd, max_sink_modeC);
+        APPEND_FIELD(key, aptxAd, encoder_mode);
+        APPEND_FIELD(key, aptxAd, TTP_modeA_low);
+        APPEND_FIELD(key, aptxAd, TTP_modeA_high);
+        APPEND_FIELD(key, aptxAd, TTP_modeB_low);
+        APPEND_FIELD(key, aptxAd, TTP_modeB_high);
+        APPEND_FIELD(key, aptxAd, TTP_TWS_low);
+        APPEND_FIELD(key, aptxAd, TTP_TWS_high);
+        APPEND_FIELD(key, aptxAd, bits_per_sample);
+        APPEND_FIELD(key, aptxAd, input_mode);
+        APPEND_FIELD(key, aptxAd, fade_duration);
+        APPEND_FIELD(key, aptxAd, sink_cap);
+        break;
+    case CODEC_TYPE_APTX_AD_SPEECH:
+        /* speech mode */
+        appendKey(key, codecInfo, sizeof(uint32_t));
+        break;
+    case CODEC_TYPE_AAC:
+        if (direction != ENC)
+            goto uncached;
+        aac = (audio_aac_encoder_config_t *)codecInfo;
+        APPEND_FIELD(key, aac, enc_mode);
+        APPEND_FIELD(key, aac, format_flag);
+        APPEND_FIELD(key, aac, channels);
+        APPEND_FIELD(key, aac, sampling_rate);
+        APPEND_FIELD(key, aac, bitrate);
+        APPEND_FIELD(key, aac, bits_per_sample);
+        APPEND_FIELD(key, aac, frame_ctl.ctl_type);
+        APPEND_FIELD(key, aac, frame_ctl.ctl_value);
+        APPEND_FIELD(key, aac, size_control_struct);
+        present = aac->frame_ctl_ptr ? 1 : 0;
+        appendKey(key, &present, sizeof(present));
+        if (aac->frame_ctl_ptr) {
+            APPEND_FIELD(key, aac, frame_ctl_ptr->ctl_type);
+            APPEND_FIELD(key, aac, frame_ctl_ptr->ctl_value);
+        }
+        APPEND_FIELD(key, aac, abr_size_control_struct);
+        present = aac->abr_ctl_ptr ? 1 : 0;
+        appendKey(key, &present, sizeof(present));
+        if (aac->abr_ctl_ptr) {
+            APPEND_FIELD(key, aac, abr_ctl_ptr->is_abr_enabled);
+            appendAbrMapKey(key, &aac->abr_ctl_ptr->level_to_bitrate_map);
+        }
+        break;
+    case CODEC_TYPE_LC3:
+        lc3 = (audio_lc3_codec_cfg_t *)codecInfo;
+        appendLc3Key(key, &lc3->enc_cfg.toAirConfig);
+        appendStreamMapKey(key, lc3->enc_cfg.stream_map_size, lc3->enc_cfg.streamMapOut);
+        appendLc3Key(key, &lc3->dec_cfg.fromAirConfig);
+        APPEND_FIELD(key, lc3, dec_cfg.decoder_output_channel);
+        appendStreamMapKey(key, lc3->dec_cfg.stream_map_size, lc3->dec_cfg.streamMapIn);
+        APPEND_FIELD(key, lc3, is_enc_config_set);
+        APPEND_FIELD(key, lc3, is_dec_config_set);
+        break;
+    default:
+        goto uncached;
+    }
+    return;
+
+uncached:
+    key.clear();
+}
+
+std::shared_ptr<BtCodecPayload> BtCodecPluginRegistry::getPayload(const std::string &key)
+{
+    std::shared_ptr<BtCodecPayload> payload = nullptr;
+
+    if (key.empty())
+        return nullptr;
+
+    mMutex.lock();
+    auto it = mPayloads.find(key);
+    if (it != mPayloads.end()) {
+        payload = it->second.payload;
+        /* most recently used goes last */
+        mPayloadOrder.splice(mPayloadOrder.end(), mPayloadOrder, it->second.order);
+    }
+    mMutex.unlock();
+
+    return payload;
+}
+
+std::shared_ptr<BtCodecPayload> BtCodecPluginRegistry::putPayload(const std::string &key,
+                                                                  const bt_enc_payload_t *src)
+{
+    std::shared_ptr<BtCodecPayload> payload = std::make_shared<BtCodecPayload>(src);
+
+    if (!payload->get())
+        return nullptr;
+    if (key.empty())
+        return payload;
+
+    mMutex.lock();
+    auto it = mPayloads.find(key);
+    if (it != mPayloads.end()) {
+        it->second.payload = payload;
+        mPayloadOrder.splice(mPayloadOrder.end(), mPayloadOrder, it->second.order);
+    } else {
+        if (mPayloads.size() >= BT_CODEC_PAYLOAD_CACHE_SIZE) {
+            mPayloads.erase(mPayloadOrder.front());
+            mPayloadOrder.pop_front();
+        }
+        mPayloads[key] = {payload, mPayloadOrder.insert(mPayloadOrder.end(), key)};
+    }
+    mMutex.unlock();
+
+    return payload;
+}
@@ -33,6 +33,7 @@
 #include <tinyalsa/asoundlib.h>
 #include "ResourceManager.h"
 #include "SessionAlsaUtils.h"
+#include "PalLatencyStats.h"
 #include "Device.h"
 #include "Speaker.h"
 #include "SpeakerProtection.h"
@@ -364,6 +365,7 @@ int Device::deinit(pal_param_device_connection_t device_conn __unused)
 
 int Device::open()
 {
+    PalLatencyScope latency(PAL_LATENCY_DEVICE_OPEN);
     int status = 0;
 
     mDeviceMutex.lock();
@@ -411,6 +413,7 @@ exit:
 
 int Device::close()
 {
+    PalLatencyScope latency(PAL_LATENCY_DEVICE_CLOSE);
     int status = 0;
     mDeviceMutex.lock();
     PAL_INFO(LOG_TAG, "Enter. deviceCount %d for device id %d (%s)", deviceCount,
@@ -546,7 +549,7 @@ int32_t Device::configureDeviceClockSrc(char const *mixerStrClockSrc, const uint
     /* Hw mixer control registration is optional in case
      * clock source selection is not required
      */
-    clockSrcCtrl = mixer_get_ctl_by_name(hwMixerHandle, mixerStrClockSrc);
+    clockSrcCtrl = SessionAlsaUtils::getMixerControl(hwMixerHandle, mixerStrClockSrc);
     if (!clockSrcCtrl) {
         PAL_DBG(LOG_TAG, "%s hw mixer control not identified", mixerStrClockSrc);
         goto exit;
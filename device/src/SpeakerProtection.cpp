@@ -298,7 +298,7 @@ int SpeakerProtection::getCpsDevNumber(std::string mixer_name)
     PAL_DBG(LOG_TAG, "Mixer control %s", mixer_name.c_str());
     PAL_DBG(LOG_TAG, "audio_hw_mixer %pK", hwMixer);
 
-    ctl = mixer_get_ctl_by_name(hwMixer, mixer_name.c_str());
+    ctl = SessionAlsaUtils::getMixerControl(hwMixer, mixer_name.c_str());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_name.c_str());
         status = -ENOENT;
@@ -329,7 +329,7 @@ int SpeakerProtection::getSpeakerTemperature(int spkr_pos)
 
     PAL_DBG(LOG_TAG, "audio_mixer %pK", hwMixer);
 
-    ctl = mixer_get_ctl_by_name(hwMixer, mixer_ctl_name.c_str());
+    ctl = SessionAlsaUtils::getMixerControl(hwMixer, mixer_ctl_name.c_str());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_ctl_name.c_str());
         status = -EINVAL;
@@ -366,7 +366,7 @@ void SpeakerProtection::disconnectFeandBe(std::vector<int> pcmDevIds,
     }
 
     disconnectCtrlNameBe<< backEndName << " metadata";
-    beMetaDataMixerCtrl = mixer_get_ctl_by_name(virtMixer, disconnectCtrlNameBe.str().data());
+    beMetaDataMixerCtrl = SessionAlsaUtils::getMixerControl(virtMixer, disconnectCtrlNameBe.str().data());
     if (!beMetaDataMixerCtrl) {
         ret = -EINVAL;
         PAL_ERR(LOG_TAG, "Error: %d, invalid mixer control %s", ret, backEndName.c_str());
@@ -374,7 +374,7 @@ void SpeakerProtection::disconnectFeandBe(std::vector<int> pcmDevIds,
     }
 
     disconnectCtrlName << "PCM" << pcmDevIds.at(0) << " disconnect";
-    disconnectCtrl = mixer_get_ctl_by_name(virtMixer, disconnectCtrlName.str().data());
+    disconnectCtrl = SessionAlsaUtils::getMixerControl(virtMixer, disconnectCtrlName.str().data());
     if (!disconnectCtrl) {
         ret = -EINVAL;
         PAL_ERR(LOG_TAG, "Error: %d, invalid mixer control: %s", ret, disconnectCtrlName.str().data());
@@ -387,10 +387,11 @@ void SpeakerProtection::disconnectFeandBe(std::vector<int> pcmDevIds,
     }
 
     if (deviceMetaData.size) {
-        ret = mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+        ret = SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                     deviceMetaData.size);
         free(deviceMetaData.buf);
         deviceMetaData.buf = nullptr;
+        SessionAlsaUtils::invalidateTagModuleInfo(backEndName);
     } else {
         PAL_ERR(LOG_TAG, "Error: %d, Device Metadata not cleaned up", ret);
         goto exit;
@@ -550,7 +551,7 @@ int SpeakerProtection::spkrStartCalibrationV2()
     }
 
     connectCtrlNameBeVI<< backEndNameTx << " metadata";
-    beMetaDataMixerCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlNameBeVI.str().data());
+    beMetaDataMixerCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlNameBeVI.str().data());
     if (!beMetaDataMixerCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control for VI : %s", backEndNameTx.c_str());
         ret = -EINVAL;
@@ -558,10 +559,11 @@ int SpeakerProtection::spkrStartCalibrationV2()
     }
 
     if (deviceMetaData.size) {
-        ret = mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+        ret = SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                     deviceMetaData.size);
         free(deviceMetaData.buf);
         deviceMetaData.buf = nullptr;
+        SessionAlsaUtils::invalidateTagModuleInfo(backEndNameTx);
     }
     else {
         PAL_ERR(LOG_TAG, "Device Metadata not set for TX path");
@@ -586,7 +588,7 @@ int SpeakerProtection::spkrStartCalibrationV2()
     }
 
     connectCtrlName << "PCM" << pcmDevIdsTx.at(0) << " connect";
-    connectCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlName.str().data());
+    connectCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlName.str().data());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
         goto free_fe;
@@ -823,7 +825,7 @@ int SpeakerProtection::spkrStartCalibrationV2()
 
     connectCtrlNameBe<< backEndNameRx << " metadata";
 
-    beMetaDataMixerCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlNameBe.str().data());
+    beMetaDataMixerCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlNameBe.str().data());
     if (!beMetaDataMixerCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", backEndNameRx.c_str());
         ret = -EINVAL;
@@ -831,10 +833,11 @@ int SpeakerProtection::spkrStartCalibrationV2()
     }
 
     if (deviceMetaData.size) {
-        ret = mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+        ret = SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                                     deviceMetaData.size);
         free(deviceMetaData.buf);
         deviceMetaData.buf = nullptr;
+        SessionAlsaUtils::invalidateTagModuleInfo(backEndNameRx);
     }
     else {
         PAL_ERR(LOG_TAG, "Device Metadata not set for RX path");
@@ -860,7 +863,7 @@ int SpeakerProtection::spkrStartCalibrationV2()
     }
 
     connectCtrlNameRx << "PCM" << pcmDevIdsRx.at(0) << " connect";
-    connectCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlNameRx.str().data());
+    connectCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlNameRx.str().data());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlNameRx.str().data());
         ret = -ENOSYS;
@@ -1203,7 +1206,7 @@ int SpeakerProtection::spkrStartCalibration()
     }
 
     connectCtrlNameBeVI<< backEndNameTx << " metadata";
-    beMetaDataMixerCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlNameBeVI.str().data());
+    beMetaDataMixerCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlNameBeVI.str().data());
     if (!beMetaDataMixerCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control for VI : %s", backEndNameTx.c_str());
         ret = -EINVAL;
@@ -1211,10 +1214,11 @@ int SpeakerProtection::spkrStartCalibration()
     }
 
     if (deviceMetaData.size) {
-        ret = mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+        ret = SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                     deviceMetaData.size);
         free(deviceMetaData.buf);
         deviceMetaData.buf = nullptr;
+        SessionAlsaUtils::invalidateTagModuleInfo(backEndNameTx);
     }
     else {
         PAL_ERR(LOG_TAG, "Device Metadata not set for TX path");
@@ -1239,7 +1243,7 @@ int SpeakerProtection::spkrStartCalibration()
     }
 
     connectCtrlName << "PCM" << pcmDevIdsTx.at(0) << " connect";
-    connectCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlName.str().data());
+    connectCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlName.str().data());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
         goto free_fe;
@@ -1475,7 +1479,7 @@ int SpeakerProtection::spkrStartCalibration()
 
     connectCtrlNameBe<< backEndNameRx << " metadata";
 
-    beMetaDataMixerCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlNameBe.str().data());
+    beMetaDataMixerCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlNameBe.str().data());
     if (!beMetaDataMixerCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", backEndNameRx.c_str());
         ret = -EINVAL;
@@ -1483,10 +1487,11 @@ int SpeakerProtection::spkrStartCalibration()
     }
 
     if (deviceMetaData.size) {
-        ret = mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+        ret = SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                                     deviceMetaData.size);
         free(deviceMetaData.buf);
         deviceMetaData.buf = nullptr;
+        SessionAlsaUtils::invalidateTagModuleInfo(backEndNameRx);
     }
     else {
         PAL_ERR(LOG_TAG, "Device Metadata not set for RX path");
@@ -1512,7 +1517,7 @@ int SpeakerProtection::spkrStartCalibration()
     }
 
     connectCtrlNameRx << "PCM" << pcmDevIdsRx.at(0) << " connect";
-    connectCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlNameRx.str().data());
+    connectCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlNameRx.str().data());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlNameRx.str().data());
         ret = -ENOSYS;
@@ -1838,7 +1843,7 @@ int SpeakerProtection::getDeviceTemperatureList()
     for(i = 0; i < spDevInfo.numChannels; i++) {
         PAL_ERR(LOG_TAG, "audio_mixer %pK", hwMixer);
         mixer_ctl_name = temp_ctrls[i];
-        ctl = mixer_get_ctl_by_name(hwMixer, mixer_ctl_name.c_str());
+        ctl = SessionAlsaUtils::getMixerControl(hwMixer, mixer_ctl_name.c_str());
         if(!ctl) {
             PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n",
                     mixer_ctl_name.c_str());
@@ -2494,7 +2499,7 @@ int32_t SpeakerProtection::spkrProtProcessingModeV2(bool flag)
             goto exit;
         }
         connectCtrlNameBeVI<< backEndName << " metadata";
-        beMetaDataMixerCtrl = mixer_get_ctl_by_name(virtMixer,
+        beMetaDataMixerCtrl = SessionAlsaUtils::getMixerControl(virtMixer,
                                     connectCtrlNameBeVI.str().data());
         if (!beMetaDataMixerCtrl) {
             PAL_ERR(LOG_TAG, "invalid mixer control for VI : %s", backEndName.c_str());
@@ -2503,10 +2508,11 @@ int32_t SpeakerProtection::spkrProtProcessingModeV2(bool flag)
         }
 
         if (deviceMetaData.size) {
-            ret = mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+            ret = SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                         deviceMetaData.size);
             free(deviceMetaData.buf);
             deviceMetaData.buf = nullptr;
+            SessionAlsaUtils::invalidateTagModuleInfo(backEndName);
         }
         else {
             PAL_ERR(LOG_TAG, "Device Metadata not set for TX path");
@@ -2532,7 +2538,7 @@ int32_t SpeakerProtection::spkrProtProcessingModeV2(bool flag)
         }
 
         connectCtrlName << "PCM" << pcmDevIdTx.at(0) << " connect";
-        connectCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlName.str().data());
+        connectCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlName.str().data());
         if (!connectCtrl) {
             PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
             goto free_fe;
@@ -3155,7 +3161,7 @@ int SpeakerProtection::viTxSetupThreadLoop()
         }
 
         connectCtrlNameBeVI<< backEndName << " metadata";
-        beMetaDataMixerCtrl = mixer_get_ctl_by_name(virtMixer,
+        beMetaDataMixerCtrl = SessionAlsaUtils::getMixerControl(virtMixer,
                                     connectCtrlNameBeVI.str().data());
         if (!beMetaDataMixerCtrl) {
             PAL_ERR(LOG_TAG, "invalid mixer control for VI : %s",
@@ -3170,10 +3176,11 @@ int SpeakerProtection::viTxSetupThreadLoop()
             goto exit;
         }
 
-        ret = mixer_ctl_set_array(beMetaDataMixerCtrl, (void*)deviceMetaData.buf,
+        ret = SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void*)deviceMetaData.buf,
                     deviceMetaData.size);
         free(deviceMetaData.buf);
         deviceMetaData.buf = nullptr;
+        SessionAlsaUtils::invalidateTagModuleInfo(backEndName);
 
         ret = SessionAlsaUtils::setDeviceMediaConfig(rm, backEndName, &device);
         if (ret) {
@@ -3193,7 +3200,7 @@ int SpeakerProtection::viTxSetupThreadLoop()
         }
 
         connectCtrlName << "PCM" << pcmDevIdTx.at(0) << " connect";
-        connectCtrl = mixer_get_ctl_by_name(virtMixer, connectCtrlName.str().data());
+        connectCtrl = SessionAlsaUtils::getMixerControl(virtMixer, connectCtrlName.str().data());
         if (!connectCtrl) {
             PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
             goto free_fe;
@@ -3866,7 +3873,7 @@ int32_t SpeakerProtection::getFTMParameter(void **param)
         goto exit;
     }
 
-    ctl = mixer_get_ctl_by_name(virtMixer, cntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(virtMixer, cntrlName.str().data());
     if (!ctl) {
         status = -ENOENT;
         PAL_ERR(LOG_TAG, "Error: %d Invalid mixer control: %s\n", status,cntrlName.str().data());
@@ -33,6 +33,7 @@
 
 #include <cstdio>
 #include <cmath>
+#include <ctype.h>
 #include "USBAudio.h"
 #include "ResourceManager.h"
 #include "PayloadBuilder.h"
@@ -401,179 +402,335 @@ void USBCardConfig::usb_info_dump(char* read_buf, int type) {
     }
 }
 
-int USBCardConfig::getCapability(usb_usecase_type_t type,
-                                        struct pal_usb_device_address addr) {
-    int32_t size = 0;
+std::mutex USBCardConfig::stream_cap_mutex_;
+std::map<std::pair<int, int>, std::shared_ptr<usb_stream_cap_t>>
+    USBCardConfig::stream_cap_cache_;
+
+/*
+ * Single pass over stream0, e.g.
+ *   Playback:
+ *     Status: Running
+ *       Interface = 1
+ *       Altset = 1
+ *       ...
+ *     Interface 1
+ *       Altset 1
+ *       Format: S16_LE
+ *       Channels: 2
+ *       Rates: 44100, 48000 | Rates: 8000 - 48000 (continuous)
+ *       Data packet interval: 125 us
+ *   Capture:
+ *     ...
+ * The Status block only describes the altset in use and is skipped up to
+ * the next Interface line. Altsets are accepted as "Altset N" or
+ * "Altset = N". Altsets missing format, channels or rates are dropped.
+ */
+int USBCardConfig::parseStreamInfo(const char *stream_info,
+                                   std::vector<usb_altset_cap_t> &altsets)
+{
+    const char *line = stream_info;
+    const char *eol = nullptr;
+    bool in_section = false;
+    bool in_status = false;
+    bool in_altset = false;
+    usb_usecase_type_t type = USB_PLAYBACK;
+    usb_altset_cap_t altset;
+
+    auto commitAltset = [&]() {
+        if (in_altset && altset.bit_width && altset.channels &&
+            !altset.rates.empty())
+            altsets.push_back(altset);
+        in_altset = false;
+    };
+
+    altsets.clear();
+    while (line && *line) {
+        eol = strchr(line, '\n');
+        std::string text(line, eol ? eol - line : strlen(line));
+        line = eol ? eol + 1 : nullptr;
+
+        size_t pos = text.find_first_not_of(" \t");
+        if (pos == std::string::npos)
+            continue;
+        const char *field = text.c_str() + pos;
+
+        if (!strncmp(field, PLAYBACK_PROFILE_STR, strlen(PLAYBACK_PROFILE_STR)) ||
+            !strncmp(field, CAPTURE_PROFILE_STR, strlen(CAPTURE_PROFILE_STR))) {
+            commitAltset();
+            in_section = true;
+            in_status = false;
+            type = (field[0] == 'P') ? USB_PLAYBACK : USB_CAPTURE;
+        } else if (!in_section) {
+            continue;
+        } else if (!strncmp(field, STATUS_STR, strlen(STATUS_STR))) {
+            commitAltset();
+            in_status = true;
+        } else if (!strncmp(field, INTERFACE_STR, strlen(INTERFACE_STR)) &&
+                   isdigit(field[strlen(INTERFACE_STR)])) {
+            commitAltset();
+            in_status = false;
+        } else if (in_status) {
+            continue;
+        } else if (!strncmp(field, ALTSET_STR, strlen(ALTSET_STR)) &&
+                   isdigit(field[strlen(ALTSET_STR) +
+                       strspn(field + strlen(ALTSET_STR), "= ")])) {
+            commitAltset();
+            altset = usb_altset_cap_t();
+            altset.type = type;
+            altset.service_interval_us = DEFAULT_SERVICE_INTERVAL_US;
+            in_altset = true;
+        } else if (!in_altset) {
+            continue;
+        } else if (!strncmp(field, FORMAT_STR, strlen(FORMAT_STR))) {
+            const char *formats[] = {"S32", "S24_3", "S24", "S16", "U32"};
+            const unsigned int bit_width[] = {32, 24, 24, 16, 32};
+            for (size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); i++) {
+                const char *fmt = strstr(field, formats[i]);
+                if (fmt) {
+                    altset.bit_width = bit_width[i];
+                    altset.big_endian = strstr(fmt, "BE") != NULL;
+                    break;
+                }
+            }
+        } else if (!strncmp(field, CHANNEL_NUMBER_STR, strlen(CHANNEL_NUMBER_STR))) {
+            altset.channels = atoi(field + strlen(CHANNEL_NUMBER_STR));
+        } else if (!strncmp(field, RATES_STR, strlen(RATES_STR))) {
+            const char *rate = field + strlen(RATES_STR);
+            char *next = nullptr;
+            altset.continuous_rates = strstr(rate, "continuous") != NULL;
+            while (*rate) {
+                unsigned long sr = strtoul(rate, &next, 10);
+                if (next == rate)
+                    break;
+                altset.rates.push_back(sr);
+                rate = next + strspn(next, " ,-");
+                if (altset.continuous_rates && altset.rates.size() == 2)
+                    break;
+            }
+            if (altset.continuous_rates && altset.rates.size() != 2) {
+                PAL_ERR(LOG_TAG, "could not find min/max of continuous rates");
+                altset.rates.clear();
+            }
+        } else if (!strncmp(field, DATA_PACKET_INTERVAL_STR,
+                            strlen(DATA_PACKET_INTERVAL_STR))) {
+            // Data packet interval is an optional field.
+            // Assume 0ms interval if this cannot be read
+            // LPASS USB and HLOS USB will figure out the default to use
+            unsigned long interval = 0;
+            char time_unit[8] = {0};
+            sscanf(field + strlen(DATA_PACKET_INTERVAL_STR), "%lu %2s",
+                   &interval, &time_unit[0]);
+            if (!strcmp(time_unit, "us")) {
+                altset.service_interval_us = interval;
+            } else if (!strcmp(time_unit, "ms")) {
+                altset.service_interval_us = interval * 1000;
+            } else if (!strcmp(time_unit, "s")) {
+                altset.service_interval_us = interval * 1000000;
+            } else {
+                PAL_ERR(LOG_TAG, "unknown time_unit %s, assume default", time_unit);
+                altset.service_interval_us = DEFAULT_SERVICE_INTERVAL_US;
+            }
+        }
+    }
+    commitAltset();
+
+    return 0;
+}
+
+int USBCardConfig::readStreamInfo(int card, std::string &stream_info)
+{
     FILE *fd = NULL;
-    int32_t channels_no;
-    char *str_start = NULL;
-    char *str_end = NULL;
-    char *channel_start = NULL;
-    char *bit_width_start = NULL;
-    char *rates_str_start = NULL;
-    char *target = NULL;
-    char *read_buf = NULL;
-    char *rates_str = NULL;
-    char *interval_str_start = NULL;
     char path[128];
-    int ret = 0;
-    char *bit_width_str = NULL;
+    char buf[USB_BUFF_SIZE];
     size_t num_read = 0;
-    const char* suffix;
-    bool jack_status;
-    //std::shared_ptr<USBDeviceConfig> usb_device_info = nullptr;
 
-    bool check = false;
-
-    memset(path, 0, sizeof(path));
-    PAL_INFO(LOG_TAG, "for %s", (type == USB_PLAYBACK) ?
-          PLAYBACK_PROFILE_STR : CAPTURE_PROFILE_STR);
+    snprintf(path, sizeof(path), "/proc/asound/card%u/stream0", card);
+    fd = fopen(path, "r");
+    if (!fd) {
+        PAL_ERR(LOG_TAG, "failed to open config file %s error: %d\n", path, errno);
+        return -EINVAL;
+    }
 
-    ret = snprintf(path, sizeof(path), "/proc/asound/card%u/stream0",
-             addr.card_id);
-    if(ret < 0) {
-        PAL_ERR(LOG_TAG, "failed on snprintf (%d) to path %s\n", ret, path);
-        ret = -EINVAL;
-        goto done;
+    /* procfs reports no size, read until EOF */
+    stream_info.clear();
+    while ((num_read = fread(buf, 1, sizeof(buf), fd)) > 0) {
+        stream_info.append(buf, num_read);
+        if (stream_info.size() >= USB_STREAM_INFO_MAX_SIZE) {
+            PAL_ERR(LOG_TAG, "%s larger than %d, truncated", path,
+                USB_STREAM_INFO_MAX_SIZE);
+            break;
+        }
     }
+    fclose(fd);
 
+    return 0;
+}
+
+int USBCardConfig::readUsbId(int card, std::string &usbid)
+{
+    FILE *fd = NULL;
+    char path[128];
+    char buf[USBID_SIZE] = {0};
+
+    snprintf(path, sizeof(path), "/proc/asound/card%u/usbid", card);
     fd = fopen(path, "r");
     if (!fd) {
-        PAL_ERR(LOG_TAG, "failed to open config file %s error: %d\n", path, errno);
-        ret = -EINVAL;
-        goto done;
+        PAL_ERR(LOG_TAG, "failed to open %s error: %d", path, errno);
+        return -EINVAL;
     }
 
-    read_buf = (char *)calloc(1, USB_BUFF_SIZE + 1);
-    if (!read_buf) {
-        PAL_ERR(LOG_TAG, "Failed to create read_buf");
-        ret = -ENOMEM;
-        goto done;
+    if (!fgets(buf, sizeof(buf), fd) || !buf[0]) {
+        PAL_ERR(LOG_TAG, "failed to read %s", path);
+        fclose(fd);
+        return -EINVAL;
     }
+    fclose(fd);
+
+    buf[strcspn(buf, "\n")] = '\0';
+    usbid = buf;
+
+    return 0;
+}
+
+int USBCardConfig::readStreamHeader(int card, std::string &header)
+{
+    FILE *fd = NULL;
+    char path[128];
+    char buf[USB_BUFF_SIZE] = {0};
 
-    if ((num_read = fread(read_buf, 1, USB_BUFF_SIZE, fd)) < 0) {
-        PAL_ERR(LOG_TAG, "file read error");
-        goto done;
+    snprintf(path, sizeof(path), "/proc/asound/card%u/stream0", card);
+    fd = fopen(path, "r");
+    if (!fd) {
+        PAL_ERR(LOG_TAG, "failed to open %s error: %d", path, errno);
+        return -EINVAL;
     }
-    read_buf[num_read] = '\0';
 
-    str_start = strstr(read_buf, ((type == USB_PLAYBACK) ?
-                       PLAYBACK_PROFILE_STR : CAPTURE_PROFILE_STR));
-    if (str_start == NULL) {
-        PAL_INFO(LOG_TAG, "error %s section not found in usb config file",
-                ((type == USB_PLAYBACK) ?
-               PLAYBACK_PROFILE_STR : CAPTURE_PROFILE_STR));
-        ret = -ENOENT;
-        goto done;
+    if (!fgets(buf, sizeof(buf), fd) || !buf[0]) {
+        PAL_ERR(LOG_TAG, "failed to read %s", path);
+        fclose(fd);
+        return -EINVAL;
     }
+    fclose(fd);
 
-    str_end = strstr(read_buf, ((type == USB_PLAYBACK) ?
-                       CAPTURE_PROFILE_STR : PLAYBACK_PROFILE_STR));
+    buf[strcspn(buf, "\n")] = '\0';
+    header = buf;
 
-    if (str_end > str_start)
-        check = true;
+    return 0;
+}
 
-    while (str_start != NULL) {
-        str_start = strstr(str_start, "Altset ");
-        if ((str_start == NULL) || (check  && (str_start >= str_end))) {
-            PAL_VERBOSE(LOG_TAG,"done parsing %s\n", str_start);
-            break;
-        }
-        PAL_VERBOSE(LOG_TAG,"remaining string %s\n", str_start);
-        str_start += sizeof("Altset ");
-        std::shared_ptr<USBDeviceConfig> usb_device_info(new USBDeviceConfig());
-        if (!usb_device_info) {
-            PAL_ERR(LOG_TAG, "error unable to create usb device config object");
-            ret = -ENOMEM;
-            break;
-        }
-        usb_device_info->setType(type);
-        /* Bit bit_width parsing */
-        bit_width_start = strstr(str_start, "Format: ");
-        if (bit_width_start == NULL || (check && (bit_width_start >= str_end))) {
-            PAL_INFO(LOG_TAG, "Could not find bit_width string");
-            continue;
-        }
-        target = strchr(bit_width_start, '\n');
-        if (target == NULL) {
-            PAL_INFO(LOG_TAG, "end of line not found");
-            continue;
-        }
-        size = target - bit_width_start;
-        if ((bit_width_str = (char *)malloc(size + 1)) == NULL) {
-            PAL_ERR(LOG_TAG, "unable to allocate memory to hold bit width strings");
-            ret = -EINVAL;
-            break;
-        }
-        memcpy(bit_width_str, bit_width_start, size);
-        bit_width_str[size] = '\0';
-
-        const char *formats[] = {"S32", "S24_3", "S24", "S16", "U32"};
-        const int bit_width[] = {32, 24, 24, 16, 32};
-        for (size_t i = 0; i < sizeof(formats)/sizeof(formats[0]); i++) {
-            const char * s = strstr(bit_width_str, formats[i]);
-            if (s) {
-                usb_device_info->setBitWidth(bit_width[i]);
-                setEndian(strstr(s, "BE") ? 1 : 0);
-                break;
-            }
-        }
+/*
+ * A card address is reused by whatever device is plugged in next, so a
+ * cached entry only holds if the usbid and the stream0 header line, which
+ * carries the bus path and speed, still match. A headset moved to a port
+ * of another speed gets other service intervals and is parsed again.
+ */
+std::shared_ptr<usb_stream_cap_t> USBCardConfig::findStreamCapability(
+    struct pal_usb_device_address addr, const std::string &usbid,
+    const std::string &header)
+{
+    std::shared_ptr<usb_stream_cap_t> cap = nullptr;
 
-        if (bit_width_str)
-            free(bit_width_str);
+    stream_cap_mutex_.lock();
+    auto it = stream_cap_cache_.find(std::make_pair(addr.card_id, addr.device_num));
+    if (it != stream_cap_cache_.end() && it->second->usbid == usbid &&
+        it->second->header == header)
+        cap = it->second;
+    stream_cap_mutex_.unlock();
 
-        /* channels parsing */
-        channel_start = strstr(str_start, CHANNEL_NUMBER_STR);
-        if (channel_start == NULL || (check && (channel_start >= str_end))) {
-            PAL_INFO(LOG_TAG, "could not find Channels string");
-            continue;
-        }
-        channels_no = atoi(channel_start + strlen(CHANNEL_NUMBER_STR));
-        usb_device_info->setChannels(channels_no);
+    return cap;
+}
 
-        /* Sample rates parsing */
-        rates_str_start = strstr(str_start, "Rates: ");
-        if (rates_str_start == NULL || (check && (rates_str_start >= str_end))) {
-            PAL_INFO(LOG_TAG, "cant find rates string");
-            continue;
+void USBCardConfig::cacheStreamCapability(struct pal_usb_device_address addr,
+                                          std::shared_ptr<usb_stream_cap_t> cap)
+{
+    stream_cap_mutex_.lock();
+    stream_cap_cache_[std::make_pair(addr.card_id, addr.device_num)] = cap;
+    stream_cap_mutex_.unlock();
+}
+
+/*
+ * Reconnects of the same device skip reading and parsing all of stream0,
+ * only its usbid and first line are read to validate the cached entry.
+ * Without either the file is read and parsed uncached.
+ */
+int USBCardConfig::getStreamCapability(struct pal_usb_device_address addr,
+                                       std::shared_ptr<usb_stream_cap_t> &cap)
+{
+    int ret = 0;
+    std::string usbid;
+    std::string header;
+    bool cacheable = false;
+
+    cacheable = !readUsbId(addr.card_id, usbid) &&
+                !readStreamHeader(addr.card_id, header);
+
+    if (cacheable) {
+        cap = findStreamCapability(addr, usbid, header);
+        if (cap) {
+            PAL_DBG(LOG_TAG, "reuse parsed stream info of usb id %s on card %d",
+                usbid.c_str(), addr.card_id);
+            return 0;
         }
-        target = strchr(rates_str_start, '\n');
-        if (target == NULL) {
-            PAL_INFO(LOG_TAG, "end of line not found");
+    }
+
+    cap = std::make_shared<usb_stream_cap_t>();
+    ret = readStreamInfo(addr.card_id, cap->stream_info);
+    if (ret) {
+        cap = nullptr;
+        return ret;
+    }
+    parseStreamInfo(cap->stream_info.c_str(), cap->altsets);
+    cap->usbid = usbid;
+    /* validate against what was parsed, the device may have changed since */
+    cap->header = cap->stream_info.substr(0, cap->stream_info.find('\n'));
+    if (cacheable)
+        cacheStreamCapability(addr, cap);
+
+    return ret;
+}
+
+int USBCardConfig::getCapability(usb_usecase_type_t type,
+                                        struct pal_usb_device_address addr) {
+    int ret = 0;
+    const char* suffix;
+    bool jack_status = true;
+    bool found = false;
+    std::string dump;
+    std::shared_ptr<usb_stream_cap_t> cap = nullptr;
+
+    PAL_INFO(LOG_TAG, "for %s", (type == USB_PLAYBACK) ?
+          PLAYBACK_PROFILE_STR : CAPTURE_PROFILE_STR);
+
+    ret = getStreamCapability(addr, cap);
+    if (ret)
+        return ret;
+
+    for (auto &altset : cap->altsets) {
+        if (altset.type != type)
             continue;
+
+        if (!found) {
+            /* jack status is per direction, query the mixer only once */
+            suffix = (type == USB_PLAYBACK) ? USB_OUT_JACK_SUFFIX : USB_IN_JACK_SUFFIX;
+            jack_status = getJackConnectionStatus(addr.card_id, suffix);
+            PAL_DBG(LOG_TAG, "jack_status %d", jack_status);
+            found = true;
         }
-        size = target - rates_str_start;
-        if ((rates_str = (char *)malloc(size + 1)) == NULL) {
-            PAL_INFO(LOG_TAG, "unable to allocate memory to hold sample rate strings");
-            ret = -EINVAL;
 
-            break;
+        std::shared_ptr<USBDeviceConfig> usb_device_info(new USBDeviceConfig());
+        if (!usb_device_info) {
+            PAL_ERR(LOG_TAG, "error unable to create usb device config object");
+            return -ENOMEM;
         }
-        memcpy(rates_str, rates_str_start, size);
-        rates_str[size] = '\0';
-        ret = usb_device_info->getSampleRates(type, rates_str);
-        if (rates_str)
-            free(rates_str);
-        if (ret < 0) {
+        usb_device_info->setType(type);
+        usb_device_info->setBitWidth(altset.bit_width);
+        setEndian(altset.big_endian ? 1 : 0);
+        usb_device_info->setChannels(altset.channels);
+        if (usb_device_info->setSampleRates(type, altset) < 0) {
             PAL_INFO(LOG_TAG, "error unable to get sample rate values");
             continue;
         }
-        // Data packet interval is an optional field.
-        // Assume 0ms interval if this cannot be read
-        // LPASS USB and HLOS USB will figure out the default to use
-        usb_device_info->setInterval(DEFAULT_SERVICE_INTERVAL_US);
-        interval_str_start = strstr(str_start, DATA_PACKET_INTERVAL_STR);
-        if (interval_str_start != NULL) {
-            interval_str_start += strlen(DATA_PACKET_INTERVAL_STR);
-            ret = usb_device_info->getServiceInterval(interval_str_start);
-            if (ret < 0) {
-                PAL_INFO(LOG_TAG, "error unable to get service interval, assume default");
-            }
-        }
-        /* jack status parsing */
-        suffix = (type == USB_PLAYBACK) ? USB_OUT_JACK_SUFFIX : USB_IN_JACK_SUFFIX;
-        jack_status = getJackConnectionStatus(addr.card_id, suffix);
-        PAL_DBG(LOG_TAG, "jack_status %d", jack_status);
+        usb_device_info->setInterval(altset.service_interval_us);
         usb_device_info->setJackStatus(jack_status);
 
         /* Add to list if every field is valid */
@@ -581,16 +738,17 @@ int USBCardConfig::getCapability(usb_usecase_type_t type,
         format_list_map.insert( std::pair<int, std::shared_ptr<USBDeviceConfig>>(usb_device_info->getBitWidth(),usb_device_info));
     }
 
-     usb_info_dump(read_buf, type);
-
-done:
-    if (fd)
-        fclose(fd);
+    if (!found) {
+        PAL_INFO(LOG_TAG, "error %s section not found in usb config file",
+                ((type == USB_PLAYBACK) ?
+               PLAYBACK_PROFILE_STR : CAPTURE_PROFILE_STR));
+        return -ENOENT;
+    }
 
-    if (read_buf)
-        free(read_buf);
+    dump = cap->stream_info;
+    usb_info_dump(&dump[0], type);
 
-    return ret;
+    return 0;
 }
 
 USBCardConfig::USBCardConfig(struct pal_usb_device_address address) {
@@ -1032,31 +1190,22 @@ int USBDeviceConfig::updateBestChInfo(struct pal_channel_info *requested_ch_info
     return 0;
 }
 
-int USBDeviceConfig::getSampleRates(int type, char *rates_str) {
+int USBDeviceConfig::setSampleRates(int type, const usb_altset_cap_t &altset) {
     unsigned int i;
-    char *next_sr_string, *temp_ptr;
-    unsigned int sr, min_sr, max_sr, sr_size = 0;
+    unsigned int min_sr, max_sr;
 
-    /* Sample rate string can be in any of the folloing two bit_widthes:
+    /* Sample rates come in either of the following two forms:
      * Rates: 8000 - 48000 (continuous)
      * Rates: 8000, 44100, 48000
-     * Support both the bit_widths
+     * Support both the forms
      */
-
-    PAL_VERBOSE(LOG_TAG, "rates_str %s", rates_str);
-    next_sr_string = strtok_r(rates_str, "Rates: ", &temp_ptr);
-    if (next_sr_string == NULL) {
+    if (altset.rates.empty()) {
         PAL_ERR(LOG_TAG, "could not find min rates string");
         return -EINVAL;
     }
-    if (strstr(rates_str, "continuous") != NULL) {
-        min_sr = (unsigned int)atoi(next_sr_string);
-        next_sr_string = strtok_r(NULL, " ,.-", &temp_ptr);
-        if (next_sr_string == NULL) {
-            PAL_ERR(LOG_TAG, "could not find max rates string");
-            return -EINVAL;
-        }
-        max_sr = (unsigned int)atoi(next_sr_string);
+    if (altset.continuous_rates) {
+        min_sr = altset.rates[0];
+        max_sr = altset.rates[1];
 
         for (i = 0; i < MAX_SAMPLE_RATE_SIZE; i++) {
             if (supported_sample_rates_[i] >= min_sr &&
@@ -1072,13 +1221,10 @@ int USBDeviceConfig::getSampleRates(int type, char *rates_str) {
             }
         }
     } else {
-        do {
-            sr = (unsigned int)atoi(next_sr_string);
+        for (auto sr : altset.rates) {
             // FIXME: we don't support >192KHz in recording path for now
-            if ((sr > SAMPLE_RATE_192000) && (type == USB_CAPTURE)) {
-                next_sr_string = strtok_r(NULL, " ,.-", &temp_ptr);
+            if ((sr > SAMPLE_RATE_192000) && (type == USB_CAPTURE))
                 continue;
-            }
 
             for (i = 0; i < MAX_SAMPLE_RATE_SIZE; i++) {
                 if (supported_sample_rates_[i] == sr) {
@@ -1088,47 +1234,8 @@ int USBDeviceConfig::getSampleRates(int type, char *rates_str) {
                     supported_sample_rates_mask_[type] |= (1<<i);
                 }
             }
-            next_sr_string = strtok_r(NULL, " ,.-", &temp_ptr);
-        } while (next_sr_string != NULL);
-    }
-    return 0;
-}
-
-int USBDeviceConfig::getServiceInterval(const char *interval_str_start)
-{
-    unsigned long interval = 0;
-    char time_unit[8] = {0};
-    int multiplier = 0;
-
-    const char *eol = strchr(interval_str_start, '\n');
-    if (!eol) {
-        PAL_ERR(LOG_TAG, "No EOL found");
-        return -1;
-    }
-    char *tmp = (char *)calloc(1, eol-interval_str_start+1);
-    if (!tmp) {
-        PAL_ERR(LOG_TAG, "failed to allocate tmp");
-        return -1;
-    }
-    memcpy(tmp, interval_str_start, eol-interval_str_start);
-    tmp[eol-interval_str_start] = '\0';
-    sscanf(tmp, "%lu %2s", &interval, &time_unit[0]);
-    if (!strcmp(time_unit, "us")) {
-        multiplier = 1;
-    } else if (!strcmp(time_unit, "ms")) {
-        multiplier = 1000;
-    } else if (!strcmp(time_unit, "s")) {
-        multiplier = 1000000;
-    } else {
-        PAL_ERR(LOG_TAG, "unknown time_unit %s, assume default", time_unit);
-        interval = DEFAULT_SERVICE_INTERVAL_US;
-        multiplier = 1;
+        }
     }
-    interval *= multiplier;
-    PAL_DBG(LOG_TAG, "set service_interval_us %lu", interval);
-    service_interval_us_ = interval;
-    free(tmp);
-
     return 0;
 }
 
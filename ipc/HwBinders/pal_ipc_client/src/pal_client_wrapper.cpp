@@ -33,6 +33,7 @@
 #include <hidl/Status.h>
 #include <log/log.h>
 #include "PalApi.h"
+#include <algorithm>
 #include "inc/PalCallback.h"
 
 using android::hardware::Return;
@@ -118,61 +119,44 @@ Return<int32_t> PalCallback::event_callback_rw_done(uint64_t strm_handle,
                                  uint32_t event_data_size,
                                  const hidl_vec<PalEventReadWriteDonePayload>& event_data,
                                  uint64_t cookie) {
-    struct pal_event_read_write_done_payload *rw_done_payload;
+    struct pal_event_read_write_done_payload rw_done_payload;
     struct pal_buffer *buffer = nullptr;
-    uint32_t *ev_data = NULL;
+    struct timespec ts;
     const native_handle *allochandle = nullptr;
     const PalEventReadWriteDonePayload *rwDonePayloadHidl = event_data.data();
-    PalBuffer *bufferHidl;
 
     ALOGV("%s called \n", __func__);
-    rw_done_payload = (struct pal_event_read_write_done_payload *)
-                          calloc(1, sizeof(pal_event_read_write_done_payload));
-    if (!rw_done_payload) {
-        ALOGE("%s:%d Failed to allocate memory to rw_done_payload", __func__, __LINE__);
-        goto exit;
-    }
-
-    ev_data = (uint32_t *)rw_done_payload;
-    rw_done_payload->tag = rwDonePayloadHidl->tag;
-    rw_done_payload->status = rwDonePayloadHidl->status;
-    rw_done_payload->md_status = rwDonePayloadHidl->md_status;
-
-    buffer = &rw_done_payload->buff;
+    /*
+     * The payload only has to stay valid for the duration of the client
+     * callback, so it lives on the stack and buffer/metadata point straight
+     * into the received hidl_vec instead of being copied.
+     */
+    memset(&rw_done_payload, 0, sizeof(rw_done_payload));
+    memset(&ts, 0, sizeof(ts));
+    rw_done_payload.tag = rwDonePayloadHidl->tag;
+    rw_done_payload.status = rwDonePayloadHidl->status;
+    rw_done_payload.md_status = rwDonePayloadHidl->md_status;
+
+    buffer = &rw_done_payload.buff;
 
     buffer->size = rwDonePayloadHidl->buff.size;
-    if (rwDonePayloadHidl->buff.buffer.size() == buffer->size) {
-        buffer->buffer = (uint8_t *)calloc(1, buffer->size);
-        if (!buffer->buffer) {
-            ALOGE("%s:%d Failed to allocate memory to buffer", __func__, __LINE__);
-            goto exit;
-        }
-        memcpy(buffer->buffer, rwDonePayloadHidl->buff.buffer.data(),
-               buffer->size);
-    }
+    if (rwDonePayloadHidl->buff.buffer.size() == buffer->size)
+        buffer->buffer = (uint8_t *)rwDonePayloadHidl->buff.buffer.data();
 
     buffer->offset = rwDonePayloadHidl->buff.offset;
-    buffer->ts = (struct timespec *) calloc(1, sizeof(struct timespec));
-    if (!buffer->ts) {
-        ALOGE("%s:%d Failed to allocate memory to buffer->ts", __func__, __LINE__);
-        goto exit;
-    }
-
+    buffer->ts = &ts;
     buffer->ts->tv_sec = rwDonePayloadHidl->buff.timeStamp.tvSec;
     buffer->ts->tv_nsec = rwDonePayloadHidl->buff.timeStamp.tvNSec;
     buffer->flags = rwDonePayloadHidl->buff.flags;
     if (rwDonePayloadHidl->buff.metadataSz) {
-        buffer->metadata_size = rwDonePayloadHidl->buff.metadataSz;
-        buffer->metadata = (uint8_t *)calloc(1, buffer->metadata_size);
-        if (!buffer->metadata) {
-            ALOGE("%s:%d Failed to allocate memory to buffer->metadata",
-                __func__, __LINE__);
+        if (rwDonePayloadHidl->buff.metadata.size() < rwDonePayloadHidl->buff.metadataSz) {
+            ALOGE("%s:%d invalid metadata size %d", __func__, __LINE__,
+                  rwDonePayloadHidl->buff.metadataSz);
             goto exit;
         }
-
+        buffer->metadata_size = rwDonePayloadHidl->buff.metadataSz;
+        buffer->metadata = (uint8_t *)rwDonePayloadHidl->buff.metadata.data();
         ALOGV("metadatasize %d \n", buffer->metadata_size);
-        memcpy(buffer->metadata, rwDonePayloadHidl->buff.metadata.data(),
-               buffer->metadata_size);
     }
 
     allochandle = rwDonePayloadHidl->buff.alloc_info.alloc_handle.handle();
@@ -183,20 +167,10 @@ Return<int32_t> PalCallback::event_callback_rw_done(uint64_t strm_handle,
     ALOGV("%s:%d Bufsize %d  ret bufSize %d", __func__, __LINE__, rwDonePayloadHidl->buff.size, buffer->size);
     ALOGV("event_payload_size %d alloc_handle %d", event_data_size, allochandle->data[1]);
     ALOGV("alloc size %d alloc_size ret %d", rwDonePayloadHidl->buff.alloc_info.alloc_size,buffer->alloc_info.alloc_size);
-    this->cb((pal_stream_handle_t *)strm_handle, event_id, ev_data, event_data_size,
-                                    cookie);
+    this->cb((pal_stream_handle_t *)strm_handle, event_id, (uint32_t *)&rw_done_payload,
+             event_data_size, cookie);
 
 exit:
-    if (buffer) {
-        if (buffer->metadata)
-            free(buffer->metadata);
-        if (buffer->buffer)
-            free(buffer->buffer);
-        if (buffer->ts)
-            free(buffer->ts);
-    }
-    if (rw_done_payload)
-        free(rw_done_payload);
     return int32_t {};
 }
 
@@ -460,7 +434,8 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
             return ret;
 
         hidl_vec<PalBuffer> buf_hidl;
-        buf_hidl.resize(sizeof(struct pal_buffer));
+        /* only the first element is consumed by the server */
+        buf_hidl.resize(1);
         PalBuffer *palBuff = buf_hidl.data();
         native_handle_t *allocHidlHandle = nullptr;
         allocHidlHandle = native_handle_create(1, 1);
@@ -473,19 +448,22 @@ ssize_t pal_stream_write(pal_stream_handle_t *stream_handle, struct pal_buffer *
 
         palBuff->size = buf->size;
         palBuff->offset = buf->offset;
-        palBuff->buffer.resize(buf->size);
         palBuff->flags = buf->flags;
         if (buf->ts) {
              palBuff->timeStamp.tvSec = buf->ts->tv_sec;
              palBuff->timeStamp.tvNSec = buf->ts->tv_nsec;
         }
+        /*
+         * The call is synchronous, so the caller's buffers are referenced
+         * in place and serialized straight into the binder transaction.
+         */
         if (buf->size && buf->buffer)
-            memcpy(palBuff->buffer.data(), buf->buffer, buf->size);
+            palBuff->buffer.setToExternal(buf->buffer, buf->size);
+        else
+            palBuff->buffer.resize(buf->size);
         if ((buf->metadata_size > 0) && buf->metadata) {
             palBuff->metadataSz = buf->metadata_size;
-            palBuff->metadata.resize(buf->metadata_size);
-            memcpy(palBuff->metadata.data(),
-                   buf->metadata, buf->metadata_size);
+            palBuff->metadata.setToExternal(buf->metadata, buf->metadata_size);
          }
          palBuff->alloc_info.alloc_handle = hidl_memory("arpal_alloc_handle", hidl_handle(allocHidlHandle),
                                                          buf->alloc_info.alloc_size);
@@ -512,7 +490,7 @@ ssize_t pal_stream_read(pal_stream_handle_t *stream_handle, struct pal_buffer *b
             return ret;
 
         hidl_vec<PalBuffer> buf_hidl;
-        buf_hidl.resize(sizeof(struct pal_buffer));
+        buf_hidl.resize(1);
         PalBuffer *palBuff = buf_hidl.data();
         native_handle_t *allocHidlHandle = nullptr;
         allocHidlHandle = native_handle_create(1, 1);
@@ -557,7 +535,8 @@ ssize_t pal_stream_read(pal_stream_handle_t *stream_handle, struct pal_buffer *b
                               if (buf->buffer)
                                    memcpy(buf->buffer,
                                           ret_buf_hidl.data()->buffer.data(),
-                                          buf->size);
+                                          std::min((size_t)buf->size,
+                                                ret_buf_hidl.data()->buffer.size()));
                            }
                       }
                       ret = ret_;
@@ -34,6 +34,7 @@
 #define LOG_TAG "pal_server_wrapper"
 #include "inc/pal_server_wrapper.h"
 #include <hwbinder/IPCThreadState.h>
+#include <stdio.h>
 
 #define MAX_CACHE_SIZE 64
 
@@ -161,12 +162,8 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
         struct pal_event_read_write_done_payload *rw_done_payload;
         int input_fd = -1;
         int fdToBeClosed = -1;
-        native_handle_t *allocHidlHandle = nullptr;
-        allocHidlHandle = native_handle_create(1, 1);
-        if (!allocHidlHandle) {
-            ALOGE("handle allocHidlHandle is NULL");
-            return -EINVAL;
-        }
+        NATIVE_HANDLE_DECLARE_STORAGE(allocHidlHandleStorage, 1, 1);
+        native_handle_t *allocHidlHandle = native_handle_init(allocHidlHandleStorage, 1, 1);
 
         rw_done_payload = (struct pal_event_read_write_done_payload *)event_data;
         /*
@@ -198,7 +195,7 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
         }
         PAL::getInstance()->mClientLock.unlock();
 
-        rwDonePayloadHidl.resize(sizeof(struct pal_event_read_write_done_payload));
+        rwDonePayloadHidl.resize(1);
         rwDonePayload =(PalEventReadWriteDonePayload *)rwDonePayloadHidl.data();
         rwDonePayload->tag = rw_done_payload->tag;
         rwDonePayload->status = rw_done_payload->status;
@@ -213,17 +210,15 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
         }
         if ((rw_done_payload->buff.buffer != NULL) &&
              !(sr_clbk_dat->session_attr.flags & PAL_STREAM_FLAG_EXTERN_MEM)) {
-            rwDonePayload->buff.buffer.resize(rwDonePayload->buff.size);
-            memcpy(rwDonePayload->buff.buffer.data(), rw_done_payload->buff.buffer,
-                   rwDonePayload->buff.size);
+            rwDonePayload->buff.buffer.setToExternal(rw_done_payload->buff.buffer,
+                                                     rwDonePayload->buff.size);
         }
         if ((rw_done_payload->buff.metadata_size > 0) &&
              rw_done_payload->buff.metadata) {
             ALOGV("metadatasize %d ", rw_done_payload->buff.metadata_size);
             rwDonePayload->buff.metadataSz = rw_done_payload->buff.metadata_size;
-            rwDonePayload->buff.metadata.resize(rwDonePayload->buff.metadataSz);
-            memcpy(rwDonePayload->buff.metadata.data(), rw_done_payload->buff.metadata,
-                    rwDonePayload->buff.metadataSz);
+            rwDonePayload->buff.metadata.setToExternal(rw_done_payload->buff.metadata,
+                                                       rwDonePayload->buff.metadataSz);
         }
 
         allocHidlHandle->data[0] = rw_done_payload->buff.alloc_info.alloc_handle;
@@ -252,8 +247,6 @@ static int32_t pal_callback(pal_stream_handle_t *stream_handle,
         } else {
             ALOGE("Error finding fd %d", rw_done_payload->buff.alloc_info.alloc_handle);
         }
-        if (allocHidlHandle)
-            native_handle_delete(allocHidlHandle);
     } else {
         hidl_vec<uint8_t> PayloadHidl;
         PayloadHidl.resize(event_data_size);
@@ -670,8 +663,9 @@ Return<void> PAL::ipc_pal_stream_get_buffer_size(const uint64_t streamHandle,
 
 Return<int32_t> PAL::ipc_pal_stream_write(const uint64_t streamHandle,
                                           const hidl_vec<PalBuffer>& buff_hidl) {
-    int32_t ret = -ENOMEM;
+    int32_t ret = -EINVAL;
     struct pal_buffer buf = {0};
+    struct timespec ts = {0};
     uint32_t bufSize;
     const native_handle *allochandle = nullptr;
 
@@ -680,28 +674,32 @@ Return<int32_t> PAL::ipc_pal_stream_write(const uint64_t streamHandle,
         return -EINVAL;
     }
 
+    if (!buff_hidl.size()) {
+        ALOGE("%s: Empty buffer vector", __func__);
+        return -EINVAL;
+    }
+
+    /*
+     * pal_stream_write consumes the data before returning, so the payload
+     * and metadata are handed over in place from the incoming hidl_vec
+     * instead of being copied into per-call heap buffers.
+     */
     bufSize = buff_hidl.data()->size;
     if (buff_hidl.data()->buffer.size() == bufSize)
-        buf.buffer = (uint8_t *)calloc(1, bufSize);
+        buf.buffer = (uint8_t *)buff_hidl.data()->buffer.data();
     buf.size = (size_t)bufSize;
     buf.offset = (size_t)buff_hidl.data()->offset;
-    buf.ts = (struct timespec *) calloc(1, sizeof(struct timespec));
-    if (!buf.ts) {
-        ALOGE("Not enough memory for buf.ts ");
-        goto exit;
-    }
-    buf.ts->tv_sec =  buff_hidl.data()->timeStamp.tvSec;
-    buf.ts->tv_nsec = buff_hidl.data()->timeStamp.tvNSec;
+    ts.tv_sec =  buff_hidl.data()->timeStamp.tvSec;
+    ts.tv_nsec = buff_hidl.data()->timeStamp.tvNSec;
+    buf.ts = &ts;
     buf.flags = buff_hidl.data()->flags;
     if (buff_hidl.data()->metadataSz) {
-        buf.metadata_size = buff_hidl.data()->metadataSz;
-        buf.metadata = (uint8_t *)calloc(1, buf.metadata_size);
-        if (!buf.metadata) {
-            ALOGE("Not enough memory for buf.metadata");
-            goto exit;
+        if (buff_hidl.data()->metadata.size() < buff_hidl.data()->metadataSz) {
+            ALOGE("%s: Invalid metadata size %d", __func__, buff_hidl.data()->metadataSz);
+            return -EINVAL;
         }
-        memcpy(buf.metadata, buff_hidl.data()->metadata.data(),
-               buf.metadata_size);
+        buf.metadata_size = buff_hidl.data()->metadataSz;
+        buf.metadata = (uint8_t *)buff_hidl.data()->metadata.data();
     }
 
     allochandle = buff_hidl.data()->alloc_info.alloc_handle.handle();
@@ -713,44 +711,48 @@ Return<int32_t> PAL::ipc_pal_stream_write(const uint64_t streamHandle,
     buf.alloc_info.alloc_size = buff_hidl.data()->alloc_info.alloc_size;
     buf.alloc_info.offset = buff_hidl.data()->alloc_info.offset;
 
-    if (buf.buffer != NULL)
-        memcpy(buf.buffer, buff_hidl.data()->buffer.data(), bufSize);
     ALOGV("%s:%d sz %d", __func__,__LINE__,bufSize);
     ret = pal_stream_write((pal_stream_handle_t *)streamHandle, &buf);
-exit:
-    if (buf.buffer)
-        free(buf.buffer);
-    if (buf.ts)
-        free(buf.ts);
-    if (buf.metadata)
-        free(buf.metadata);
     return ret;
 }
 
 Return<void> PAL::ipc_pal_stream_read(const uint64_t streamHandle,
                                       const hidl_vec<PalBuffer>& inBuff_hidl,
                                       ipc_pal_stream_read_cb _hidl_cb) {
-    struct pal_buffer buf;
+    struct pal_buffer buf = {0};
+    struct timespec ts = {0};
     int32_t ret = 0;
     hidl_vec<PalBuffer> outBuff_hidl;
+    PalBuffer *outBuff = nullptr;
     uint32_t bufSize;
     const native_handle *allochandle = nullptr;
 
-    bufSize = inBuff_hidl.data()->size;
-    buf.buffer = (uint8_t *)calloc(1, bufSize);
-    buf.size = (size_t)bufSize;
-    buf.metadata_size = inBuff_hidl.data()->metadataSz;
-    buf.metadata = (uint8_t *)calloc(1, buf.metadata_size);
-    if (!buf.metadata) {
-        ALOGE("Not enough memory for buf.metadata");
-        goto exit;
-    }
-
     if (!isValidstreamHandle(streamHandle)) {
         ALOGE("%s: Invalid streamHandle: %pK", __func__, streamHandle);
         return Void();
     }
 
+    if (!inBuff_hidl.size()) {
+        ALOGE("%s: Empty buffer vector", __func__);
+        return Void();
+    }
+
+    /*
+     * Read straight into the reply vector, which is what gets marshalled
+     * back to the client, rather than into a scratch buffer that would
+     * have to be copied over afterwards.
+     */
+    bufSize = inBuff_hidl.data()->size;
+    outBuff_hidl.resize(1);
+    outBuff = outBuff_hidl.data();
+    outBuff->buffer.resize(bufSize);
+    outBuff->metadata.resize(inBuff_hidl.data()->metadataSz);
+    buf.buffer = outBuff->buffer.data();
+    buf.size = (size_t)bufSize;
+    buf.metadata_size = inBuff_hidl.data()->metadataSz;
+    buf.metadata = outBuff->metadata.data();
+    buf.ts = &ts;
+
     allochandle = inBuff_hidl.data()->alloc_info.alloc_handle.handle();
 
     buf.alloc_info.alloc_handle = dup(allochandle->data[0]);
@@ -762,28 +764,18 @@ Return<void> PAL::ipc_pal_stream_read(const uint64_t streamHandle,
 
     ret = pal_stream_read((pal_stream_handle_t *)streamHandle, &buf);
     if (ret > 0) {
-        outBuff_hidl.resize(sizeof(struct pal_buffer));
-        outBuff_hidl.data()->size = (uint32_t)buf.size;
-        outBuff_hidl.data()->offset = (uint32_t)buf.offset;
-        outBuff_hidl.data()->buffer.resize(buf.size);
-        memcpy(outBuff_hidl.data()->buffer.data(), buf.buffer,
-               buf.size);
-        if (buf.ts) {
-          outBuff_hidl.data()->timeStamp.tvSec = buf.ts->tv_sec;
-          outBuff_hidl.data()->timeStamp.tvNSec = buf.ts->tv_nsec;
-        }
-        if (buf.metadata_size) {
-           outBuff_hidl.data()->metadata.resize(buf.metadata_size);
-           memcpy(outBuff_hidl.data()->metadata.data(),
-                  buf.metadata, buf.metadata_size);
-        }
+        outBuff->size = (uint32_t)buf.size;
+        outBuff->offset = (uint32_t)buf.offset;
+        if (buf.size < outBuff->buffer.size())
+            outBuff->buffer.resize(buf.size);
+        outBuff->timeStamp.tvSec = ts.tv_sec;
+        outBuff->timeStamp.tvNSec = ts.tv_nsec;
+        if (buf.metadata_size < outBuff->metadata.size())
+            outBuff->metadata.resize(buf.metadata_size);
+    } else {
+        outBuff_hidl.resize(0);
     }
     _hidl_cb(ret, outBuff_hidl);
-exit:
-    if (buf.buffer)
-        free(buf.buffer);
-    if (buf.metadata)
-        free(buf.metadata);
     return Void();
 }
 
@@ -1145,6 +1137,53 @@ Return<void>PAL::ipc_pal_stream_get_tags_with_module_info(PalStreamHandle stream
 }
 
 
+/* lshal debug: dump the PAL API latency histograms and log trace */
+Return<void> PAL::debug(const hidl_handle& fd,
+                        const hidl_vec<hidl_string>& options __unused)
+{
+    pal_param_latency_stats_t *stats = NULL;
+    pal_latency_hist_t *hist = NULL;
+    char *trace = NULL;
+    size_t sz = 0;
+    int32_t ret = 0;
+    int out;
+
+    if (fd.getNativeHandle() == nullptr || fd->numFds < 1) {
+        ALOGE("%s: invalid debug fd", __func__);
+        return Void();
+    }
+    out = fd->data[0];
+
+    ret = pal_get_param(PAL_PARAM_ID_API_LATENCY_STATS, (void **)&stats, &sz, NULL);
+    if (ret || !stats || sz < sizeof(pal_param_latency_stats_t)) {
+        dprintf(out, "PAL latency stats unavailable, ret %d\n", ret);
+        return Void();
+    }
+
+    dprintf(out, "PAL API latency (us), point ids from pal_latency_point_t\n");
+    dprintf(out, "%5s %10s %10s %10s  histogram (bucket:count, bucket n < 2^n us)\n",
+            "point", "count", "avg", "max");
+    for (uint32_t i = 0; i < stats->num_points && i < PAL_LATENCY_POINT_MAX; i++) {
+        hist = &stats->hist[i];
+        if (!hist->count)
+            continue;
+        dprintf(out, "%5u %10llu %10llu %10llu ", i,
+                (unsigned long long)hist->count,
+                (unsigned long long)(hist->total_us / hist->count),
+                (unsigned long long)hist->max_us);
+        for (uint32_t b = 0; b < stats->num_buckets && b < PAL_LATENCY_HIST_BUCKETS; b++) {
+            if (hist->buckets[b])
+                dprintf(out, " %u:%llu", b, (unsigned long long)hist->buckets[b]);
+        }
+        dprintf(out, "\n");
+    }
+
+    sz = 0;
+    ret = pal_get_param(PAL_PARAM_ID_LOG_TRACE, (void **)&trace, &sz, NULL);
+    if (!ret && trace && sz > 1)
+        dprintf(out, "\nPAL log trace\n%s", trace);
+    return Void();
+}
 
 IPAL* HIDL_FETCH_IPAL(const char* /* name */) {
     ALOGV("%s");
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ACTIVE_STREAM_REGISTRY_H
+#define ACTIVE_STREAM_REGISTRY_H
+
+#include <stdint.h>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "PalDefs.h"
+
+class Stream;
+class Device;
+
+/*
+ * Groups of stream types ResourceManager walks together, one per former
+ * active_streams_* list. Ordered the way getActiveStream_l merges them.
+ */
+typedef enum {
+    ACTIVE_STREAMS_LL = 0,        /* low latency, VoIP and voice call */
+    ACTIVE_STREAMS_ULL,
+    ACTIVE_STREAMS_ULLA,          /* generic */
+    ACTIVE_STREAMS_DB,
+    ACTIVE_STREAMS_RAW,
+    ACTIVE_STREAMS_COMP,
+    ACTIVE_STREAMS_ST,
+    ACTIVE_STREAMS_ACD,
+    ACTIVE_STREAMS_PO,            /* PCM offload and loopback */
+    ACTIVE_STREAMS_PROXY,
+    ACTIVE_STREAMS_INCALL_RECORD,
+    ACTIVE_STREAMS_NON_TUNNEL,
+    ACTIVE_STREAMS_INCALL_MUSIC,
+    ACTIVE_STREAMS_HAPTICS,
+    ACTIVE_STREAMS_ULTRASOUND,
+    ACTIVE_STREAMS_SENSOR_PCM_DATA,
+    ACTIVE_STREAMS_VOICE_REC,
+    ACTIVE_STREAMS_CONTEXT_PROXY,
+    ACTIVE_STREAMS_MAX,
+} active_stream_group_t;
+
+/*
+ * Registered streams of ResourceManager. Every stream sits in the list of
+ * all streams and in the list of its group, in registration order, and an
+ * index keyed by stream gives O(1) lookup and removal from both. A second
+ * index keyed by device id holds the (device, stream) pairs registered
+ * through registerDevice, so per-device queries do not walk every stream.
+ * Callers that drop locks or call into streams while walking take a
+ * snapshot first. Not thread safe: the stream part is protected by
+ * mActiveStreamMutex, the device part by mResourceManagerMutex.
+ */
+class ActiveStreamRegistry
+{
+public:
+    typedef std::pair<std::shared_ptr<Device>, Stream*> devicePair;
+
+    ActiveStreamRegistry() {};
+    ~ActiveStreamRegistry() {};
+
+    /* ACTIVE_STREAMS_MAX for types without a group */
+    static active_stream_group_t getGroup(pal_stream_type_t type);
+
+    /* a stream of an unknown type is only added to the list of all streams */
+    int32_t add(Stream *s, pal_stream_type_t type);
+    int32_t remove(Stream *s);
+    bool contains(Stream *s) const;
+    size_t size() const { return mAll.size(); };
+    bool empty() const { return mAll.empty(); };
+    size_t count(active_stream_group_t group) const;
+    const std::list<Stream*> &group(active_stream_group_t group) const;
+    std::list<Stream*>::iterator begin() { return mAll.begin(); };
+    std::list<Stream*>::iterator end() { return mAll.end(); };
+    void snapshot(std::vector<Stream*> &streams) const;
+    void snapshot(active_stream_group_t group, std::vector<Stream*> &streams) const;
+
+    /* group members cast to the class every type of the group is created as */
+    template <class T>
+    void snapshot(active_stream_group_t group, std::vector<T*> &streams) const
+    {
+        const std::list<Stream*> &members = this->group(group);
+
+        streams.clear();
+        streams.reserve(members.size());
+        for (Stream *s : members)
+            streams.push_back(static_cast<T*>(s));
+    }
+
+    int32_t addDevice(std::shared_ptr<Device> d, int deviceId, Stream *s);
+    int32_t removeDevice(std::shared_ptr<Device> d, int deviceId, Stream *s);
+    bool hasDevice(std::shared_ptr<Device> d, int deviceId, Stream *s) const;
+    const std::unordered_map<int, std::vector<devicePair>> &devices() const
+    {
+        return mDevices;
+    };
+
+private:
+    struct entry {
+        active_stream_group_t group;
+        std::list<Stream*>::iterator all;
+        std::list<Stream*>::iterator member;
+    };
+    std::list<Stream*> mAll;
+    std::list<Stream*> mGroups[ACTIVE_STREAMS_MAX];
+    std::unordered_map<Stream*, entry> mIndex;
+    std::unordered_map<int, std::vector<devicePair>> mDevices;
+};
+
+#endif
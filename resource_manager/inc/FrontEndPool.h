@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FRONT_END_POOL_H
+#define FRONT_END_POOL_H
+
+#include <stdint.h>
+#include <mutex>
+#include <vector>
+#include <unordered_map>
+
+#define FRONT_END_POOL_WORDS   2
+#define FRONT_END_POOL_MAX_IDS (FRONT_END_POOL_WORDS * 64)
+
+typedef enum {
+    FE_POOL_PCM_PLAYBACK = 0,
+    FE_POOL_PCM_RECORD,
+    FE_POOL_PCM_HOSTLESS_RX,
+    FE_POOL_PCM_HOSTLESS_TX,
+    FE_POOL_COMPRESS_PLAYBACK,
+    FE_POOL_COMPRESS_RECORD,
+    FE_POOL_VOICE1_RX,
+    FE_POOL_VOICE1_TX,
+    FE_POOL_VOICE2_RX,
+    FE_POOL_VOICE2_TX,
+    FE_POOL_INCALL_RECORD,
+    FE_POOL_INCALL_MUSIC,
+    FE_POOL_CONTEXT_PROXY,
+    FE_POOL_EXT_EC_TX,
+    FE_POOL_NON_TUNNEL,
+    FE_POOL_MAX,
+} fe_pool_class_t;
+
+struct frontEndPoolStats {
+    uint32_t total;
+    uint32_t inUse;
+    uint32_t peak;
+    uint32_t failures;
+    bool shared;
+};
+
+/*
+ * Fixed set of front end ids of one class. Free ids are tracked in a
+ * bitmap indexed by the position of the id in the ascending id list,
+ * so allocate always hands out the highest free id. Each busy slot
+ * records its owner, usually the Stream, to catch mismatched frees
+ * and ids left behind after a stream is gone. Shared pools (voice)
+ * hand out ids without consuming them.
+ */
+class FrontEndPool
+{
+public:
+    FrontEndPool();
+    ~FrontEndPool() {};
+
+    void init(const std::vector<int> &ids, bool shared);
+    void clear();
+    int32_t allocate(int howMany, const void *owner, std::vector<int> &ids);
+    int32_t release(const std::vector<int> &ids, const void *owner);
+    /* busy ids still owned by owner */
+    void getOwnedIds(const void *owner, std::vector<int> &ids);
+    void getStats(struct frontEndPoolStats *stats);
+
+private:
+    std::mutex mMutex;
+    std::vector<int> mIds;
+    std::vector<const void *> mOwners;
+    std::unordered_map<int, uint32_t> mSlots;
+    uint64_t mFreeMask[FRONT_END_POOL_WORDS];
+    uint32_t mInUse;
+    uint32_t mPeak;
+    uint32_t mFailures;
+    bool mShared;
+};
+
+#endif
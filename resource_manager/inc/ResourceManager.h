@@ -68,6 +68,7 @@
 #include <memory>
 #include <iostream>
 #include <thread>
+#include <future>
 #include <mutex>
 #include <string>
 #include "audio_route/audio_route.h"
@@ -87,6 +88,9 @@
 #include "ACDPlatformInfo.h"
 #include "ContextManager.h"
 #include "SignalHandler.h"
+#include "StreamHandleRegistry.h"
+#include "ActiveStreamRegistry.h"
+#include "FrontEndPool.h"
 #include <fstream>
 
 typedef enum {
@@ -110,9 +114,12 @@ typedef enum {
 #define AUDIO_PARAMETER_KEY_UPD_DEDICATED_BE "upd_dedicated_be"
 #define AUDIO_PARAMETER_KEY_DUAL_MONO "dual_mono"
 #define AUDIO_PARAMETER_KEY_SIGNAL_HANDLER "signal_handler"
+#define AUDIO_PARAMETER_KEY_VOLUME_RAMP_PERIOD "volume_ramp_period_ms"
+#define AUDIO_PARAMETER_KEY_API_LATENCY_STATS "api_latency_stats"
 #define MAX_PCM_NAME_SIZE 50
 #define MAX_STREAM_INSTANCES (sizeof(uint64_t) << 3)
 #define MIN_USECASE_PRIORITY 0xFFFFFFFF
+#define A2DP_DRAIN_POLL_INTERVAL_MS 5
 #if LINUX_ENABLED
 #if defined(__LP64__)
 #define ADM_LIBRARY_PATH "/usr/lib64/libadm.so"
@@ -419,6 +426,21 @@ struct deviceIn {
     pal_audio_fmt_t bitFormatSupported;
 };
 
+/*
+ * pal_device_info of a deviceIn entry resolved for one stream type, with
+ * the result for every custom config key of that type.
+ */
+struct deviceInfoUsecaseEntry {
+    struct pal_device_info info;
+    std::unordered_map<std::string, struct pal_device_info> customConfig;
+};
+
+/* info is the result for stream types without a usecase entry */
+struct deviceInfoIndexEntry {
+    struct pal_device_info info;
+    std::unordered_map<int, deviceInfoUsecaseEntry> usecase;
+};
+
 class ResourceManager
 {
 
@@ -435,8 +457,8 @@ private:
     void getHigherPriorityActiveStreams(const int inComingStreamPriority,
                                         std::vector<Stream*> &activestreams,
                                         std::vector<T> sourcestreams);
-    const std::vector<int> allocateVoiceFrontEndIds(std::vector<int> listAllPcmVoiceFrontEnds,
-                                  const int howMany);
+    int getFrontEndPoolClass(const struct pal_stream_attributes &sAttr,
+                             int lDirection);
     int getDeviceDefaultCapability(pal_param_device_capability_t capability);
 
     int handleScreenStatusChange(pal_param_screen_state_t screen_state);
@@ -459,29 +481,12 @@ private:
     void onVUIStreamRegistered();
     void onVUIStreamDeregistered();
 protected:
-    std::list <Stream*> mActiveStreams;
-    std::list <StreamPCM*> active_streams_ll;
-    std::list <StreamPCM*> active_streams_ulla;
-    std::list <StreamPCM*> active_streams_ull;
-    std::list <StreamPCM*> active_streams_db;
-    std::list <StreamPCM*> active_streams_po;
-    std::list <StreamPCM*> active_streams_proxy;
-    std::list <StreamPCM*> active_streams_haptics;
-    std::list <StreamPCM*> active_streams_raw;
-    std::list <StreamPCM*> active_streams_voice_rec;
-    std::list <StreamInCall*> active_streams_incall_record;
-    std::list <StreamNonTunnel*> active_streams_non_tunnel;
-    std::list <StreamInCall*> active_streams_incall_music;
-    std::list <StreamCompress*> active_streams_comp;
-    std::list <StreamSoundTrigger*> active_streams_st;
-    std::list <StreamACD*> active_streams_acd;
-    std::list <StreamUltraSound*> active_streams_ultrasound;
-    std::list <StreamSensorPCMData*> active_streams_sensor_pcm_data;
-    std::list <StreamContextProxy*> active_streams_context_proxy;
+    /* registered streams, indexed by stream, type group and device */
+    ActiveStreamRegistry mActiveStreams;
     std::vector <std::pair<std::shared_ptr<Device>, Stream*>> active_devices;
     std::vector <std::shared_ptr<Device>> plugin_devices_;
     std::vector <pal_device_id_t> avail_devices_;
-    std::map<Stream*, std::pair<uint32_t, bool>> mActiveStreamUserCounter;
+    StreamHandleRegistry mStreamHandleRegistry;
     bool bOverwriteFlag;
     bool screen_state_ = true;
     bool charging_state_;
@@ -495,7 +500,6 @@ protected:
     static std::mutex mActiveStreamMutex;
     static std::mutex mValidStreamMutex;
     static std::mutex mSleepMonitorMutex;
-    static std::mutex mListFrontEndsMutex;
     static int snd_virt_card;
     static int snd_hw_card;
 
@@ -511,22 +515,8 @@ protected:
     static std::vector<std::pair<int32_t, int32_t>> devicePcmId;
     static std::vector<std::pair<int32_t, std::string>> deviceLinkName;
     static std::vector<int> listAllFrontEndIds;
-    static std::vector<int> listAllPcmPlaybackFrontEnds;
-    static std::vector<int> listAllPcmRecordFrontEnds;
-    static std::vector<int> listAllPcmHostlessRxFrontEnds;
-    static std::vector<int> listAllNonTunnelSessionIds;
-    static std::vector<int> listAllPcmHostlessTxFrontEnds;
-    static std::vector<int> listAllCompressPlaybackFrontEnds;
-    static std::vector<int> listAllCompressRecordFrontEnds;
     static std::vector<int> listFreeFrontEndIds;
-    static std::vector<int> listAllPcmVoice1RxFrontEnds;
-    static std::vector<int> listAllPcmVoice1TxFrontEnds;
-    static std::vector<int> listAllPcmVoice2RxFrontEnds;
-    static std::vector<int> listAllPcmVoice2TxFrontEnds;
-    static std::vector<int> listAllPcmExtEcTxFrontEnds;
-    static std::vector<int> listAllPcmInCallRecordFrontEnds;
-    static std::vector<int> listAllPcmInCallMusicFrontEnds;
-    static std::vector<int> listAllPcmContextProxyFrontEnds;
+    static FrontEndPool frontEndPools[FE_POOL_MAX];
     static std::vector<std::pair<int32_t, std::string>> listAllBackEndIds;
     static std::vector<std::pair<int32_t, std::string>> sndDeviceNameLUT;
     static std::vector<deviceCap> devInfo;
@@ -538,6 +528,7 @@ protected:
     static std::map<std::string, int> handsetPosTable;
     static std::map<pal_device_id_t, std::vector<std::string>> deviceTempCtrlsMap;
     static std::vector<deviceIn> deviceInfo;
+    static std::unordered_map<int, deviceInfoIndexEntry> deviceInfoIndex;
     static std::vector<tx_ecinfo> txEcInfo;
     static struct vsid_info vsidInfo;
     static struct volume_set_param_info volumeSetParamInfo_;
@@ -600,6 +591,8 @@ public:
     static bool isDualMonoEnabled;
     static bool isUHQAEnabled;
     static bool isSignalHandlerEnabled;
+    /* soft pause volume ramp period, bound for waiting on ramp completion */
+    static uint32_t volumeRampPeriodUs;
     /* Variable to store which speaker side is being used for call audio.
      * Valid for Stereo case only
      */
@@ -648,6 +641,9 @@ public:
     /*getDeviceInfo - updates channels, fluence info of the device*/
     void getDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type,
                        std::string key, struct pal_device_info *devinfo);
+    static void resolveDeviceInfo(const deviceIn &dev, int type, const std::string *key,
+                                  struct pal_device_info *devinfo);
+    static void buildDeviceInfoIndex();
     bool getEcRefStatus(pal_stream_type_t tx_streamtype,pal_stream_type_t rx_streamtype);
     int32_t getVsidInfo(struct vsid_info  *info);
     int32_t getVolumeSetParamInfo(struct volume_set_param_info *volinfo);
@@ -678,6 +674,7 @@ public:
     bool isDeviceActive(pal_device_id_t deviceId);
     bool isDeviceActive(std::shared_ptr<Device> d, Stream *s);
     bool isDeviceActive_l(std::shared_ptr<Device> d, Stream *s);
+    bool isStreamActive(Stream *s);
     int addPlugInDevice(std::shared_ptr<Device> d,
                         pal_param_device_connection_t connection_state);
     int removePlugInDevice(pal_device_id_t device_id,
@@ -686,6 +683,7 @@ public:
     int checkAndGetDeviceConfig(struct pal_device *device ,bool* bIsUpdated);
     static void getFileNameExtn(const char* in_snd_card_name, char* file_name_extn);
     int init_audio();
+    int init_audio_route();
     void loadAdmLib();
     static int init();
     static void deinit();
@@ -741,12 +739,14 @@ public:
     int getDevicePpTag(std::vector <int> &tag);
     int getDeviceDirection(uint32_t beDevId);
     const std::vector<int> allocateFrontEndIds (const struct pal_stream_attributes,
-                                                int lDirection);
+                                                int lDirection, Stream *s = NULL);
     const std::vector<int> allocateFrontEndExtEcIds ();
     void freeFrontEndEcTxIds (const std::vector<int> f);
     void freeFrontEndIds (const std::vector<int> f,
                           const struct pal_stream_attributes,
-                          int lDirection);
+                          int lDirection, Stream *s = NULL);
+    int getFrontEndPoolStats(fe_pool_class_t poolClass,
+                             struct frontEndPoolStats *stats);
     const std::vector<std::string> getBackEndNames(const std::vector<std::shared_ptr<Device>> &deviceList) const;
     void getSharedBEDevices(std::vector<std::shared_ptr<Device>> &deviceList, std::shared_ptr<Device> inDevice) const;
     void getBackEndNames( const std::vector<std::shared_ptr<Device>> &deviceList,
@@ -850,6 +850,9 @@ public:
     static int setUpdDedicatedBeEnableParam(struct str_parms *parms,char *value, int len);
     static int setDualMonoEnableParam(struct str_parms *parms,char *value, int len);
     static int setSignalHandlerEnableParam(struct str_parms *parms,char *value, int len);
+    static int setVolumeRampPeriodParam(struct str_parms *parms,char *value, int len);
+    static int setLatencyStatsEnableParam(struct str_parms *parms,char *value, int len);
+    static uint32_t getVolumeRampPeriodUs() { return volumeRampPeriodUs; };
     static bool isLpiLoggingEnabled();
     static void processConfigParams(const XML_Char **attr);
     static bool isValidDevId(int deviceId);
@@ -868,6 +871,8 @@ public:
     static bool isBtDevice(pal_device_id_t id);
     int32_t a2dpSuspend();
     int32_t a2dpResume();
+    void waitForMutedStreamsDrained(std::vector<std::pair<Stream *, uint32_t>> &mutedStreams,
+                                    uint32_t timeoutMs);
     int32_t a2dpCaptureSuspend();
     int32_t a2dpCaptureResume();
     bool isPluginDevice(pal_device_id_t id);
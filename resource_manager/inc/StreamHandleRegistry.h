@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STREAM_HANDLE_REGISTRY_H
+#define STREAM_HANDLE_REGISTRY_H
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+
+#define STREAM_HANDLE_REGISTRY_SIZE 512
+
+/* registered in ResourceManager active stream list */
+#define STREAM_HANDLE_VALID  (0x1)
+/* opened by client, accepting new users */
+#define STREAM_HANDLE_ACTIVE (0x2)
+
+/*
+ * Open addressing table of stream handles. Each slot keeps one 64 bit
+ * state word holding the user count, the handle flags and a generation
+ * tag bumped whenever the slot is recycled, so acquire/release and
+ * lookups are lock free. Insert/update/erase are serialized internally,
+ * insert reuses the first tombstone on the probe path and erase empties
+ * trailing tombstones so lookups stop at the end of the chain. Once the
+ * last handle is erased every tombstone is emptied, a table that was
+ * filled up has no empty slot left to end a chain on otherwise.
+ */
+class StreamHandleRegistry
+{
+public:
+    StreamHandleRegistry();
+    ~StreamHandleRegistry() {};
+
+    int32_t setFlags(const void *handle, uint32_t flags);
+    int32_t clearFlags(const void *handle, uint32_t flags);
+    bool hasFlags(const void *handle, uint32_t flags);
+    int32_t erase(const void *handle);
+    /* clear STREAM_HANDLE_ACTIVE, users is number of users still in flight */
+    int32_t deactivate(const void *handle, uint32_t *users);
+    /* add an user if handle is both valid and active */
+    int32_t acquire(const void *handle);
+    /* lastUser is set when an user leaves a deactivated handle */
+    int32_t release(const void *handle, bool *lastUser);
+    int32_t getUsers(const void *handle);
+
+private:
+    struct slot {
+        std::atomic<uintptr_t> key;
+        std::atomic<uint64_t> state;
+    };
+    slot mSlots[STREAM_HANDLE_REGISTRY_SIZE];
+    std::mutex mMutex;
+    /* handles currently in the table, protected by mMutex */
+    uint32_t mLive;
+    int32_t findSlot(uintptr_t key);
+    int32_t findOrInsertSlot_l(uintptr_t key);
+    void reclaimTombstones_l(int32_t idx);
+};
+
+#endif
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <algorithm>
+#include "ActiveStreamRegistry.h"
+
+active_stream_group_t ActiveStreamRegistry::getGroup(pal_stream_type_t type)
+{
+    switch (type) {
+    case PAL_STREAM_LOW_LATENCY:
+    case PAL_STREAM_VOIP_RX:
+    case PAL_STREAM_VOIP_TX:
+    case PAL_STREAM_VOICE_CALL:
+        return ACTIVE_STREAMS_LL;
+    case PAL_STREAM_PCM_OFFLOAD:
+    case PAL_STREAM_LOOPBACK:
+        return ACTIVE_STREAMS_PO;
+    case PAL_STREAM_DEEP_BUFFER:
+        return ACTIVE_STREAMS_DB;
+    case PAL_STREAM_COMPRESSED:
+        return ACTIVE_STREAMS_COMP;
+    case PAL_STREAM_GENERIC:
+        return ACTIVE_STREAMS_ULLA;
+    case PAL_STREAM_VOICE_UI:
+        return ACTIVE_STREAMS_ST;
+    case PAL_STREAM_ULTRA_LOW_LATENCY:
+        return ACTIVE_STREAMS_ULL;
+    case PAL_STREAM_PROXY:
+        return ACTIVE_STREAMS_PROXY;
+    case PAL_STREAM_VOICE_CALL_MUSIC:
+        return ACTIVE_STREAMS_INCALL_MUSIC;
+    case PAL_STREAM_VOICE_CALL_RECORD:
+        return ACTIVE_STREAMS_INCALL_RECORD;
+    case PAL_STREAM_NON_TUNNEL:
+        return ACTIVE_STREAMS_NON_TUNNEL;
+    case PAL_STREAM_HAPTICS:
+        return ACTIVE_STREAMS_HAPTICS;
+    case PAL_STREAM_ACD:
+        return ACTIVE_STREAMS_ACD;
+    case PAL_STREAM_ULTRASOUND:
+        return ACTIVE_STREAMS_ULTRASOUND;
+    case PAL_STREAM_RAW:
+        return ACTIVE_STREAMS_RAW;
+    case PAL_STREAM_SENSOR_PCM_DATA:
+        return ACTIVE_STREAMS_SENSOR_PCM_DATA;
+    case PAL_STREAM_CONTEXT_PROXY:
+        return ACTIVE_STREAMS_CONTEXT_PROXY;
+    case PAL_STREAM_VOICE_RECOGNITION:
+        return ACTIVE_STREAMS_VOICE_REC;
+    default:
+        return ACTIVE_STREAMS_MAX;
+    }
+}
+
+int32_t ActiveStreamRegistry::add(Stream *s, pal_stream_type_t type)
+{
+    struct entry e;
+
+    if (mIndex.find(s) != mIndex.end())
+        return -EALREADY;
+
+    e.group = getGroup(type);
+    e.all = mAll.insert(mAll.end(), s);
+    if (e.group != ACTIVE_STREAMS_MAX)
+        e.member = mGroups[e.group].insert(mGroups[e.group].end(), s);
+    mIndex[s] = e;
+    return e.group == ACTIVE_STREAMS_MAX ? -EINVAL : 0;
+}
+
+int32_t ActiveStreamRegistry::remove(Stream *s)
+{
+    auto iter = mIndex.find(s);
+
+    if (iter == mIndex.end())
+        return -ENOENT;
+
+    mAll.erase(iter->second.all);
+    if (iter->second.group != ACTIVE_STREAMS_MAX)
+        mGroups[iter->second.group].erase(iter->second.member);
+    mIndex.erase(iter);
+    return 0;
+}
+
+bool ActiveStreamRegistry::contains(Stream *s) const
+{
+    return mIndex.find(s) != mIndex.end();
+}
+
+size_t ActiveStreamRegistry::count(active_stream_group_t group) const
+{
+    return group < ACTIVE_STREAMS_MAX ? mGroups[group].size() : 0;
+}
+
+const std::list<Stream*> &ActiveStreamRegistry::group(active_stream_group_t group) const
+{
+    static const std::list<Stream*> none;
+
+    return group < ACTIVE_STREAMS_MAX ? mGroups[group] : none;
+}
+
+void ActiveStreamRegistry::snapshot(std::vector<Stream*> &streams) const
+{
+    streams.assign(mAll.begin(), mAll.end());
+}
+
+void ActiveStreamRegistry::snapshot(active_stream_group_t group,
+                                    std::vector<Stream*> &streams) const
+{
+    const std::list<Stream*> &members = this->group(group);
+
+    streams.assign(members.begin(), members.end());
+}
+
+int32_t ActiveStreamRegistry::addDevice(std::shared_ptr<Device> d, int deviceId, Stream *s)
+{
+    std::vector<devicePair> &pairs = mDevices[deviceId];
+
+    if (std::find(pairs.begin(), pairs.end(), std::make_pair(d, s)) != pairs.end())
+        return -EINVAL;
+    pairs.push_back(std::make_pair(d, s));
+    return 0;
+}
+
+int32_t ActiveStreamRegistry::removeDevice(std::shared_ptr<Device> d, int deviceId, Stream *s)
+{
+    auto iter = mDevices.find(deviceId);
+    std::vector<devicePair>::iterator pair;
+
+    if (iter == mDevices.end())
+        return -ENOENT;
+    pair = std::find(iter->second.begin(), iter->second.end(), std::make_pair(d, s));
+    if (pair == iter->second.end())
+        return -ENOENT;
+    iter->second.erase(pair);
+    if (iter->second.empty())
+        mDevices.erase(iter);
+    return 0;
+}
+
+bool ActiveStreamRegistry::hasDevice(std::shared_ptr<Device> d, int deviceId, Stream *s) const
+{
+    auto iter = mDevices.find(deviceId);
+
+    return iter != mDevices.end() &&
+           std::find(iter->second.begin(), iter->second.end(),
+                     std::make_pair(d, s)) != iter->second.end();
+}
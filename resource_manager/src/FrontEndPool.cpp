@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "PAL: FrontEndPool"
+
+#include <errno.h>
+#include <algorithm>
+#include "FrontEndPool.h"
+#include "PalCommon.h"
+
+FrontEndPool::FrontEndPool()
+{
+    clear();
+}
+
+void FrontEndPool::clear()
+{
+    mMutex.lock();
+    mIds.clear();
+    mOwners.clear();
+    mSlots.clear();
+    for (int i = 0; i < FRONT_END_POOL_WORDS; i++)
+        mFreeMask[i] = 0;
+    mInUse = 0;
+    mPeak = 0;
+    mFailures = 0;
+    mShared = false;
+    mMutex.unlock();
+}
+
+void FrontEndPool::init(const std::vector<int> &ids, bool shared)
+{
+    clear();
+
+    mMutex.lock();
+    mIds = ids;
+    std::sort(mIds.begin(), mIds.end());
+    mIds.erase(std::unique(mIds.begin(), mIds.end()), mIds.end());
+    if (mIds.size() > FRONT_END_POOL_MAX_IDS) {
+        PAL_ERR(LOG_TAG, "%zu front ends exceed pool size %d, dropping lowest",
+                mIds.size(), FRONT_END_POOL_MAX_IDS);
+        mIds.erase(mIds.begin(), mIds.end() - FRONT_END_POOL_MAX_IDS);
+    }
+    mOwners.assign(mIds.size(), nullptr);
+    for (uint32_t i = 0; i < mIds.size(); i++) {
+        mSlots[mIds[i]] = i;
+        mFreeMask[i / 64] |= (uint64_t)1 << (i % 64);
+    }
+    mShared = shared;
+    mMutex.unlock();
+}
+
+int32_t FrontEndPool::allocate(int howMany, const void *owner, std::vector<int> &ids)
+{
+    int32_t status = 0;
+    int freeCount = 0;
+    int word = FRONT_END_POOL_WORDS - 1;
+    uint32_t slot;
+
+    ids.clear();
+    mMutex.lock();
+    if (mShared) {
+        if (howMany > (int)mIds.size()) {
+            status = -ENOENT;
+            goto exit;
+        }
+        for (int i = 0; i < howMany; i++)
+            ids.push_back(mIds[mIds.size() - 1 - i]);
+        goto exit;
+    }
+
+    for (int i = 0; i < FRONT_END_POOL_WORDS; i++)
+        freeCount += __builtin_popcountll(mFreeMask[i]);
+    if (howMany > freeCount) {
+        status = -ENOENT;
+        goto exit;
+    }
+
+    for (int i = 0; i < howMany; i++) {
+        while (!mFreeMask[word])
+            word--;
+        slot = word * 64 + (63 - __builtin_clzll(mFreeMask[word]));
+        mFreeMask[word] &= ~((uint64_t)1 << (slot % 64));
+        mOwners[slot] = owner;
+        ids.push_back(mIds[slot]);
+    }
+    mInUse += howMany;
+    if (mInUse > mPeak)
+        mPeak = mInUse;
+
+exit:
+    if (status)
+        mFailures++;
+    mMutex.unlock();
+    return status;
+}
+
+int32_t FrontEndPool::release(const std::vector<int> &ids, const void *owner)
+{
+    int32_t status = 0;
+    std::unordered_map<int, uint32_t>::iterator it;
+    uint32_t slot;
+    uint64_t bit;
+
+    mMutex.lock();
+    for (size_t i = 0; i < ids.size(); i++) {
+        it = mSlots.find(ids[i]);
+        if (it == mSlots.end()) {
+            PAL_ERR(LOG_TAG, "front end %d does not belong to this pool", ids[i]);
+            status = -EINVAL;
+            continue;
+        }
+        if (mShared)
+            continue;
+
+        slot = it->second;
+        bit = (uint64_t)1 << (slot % 64);
+        if (mFreeMask[slot / 64] & bit) {
+            PAL_ERR(LOG_TAG, "front end %d is already free", ids[i]);
+            status = -EINVAL;
+            continue;
+        }
+        if (owner && mOwners[slot] && owner != mOwners[slot])
+            PAL_INFO(LOG_TAG, "front end %d owned by %pK, freed by %pK",
+                     ids[i], mOwners[slot], owner);
+        mOwners[slot] = nullptr;
+        mFreeMask[slot / 64] |= bit;
+        mInUse--;
+    }
+    mMutex.unlock();
+    return status;
+}
+
+void FrontEndPool::getOwnedIds(const void *owner, std::vector<int> &ids)
+{
+    mMutex.lock();
+    for (uint32_t i = 0; i < mIds.size(); i++) {
+        if (!(mFreeMask[i / 64] & ((uint64_t)1 << (i % 64))) &&
+            mOwners[i] == owner)
+            ids.push_back(mIds[i]);
+    }
+    mMutex.unlock();
+}
+
+void FrontEndPool::getStats(struct frontEndPoolStats *stats)
+{
+    mMutex.lock();
+    stats->total = mIds.size();
+    stats->inUse = mInUse;
+    stats->peak = mPeak;
+    stats->failures = mFailures;
+    stats->shared = mShared;
+    mMutex.unlock();
+}
@@ -63,8 +63,11 @@
 #define LOG_TAG "PAL: ResourceManager"
 #include "ResourceManager.h"
 #include "Session.h"
+#include "SessionAlsaUtils.h"
 #include "Device.h"
 #include "Stream.h"
+#include "PalLatencyStats.h"
+#include "PalTrace.h"
 #include "StreamPCM.h"
 #include "StreamCompress.h"
 #include "StreamSoundTrigger.h"
@@ -180,6 +183,8 @@ static struct str_parms *configParamKVPairs;
 
 char rmngr_xml_file[XML_PATH_MAX_LENGTH] = {0};
 
+static char mixer_xml_file[XML_PATH_MAX_LENGTH] = {0};
+
 char vendor_config_path[VENDOR_CONFIG_PATH_MAX_LENGTH] = {0};
 
 const std::vector<int> gSignalsOfInterest = {
@@ -414,24 +419,9 @@ std::mutex ResourceManager::mGraphMutex;
 std::mutex ResourceManager::mActiveStreamMutex;
 std::mutex ResourceManager::mValidStreamMutex;
 std::mutex ResourceManager::mSleepMonitorMutex;
-std::mutex ResourceManager::mListFrontEndsMutex;
 std::vector <int> ResourceManager::listAllFrontEndIds = {0};
 std::vector <int> ResourceManager::listFreeFrontEndIds = {0};
-std::vector <int> ResourceManager::listAllPcmPlaybackFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmRecordFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmHostlessRxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmHostlessTxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmExtEcTxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllCompressPlaybackFrontEnds = {0};
-std::vector <int> ResourceManager::listAllCompressRecordFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice1RxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice1TxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice2RxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmVoice2TxFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmInCallRecordFrontEnds = {0};
-std::vector <int> ResourceManager::listAllPcmInCallMusicFrontEnds = {0};
-std::vector <int> ResourceManager::listAllNonTunnelSessionIds = {0};
-std::vector <int> ResourceManager::listAllPcmContextProxyFrontEnds = {0};
+FrontEndPool ResourceManager::frontEndPools[FE_POOL_MAX];
 struct audio_mixer* ResourceManager::audio_virt_mixer = NULL;
 struct audio_mixer* ResourceManager::audio_hw_mixer = NULL;
 struct audio_route* ResourceManager::audio_route = NULL;
@@ -439,6 +429,10 @@ int ResourceManager::snd_virt_card = SND_CARD_VIRTUAL;
 int ResourceManager::snd_hw_card = SND_CARD_HW;
 std::vector<deviceCap> ResourceManager::devInfo;
 static struct nativeAudioProp na_props;
+static pal_param_latency_stats_t latencyStats;
+static pal_param_fe_pool_stats_t fePoolStats;
+static pal_param_session_cache_stats_t sessionCacheStats;
+static std::string logTrace;
 static bool isHifiFilterEnabled = false;
 SndCardMonitor* ResourceManager::sndmon = NULL;
 void* ResourceManager::cl_lib_handle = NULL;
@@ -483,6 +477,7 @@ bool ResourceManager::lpi_logging_ = false;
 bool ResourceManager::isUpdDedicatedBeEnabled = false;
 int ResourceManager::max_voice_vol = -1;     /* Variable to store max volume index for voice call */
 bool ResourceManager::isSignalHandlerEnabled = false;
+uint32_t ResourceManager::volumeRampPeriodUs = VOLUME_RAMP_PERIOD;
 bool ResourceManager::a2dp_suspended = false;
 
 //TODO:Needs to define below APIs so that functionality won't break
@@ -500,6 +495,7 @@ void str_parms_destroy(struct str_parms *str_parms){return;}
 
 std::vector<uint32_t> ResourceManager::lpi_vote_streams_;
 std::vector<deviceIn> ResourceManager::deviceInfo;
+std::unordered_map<int, deviceInfoIndexEntry> ResourceManager::deviceInfoIndex;
 std::vector<tx_ecinfo> ResourceManager::txEcInfo;
 struct vsid_info ResourceManager::vsidInfo;
 struct volume_set_param_info ResourceManager::volumeSetParamInfo_;
@@ -684,6 +680,8 @@ void ResourceManager::sendCrashSignal(int signal, pid_t pid, uid_t uid)
 ResourceManager::ResourceManager()
 {
     int ret = 0;
+    std::future<int> payloadBuilderInit;
+    std::future<int> audioRouteInit;
     // Init audio_route and audio_mixer
     sleepmon_fd_ = -1;
     na_props.rm_na_prop_enabled = false;
@@ -700,6 +698,27 @@ ResourceManager::ResourceManager()
 
     vsidInfo.loopback_delay = 0;
 
+#ifndef FEATURE_IPQ_OPENWRT
+    {
+        char value[PROPERTY_VALUE_MAX] = {0};
+
+        property_get("vendor.audio.pal.latency_stats", value, "");
+        if (!strncmp("true", value, sizeof("true")))
+            PalLatencyStats::setEnabled(true);
+    }
+#endif
+    PalLatencyScope latency(PAL_LATENCY_RM_INIT);
+
+    /*
+     * usecaseKvManager.xml does not depend on the sound card or on any of
+     * the configs below, so it is parsed concurrently with them. If the
+     * constructor throws, the future destructor waits for the task.
+     */
+    payloadBuilderInit = std::async(std::launch::async, []() {
+        PalLatencyScope latency(PAL_LATENCY_RM_INIT_KV_XML);
+        return PayloadBuilder::init();
+    });
+
     ret = ResourceManager::XmlParser(SNDPARSER);
     if (ret) {
         PAL_ERR(LOG_TAG, "error in snd xml parsing ret %d", ret);
@@ -712,11 +731,31 @@ ResourceManager::ResourceManager()
         throw std::runtime_error("error in init audio route and audio mixer");
     }
 
+    /* mixer paths and resource manager xml only need the sound card name */
+    audioRouteInit = std::async(std::launch::async,
+                                &ResourceManager::init_audio_route, this);
+
     ret = ResourceManager::XmlParser(rmngr_xml_file);
     if (ret) {
         PAL_ERR(LOG_TAG, "error in resource xml parsing ret %d", ret);
+        audioRouteInit.wait();
         throw std::runtime_error("error in resource xml parsing");
     }
+    buildDeviceInfoIndex();
+
+    {
+        PalLatencyScope joinLatency(PAL_LATENCY_RM_INIT_JOIN);
+        ret = audioRouteInit.get();
+    }
+    if (ret) {
+        /* the mixers are only torn down once the route task has finished */
+        PAL_ERR(LOG_TAG, "error in init audio route and audio mixer ret %d", ret);
+        SessionAlsaUtils::clearMixerControlCache(audio_virt_mixer);
+        SessionAlsaUtils::clearMixerControlCache(audio_hw_mixer);
+        mixer_close(audio_virt_mixer);
+        mixer_close(audio_hw_mixer);
+        throw std::runtime_error("error in init audio route and audio mixer");
+    }
 
     if (isHifiFilterEnabled)
         audio_route_apply_and_update_path(audio_route, "hifi-filter-coefficients");
@@ -739,65 +778,52 @@ ResourceManager::ResourceManager()
 #endif
     listAllFrontEndIds.clear();
     listFreeFrontEndIds.clear();
-    listAllPcmPlaybackFrontEnds.clear();
-    listAllPcmRecordFrontEnds.clear();
-    listAllPcmHostlessRxFrontEnds.clear();
-    listAllNonTunnelSessionIds.clear();
-    listAllPcmHostlessTxFrontEnds.clear();
-    listAllCompressPlaybackFrontEnds.clear();
-    listAllCompressRecordFrontEnds.clear();
-    listAllPcmVoice1RxFrontEnds.clear();
-    listAllPcmVoice1TxFrontEnds.clear();
-    listAllPcmVoice2RxFrontEnds.clear();
-    listAllPcmVoice2TxFrontEnds.clear();
-    listAllPcmInCallRecordFrontEnds.clear();
-    listAllPcmInCallMusicFrontEnds.clear();
-    listAllPcmContextProxyFrontEnds.clear();
-    listAllPcmExtEcTxFrontEnds.clear();
     memset(stream_instances, 0, PAL_STREAM_MAX * sizeof(uint64_t));
     memset(in_stream_instances, 0, PAL_STREAM_MAX * sizeof(uint64_t));
 
+    std::vector<int> feIds[FE_POOL_MAX];
+
     for (int i=0; i < devInfo.size(); i++) {
 
         if (devInfo[i].type == PCM) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].playback == 1) {
-                listAllPcmHostlessRxFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_PCM_HOSTLESS_RX].push_back(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmHostlessTxFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_PCM_HOSTLESS_TX].push_back(devInfo[i].deviceId);
             } else if (devInfo[i].playback == 1 && devInfo[i].sess_mode == DEFAULT) {
-                listAllPcmPlaybackFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_PCM_PLAYBACK].push_back(devInfo[i].deviceId);
             } else if (devInfo[i].record == 1 && devInfo[i].sess_mode == DEFAULT) {
-                listAllPcmRecordFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_PCM_RECORD].push_back(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == NON_TUNNEL && devInfo[i].record == 1) {
-                listAllPcmInCallRecordFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_INCALL_RECORD].push_back(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == NON_TUNNEL && devInfo[i].playback == 1) {
-                listAllPcmInCallMusicFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_INCALL_MUSIC].push_back(devInfo[i].deviceId);
             } else if (devInfo[i].sess_mode == NO_CONFIG && devInfo[i].record == 1) {
-                listAllPcmContextProxyFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_CONTEXT_PROXY].push_back(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == COMPRESS) {
             if (devInfo[i].playback == 1) {
-                listAllCompressPlaybackFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_COMPRESS_PLAYBACK].push_back(devInfo[i].deviceId);
             } else if (devInfo[i].record == 1) {
-                listAllCompressRecordFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_COMPRESS_RECORD].push_back(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == VOICE1) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].playback == 1) {
-                listAllPcmVoice1RxFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_VOICE1_RX].push_back(devInfo[i].deviceId);
             }
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmVoice1TxFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_VOICE1_TX].push_back(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == VOICE2) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].playback == 1) {
-                listAllPcmVoice2RxFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_VOICE2_RX].push_back(devInfo[i].deviceId);
             }
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmVoice2TxFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_VOICE2_TX].push_back(devInfo[i].deviceId);
             }
         } else if (devInfo[i].type == ExtEC) {
             if (devInfo[i].sess_mode == HOSTLESS && devInfo[i].record == 1) {
-                listAllPcmExtEcTxFrontEnds.push_back(devInfo[i].deviceId);
+                feIds[FE_POOL_EXT_EC_TX].push_back(devInfo[i].deviceId);
             }
         }
         /*We create a master list of all the frontends*/
@@ -812,7 +838,17 @@ ResourceManager::ResourceManager()
      sort(listAllFrontEndIds.rbegin(), listAllFrontEndIds.rend());
      int maxDeviceIdInUse = listAllFrontEndIds.at(0);
      for (int i = 0; i < max_nt_sessions; i++)
-          listAllNonTunnelSessionIds.push_back(maxDeviceIdInUse + i);
+          feIds[FE_POOL_NON_TUNNEL].push_back(maxDeviceIdInUse + i);
+
+     /*
+      *Voice front ends are shared by all calls on the same VSID,
+      *so they are handed out without being consumed.
+      */
+     for (int i = 0; i < FE_POOL_MAX; i++)
+          frontEndPools[i].init(feIds[i], (i == FE_POOL_VOICE1_RX ||
+                                           i == FE_POOL_VOICE1_TX ||
+                                           i == FE_POOL_VOICE2_RX ||
+                                           i == FE_POOL_VOICE2_TX));
 
     // Get AGM service handle
     ret = agm_register_service_crash_callback(&agmServiceCrashHandler,
@@ -828,7 +864,10 @@ ResourceManager::ResourceManager()
 
     ResourceManager::loadAdmLib();
     ResourceManager::initWakeLocks();
-    ret = PayloadBuilder::init();
+    {
+        PalLatencyScope joinLatency(PAL_LATENCY_RM_INIT_JOIN);
+        ret = payloadBuilderInit.get();
+    }
     if (ret) {
         throw std::runtime_error("Failed to parse usecase manager xml");
     } else {
@@ -857,21 +896,12 @@ ResourceManager::~ResourceManager()
     deviceTag.clear();
 
     listAllFrontEndIds.clear();
-    listAllPcmPlaybackFrontEnds.clear();
-    listAllPcmRecordFrontEnds.clear();
-    listAllPcmHostlessRxFrontEnds.clear();
-    listAllPcmHostlessTxFrontEnds.clear();
-    listAllCompressPlaybackFrontEnds.clear();
-    listAllCompressRecordFrontEnds.clear();
     listFreeFrontEndIds.clear();
-    listAllPcmVoice1RxFrontEnds.clear();
-    listAllPcmVoice1TxFrontEnds.clear();
-    listAllPcmVoice2RxFrontEnds.clear();
-    listAllPcmVoice2TxFrontEnds.clear();
-    listAllNonTunnelSessionIds.clear();
-    listAllPcmExtEcTxFrontEnds.clear();
+    for (int i = 0; i < FE_POOL_MAX; i++)
+        frontEndPools[i].clear();
     devInfo.clear();
     deviceInfo.clear();
+    deviceInfoIndex.clear();
     txEcInfo.clear();
 
     STInstancesLists.clear();
@@ -1020,6 +1050,7 @@ void ResourceManager::ssrHandlingLoop(std::shared_ptr<ResourceManager> rm)
     uint32_t eventData;
     pal_global_callback_event_t event;
     pal_stream_type_t type;
+    std::vector<Stream*> streams;
 
     PAL_INFO(LOG_TAG,"ssr Handling thread started");
 
@@ -1038,6 +1069,9 @@ void ResourceManager::ssrHandlingLoop(std::shared_ptr<ResourceManager> rm)
             mActiveStreamMutex.lock();
             rm->cardState = state;
             if (state != prevState) {
+                /* graphs and card controls are rebuilt across SSR */
+                SessionAlsaUtils::invalidateTagModuleInfo();
+                SessionAlsaUtils::clearMixerControlCache();
                 if (rm->globalCb) {
                     PAL_DBG(LOG_TAG, "Notifying client about sound card state %d global cb %pK",
                                       rm->cardState, rm->globalCb);
@@ -1069,7 +1103,9 @@ void ResourceManager::ssrHandlingLoop(std::shared_ptr<ResourceManager> rm)
             } else if (state == prevState) {
                 PAL_INFO(LOG_TAG, "%d state already handled", state);
             } else if (state == CARD_STATUS_OFFLINE) {
-                for (auto str: rm->mActiveStreams) {
+                /* stream handlers may register or deregister streams */
+                rm->mActiveStreams.snapshot(streams);
+                for (auto str: streams) {
                     lockValidStreamMutex();
                     ret = increaseStreamUserCounter(str);
                     unlockValidStreamMutex();
@@ -1115,7 +1151,8 @@ void ResourceManager::ssrHandlingLoop(std::shared_ptr<ResourceManager> rm)
                 }
 
                 SoundTriggerCaptureProfile = GetCaptureProfileByPriority(nullptr);
-                for (auto str: rm->mActiveStreams) {
+                rm->mActiveStreams.snapshot(streams);
+                for (auto str: streams) {
                     lockValidStreamMutex();
                     ret = increaseStreamUserCounter(str);
                     unlockValidStreamMutex();
@@ -1193,7 +1230,6 @@ int ResourceManager::init_audio()
 
     char *snd_card_name = NULL;
 
-    char mixer_xml_file[XML_PATH_MAX_LENGTH] = {0};
     char file_name_extn[XML_PATH_EXTN_MAX_SIZE] = {0};
 
     PAL_DBG(LOG_TAG, "Enter.");
@@ -1268,6 +1304,7 @@ int ResourceManager::init_audio()
         PAL_ERR(LOG_TAG, "Error: %d virtual audio mixer open failure", -EIO);
         if (snd_card_name)
             free(snd_card_name);
+        SessionAlsaUtils::clearMixerControlCache(audio_hw_mixer);
         mixer_close(audio_hw_mixer);
         return -EIO;
     }
@@ -1294,17 +1331,8 @@ int ResourceManager::init_audio()
     strlcat(mixer_xml_file, XML_FILE_EXT, XML_PATH_MAX_LENGTH);
     strlcat(rmngr_xml_file, XML_FILE_EXT, XML_PATH_MAX_LENGTH);
 
-    audio_route = audio_route_init(snd_hw_card, mixer_xml_file);
-    PAL_INFO(LOG_TAG, "audio route %pK, mixer path %s", audio_route, mixer_xml_file);
-    if (!audio_route) {
-        PAL_ERR(LOG_TAG, "audio route init failed");
-        mixer_close(audio_virt_mixer);
-        mixer_close(audio_hw_mixer);
-        status = -EINVAL;
-    }
-    // audio_route init success
 exit:
-    PAL_DBG(LOG_TAG, "Exit, status %d. audio route init with card %d mixer path %s", status,
+    PAL_DBG(LOG_TAG, "Exit, status %d. card %d mixer path %s", status,
             snd_hw_card, mixer_xml_file);
     if (snd_card_name) {
         free(snd_card_name);
@@ -1314,6 +1342,26 @@ exit:
     return status;
 }
 
+/*
+ * Parses mixer paths of the card selected in init_audio. Runs on an async
+ * task while the constructor keeps using the mixers, so a failure is only
+ * reported here and the caller closes the mixers after joining.
+ */
+int ResourceManager::init_audio_route()
+{
+    int status = 0;
+    PalLatencyScope latency(PAL_LATENCY_RM_INIT_AUDIO_ROUTE);
+
+    audio_route = audio_route_init(snd_hw_card, mixer_xml_file);
+    PAL_INFO(LOG_TAG, "audio route %pK, mixer path %s", audio_route, mixer_xml_file);
+    if (!audio_route) {
+        PAL_ERR(LOG_TAG, "audio route init failed");
+        status = -EINVAL;
+    }
+
+    return status;
+}
+
 int ResourceManager::initContextManager()
 {
     int ret = 0;
@@ -1635,123 +1683,133 @@ bool ResourceManager::getEcRefStatus(pal_stream_type_t tx_streamtype,pal_stream_
     return ecref_status;
 }
 
-void ResourceManager::getDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type, std::string key, struct pal_device_info *devinfo)
-{
-    bool found = false;
+/*
+ * Resolve pal_device_info of one deviceIn entry: device defaults, then the
+ * overrides of every usecase entry of the stream type, then the first
+ * custom config of each such usecase matching key, if key is given.
+ */
+void ResourceManager::resolveDeviceInfo(const deviceIn &dev, int type, const std::string *key,
+                                        struct pal_device_info *devinfo)
+{
+    devinfo->max_channels = dev.max_channel;
+    devinfo->channels = dev.channel;
+    devinfo->sndDevName = dev.sndDevName;
+    devinfo->samplerate = dev.samplerate;
+    devinfo->isExternalECRefEnabledFlag = dev.isExternalECRefEnabled;
+    devinfo->priority = MIN_USECASE_PRIORITY;
+    devinfo->bit_width = dev.bit_width;
+    devinfo->bitFormatSupported = dev.bitFormatSupported;
+    devinfo->channels_overwrite = false;
+    devinfo->samplerate_overwrite = false;
+    devinfo->sndDevName_overwrite = false;
+    devinfo->bit_width_overwrite = false;
+    devinfo->fractionalSRSupported = dev.fractionalSRSupported;
+    for (int32_t j = 0; j < dev.usecase.size(); j++) {
+        const usecase_info &usecase = dev.usecase[j];
+
+        if (type != usecase.type)
+            continue;
+        if (usecase.channel) {
+            devinfo->channels = usecase.channel;
+            devinfo->channels_overwrite = true;
+        }
+        if (usecase.samplerate) {
+            devinfo->samplerate = usecase.samplerate;
+            devinfo->samplerate_overwrite = true;
+        }
+        if (!(usecase.sndDevName).empty()) {
+            devinfo->sndDevName = usecase.sndDevName;
+            devinfo->sndDevName_overwrite = true;
+        }
+        if (usecase.priority)
+            devinfo->priority = usecase.priority;
+        if (usecase.bit_width) {
+            devinfo->bit_width = usecase.bit_width;
+            devinfo->bit_width_overwrite = true;
+        }
+        if (!key)
+            continue;
+        /*parse custom config if there*/
+        for (int32_t k = 0; k < usecase.config.size(); k++) {
+            const usecase_custom_config_info &config = usecase.config[k];
+
+            if (config.key.compare(*key))
+                continue;
+            /*overwrite the channels if needed*/
+            if (config.channel) {
+                devinfo->channels = config.channel;
+                devinfo->channels_overwrite = true;
+            }
+            if (config.samplerate) {
+                devinfo->samplerate = config.samplerate;
+                devinfo->samplerate_overwrite = true;
+            }
+            if (!(config.sndDevName).empty()) {
+                devinfo->sndDevName = config.sndDevName;
+                devinfo->sndDevName_overwrite = true;
+            }
+            if (config.priority && config.priority != MIN_USECASE_PRIORITY)
+                devinfo->priority = config.priority;
+            if (config.bit_width) {
+                devinfo->bit_width = config.bit_width;
+                devinfo->bit_width_overwrite = true;
+            }
+            break;
+        }
+    }
+}
 
+/*
+ * Flatten deviceInfo once the resource manager xml is parsed, so that
+ * getDeviceInfo is a lookup by (device, stream type, custom key). When a
+ * device is listed more than once the last entry wins, as in the scan
+ * this replaces.
+ */
+void ResourceManager::buildDeviceInfoIndex()
+{
+    deviceInfoIndex.clear();
     for (int32_t i = 0; i < deviceInfo.size(); i++) {
-        if (deviceId == deviceInfo[i].deviceId) {
-            devinfo->max_channels = deviceInfo[i].max_channel;
-            devinfo->channels = deviceInfo[i].channel;
-            devinfo->sndDevName = deviceInfo[i].sndDevName;
-            devinfo->samplerate = deviceInfo[i].samplerate;
-            devinfo->isExternalECRefEnabledFlag = deviceInfo[i].isExternalECRefEnabled;
-            devinfo->priority = MIN_USECASE_PRIORITY;
-            devinfo->bit_width = deviceInfo[i].bit_width;
-            devinfo->bitFormatSupported = deviceInfo[i].bitFormatSupported;
-            devinfo->channels_overwrite = false;
-            devinfo->samplerate_overwrite = false;
-            devinfo->sndDevName_overwrite = false;
-            devinfo->bit_width_overwrite = false;
-            devinfo->fractionalSRSupported = deviceInfo[i].fractionalSRSupported;
-            for (int32_t j = 0; j < deviceInfo[i].usecase.size(); j++) {
-                if (type == deviceInfo[i].usecase[j].type) {
-                    if (deviceInfo[i].usecase[j].channel) {
-                        devinfo->channels = deviceInfo[i].usecase[j].channel;
-                        devinfo->channels_overwrite = true;
-                        PAL_VERBOSE(LOG_TAG, "getting overwritten channels %d for usecase %d for dev %s",
-                                devinfo->channels,
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    if (deviceInfo[i].usecase[j].samplerate) {
-                        devinfo->samplerate = deviceInfo[i].usecase[j].samplerate;
-                        devinfo->samplerate_overwrite = true;
-                        PAL_VERBOSE(LOG_TAG, "getting overwritten samplerate %d for usecase %d for dev %s",
-                                devinfo->samplerate,
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    if (!(deviceInfo[i].usecase[j].sndDevName).empty()) {
-                        devinfo->sndDevName = deviceInfo[i].usecase[j].sndDevName;
-                        devinfo->sndDevName_overwrite = true;
-                        PAL_VERBOSE(LOG_TAG, "getting overwritten snd device name %s for usecase %d for dev %s",
-                                devinfo->sndDevName.c_str(),
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    if (deviceInfo[i].usecase[j].priority) {
-                        devinfo->priority = deviceInfo[i].usecase[j].priority;
-                        PAL_VERBOSE(LOG_TAG, "getting priority %d for usecase %d for dev %s",
-                                devinfo->priority,
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    if (deviceInfo[i].usecase[j].bit_width) {
-                        devinfo->bit_width = deviceInfo[i].usecase[j].bit_width;
-                        devinfo->bit_width_overwrite = true;
-                        PAL_VERBOSE(LOG_TAG, "getting overwritten bit width %d for usecase %d for dev %s",
-                                devinfo->bit_width,
-                                type,
-                                deviceNameLUT.at(deviceId).c_str());
-                    }
-                    /*parse custom config if there*/
-                    for (int32_t k = 0; k < deviceInfo[i].usecase[j].config.size(); k++) {
-                        if (!deviceInfo[i].usecase[j].config[k].key.compare(key)) {
-                            /*overwrite the channels if needed*/
-                            if (deviceInfo[i].usecase[j].config[k].channel) {
-                                devinfo->channels = deviceInfo[i].usecase[j].config[k].channel;
-                                devinfo->channels_overwrite = true;
-                                PAL_VERBOSE(LOG_TAG, "got overwritten channels %d for custom key %s usecase %d for dev %s",
-                                        devinfo->channels,
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            if (deviceInfo[i].usecase[j].config[k].samplerate) {
-                                devinfo->samplerate = deviceInfo[i].usecase[j].config[k].samplerate;
-                                devinfo->samplerate_overwrite = true;
-                                PAL_VERBOSE(LOG_TAG, "got overwritten samplerate %d for custom key %s usecase %d for dev %s",
-                                        devinfo->samplerate,
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            if (!(deviceInfo[i].usecase[j].config[k].sndDevName).empty()) {
-                                devinfo->sndDevName = deviceInfo[i].usecase[j].config[k].sndDevName;
-                                devinfo->sndDevName_overwrite = true;
-                                PAL_VERBOSE(LOG_TAG, "got overwitten snd dev %s for custom key %s usecase %d for dev %s",
-                                        devinfo->sndDevName.c_str(),
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            if (deviceInfo[i].usecase[j].config[k].priority &&
-                                deviceInfo[i].usecase[j].config[k].priority != MIN_USECASE_PRIORITY) {
-                                devinfo->priority = deviceInfo[i].usecase[j].config[k].priority;
-                                PAL_VERBOSE(LOG_TAG, "got priority %d for custom key %s usecase %d for dev %s",
-                                        devinfo->priority,
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            if (deviceInfo[i].usecase[j].config[k].bit_width) {
-                                devinfo->bit_width = deviceInfo[i].usecase[j].config[k].bit_width;
-                                devinfo->bit_width_overwrite = true;
-                                PAL_VERBOSE(LOG_TAG, "got overwritten bit width %d for custom key %s usecase %d for dev %s",
-                                        devinfo->bit_width,
-                                        key.c_str(),
-                                        type,
-                                        deviceNameLUT.at(deviceId).c_str());
-                            }
-                            found = true;
-                            break;
-                        }
-                    }
-                }
+        const deviceIn &dev = deviceInfo[i];
+        deviceInfoIndexEntry &entry = deviceInfoIndex[dev.deviceId];
+
+        entry.usecase.clear();
+        resolveDeviceInfo(dev, -1, NULL, &entry.info);
+        for (int32_t j = 0; j < dev.usecase.size(); j++) {
+            int type = dev.usecase[j].type;
+            deviceInfoUsecaseEntry &usecaseEntry = entry.usecase[type];
+
+            resolveDeviceInfo(dev, type, NULL, &usecaseEntry.info);
+            for (int32_t k = 0; k < dev.usecase[j].config.size(); k++) {
+                const std::string &key = dev.usecase[j].config[k].key;
+
+                resolveDeviceInfo(dev, type, &key, &usecaseEntry.customConfig[key]);
             }
         }
     }
+    PAL_DBG(LOG_TAG, "device info index built for %zu devices", deviceInfoIndex.size());
+}
+
+void ResourceManager::getDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type, std::string key, struct pal_device_info *devinfo)
+{
+    auto devIter = deviceInfoIndex.find(deviceId);
+
+    if (devIter == deviceInfoIndex.end())
+        return;
+
+    auto usecaseIter = devIter->second.usecase.find(type);
+    if (usecaseIter == devIter->second.usecase.end()) {
+        *devinfo = devIter->second.info;
+    } else {
+        auto configIter = usecaseIter->second.customConfig.find(key);
+        if (configIter == usecaseIter->second.customConfig.end())
+            *devinfo = usecaseIter->second.info;
+        else
+            *devinfo = configIter->second;
+    }
+    PAL_VERBOSE(LOG_TAG, "dev %s usecase %d key %s: channels %d samplerate %d snd dev %s priority %d bit width %d",
+            deviceNameLUT.at(deviceId).c_str(), type, key.c_str(), devinfo->channels,
+            devinfo->samplerate, devinfo->sndDevName.c_str(), devinfo->priority,
+            devinfo->bit_width);
 }
 
 int32_t ResourceManager::getSidetoneMode(pal_device_id_t deviceId,
@@ -2278,78 +2336,78 @@ bool ResourceManager::isStreamSupported(struct pal_stream_attributes *attributes
         case PAL_STREAM_VOIP:
         case PAL_STREAM_VOIP_RX:
         case PAL_STREAM_VOIP_TX:
-            cur_sessions = active_streams_ll.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_LL);
             max_sessions = MAX_SESSIONS_LOW_LATENCY;
             break;
         case PAL_STREAM_ULTRA_LOW_LATENCY:
-            cur_sessions = active_streams_ull.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_ULL);
             max_sessions = MAX_SESSIONS_ULTRA_LOW_LATENCY;
             break;
         case PAL_STREAM_DEEP_BUFFER:
-            cur_sessions = active_streams_db.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_DB);
             max_sessions = MAX_SESSIONS_DEEP_BUFFER;
             break;
         case PAL_STREAM_COMPRESSED:
-            cur_sessions = active_streams_comp.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_COMP);
             max_sessions = MAX_SESSIONS_COMPRESSED;
             break;
         case PAL_STREAM_GENERIC:
-            cur_sessions = active_streams_ulla.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_ULLA);
             max_sessions = MAX_SESSIONS_GENERIC;
             break;
         case PAL_STREAM_RAW:
-            cur_sessions = active_streams_raw.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_RAW);
             max_sessions = MAX_SESSIONS_RAW;
             break;
         case PAL_STREAM_VOICE_RECOGNITION:
-            cur_sessions = active_streams_voice_rec.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_VOICE_REC);
             max_sessions = MAX_SESSIONS_VOICE_RECOGNITION;
             break;
         case PAL_STREAM_LOOPBACK:
         case PAL_STREAM_TRANSCODE:
         case PAL_STREAM_VOICE_UI:
-            cur_sessions = active_streams_st.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_ST);
             max_sessions = MAX_SESSIONS_VOICE_UI;
             break;
         case PAL_STREAM_ACD:
-            cur_sessions = active_streams_acd.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_ACD);
             max_sessions = MAX_SESSIONS_ACD;
             break;
         case PAL_STREAM_PCM_OFFLOAD:
-            cur_sessions = active_streams_po.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_PO);
             max_sessions = MAX_SESSIONS_PCM_OFFLOAD;
             break;
         case PAL_STREAM_PROXY:
-            cur_sessions = active_streams_proxy.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_PROXY);
             max_sessions = MAX_SESSIONS_PROXY;
             break;
          case PAL_STREAM_VOICE_CALL:
             break;
         case PAL_STREAM_VOICE_CALL_MUSIC:
-            cur_sessions = active_streams_incall_music.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_INCALL_MUSIC);
             max_sessions = MAX_SESSIONS_INCALL_MUSIC;
             break;
         case PAL_STREAM_VOICE_CALL_RECORD:
-            cur_sessions = active_streams_incall_record.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_INCALL_RECORD);
             max_sessions = MAX_SESSIONS_INCALL_RECORD;
             break;
         case PAL_STREAM_NON_TUNNEL:
-            cur_sessions = active_streams_non_tunnel.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_NON_TUNNEL);
             max_sessions = max_nt_sessions;
             break;
         case PAL_STREAM_HAPTICS:
-            cur_sessions = active_streams_haptics.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_HAPTICS);
             max_sessions = MAX_SESSIONS_HAPTICS;
             break;
         case PAL_STREAM_CONTEXT_PROXY:
             return true;
             break;
         case PAL_STREAM_ULTRASOUND:
-            cur_sessions = active_streams_ultrasound.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_ULTRASOUND);
             max_sessions = MAX_SESSIONS_ULTRASOUND;
             break;
         case PAL_STREAM_SENSOR_PCM_DATA:
-            cur_sessions = active_streams_sensor_pcm_data.size();
+            cur_sessions = mActiveStreams.count(ACTIVE_STREAMS_SENSOR_PCM_DATA);
             max_sessions = MAX_SESSIONS_SENSOR_PCM_DATA;
             break;
         default:
@@ -2488,14 +2546,6 @@ bool ResourceManager::isStreamSupported(struct pal_stream_attributes *attributes
     return result;
 }
 
-template <class T>
-int registerstream(T s, std::list<T> &streams)
-{
-    int ret = 0;
-    streams.push_back(s);
-    return ret;
-}
-
 int ResourceManager::registerStream(Stream *s)
 {
     int ret = 0;
@@ -2509,127 +2559,16 @@ int ResourceManager::registerStream(Stream *s)
     PAL_DBG(LOG_TAG, "stream type %d", type);
     mActiveStreamMutex.lock();
     mValidStreamMutex.lock();
-    switch (type) {
-        case PAL_STREAM_LOW_LATENCY:
-        case PAL_STREAM_VOIP_RX:
-        case PAL_STREAM_VOIP_TX:
-        case PAL_STREAM_VOICE_CALL:
-        {
-            StreamPCM* sPCM = dynamic_cast<StreamPCM*>(s);
-            ret = registerstream(sPCM, active_streams_ll);
-            break;
-        }
-        case PAL_STREAM_PCM_OFFLOAD:
-        case PAL_STREAM_LOOPBACK:
-        {
-            StreamPCM* sPCM = dynamic_cast<StreamPCM*>(s);
-            ret = registerstream(sPCM, active_streams_po);
-            break;
-        }
-        case PAL_STREAM_DEEP_BUFFER:
-        {
-            StreamPCM* sDB = dynamic_cast<StreamPCM*>(s);
-            ret = registerstream(sDB, active_streams_db);
-            break;
-        }
-        case PAL_STREAM_COMPRESSED:
-        {
-            StreamCompress* sComp = dynamic_cast<StreamCompress*>(s);
-            ret = registerstream(sComp, active_streams_comp);
-            break;
-        }
-        case PAL_STREAM_GENERIC:
-        {
-            StreamPCM* sULLA = dynamic_cast<StreamPCM*>(s);
-            ret = registerstream(sULLA, active_streams_ulla);
-            break;
-        }
-        case PAL_STREAM_VOICE_UI:
-        {
-            if (active_streams_st.size() == 0)
-                onVUIStreamRegistered();
-            StreamSoundTrigger* sST = dynamic_cast<StreamSoundTrigger*>(s);
-            ret = registerstream(sST, active_streams_st);
-            break;
-        }
-        case PAL_STREAM_ULTRA_LOW_LATENCY:
-        {
-            StreamPCM* sULL = dynamic_cast<StreamPCM*>(s);
-            ret = registerstream(sULL, active_streams_ull);
-            break;
-        }
-        case PAL_STREAM_PROXY:
-        {
-            StreamPCM* sProxy = dynamic_cast<StreamPCM*>(s);
-            ret = registerstream(sProxy, active_streams_proxy);
-            break;
-        }
-        case PAL_STREAM_VOICE_CALL_MUSIC:
-        {
-            StreamInCall* sPCM = dynamic_cast<StreamInCall*>(s);
-            ret = registerstream(sPCM, active_streams_incall_music);
-            break;
-        }
-        case PAL_STREAM_VOICE_CALL_RECORD:
-        {
-            StreamInCall* sPCM = dynamic_cast<StreamInCall*>(s);
-            ret = registerstream(sPCM, active_streams_incall_record);
-            break;
-        }
-        case PAL_STREAM_NON_TUNNEL:
-        {
-            StreamNonTunnel* sNonTunnel = dynamic_cast<StreamNonTunnel*>(s);
-            ret = registerstream(sNonTunnel, active_streams_non_tunnel);
-            break;
-        }
-        case PAL_STREAM_HAPTICS:
-        {
-            StreamPCM* sDB = dynamic_cast<StreamPCM*>(s);
-            ret = registerstream(sDB, active_streams_haptics);
-            break;
-        }
-        case PAL_STREAM_ACD:
-        {
-            StreamACD* sAcd = dynamic_cast<StreamACD*>(s);
-            ret = registerstream(sAcd, active_streams_acd);
-            break;
-        }
-        case PAL_STREAM_ULTRASOUND:
-        {
-            StreamUltraSound* sUPD = dynamic_cast<StreamUltraSound*>(s);
-            ret = registerstream(sUPD, active_streams_ultrasound);
-            break;
-        }
-        case PAL_STREAM_RAW:
-        {
-            StreamPCM* sRaw = dynamic_cast<StreamPCM*>(s);
-            ret = registerstream(sRaw, active_streams_raw);
-            break;
-        }
-        case PAL_STREAM_SENSOR_PCM_DATA:
-        {
-            StreamSensorPCMData* sPCM = dynamic_cast<StreamSensorPCMData*>(s);
-            ret = registerstream(sPCM, active_streams_sensor_pcm_data);
-            break;
-        }
-        case PAL_STREAM_CONTEXT_PROXY:
-        {
-            StreamContextProxy* sCtxt = dynamic_cast<StreamContextProxy*>(s);
-            ret = registerstream(sCtxt, active_streams_context_proxy);
-            break;
-        }
-        case PAL_STREAM_VOICE_RECOGNITION:
-        {
-            StreamPCM* sVR = dynamic_cast<StreamPCM*>(s);
-            ret = registerstream(sVR, active_streams_voice_rec);
-            break;
-        }
-        default:
-            ret = -EINVAL;
-            PAL_ERR(LOG_TAG, "Invalid stream type = %d ret %d", type, ret);
-            break;
+    if (type == PAL_STREAM_VOICE_UI && !mActiveStreams.count(ACTIVE_STREAMS_ST))
+        onVUIStreamRegistered();
+    ret = mActiveStreams.add(s, type);
+    if (ret == -EALREADY) {
+        PAL_ERR(LOG_TAG, "stream %pK already registered", s);
+        ret = 0;
+    } else if (ret) {
+        PAL_ERR(LOG_TAG, "Invalid stream type = %d ret %d", type, ret);
     }
-    mActiveStreams.push_back(s);
+    mStreamHandleRegistry.setFlags(s, STREAM_HANDLE_VALID);
 
 #if 0
     s->getStreamAttributes(&incomingStreamAttr);
@@ -2652,19 +2591,6 @@ int ResourceManager::registerStream(Stream *s)
 ///private functions
 
 
-// template function to deregister stream
-template <class T>
-int deregisterstream(T s, std::list<T> &streams)
-{
-    int ret = 0;
-    typename std::list<T>::iterator iter = std::find(streams.begin(), streams.end(), s);
-    if (iter != streams.end())
-        streams.erase(iter);
-    else
-        ret = -ENOENT;
-    return ret;
-}
-
 int ResourceManager::deregisterStream(Stream *s)
 {
     int ret = 0;
@@ -2683,182 +2609,61 @@ int ResourceManager::deregisterStream(Stream *s)
     PAL_INFO(LOG_TAG, "stream type %d", type);
     mActiveStreamMutex.lock();
     mValidStreamMutex.lock();
-    switch (type) {
-        case PAL_STREAM_LOW_LATENCY:
-        case PAL_STREAM_VOIP_RX:
-        case PAL_STREAM_VOIP_TX:
-        case PAL_STREAM_VOICE_CALL:
-        {
-            StreamPCM* sPCM = dynamic_cast<StreamPCM*>(s);
-            ret = deregisterstream(sPCM, active_streams_ll);
-            break;
-        }
-        case PAL_STREAM_PCM_OFFLOAD:
-        case PAL_STREAM_LOOPBACK:
-        {
-            StreamPCM* sPCM = dynamic_cast<StreamPCM*>(s);
-            ret = deregisterstream(sPCM, active_streams_po);
-            break;
-        }
-        case PAL_STREAM_DEEP_BUFFER:
-        {
-            StreamPCM* sDB = dynamic_cast<StreamPCM*>(s);
-            ret = deregisterstream(sDB, active_streams_db);
-            break;
-        }
-        case PAL_STREAM_COMPRESSED:
-        {
-            StreamCompress* sComp = dynamic_cast<StreamCompress*>(s);
-            ret = deregisterstream(sComp, active_streams_comp);
-            break;
-        }
-        case PAL_STREAM_GENERIC:
-        {
-            StreamPCM* sULLA = dynamic_cast<StreamPCM*>(s);
-            ret = deregisterstream(sULLA, active_streams_ulla);
-            break;
-        }
-        case PAL_STREAM_VOICE_UI:
-        {
-            StreamSoundTrigger* sST = dynamic_cast<StreamSoundTrigger*>(s);
-            ret = deregisterstream(sST, active_streams_st);
-            // reset concurrency count when all st streams deregistered
-            if (active_streams_st.size() == 0) {
-                onVUIStreamDeregistered();
-            }
-            break;
-        }
-        case PAL_STREAM_ULTRA_LOW_LATENCY:
-        {
-            StreamPCM* sULL = dynamic_cast<StreamPCM*>(s);
-            ret = deregisterstream(sULL, active_streams_ull);
-            break;
-        }
-        case PAL_STREAM_PROXY:
-        {
-            StreamPCM* sProxy = dynamic_cast<StreamPCM*>(s);
-            ret = deregisterstream(sProxy, active_streams_proxy);
-            break;
-        }
-        case PAL_STREAM_VOICE_CALL_MUSIC:
-        {
-            StreamInCall* sPCM = dynamic_cast<StreamInCall*>(s);
-            ret = deregisterstream(sPCM, active_streams_incall_music);
-            break;
-        }
-        case PAL_STREAM_VOICE_CALL_RECORD:
-        {
-            StreamInCall* sPCM = dynamic_cast<StreamInCall*>(s);
-            ret = deregisterstream(sPCM, active_streams_incall_record);
-            break;
-        }
-        case PAL_STREAM_NON_TUNNEL:
-        {
-            StreamNonTunnel* sNonTunnel = dynamic_cast<StreamNonTunnel*>(s);
-            ret = deregisterstream(sNonTunnel, active_streams_non_tunnel);
-            break;
-        }
-        case PAL_STREAM_HAPTICS:
-        {
-            StreamPCM* sDB = dynamic_cast<StreamPCM*>(s);
-            ret = deregisterstream(sDB, active_streams_haptics);
-            break;
-        }
-        case PAL_STREAM_ACD:
-        {
-            StreamACD* sAcd = dynamic_cast<StreamACD*>(s);
-            ret = deregisterstream(sAcd, active_streams_acd);
-            break;
-        }
-        case PAL_STREAM_ULTRASOUND:
-        {
-            StreamUltraSound* sUPD = dynamic_cast<StreamUltraSound*>(s);
-            ret = deregisterstream(sUPD, active_streams_ultrasound);
-            break;
-        }
-        case PAL_STREAM_RAW:
-        {
-            StreamPCM* sRaw = dynamic_cast<StreamPCM*>(s);
-            ret = deregisterstream(sRaw, active_streams_raw);
-            break;
-        }
-        case PAL_STREAM_SENSOR_PCM_DATA:
-        {
-            StreamSensorPCMData* sPCM = dynamic_cast<StreamSensorPCMData*>(s);
-            ret = deregisterstream(sPCM, active_streams_sensor_pcm_data);
-            break;
-        }
-        case PAL_STREAM_CONTEXT_PROXY:
-        {
-            StreamContextProxy* sCtxt = dynamic_cast<StreamContextProxy*>(s);
-            ret = deregisterstream(sCtxt, active_streams_context_proxy);
-            break;
-        }
-        case PAL_STREAM_VOICE_RECOGNITION:
-        {
-            StreamPCM* sVR = dynamic_cast<StreamPCM*>(s);
-            ret = deregisterstream(sVR, active_streams_voice_rec);
-            break;
-        }
-        default:
-            ret = -EINVAL;
-            PAL_ERR(LOG_TAG, "Invalid stream type = %d ret %d", type, ret);
-            break;
+    ret = mActiveStreams.remove(s);
+    if (!ret && ActiveStreamRegistry::getGroup(type) == ACTIVE_STREAMS_MAX) {
+        ret = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid stream type = %d ret %d", type, ret);
     }
-
-    deregisterstream(s, mActiveStreams);
+    // reset concurrency count when all st streams deregistered
+    if (type == PAL_STREAM_VOICE_UI && !mActiveStreams.count(ACTIVE_STREAMS_ST))
+        onVUIStreamDeregistered();
+    mStreamHandleRegistry.clearFlags(s, STREAM_HANDLE_VALID);
     mValidStreamMutex.unlock();
     mActiveStreamMutex.unlock();
+
+    for (int i = 0; i < FE_POOL_MAX; i++) {
+        std::vector<int> leaked;
+
+        frontEndPools[i].getOwnedIds(s, leaked);
+        for (int j = 0; j < leaked.size(); j++)
+            PAL_INFO(LOG_TAG, "stream %pK still holds front end %d", s, leaked[j]);
+    }
 exit:
     PAL_DBG(LOG_TAG, "Exit. ret %d", ret);
     return ret;
 }
 
-template <class T>
-bool isStreamActive(T s, std::list<T> &streams)
+/* caller holds mActiveStreamMutex or mResourceManagerMutex */
+bool ResourceManager::isStreamActive(Stream *s)
 {
-    bool ret = false;
-
-    PAL_DBG(LOG_TAG, "Enter.");
-    typename std::list<T>::iterator iter =
-        std::find(streams.begin(), streams.end(), s);
-    if (iter != streams.end()) {
-        ret = true;
-    }
-
-    PAL_DBG(LOG_TAG, "Exit, ret %d", ret);
-    return ret;
+    return mActiveStreams.contains(s);
 }
 
 int ResourceManager::isActiveStream(pal_stream_handle_t *handle) {
-    for (auto &s : mActiveStreams) {
-        if (handle == reinterpret_cast<uint64_t *>(s)) {
-            return true;
-        }
-    }
-    return false;
+    return mStreamHandleRegistry.hasFlags(handle, STREAM_HANDLE_VALID);
 }
 
 int ResourceManager::initStreamUserCounter(Stream *s)
 {
     lockValidStreamMutex();
-    mActiveStreamUserCounter.insert(std::make_pair(s, std::make_pair(0, true)));
     s->initStreamSmph();
+    mStreamHandleRegistry.setFlags(s, STREAM_HANDLE_ACTIVE);
     unlockValidStreamMutex();
     return 0;
 }
 
 int ResourceManager::deactivateStreamUserCounter(Stream *s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
+    uint32_t users = 0;
+
     lockValidStreamMutex();
     printStreamUserCounter(s);
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end() && it->second.second == true) {
-        PAL_DBG(LOG_TAG, "stream %p is to be deactivated.", s);
-        it->second.second = false;
+    if (!mStreamHandleRegistry.deactivate(s, &users)) {
+        PAL_DBG(LOG_TAG, "stream %p is to be deactivated, users %u.", s, users);
         unlockValidStreamMutex();
-        s->waitStreamSmph();
+        /* last user leaving a deactivated stream posts the semaphore */
+        if (users)
+            s->waitStreamSmph();
         PAL_DBG(LOG_TAG, "stream %p is inactive.", s);
         s->deinitStreamSmph();
         return 0;
@@ -2871,11 +2676,8 @@ int ResourceManager::deactivateStreamUserCounter(Stream *s)
 
 int ResourceManager::eraseStreamUserCounter(Stream *s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
     lockValidStreamMutex();
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end()) {
-        mActiveStreamUserCounter.erase(it);
+    if (!mStreamHandleRegistry.erase(s)) {
         PAL_DBG(LOG_TAG, "stream counter for %p is erased.", s);
         unlockValidStreamMutex();
         return 0;
@@ -2886,20 +2688,15 @@ int ResourceManager::eraseStreamUserCounter(Stream *s)
     }
 }
 
+/*
+ * Lock free, handle is validated against the registry before the stream
+ * is touched. Callers no longer need mValidStreamMutex around it.
+ */
 int ResourceManager::increaseStreamUserCounter(Stream* s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
-    printStreamUserCounter(s);
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end() &&
-        it->second.second) {
-        if (0 == it->second.first) {
-            s->waitStreamSmph();
-            PAL_DBG(LOG_TAG, "stream %p in use", s);
-        }
-        PAL_DBG(LOG_TAG, "stream %p counter was %d", s, it->second.first);
-        it->second.first = it->second.first + 1;
-        PAL_DBG(LOG_TAG, "stream %p counter increased to %d", s, it->second.first);
+    if (!mStreamHandleRegistry.acquire(s)) {
+        PAL_VERBOSE(LOG_TAG, "stream %p counter increased to %d", s,
+                    mStreamHandleRegistry.getUsers(s));
         return 0;
     } else {
         PAL_ERR(LOG_TAG, "stream %p is not found or inactive.", s);
@@ -2909,50 +2706,35 @@ int ResourceManager::increaseStreamUserCounter(Stream* s)
 
 int ResourceManager::decreaseStreamUserCounter(Stream* s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
-    printStreamUserCounter(s);
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end()) {
-        PAL_DBG(LOG_TAG, "stream %p counter was %d", s, it->second.first);
-        if (0 == it->second.first) {
-            PAL_ERR(LOG_TAG, "counter of stream %p has already been 0.", s);
-            return -EINVAL;
-        }
+    bool lastUser = false;
 
-        it->second.first = it->second.first - 1;
-        if (0 == it->second.first) {
+    if (!mStreamHandleRegistry.release(s, &lastUser)) {
+        if (lastUser) {
             PAL_DBG(LOG_TAG, "stream %p not in use", s);
             s->postStreamSmph();
         }
-        PAL_DBG(LOG_TAG, "stream %p counter decreased to %d", s, it->second.first);
         return 0;
     } else {
-        PAL_ERR(LOG_TAG, "stream %p is not found.", s);
+        PAL_ERR(LOG_TAG, "stream %p is not found or counter is already 0.", s);
         return -EINVAL;
     }
 }
 
 int ResourceManager::getStreamUserCounter(Stream *s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
-    printStreamUserCounter(s);
-    it = mActiveStreamUserCounter.find(s);
-    if (it != mActiveStreamUserCounter.end()) {
-        return it->second.first;
-    } else {
+    int users = mStreamHandleRegistry.getUsers(s);
+
+    if (users < 0)
         PAL_ERR(LOG_TAG, "stream %p is not found.", s);
-        return -EINVAL;
-    }
+    return users;
 }
 
 int ResourceManager::printStreamUserCounter(Stream *s)
 {
-    std::map<Stream*, std::pair<uint32_t, bool>>::iterator it;
-    for (it = mActiveStreamUserCounter.begin();
-            it != mActiveStreamUserCounter.end(); it++) {
-        PAL_VERBOSE(LOG_TAG, "stream = %p count = %d active = %d",
-                    it->first, it->second.first, it->second.second);
-    }
+    PAL_VERBOSE(LOG_TAG, "stream = %p count = %d valid = %d active = %d", s,
+                mStreamHandleRegistry.getUsers(s),
+                mStreamHandleRegistry.hasFlags(s, STREAM_HANDLE_VALID),
+                mStreamHandleRegistry.hasFlags(s, STREAM_HANDLE_ACTIVE));
 
     return 0;
 }
@@ -3098,12 +2880,10 @@ int ResourceManager::registerDevice_l(std::shared_ptr<Device> d, Stream *s)
 {
     int ret = 0;
     PAL_DBG(LOG_TAG, "Enter.");
-    auto iter = std::find(active_devices.begin(),
-        active_devices.end(), std::make_pair(d, s));
-    if (iter == active_devices.end())
+    /* the device index rejects pairs already registered */
+    ret = mActiveStreams.addDevice(d, d->getSndDeviceId(), s);
+    if (!ret)
         active_devices.push_back(std::make_pair(d, s));
-    else
-        ret = -EINVAL;
     PAL_DBG(LOG_TAG, "Exit.");
     return ret;
 }
@@ -3200,7 +2980,7 @@ int ResourceManager::registerDevice(std::shared_ptr<Device> d, Stream *s)
                 PAL_DBG(LOG_TAG, "Invalid device pair, skip");
             } else if (rxdevcount > 1) {
                 PAL_DBG(LOG_TAG, "EC ref already set");
-            } else if (str && isStreamActive(str, mActiveStreams)) {
+            } else if (str && isStreamActive(str)) {
                 mResourceManagerMutex.unlock();
                 /* For Device switch, stream mutex will be already acquired,
                     * so call setECRef_l instead of setECRef.
@@ -3265,7 +3045,7 @@ int ResourceManager::registerDevice(std::shared_ptr<Device> d, Stream *s)
                     PAL_DBG(LOG_TAG, "Invalid device pair, skip");
                 } else if (rxdevcount > 1) {
                     PAL_DBG(LOG_TAG, "EC ref already set");
-                } else if (str && isStreamActive(str, mActiveStreams)) {
+                } else if (str && isStreamActive(str)) {
                     mResourceManagerMutex.unlock();
                     if (isDeviceSwitch && str->isMutexLockedbyRm())
                         status = str->setECRef_l(d, true);
@@ -3301,9 +3081,10 @@ int ResourceManager::deregisterDevice_l(std::shared_ptr<Device> d, Stream *s)
 
     auto iter = std::find(active_devices.begin(),
         active_devices.end(), std::make_pair(d, s));
-    if (iter != active_devices.end())
+    if (iter != active_devices.end()) {
         active_devices.erase(iter);
-    else {
+        mActiveStreams.removeDevice(d, d->getSndDeviceId(), s);
+    } else {
         ret = -ENOENT;
         PAL_ERR(LOG_TAG, "no device %d found in active device list ret %d",
                 d->getSndDeviceId(), ret);
@@ -3379,7 +3160,7 @@ int ResourceManager::deregisterDevice(std::shared_ptr<Device> d, Stream *s)
                     PAL_DBG(LOG_TAG, "Invalid device pair, skip");
                 } else if (rxdevcount > 0) {
                     PAL_DBG(LOG_TAG, "EC ref still active, no need to reset");
-                } else if (str && isStreamActive(str, mActiveStreams)) {
+                } else if (str && isStreamActive(str)) {
                     mResourceManagerMutex.unlock();
                     if (isDeviceSwitch && str->isMutexLockedbyRm())
                         status = str->setECRef_l(d, false);
@@ -3411,7 +3192,7 @@ int ResourceManager::deregisterDevice(std::shared_ptr<Device> d, Stream *s)
                 PAL_DBG(LOG_TAG, "Invalid device pair, skip");
             } else if (rxdevcount > 0) {
                 PAL_DBG(LOG_TAG, "EC ref still active, no need to reset");
-            } else if (str && isStreamActive(str, mActiveStreams)) {
+            } else if (str && isStreamActive(str)) {
                 mResourceManagerMutex.unlock();
                 if (isDeviceSwitch && str->isMutexLockedbyRm())
                     status = str->setECRef_l(d, false);
@@ -3470,11 +3251,7 @@ bool ResourceManager::isDeviceActive_l(std::shared_ptr<Device> d, Stream *s)
     int deviceId = d->getSndDeviceId();
 
     PAL_DBG(LOG_TAG, "Enter.");
-    auto iter = std::find(active_devices.begin(),
-        active_devices.end(), std::make_pair(d, s));
-    if (iter != active_devices.end()) {
-        is_active = true;
-    }
+    is_active = mActiveStreams.hasDevice(d, deviceId, s);
 
     PAL_DBG(LOG_TAG, "Exit. device %d is active %d", deviceId, is_active);
     return is_active;
@@ -3806,8 +3583,10 @@ bool ResourceManager::CheckForForcedTransitToNonLPI() {
 std::shared_ptr<CaptureProfile> ResourceManager::GetACDCaptureProfileByPriority(
     StreamACD *s, std::shared_ptr<CaptureProfile> cap_prof_priority) {
     std::shared_ptr<CaptureProfile> cap_prof = nullptr;
+    std::vector<StreamACD*> acdStreams;
 
-       for (auto& str: active_streams_acd) {
+       mActiveStreams.snapshot(ACTIVE_STREAMS_ACD, acdStreams);
+       for (auto& str: acdStreams) {
        // NOTE: input param s can be nullptr here
         if (str == s) {
             continue;
@@ -3832,8 +3611,10 @@ std::shared_ptr<CaptureProfile> ResourceManager::GetACDCaptureProfileByPriority(
 std::shared_ptr<CaptureProfile> ResourceManager::GetSVACaptureProfileByPriority(
     StreamSoundTrigger *s, std::shared_ptr<CaptureProfile> cap_prof_priority) {
     std::shared_ptr<CaptureProfile> cap_prof = nullptr;
+    std::vector<StreamSoundTrigger*> stStreams;
 
-    for (auto& str: active_streams_st) {
+    mActiveStreams.snapshot(ACTIVE_STREAMS_ST, stStreams);
+    for (auto& str: stStreams) {
         // NOTE: input param s can be nullptr here
         if (str == s) {
             continue;
@@ -3863,8 +3644,10 @@ std::shared_ptr<CaptureProfile> ResourceManager::GetSVACaptureProfileByPriority(
 std::shared_ptr<CaptureProfile> ResourceManager::GetSPDCaptureProfileByPriority(
     StreamSensorPCMData *s, std::shared_ptr<CaptureProfile> cap_prof_priority) {
     std::shared_ptr<CaptureProfile> cap_prof = nullptr;
+    std::vector<StreamSensorPCMData*> spdStreams;
 
-    for (auto& str: active_streams_sensor_pcm_data) {
+    mActiveStreams.snapshot(ACTIVE_STREAMS_SENSOR_PCM_DATA, spdStreams);
+    for (auto& str: spdStreams) {
         // NOTE: input param s can be nullptr here
         if (str == s) {
             continue;
@@ -4292,18 +4075,18 @@ int ResourceManager::HandleDetectionStreamAction(pal_stream_type_t type, int32_t
     pal_stream_attributes st_attr;
 
     if ((type == PAL_STREAM_VOICE_UI &&
-         !active_streams_st.size()) ||
+         !mActiveStreams.count(ACTIVE_STREAMS_ST)) ||
         (type == PAL_STREAM_ACD &&
-         !active_streams_acd.size()) ||
+         !mActiveStreams.count(ACTIVE_STREAMS_ACD)) ||
         (type == PAL_STREAM_SENSOR_PCM_DATA &&
-         !active_streams_sensor_pcm_data.size())) {
+         !mActiveStreams.count(ACTIVE_STREAMS_SENSOR_PCM_DATA))) {
         PAL_VERBOSE(LOG_TAG, "No active stream for type %d, skip action", type);
         return 0;
     }
 
     PAL_DBG(LOG_TAG, "Enter");
     for (auto& str: mActiveStreams) {
-        if (!isStreamActive(str, mActiveStreams))
+        if (!isStreamActive(str))
             continue;
 
         str->getStreamAttributes(&st_attr);
@@ -4540,11 +4323,11 @@ void ResourceManager::handleDeferredSwitch()
 
         use_lpi_ = !active;
 
-        if (active_streams_st.size())
+        if (mActiveStreams.count(ACTIVE_STREAMS_ST))
             st_streams.push_back(PAL_STREAM_VOICE_UI);
-        if (active_streams_acd.size())
+        if (mActiveStreams.count(ACTIVE_STREAMS_ACD))
             st_streams.push_back(PAL_STREAM_ACD);
-        if (active_streams_sensor_pcm_data.size())
+        if (mActiveStreams.count(ACTIVE_STREAMS_SENSOR_PCM_DATA))
             st_streams.push_back(PAL_STREAM_SENSOR_PCM_DATA);
 
         handleConcurrentStreamSwitch(st_streams, active);
@@ -4557,7 +4340,10 @@ void ResourceManager::handleDeferredSwitch()
 
 bool ResourceManager::isAnyVUIStreamBuffering()
 {
-    for (auto& str: active_streams_st) {
+    std::vector<StreamSoundTrigger*> stStreams;
+
+    mActiveStreams.snapshot(ACTIVE_STREAMS_ST, stStreams);
+    for (auto& str: stStreams) {
         if (str->IsStreamInBuffering())
             return true;
     }
@@ -4616,7 +4402,7 @@ void ResourceManager::HandleConcurrencyForSoundTriggerStreams(pal_stream_type_t
                 if ((PAL_STREAM_VOICE_UI == st_stream_type && --concurrencyEnableCount == 0) ||
                     (PAL_STREAM_ACD == st_stream_type && --ACDConcurrencyEnableCount == 0) ||
                     (PAL_STREAM_SENSOR_PCM_DATA == st_stream_type && --SNSPCMDataConcurrencyEnableCount == 0)) {
-                    if (!(active_streams_st.size() && charging_state_ && IsTransitToNonLPIOnChargingSupported())) {
+                    if (!(mActiveStreams.count(ACTIVE_STREAMS_ST) && charging_state_ && IsTransitToNonLPIOnChargingSupported())) {
                         do_st_stream_switch = true;
                         use_lpi_temp = true;
                     }
@@ -4733,13 +4519,10 @@ std::vector<Stream*> ResourceManager::getConcurrentTxStream_l(
     Stream *rx_str,
     std::shared_ptr<Device> rx_device)
 {
-    int deviceId = 0;
     int status = 0;
     std::vector<Stream*> tx_stream_list;
     struct pal_stream_attributes tx_attr;
     struct pal_stream_attributes rx_attr;
-    std::shared_ptr<Device> tx_device = nullptr;
-    std::vector <std::shared_ptr<Device>> tx_device_list;
 
     // check stream direction
     status = rx_str->getStreamAttributes(&rx_attr);
@@ -4754,35 +4537,41 @@ std::vector<Stream*> ResourceManager::getConcurrentTxStream_l(
         goto exit;
     }
 
-    for (auto& tx_str: mActiveStreams) {
-        tx_device_list.clear();
-        tx_str->getStreamAttributes(&tx_attr);
-        if (tx_attr.type == PAL_STREAM_PROXY ||
-            tx_attr.type == PAL_STREAM_ULTRA_LOW_LATENCY ||
-            tx_attr.type == PAL_STREAM_GENERIC)
+    /*
+     * Walk the active tx devices instead of every stream, checking each
+     * device object against the rx device once. A stream with several
+     * matching tx devices is reported once, like the per-stream scan did.
+     */
+    for (auto &devStreams : mActiveStreams.devices()) {
+        std::shared_ptr<Device> checked = nullptr;
+        bool ecRef = false;
+
+        if (devStreams.first <= PAL_DEVICE_IN_MIN ||
+            devStreams.first >= PAL_DEVICE_IN_MAX)
             continue;
-        if (tx_attr.direction == PAL_AUDIO_INPUT) {
+        for (auto &pair : devStreams.second) {
+            Stream *tx_str = pair.second;
+
+            if (pair.first != checked) {
+                checked = pair.first;
+                ecRef = checkECRef(rx_device, checked);
+            }
+            if (!ecRef || !mActiveStreams.contains(tx_str) ||
+                std::find(tx_stream_list.begin(), tx_stream_list.end(), tx_str) !=
+                    tx_stream_list.end())
+                continue;
+            tx_str->getStreamAttributes(&tx_attr);
+            if (tx_attr.type == PAL_STREAM_PROXY ||
+                tx_attr.type == PAL_STREAM_ULTRA_LOW_LATENCY ||
+                tx_attr.type == PAL_STREAM_GENERIC ||
+                tx_attr.direction != PAL_AUDIO_INPUT)
+                continue;
             if (!getEcRefStatus(tx_attr.type, rx_attr.type)) {
                 PAL_DBG(LOG_TAG, "No need to enable ec ref for rx %d tx %d",
                         rx_attr.type, tx_attr.type);
                 continue;
             }
-            tx_str->getAssociatedDevices(tx_device_list);
-            for (int i = 0; i < tx_device_list.size(); i++) {
-                if (!isDeviceActive_l(tx_device_list[i], tx_str))
-                    continue;
-                deviceId = tx_device_list[i]->getSndDeviceId();
-                if (deviceId > PAL_DEVICE_IN_MIN &&
-                    deviceId < PAL_DEVICE_IN_MAX)
-                    tx_device = tx_device_list[i];
-                else
-                    tx_device = nullptr;
-
-                if (checkECRef(rx_device, tx_device)) {
-                    tx_stream_list.push_back(tx_str);
-                    break;
-                }
-            }
+            tx_stream_list.push_back(tx_str);
         }
     }
 exit:
@@ -5009,11 +4798,10 @@ void ResourceManager::getHigherPriorityActiveStreams(const int inComingStreamPri
 #endif
 
 
-template <class T>
-void getActiveStreams(std::shared_ptr<Device> d, std::vector<Stream*> &activestreams,
-                      std::list<T> sourcestreams)
+static void getActiveStreams(std::shared_ptr<Device> d, std::vector<Stream*> &activestreams,
+                             const std::list<Stream*> &sourcestreams)
 {
-    for (typename std::list<T>::iterator iter = sourcestreams.begin();
+    for (std::list<Stream*>::const_iterator iter = sourcestreams.begin();
                  iter != sourcestreams.end(); iter++) {
         std::vector <std::shared_ptr<Device>> devices;
         (*iter)->getAssociatedDevices(devices);
@@ -5037,23 +4825,12 @@ int ResourceManager::getActiveStream_l(std::vector<Stream*> &activestreams,
     activestreams.clear();
 
     // merge all types of active streams into activestreams
-    getActiveStreams(d, activestreams, active_streams_ll);
-    getActiveStreams(d, activestreams, active_streams_ull);
-    getActiveStreams(d, activestreams, active_streams_ulla);
-    getActiveStreams(d, activestreams, active_streams_db);
-    getActiveStreams(d, activestreams, active_streams_raw);
-    getActiveStreams(d, activestreams, active_streams_comp);
-    getActiveStreams(d, activestreams, active_streams_st);
-    getActiveStreams(d, activestreams, active_streams_acd);
-    getActiveStreams(d, activestreams, active_streams_po);
-    getActiveStreams(d, activestreams, active_streams_proxy);
-    getActiveStreams(d, activestreams, active_streams_incall_record);
-    getActiveStreams(d, activestreams, active_streams_non_tunnel);
-    getActiveStreams(d, activestreams, active_streams_incall_music);
-    getActiveStreams(d, activestreams, active_streams_haptics);
-    getActiveStreams(d, activestreams, active_streams_ultrasound);
-    getActiveStreams(d, activestreams, active_streams_sensor_pcm_data);
-    getActiveStreams(d, activestreams, active_streams_voice_rec);
+    for (int i = 0; i < ACTIVE_STREAMS_MAX; i++) {
+        /* context proxy streams are not reported */
+        if (i == ACTIVE_STREAMS_CONTEXT_PROXY)
+            continue;
+        getActiveStreams(d, activestreams, mActiveStreams.group((active_stream_group_t)i));
+    }
 
     if (activestreams.empty()) {
         ret = -ENOENT;
@@ -5079,12 +4856,11 @@ int ResourceManager::getActiveStream(std::vector<Stream*> &activestreams,
     return ret;
 }
 
-template <class T>
-void getOrphanStreams(std::vector<Stream*> &orphanstreams,
-                      std::vector<Stream*> &retrystreams,
-                      std::list<T> sourcestreams)
+static void getOrphanStreams(std::vector<Stream*> &orphanstreams,
+                             std::vector<Stream*> &retrystreams,
+                             const std::list<Stream*> &sourcestreams)
 {
-    for (typename std::list<T>::iterator iter = sourcestreams.begin();
+    for (std::list<Stream*>::const_iterator iter = sourcestreams.begin();
                  iter != sourcestreams.end(); iter++) {
         std::vector <std::shared_ptr<Device>> devices;
         (*iter)->getAssociatedDevices(devices);
@@ -5104,20 +4880,13 @@ int ResourceManager::getOrphanStream_l(std::vector<Stream*> &orphanstreams,
     orphanstreams.clear();
     retrystreams.clear();
 
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_ll);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_ull);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_ulla);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_db);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_comp);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_st);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_acd);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_po);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_proxy);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_incall_record);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_non_tunnel);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_incall_music);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_haptics);
-    getOrphanStreams(orphanstreams, retrystreams, active_streams_ultrasound);
+    for (int i = 0; i < ACTIVE_STREAMS_MAX; i++) {
+        /* raw, sensor PCM data, voice recognition and context proxy streams are not considered */
+        if (i == ACTIVE_STREAMS_RAW || i == ACTIVE_STREAMS_SENSOR_PCM_DATA ||
+            i == ACTIVE_STREAMS_VOICE_REC || i == ACTIVE_STREAMS_CONTEXT_PROXY)
+            continue;
+        getOrphanStreams(orphanstreams, retrystreams, mActiveStreams.group((active_stream_group_t)i));
+    }
 
     if (orphanstreams.empty() && retrystreams.empty()) {
         ret = -ENOENT;
@@ -5706,6 +5475,7 @@ void ResourceManager::deinit()
     card_status_t state = CARD_STATUS_NONE;
 
     mixerClosed = true;
+    SessionAlsaUtils::clearMixerControlCache();
     mixer_close(audio_virt_mixer);
     mixer_close(audio_hw_mixer);
     if (audio_route) {
@@ -5810,71 +5580,32 @@ int ResourceManager::getNumFEs(const pal_stream_type_t sType) const
 const std::vector<int> ResourceManager::allocateFrontEndExtEcIds()
 {
     std::vector<int> f;
-    f.clear();
     const int howMany = 1;
-    int id = 0;
-    std::vector<int>::iterator it;
-    if (howMany > listAllPcmExtEcTxFrontEnds.size()) {
-        PAL_ERR(LOG_TAG, "allocateFrontEndExtEcIds: requested for %d external ec front ends, have only %zu error",
-                        howMany, listAllPcmExtEcTxFrontEnds.size());
+
+    if (frontEndPools[FE_POOL_EXT_EC_TX].allocate(howMany, NULL, f)) {
+        PAL_ERR(LOG_TAG, "allocateFrontEndExtEcIds: requested for %d external ec front ends, none free",
+                howMany);
         return f;
     }
-    id = (listAllPcmExtEcTxFrontEnds.size() - 1);
-    it =  (listAllPcmExtEcTxFrontEnds.begin() + id);
-    for (int i = 0; i < howMany; i++) {
-        f.push_back(listAllPcmExtEcTxFrontEnds.at(id));
-        listAllPcmExtEcTxFrontEnds.erase(it);
+    for (int i = 0; i < f.size(); i++)
         PAL_INFO(LOG_TAG, "allocateFrontEndExtEcIds: front end %d", f[i]);
-        it -= 1;
-        id -= 1;
-    }
     return f;
 }
 
 void ResourceManager::freeFrontEndEcTxIds(const std::vector<int> frontend)
 {
-    for (int i = 0; i < frontend.size(); i++) {
+    for (int i = 0; i < frontend.size(); i++)
         PAL_INFO(LOG_TAG, "freeing ext ec dev %d\n", frontend.at(i));
-        listAllPcmExtEcTxFrontEnds.push_back(frontend.at(i));
-    }
-    return;
-}
-
-template <typename T>
-void removeDuplicates(std::vector<T> &vec)
-{
-    std::sort(vec.begin(), vec.end());
-    vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+    frontEndPools[FE_POOL_EXT_EC_TX].release(frontend, NULL);
     return;
 }
 
-const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_stream_attributes sAttr, int lDirection)
+int ResourceManager::getFrontEndPoolClass(const struct pal_stream_attributes &sAttr,
+                                          int lDirection)
 {
-    //TODO: lock resource manager
-    std::vector<int> f;
-    f.clear();
-    const int howMany = getNumFEs(sAttr.type);
-    int id = 0;
-    std::vector<int>::iterator it;
-
-    mListFrontEndsMutex.lock();
     switch(sAttr.type) {
         case PAL_STREAM_NON_TUNNEL:
-            if (howMany > listAllNonTunnelSessionIds.size()) {
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                howMany, listAllPcmRecordFrontEnds.size());
-                 goto error;
-            }
-            id = (listAllNonTunnelSessionIds.size() - 1);
-            it =  (listAllNonTunnelSessionIds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllNonTunnelSessionIds.at(id));
-                listAllNonTunnelSessionIds.erase(it);
-                PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
-            }
-            break;
+            return FE_POOL_NON_TUNNEL;
         case PAL_STREAM_LOW_LATENCY:
         case PAL_STREAM_ULTRA_LOW_LATENCY:
         case PAL_STREAM_GENERIC:
@@ -5894,100 +5625,13 @@ const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_str
         case PAL_STREAM_VOICE_RECOGNITION:
             switch (sAttr.direction) {
                 case PAL_AUDIO_INPUT:
-                    if (lDirection == TX_HOSTLESS) {
-                        if (howMany > listAllPcmHostlessTxFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmHostlessTxFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmHostlessTxFrontEnds.size() - 1);
-                        it = (listAllPcmHostlessTxFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                           f.push_back(listAllPcmHostlessTxFrontEnds.at(id));
-                           listAllPcmHostlessTxFrontEnds.erase(it);
-                           PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                           it -= 1;
-                           id -= 1;
-                        }
-                    } else {
-                        if (howMany > listAllPcmRecordFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmRecordFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmRecordFrontEnds.size() - 1);
-                        it = (listAllPcmRecordFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                            f.push_back(listAllPcmRecordFrontEnds.at(id));
-                            listAllPcmRecordFrontEnds.erase(it);
-                            PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                            it -= 1;
-                            id -= 1;
-                        }
-                    }
-                    break;
+                    return (lDirection == TX_HOSTLESS) ?
+                            FE_POOL_PCM_HOSTLESS_TX : FE_POOL_PCM_RECORD;
                 case PAL_AUDIO_OUTPUT:
-                    if (sAttr.type == PAL_STREAM_RAW) {
-                        PAL_ERR(LOG_TAG, "Raw output stream not supported");
-                        goto error;
-                    }
-                    if (howMany > listAllPcmPlaybackFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                          howMany, listAllPcmPlaybackFrontEnds.size());
-                        goto error;
-                    }
-                    if (!listAllPcmPlaybackFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, but we dont have any (%zu) !!!!!!! ",
-                                howMany, listAllPcmPlaybackFrontEnds.size());
-                        goto error;
-                    }
-                    id = (int)(((int)listAllPcmPlaybackFrontEnds.size()) - 1);
-                    if (id < 0) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: negative iterator id %d !!!!! ", id);
-                        goto error;
-                    }
-                    it =  (listAllPcmPlaybackFrontEnds.begin() + id);
-                    for (int i = 0; i < howMany; i++) {
-                        f.push_back(listAllPcmPlaybackFrontEnds.at(id));
-                        listAllPcmPlaybackFrontEnds.erase(it);
-                        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                        it -= 1;
-                        id -= 1;
-                    }
-                    break;
+                    return FE_POOL_PCM_PLAYBACK;
                 case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
-                    if (lDirection == RX_HOSTLESS) {
-                        if (howMany > listAllPcmHostlessRxFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmHostlessRxFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmHostlessRxFrontEnds.size() - 1);
-                        it = (listAllPcmHostlessRxFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                           f.push_back(listAllPcmHostlessRxFrontEnds.at(id));
-                           listAllPcmHostlessRxFrontEnds.erase(it);
-                           PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                           it -= 1;
-                           id -= 1;
-                        }
-                    } else {
-                        if (howMany > listAllPcmHostlessTxFrontEnds.size()) {
-                            PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                              howMany, listAllPcmHostlessTxFrontEnds.size());
-                            goto error;
-                        }
-                        id = (listAllPcmHostlessTxFrontEnds.size() - 1);
-                        it = (listAllPcmHostlessTxFrontEnds.begin() + id);
-                        for (int i = 0; i < howMany; i++) {
-                           f.push_back(listAllPcmHostlessTxFrontEnds.at(id));
-                           listAllPcmHostlessTxFrontEnds.erase(it);
-                           PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                           it -= 1;
-                           id -= 1;
-                        }
-                    }
-                    break;
+                    return (lDirection == RX_HOSTLESS) ?
+                            FE_POOL_PCM_HOSTLESS_RX : FE_POOL_PCM_HOSTLESS_TX;
                 default:
                     PAL_ERR(LOG_TAG,"direction unsupported");
                     break;
@@ -5996,307 +5640,103 @@ const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_str
         case PAL_STREAM_COMPRESSED:
             switch (sAttr.direction) {
                 case PAL_AUDIO_INPUT:
-                    if (howMany > listAllCompressRecordFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                          howMany, listAllCompressRecordFrontEnds.size());
-                        goto error;
-                    }
-                    id = (listAllCompressRecordFrontEnds.size() - 1);
-                    it = (listAllCompressRecordFrontEnds.begin() + id);
-                    for (int i = 0; i < howMany; i++) {
-                        f.push_back(listAllCompressRecordFrontEnds.at(id));
-                        listAllCompressRecordFrontEnds.erase(it);
-                        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                        it -= 1;
-                        id -= 1;
-                    }
-                    break;
+                    return FE_POOL_COMPRESS_RECORD;
                 case PAL_AUDIO_OUTPUT:
-                    if (howMany > listAllCompressPlaybackFrontEnds.size()) {
-                        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                          howMany, listAllCompressPlaybackFrontEnds.size());
-                        goto error;
-                    }
-                    id = (listAllCompressPlaybackFrontEnds.size() - 1);
-                    it = (listAllCompressPlaybackFrontEnds.begin() + id);
-                    for (int i = 0; i < howMany; i++) {
-                        f.push_back(listAllCompressPlaybackFrontEnds.at(id));
-                        listAllCompressPlaybackFrontEnds.erase(it);
-                        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                        it -= 1;
-                        id -= 1;
-                    }
-                    break;
+                    return FE_POOL_COMPRESS_PLAYBACK;
                 default:
                     PAL_ERR(LOG_TAG,"direction unsupported");
                     break;
-                }
-                break;
-        case PAL_STREAM_VOICE_CALL:
-            switch (sAttr.direction) {
-              case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
-                    if (lDirection == RX_HOSTLESS) {
-                        if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice1RxFrontEnds, howMany);
-                        } else if(sAttr.info.voice_call_info.VSID == VOICEMMODE2 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE2){
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice2RxFrontEnds, howMany);
-                        } else {
-                            PAL_ERR(LOG_TAG,"invalid VSID 0x%x provided",
-                                    sAttr.info.voice_call_info.VSID);
-                        }
-                    } else {
-                        if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice1TxFrontEnds, howMany);
-                        } else if(sAttr.info.voice_call_info.VSID == VOICEMMODE2 ||
-                            sAttr.info.voice_call_info.VSID == VOICELBMMODE2){
-                            f = allocateVoiceFrontEndIds(listAllPcmVoice2TxFrontEnds, howMany);
-                        } else {
-                            PAL_ERR(LOG_TAG,"invalid VSID 0x%x provided",
-                                    sAttr.info.voice_call_info.VSID);
-                        }
-                    }
-                    break;
-              default:
-                  PAL_ERR(LOG_TAG,"direction unsupported voice must be RX and TX");
-                  break;
-            }
-            break;
-        case PAL_STREAM_VOICE_CALL_RECORD:
-            if (howMany > listAllPcmInCallRecordFrontEnds.size()) {
-                    PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                      howMany, listAllPcmInCallRecordFrontEnds.size());
-                    goto error;
-                }
-            id = (listAllPcmInCallRecordFrontEnds.size() - 1);
-            it = (listAllPcmInCallRecordFrontEnds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllPcmInCallRecordFrontEnds.at(id));
-                listAllPcmInCallRecordFrontEnds.erase(it);
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
             }
             break;
-        case PAL_STREAM_VOICE_CALL_MUSIC:
-            if (howMany > listAllPcmInCallMusicFrontEnds.size()) {
-                    PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                      howMany, listAllPcmInCallMusicFrontEnds.size());
-                    goto error;
-                }
-            id = (listAllPcmInCallMusicFrontEnds.size() - 1);
-            it = (listAllPcmInCallMusicFrontEnds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllPcmInCallMusicFrontEnds.at(id));
-                listAllPcmInCallMusicFrontEnds.erase(it);
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
+        case PAL_STREAM_VOICE_CALL:
+            if (sAttr.direction != (PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT)) {
+                PAL_ERR(LOG_TAG,"direction unsupported voice must be RX and TX");
+                break;
             }
-            break;
-       case PAL_STREAM_CONTEXT_PROXY:
-            if (howMany > listAllPcmContextProxyFrontEnds.size()) {
-                    PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %zu error",
-                                      howMany, listAllPcmContextProxyFrontEnds.size());
-                    goto error;
-                }
-            id = (listAllPcmContextProxyFrontEnds.size() - 1);
-            it = (listAllPcmContextProxyFrontEnds.begin() + id);
-            for (int i = 0; i < howMany; i++) {
-                f.push_back(listAllPcmContextProxyFrontEnds.at(id));
-                listAllPcmContextProxyFrontEnds.erase(it);
-                PAL_ERR(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
-                it -= 1;
-                id -= 1;
+            if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
+                sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
+                return (lDirection == RX_HOSTLESS) ?
+                        FE_POOL_VOICE1_RX : FE_POOL_VOICE1_TX;
+            } else if (sAttr.info.voice_call_info.VSID == VOICEMMODE2 ||
+                sAttr.info.voice_call_info.VSID == VOICELBMMODE2) {
+                return (lDirection == RX_HOSTLESS) ?
+                        FE_POOL_VOICE2_RX : FE_POOL_VOICE2_TX;
             }
+            PAL_ERR(LOG_TAG,"invalid VSID 0x%x provided",
+                    sAttr.info.voice_call_info.VSID);
             break;
+        case PAL_STREAM_VOICE_CALL_RECORD:
+            return FE_POOL_INCALL_RECORD;
+        case PAL_STREAM_VOICE_CALL_MUSIC:
+            return FE_POOL_INCALL_MUSIC;
+        case PAL_STREAM_CONTEXT_PROXY:
+            return FE_POOL_CONTEXT_PROXY;
         default:
             break;
     }
 
-error:
-    mListFrontEndsMutex.unlock();
-    return f;
+    return -EINVAL;
 }
 
-
-const std::vector<int> ResourceManager::allocateVoiceFrontEndIds(std::vector<int> listAllPcmVoiceFrontEnds, const int howMany)
+const std::vector<int> ResourceManager::allocateFrontEndIds(const struct pal_stream_attributes sAttr,
+                                                            int lDirection, Stream *s)
 {
     std::vector<int> f;
-    f.clear();
-    int id = 0;
-    std::vector<int>::iterator it;
-    if ( howMany > listAllPcmVoiceFrontEnds.size()) {
-        PAL_ERR(LOG_TAG, "allocate voice FrontEndIds: requested for %d front ends, have only %zu error",
-                howMany, listAllPcmVoiceFrontEnds.size());
+    const int howMany = getNumFEs(sAttr.type);
+    int poolClass;
+    struct frontEndPoolStats stats;
+
+    if (sAttr.type == PAL_STREAM_RAW && sAttr.direction == PAL_AUDIO_OUTPUT) {
+        PAL_ERR(LOG_TAG, "Raw output stream not supported");
         return f;
     }
-    id = (listAllPcmVoiceFrontEnds.size() - 1);
-    it =  (listAllPcmVoiceFrontEnds.begin() + id);
-    for (int i = 0; i < howMany; i++) {
-        f.push_back(listAllPcmVoiceFrontEnds.at(id));
-        listAllPcmVoiceFrontEnds.erase(it);
-        PAL_INFO(LOG_TAG, "allocate VoiceFrontEndIds: front end %d", f[i]);
-        it -= 1;
-        id -= 1;
+
+    poolClass = getFrontEndPoolClass(sAttr, lDirection);
+    if (poolClass < 0)
+        return f;
+
+    if (frontEndPools[poolClass].allocate(howMany, s, f)) {
+        frontEndPools[poolClass].getStats(&stats);
+        PAL_ERR(LOG_TAG, "allocateFrontEndIds: requested for %d front ends, have only %u error",
+                howMany, stats.total - stats.inUse);
+        return f;
     }
+    for (int i = 0; i < f.size(); i++)
+        PAL_INFO(LOG_TAG, "allocateFrontEndIds: front end %d", f[i]);
 
     return f;
 }
+
 void ResourceManager::freeFrontEndIds(const std::vector<int> frontend,
                                       const struct pal_stream_attributes sAttr,
-                                      int lDirection)
+                                      int lDirection, Stream *s)
 {
-    mListFrontEndsMutex.lock();
+    int poolClass;
+
     if (frontend.size() <= 0) {
         PAL_ERR(LOG_TAG,"frontend size is invalid");
-        mListFrontEndsMutex.unlock();
         return;
     }
     PAL_INFO(LOG_TAG, "stream type %d, freeing %d\n", sAttr.type,
              frontend.at(0));
+    SessionAlsaUtils::invalidateTagModuleInfo(frontend);
 
-    switch(sAttr.type) {
-        case PAL_STREAM_NON_TUNNEL:
-            for (int i = 0; i < frontend.size(); i++) {
-                 listAllNonTunnelSessionIds.push_back(frontend.at(i));
-            }
-            removeDuplicates(listAllNonTunnelSessionIds);
-            break;
-        case PAL_STREAM_LOW_LATENCY:
-        case PAL_STREAM_ULTRA_LOW_LATENCY:
-        case PAL_STREAM_GENERIC:
-        case PAL_STREAM_PROXY:
-        case PAL_STREAM_DEEP_BUFFER:
-        case PAL_STREAM_VOIP:
-        case PAL_STREAM_VOIP_RX:
-        case PAL_STREAM_VOIP_TX:
-        case PAL_STREAM_VOICE_UI:
-        case PAL_STREAM_LOOPBACK:
-        case PAL_STREAM_ACD:
-        case PAL_STREAM_PCM_OFFLOAD:
-        case PAL_STREAM_HAPTICS:
-        case PAL_STREAM_ULTRASOUND:
-        case PAL_STREAM_SENSOR_PCM_DATA:
-        case PAL_STREAM_RAW:
-        case PAL_STREAM_VOICE_RECOGNITION:
-            switch (sAttr.direction) {
-                case PAL_AUDIO_INPUT:
-                    if (lDirection == TX_HOSTLESS) {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmHostlessTxFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmHostlessTxFrontEnds);
-                    } else {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmRecordFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmRecordFrontEnds);
-                    }
-                    break;
-                case PAL_AUDIO_OUTPUT:
-                    for (int i = 0; i < frontend.size(); i++) {
-                        listAllPcmPlaybackFrontEnds.push_back(frontend.at(i));
-                    }
-                    removeDuplicates(listAllPcmPlaybackFrontEnds);
-                    break;
-                case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
-                    if (lDirection == RX_HOSTLESS) {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmHostlessRxFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmHostlessRxFrontEnds);
-                    } else {
-                        for (int i = 0; i < frontend.size(); i++) {
-                            listAllPcmHostlessTxFrontEnds.push_back(frontend.at(i));
-                        }
-                        removeDuplicates(listAllPcmHostlessTxFrontEnds);
-                    }
-                    break;
-                default:
-                    PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
-            }
-            break;
+    poolClass = getFrontEndPoolClass(sAttr, lDirection);
+    if (poolClass < 0)
+        return;
 
-        case PAL_STREAM_VOICE_CALL:
-            if (lDirection == RX_HOSTLESS) {
-                for (int i = 0; i < frontend.size(); i++) {
-                    if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                        sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                        listAllPcmVoice1RxFrontEnds.push_back(frontend.at(i));
-                    } else {
-                        listAllPcmVoice2RxFrontEnds.push_back(frontend.at(i));
-                    }
+    frontEndPools[poolClass].release(frontend, s);
+    return;
+}
 
-                }
-                removeDuplicates(listAllPcmVoice1RxFrontEnds);
-                removeDuplicates(listAllPcmVoice2RxFrontEnds);
-            } else {
-                for (int i = 0; i < frontend.size(); i++) {
-                    if (sAttr.info.voice_call_info.VSID == VOICEMMODE1 ||
-                        sAttr.info.voice_call_info.VSID == VOICELBMMODE1) {
-                        listAllPcmVoice1TxFrontEnds.push_back(frontend.at(i));
-                    } else {
-                        listAllPcmVoice2TxFrontEnds.push_back(frontend.at(i));
-                    }
-                }
-                removeDuplicates(listAllPcmVoice1TxFrontEnds);
-                removeDuplicates(listAllPcmVoice2TxFrontEnds);
-            }
-            break;
+int ResourceManager::getFrontEndPoolStats(fe_pool_class_t poolClass,
+                                          struct frontEndPoolStats *stats)
+{
+    if ((uint32_t)poolClass >= FE_POOL_MAX || !stats)
+        return -EINVAL;
 
-        case PAL_STREAM_COMPRESSED:
-            switch (sAttr.direction) {
-                case PAL_AUDIO_INPUT:
-                    for (int i = 0; i < frontend.size(); i++) {
-                        listAllCompressRecordFrontEnds.push_back(frontend.at(i));
-                    }
-                    removeDuplicates(listAllCompressRecordFrontEnds);
-                    break;
-                case PAL_AUDIO_OUTPUT:
-                    for (int i = 0; i < frontend.size(); i++) {
-                        listAllCompressPlaybackFrontEnds.push_back(frontend.at(i));
-                    }
-                    removeDuplicates(listAllCompressPlaybackFrontEnds);
-                    break;
-                default:
-                    PAL_ERR(LOG_TAG,"direction unsupported");
-                    break;
-                }
-            break;
-        case PAL_STREAM_VOICE_CALL_RECORD:
-        case PAL_STREAM_VOICE_CALL_MUSIC:
-            switch (sAttr.direction) {
-              case PAL_AUDIO_INPUT:
-                for (int i = 0; i < frontend.size(); i++) {
-                    listAllPcmInCallRecordFrontEnds.push_back(frontend.at(i));
-                }
-                removeDuplicates(listAllPcmInCallRecordFrontEnds);
-                break;
-              case PAL_AUDIO_OUTPUT:
-                for (int i = 0; i < frontend.size(); i++) {
-                    listAllPcmInCallMusicFrontEnds.push_back(frontend.at(i));
-                }
-                removeDuplicates(listAllPcmInCallMusicFrontEnds);
-                break;
-              default:
-                break;
-            }
-            break;
-       case PAL_STREAM_CONTEXT_PROXY:
-            for (int i = 0; i < frontend.size(); i++) {
-                 listAllPcmContextProxyFrontEnds.push_back(frontend.at(i));
-            }
-            removeDuplicates(listAllPcmContextProxyFrontEnds);
-            break;
-        default:
-            break;
-    }
-    mListFrontEndsMutex.unlock();
-    return;
+    frontEndPools[poolClass].getStats(stats);
+    return 0;
 }
 
 void ResourceManager::getSharedBEActiveStreamDevs(std::vector <std::tuple<Stream *, uint32_t>> &activeStreamsDevices,
@@ -6519,7 +5959,7 @@ int32_t ResourceManager::streamDevDisconnect(std::vector <std::tuple<Stream *, u
 
     /* disconnect active list from the current devices they are attached to */
     for (sIter = streamDevDisconnectList.begin(); sIter != streamDevDisconnectList.end(); sIter++) {
-        if ((std::get<0>(*sIter) != NULL) && isStreamActive(std::get<0>(*sIter), mActiveStreams)) {
+        if ((std::get<0>(*sIter) != NULL) && isStreamActive(std::get<0>(*sIter))) {
             status = (std::get<0>(*sIter))->disconnectStreamDevice(std::get<0>(*sIter), (pal_device_id_t)std::get<1>(*sIter));
             if (status) {
                 PAL_ERR(LOG_TAG, "failed to disconnect stream %pK from device %d",
@@ -6543,7 +5983,7 @@ int32_t ResourceManager::streamDevConnect(std::vector <std::tuple<Stream *, stru
     PAL_DBG(LOG_TAG, "Enter");
     /* connect active list from the current devices they are attached to */
     for (sIter = streamDevConnectList.begin(); sIter != streamDevConnectList.end(); sIter++) {
-        if ((std::get<0>(*sIter) != NULL) && isStreamActive(std::get<0>(*sIter), mActiveStreams)) {
+        if ((std::get<0>(*sIter) != NULL) && isStreamActive(std::get<0>(*sIter))) {
             status = std::get<0>(*sIter)->connectStreamDevice(std::get<0>(*sIter), std::get<1>(*sIter));
             if (status) {
                 PAL_ERR(LOG_TAG,"failed to connect stream %pK from device %d",
@@ -6568,7 +6008,7 @@ int32_t ResourceManager::streamDevDisconnect_l(std::vector <std::tuple<Stream *,
 
     /* disconnect active list from the current devices they are attached to */
     for (sIter = streamDevDisconnectList.begin(); sIter != streamDevDisconnectList.end(); sIter++) {
-        if ((std::get<0>(*sIter) != NULL) && isStreamActive(std::get<0>(*sIter), mActiveStreams)) {
+        if ((std::get<0>(*sIter) != NULL) && isStreamActive(std::get<0>(*sIter))) {
             status = (std::get<0>(*sIter))->disconnectStreamDevice_l(std::get<0>(*sIter), (pal_device_id_t)std::get<1>(*sIter));
             if (status) {
                 PAL_ERR(LOG_TAG, "failed to disconnect stream %pK from device %d",
@@ -6592,7 +6032,7 @@ int32_t ResourceManager::streamDevConnect_l(std::vector <std::tuple<Stream *, st
     PAL_DBG(LOG_TAG, "Enter");
     /* connect active list from the current devices they are attached to */
     for (sIter = streamDevConnectList.begin(); sIter != streamDevConnectList.end(); sIter++) {
-        if ((std::get<0>(*sIter) != NULL) && isStreamActive(std::get<0>(*sIter), mActiveStreams)) {
+        if ((std::get<0>(*sIter) != NULL) && isStreamActive(std::get<0>(*sIter))) {
             status = std::get<0>(*sIter)->connectStreamDevice_l(std::get<0>(*sIter), std::get<1>(*sIter));
             if (status) {
                 PAL_ERR(LOG_TAG,"failed to connect stream %pK from device %d",
@@ -6622,6 +6062,7 @@ void SortAndUnique(std::vector<T> &streams)
 int32_t ResourceManager::streamDevSwitch(std::vector <std::tuple<Stream *, uint32_t>> streamDevDisconnectList,
                                          std::vector <std::tuple<Stream *, struct pal_device *>> streamDevConnectList)
 {
+    PalLatencyScope latency(PAL_LATENCY_RM_DEVICE_SWITCH);
     int status = 0;
     std::vector <Stream*>::iterator sIter;
     std::vector <struct pal_device *>::iterator dIter;
@@ -6630,6 +6071,7 @@ int32_t ResourceManager::streamDevSwitch(std::vector <std::tuple<Stream *, uint3
     std::vector <Stream*> uniqueStreamsList;
     std::vector <struct pal_device *> uniqueDevConnectionList;
     pal_stream_attributes sAttr;
+    uint32_t skippedWrites = 0;
 
     PAL_INFO(LOG_TAG, "Enter");
 
@@ -6643,20 +6085,48 @@ int32_t ResourceManager::streamDevSwitch(std::vector <std::tuple<Stream *, uint3
     SortAndUnique(streamDevDisconnectList);
     SortAndUnique(streamDevConnectList);
 
+    /*
+     * Take the streams of one backend together: all of them leave it
+     * before its device is stopped and closed, and its device is opened
+     * and started for the first one joining while the rest attach to the
+     * running backend. Backend config writes repeated in between are
+     * dropped by the batch below.
+     */
+    std::stable_sort(streamDevDisconnectList.begin(), streamDevDisconnectList.end(),
+        [this](const std::tuple<Stream *, uint32_t> &a,
+               const std::tuple<Stream *, uint32_t> &b) {
+            std::string beA, beB;
+
+            getBackendName(std::get<1>(a), beA);
+            getBackendName(std::get<1>(b), beB);
+            return beA < beB;
+        });
+    std::stable_sort(streamDevConnectList.begin(), streamDevConnectList.end(),
+        [this](const std::tuple<Stream *, struct pal_device *> &a,
+               const std::tuple<Stream *, struct pal_device *> &b) {
+            std::string beA, beB;
+
+            if (!std::get<1>(a) || !std::get<1>(b))
+                return std::get<1>(b) != NULL && std::get<1>(a) == NULL;
+            getBackendName(std::get<1>(a)->id, beA);
+            getBackendName(std::get<1>(b)->id, beB);
+            return beA < beB;
+        });
+
     /* Need to lock all streams that are involved in devSwitch
      * When we are doing Switch to avoid any stream specific calls to happen.
      * We want to avoid stream close or any other control operations to happen when we are in the
      * middle of the switch
      */
     for (sIter1 = streamDevDisconnectList.begin(); sIter1 != streamDevDisconnectList.end(); sIter1++) {
-        if ((std::get<0>(*sIter1) != NULL) && isStreamActive(std::get<0>(*sIter1), mActiveStreams)) {
+        if ((std::get<0>(*sIter1) != NULL) && isStreamActive(std::get<0>(*sIter1))) {
             uniqueStreamsList.push_back(std::get<0>(*sIter1));
             PAL_VERBOSE(LOG_TAG, "streamDevDisconnectList stream %pK", std::get<0>(*sIter1));
         }
     }
 
     for (sIter2 = streamDevConnectList.begin(); sIter2 != streamDevConnectList.end(); sIter2++) {
-        if ((std::get<0>(*sIter2) != NULL) && isStreamActive(std::get<0>(*sIter2), mActiveStreams)) {
+        if ((std::get<0>(*sIter2) != NULL) && isStreamActive(std::get<0>(*sIter2))) {
             uniqueStreamsList.push_back(std::get<0>(*sIter2));
             PAL_VERBOSE(LOG_TAG, "streamDevConnectList stream %pK", std::get<0>(*sIter2));
             uniqueDevConnectionList.push_back(std::get<1>(*sIter2));
@@ -6685,6 +6155,8 @@ int32_t ResourceManager::streamDevSwitch(std::vector <std::tuple<Stream *, uint3
         (*sIter)->lockStreamMutex();
     }
     isDeviceSwitch = true;
+    /* streams sharing a backend resend the same backend config, send it once */
+    SessionAlsaUtils::beginBeControlBatch();
 
     for (sIter = uniqueStreamsList.begin(); sIter != uniqueStreamsList.end(); sIter++) {
         status = (*sIter)->getStreamAttributes(&sAttr);
@@ -6711,6 +6183,9 @@ int32_t ResourceManager::streamDevSwitch(std::vector <std::tuple<Stream *, uint3
     }
 
 exit:
+    skippedWrites = SessionAlsaUtils::endBeControlBatch();
+    PAL_DBG(LOG_TAG, "%zu streams switched, %u backend config writes skipped",
+            uniqueStreamsList.size(), skippedWrites);
     // unlock all stream mutexes
     for (sIter = uniqueStreamsList.begin(); sIter != uniqueStreamsList.end(); sIter++) {
         PAL_DBG(LOG_TAG, "uniqueStreamsList stream %pK unlock", (*sIter));
@@ -6945,7 +6420,7 @@ int32_t ResourceManager::forceDeviceSwitch(std::shared_ptr<Device> inDev,
     if (!status) {
         mActiveStreamMutex.lock();
         for (sIter = activeStreams.begin(); sIter != activeStreams.end(); sIter++) {
-            if (((*sIter) != NULL) && isStreamActive(*sIter, mActiveStreams)) {
+            if (((*sIter) != NULL) && isStreamActive(*sIter)) {
                 (*sIter)->lockStreamMutex();
                 (*sIter)->clearOutPalDevices();
                 (*sIter)->addPalDevice(newDevAttr);
@@ -6978,7 +6453,7 @@ int32_t ResourceManager::forceDeviceSwitch(std::shared_ptr<Device> inDev,
     // create dev switch vectors
     mActiveStreamMutex.lock();
     for (sIter = prevActiveStreams.begin(); sIter != prevActiveStreams.end(); sIter++) {
-        if (((*sIter) != NULL) && isStreamActive((*sIter), mActiveStreams)) {
+        if (((*sIter) != NULL) && isStreamActive((*sIter))) {
             streamDevDisconnect.push_back({(*sIter), inDev->getSndDeviceId()});
             streamDevConnect.push_back({(*sIter), newDevAttr});
         }
@@ -6988,7 +6463,7 @@ int32_t ResourceManager::forceDeviceSwitch(std::shared_ptr<Device> inDev,
     if (!status) {
         mActiveStreamMutex.lock();
         for (sIter = prevActiveStreams.begin(); sIter != prevActiveStreams.end(); sIter++) {
-            if (((*sIter) != NULL) && isStreamActive(*sIter, mActiveStreams)) {
+            if (((*sIter) != NULL) && isStreamActive(*sIter)) {
                 (*sIter)->lockStreamMutex();
                 (*sIter)->clearOutPalDevices();
                 (*sIter)->addPalDevice(newDevAttr);
@@ -7206,6 +6681,8 @@ int ResourceManager::setConfigParams(struct str_parms *parms)
     ret = setUpdDedicatedBeEnableParam(parms, value, len);
     ret = setDualMonoEnableParam(parms, value, len);
     ret = setSignalHandlerEnableParam(parms, value, len);
+    ret = setVolumeRampPeriodParam(parms, value, len);
+    ret = setLatencyStatsEnableParam(parms, value, len);
 
     /* Not checking return value as this is optional */
     setLpiLoggingParams(parms, value, len);
@@ -7348,6 +6825,55 @@ int ResourceManager::setSignalHandlerEnableParam(struct str_parms *parms,
     return ret;
 }
 
+int ResourceManager::setVolumeRampPeriodParam(struct str_parms *parms,
+                                 char *value, int len)
+{
+    int ret = -EINVAL;
+    int periodMs = 0;
+
+    if (!value || !parms)
+        return ret;
+
+    ret = str_parms_get_str(parms, AUDIO_PARAMETER_KEY_VOLUME_RAMP_PERIOD,
+                                value, len);
+    if (ret >= 0) {
+        periodMs = atoi(value);
+        if (periodMs > 0)
+            volumeRampPeriodUs = (uint32_t)periodMs * 1000;
+        else
+            PAL_ERR(LOG_TAG, "Invalid volume ramp period %s", value);
+
+        str_parms_del(parms, AUDIO_PARAMETER_KEY_VOLUME_RAMP_PERIOD);
+    }
+
+    PAL_INFO(LOG_TAG, "Volume ramp period is %u us", volumeRampPeriodUs);
+
+    return ret;
+}
+
+int ResourceManager::setLatencyStatsEnableParam(struct str_parms *parms,
+                                 char *value, int len)
+{
+    int ret = -EINVAL;
+
+    if (!value || !parms)
+        return ret;
+
+    ret = str_parms_get_str(parms, AUDIO_PARAMETER_KEY_API_LATENCY_STATS,
+                                value, len);
+    if (ret >= 0) {
+        if (value && !strncmp(value, "true", sizeof("true")))
+            PalLatencyStats::setEnabled(true);
+
+        str_parms_del(parms, AUDIO_PARAMETER_KEY_API_LATENCY_STATS);
+    }
+
+    PAL_INFO(LOG_TAG, "Api latency stats enabled is=%x",
+             PalLatencyStats::isEnabled());
+
+    return ret;
+}
+
 int ResourceManager::setNativeAudioParams(struct str_parms *parms,
                                           char *value, int len)
 {
@@ -7501,6 +7027,8 @@ int32_t ResourceManager::a2dpSuspend()
     std::vector <Stream *> activeStreams;
     std::vector <Stream*>::iterator sIter;
     std::vector <std::shared_ptr<Device>> associatedDevices;
+    std::vector <std::pair<Stream *, uint32_t>> mutedStreams;
+    PalLatencyScope latency(PAL_LATENCY_A2DP_SUSPEND);
 
     PAL_DBG(LOG_TAG, "enter");
 
@@ -7572,7 +7100,7 @@ int32_t ResourceManager::a2dpSuspend()
         switchDevDattr.id);
 
     for (sIter = activeA2dpStreams.begin(); sIter != activeA2dpStreams.end(); sIter++) {
-        if (((*sIter) != NULL) && isStreamActive(*sIter, mActiveStreams)) {
+        if (((*sIter) != NULL) && isStreamActive(*sIter)) {
             associatedDevices.clear();
             status = (*sIter)->getAssociatedDevices(associatedDevices);
             if ((0 != status) ||
@@ -7615,8 +7143,10 @@ int32_t ResourceManager::a2dpSuspend()
                     if (maxLatencyMs < latencyMs)
                         maxLatencyMs = latencyMs;
                     // Mute
-                    if (!(*sIter)->mute_l(true))
+                    if (!(*sIter)->mute_l(true)) {
                         (*sIter)->a2dpMuted = true;
+                        mutedStreams.push_back(std::make_pair(*sIter, latencyMs));
+                    }
                 }
             }
             (*sIter)->unlockStreamMutex();
@@ -7627,17 +7157,17 @@ int32_t ResourceManager::a2dpSuspend()
 
     // wait for stale pcm drained before switching to speaker
     if (maxLatencyMs > 0) {
-        // multiplication factor applied to latency when calculating a safe mute delay
-        // TODO: It's not needed if latency is accurate.
+        // multiplication factor applied to latency when calculating a safe mute delay,
+        // only used as timeout when session time cannot tell the streams are drained.
         const int latencyMuteFactor = 2;
-        usleep(maxLatencyMs * 1000 * latencyMuteFactor);
+        waitForMutedStreamsDrained(mutedStreams, maxLatencyMs * latencyMuteFactor);
     }
 
     forceDeviceSwitch(a2dpDev, &switchDevDattr, activeA2dpStreams);
 
     mActiveStreamMutex.lock();
     for (sIter = activeA2dpStreams.begin(); sIter != activeA2dpStreams.end(); sIter++) {
-        if (((*sIter) != NULL) && isStreamActive(*sIter, mActiveStreams)) {
+        if (((*sIter) != NULL) && isStreamActive(*sIter)) {
             (*sIter)->lockStreamMutex();
             struct pal_stream_attributes sAttr;
             (*sIter)->getStreamAttributes(&sAttr);
@@ -7663,6 +7193,88 @@ exit:
     return status;
 }
 
+/*
+ * Wait until every muted stream has rendered at least its latency worth of
+ * data past the mute point, i.e. the unmuted data still queued in the
+ * pipeline when mute was applied has been played out. Progress is tracked
+ * with the session time reported by the DSP. Streams whose session time
+ * cannot be read are only released by the timeout.
+ */
+void ResourceManager::waitForMutedStreamsDrained(
+                          std::vector<std::pair<Stream *, uint32_t>> &mutedStreams,
+                          uint32_t timeoutMs)
+{
+    struct pal_session_time stime;
+    struct timespec now, start;
+    std::vector<uint64_t> startTimeUs;
+    std::vector<bool> drained;
+    uint64_t sessionTimeUs = 0;
+    uint64_t elapsedMs = 0;
+    uint32_t pending = 0;
+    int status = 0;
+    PalLatencyScope latency(PAL_LATENCY_A2DP_SUSPEND_DRAIN);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    startTimeUs.resize(mutedStreams.size(), 0);
+    drained.resize(mutedStreams.size(), false);
+
+    do {
+        pending = 0;
+        mActiveStreamMutex.lock();
+        for (size_t i = 0; i < mutedStreams.size(); i++) {
+            if (drained[i])
+                continue;
+
+            Stream *s = mutedStreams[i].first;
+            if (!isStreamActive(s)) {
+                drained[i] = true;
+                continue;
+            }
+
+            memset(&stime, 0, sizeof(stime));
+            s->lockStreamMutex();
+            status = s->getTimestamp_l(&stime);
+            s->unlockStreamMutex();
+            if (status) {
+                // no position available, rely on timeout for this stream
+                pending++;
+                continue;
+            }
+
+            sessionTimeUs = ((uint64_t)stime.session_time.value_msw << 32) |
+                            stime.session_time.value_lsw;
+            if (!startTimeUs[i]) {
+                startTimeUs[i] = sessionTimeUs ? sessionTimeUs : 1;
+                pending++;
+            } else if (sessionTimeUs >= startTimeUs[i] + (uint64_t)mutedStreams[i].second * 1000) {
+                PAL_DBG(LOG_TAG, "stream %pK drained, session time %llu us",
+                        s, (unsigned long long)sessionTimeUs);
+                drained[i] = true;
+            } else {
+                pending++;
+            }
+        }
+        mActiveStreamMutex.unlock();
+
+        if (!pending)
+            break;
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsedMs = (now.tv_sec - start.tv_sec) * 1000 +
+                    (now.tv_nsec - start.tv_nsec) / 1000000;
+        if (elapsedMs >= timeoutMs) {
+            PAL_INFO(LOG_TAG, "%u muted streams not drained in %u ms", pending, timeoutMs);
+            break;
+        }
+        usleep(std::min((uint64_t)A2DP_DRAIN_POLL_INTERVAL_MS, timeoutMs - elapsedMs) * 1000);
+    } while (true);
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    PAL_DBG(LOG_TAG, "muted streams drain wait took %lld ms",
+            (long long)((now.tv_sec - start.tv_sec) * 1000 +
+            (now.tv_nsec - start.tv_nsec) / 1000000));
+}
+
 int32_t ResourceManager::a2dpResume()
 {
     int status = 0;
@@ -7799,7 +7411,7 @@ int32_t ResourceManager::a2dpResume()
     mActiveStreamMutex.lock();
     SortAndUnique(restoredStreams);
     for (sIter = restoredStreams.begin(); sIter != restoredStreams.end(); sIter++) {
-        if (((*sIter) != NULL) && isStreamActive(*sIter, mActiveStreams)) {
+        if (((*sIter) != NULL) && isStreamActive(*sIter)) {
             (*sIter)->lockStreamMutex();
             // update PAL devices for the restored streams
             if ((*sIter)->suspendedDevIds.size() == 1 /* non-combo */) {
@@ -7903,7 +7515,7 @@ int32_t ResourceManager::a2dpCaptureSuspend()
 
     mActiveStreamMutex.lock();
     for (sIter = activeA2dpStreams.begin(); sIter != activeA2dpStreams.end(); sIter++) {
-        if (((*sIter) != NULL) && isStreamActive(*sIter, mActiveStreams)) {
+        if (((*sIter) != NULL) && isStreamActive(*sIter)) {
             (*sIter)->suspendedDevIds.clear();
             (*sIter)->suspendedDevIds.push_back(a2dpDattr.id);
         }
@@ -7982,7 +7594,7 @@ int32_t ResourceManager::a2dpCaptureResume()
 
     mActiveStreamMutex.lock();
     for (sIter = restoredStreams.begin(); sIter != restoredStreams.end(); sIter++) {
-        if ((*sIter) && isStreamActive(*sIter, mActiveStreams)) {
+        if ((*sIter) && isStreamActive(*sIter)) {
             (*sIter)->suspendedDevIds.clear();
             (*sIter)->mute_l(false);
             (*sIter)->a2dpMuted = false;
@@ -8123,6 +7735,47 @@ int ResourceManager::getParameter(uint32_t param_id, void **param_payload,
             **(bool **)param_payload = isHifiFilterEnabled;
         }
         break;
+        case PAL_PARAM_ID_API_LATENCY_STATS:
+        {
+            PalLatencyStats::get(&latencyStats);
+            *param_payload = (uint8_t *)&latencyStats;
+            *payload_size = sizeof(latencyStats);
+        }
+        break;
+        case PAL_PARAM_ID_FE_POOL_STATS:
+        {
+            struct frontEndPoolStats stats;
+
+            static_assert(FE_POOL_MAX <= PAL_FE_POOL_STATS_MAX,
+                          "pal_param_fe_pool_stats_t too small");
+            fePoolStats.num_pools = FE_POOL_MAX;
+            for (int i = 0; i < FE_POOL_MAX; i++) {
+                frontEndPools[i].getStats(&stats);
+                fePoolStats.pool[i].total = stats.total;
+                fePoolStats.pool[i].in_use = stats.inUse;
+                fePoolStats.pool[i].peak = stats.peak;
+                fePoolStats.pool[i].failures = stats.failures;
+            }
+            *param_payload = (uint8_t *)&fePoolStats;
+            *payload_size = sizeof(fePoolStats);
+        }
+        break;
+        case PAL_PARAM_ID_SESSION_CACHE_STATS:
+        {
+            SessionAlsaUtils::getCacheStats(&sessionCacheStats);
+            *param_payload = (uint8_t *)&sessionCacheStats;
+            *payload_size = sizeof(sessionCacheStats);
+        }
+        break;
+        case PAL_PARAM_ID_LOG_TRACE:
+        {
+            /* palTraceDecode appends, drop the previous dump first */
+            logTrace.clear();
+            palTraceDecode(logTrace);
+            *param_payload = (uint8_t *)logTrace.c_str();
+            *payload_size = logTrace.length() + 1;
+        }
+        break;
         default:
             status = -EINVAL;
             PAL_ERR(LOG_TAG, "Unknown ParamID:%d", param_id);
@@ -8181,6 +7834,18 @@ int ResourceManager::setParameter(uint32_t param_id, void *param_payload,
 
     mResourceManagerMutex.lock();
     switch (param_id) {
+        case PAL_PARAM_ID_API_LATENCY_STATS:
+        {
+            PAL_INFO(LOG_TAG, "reset api latency stats");
+            PalLatencyStats::reset();
+        }
+        break;
+        case PAL_PARAM_ID_LOG_TRACE:
+        {
+            PAL_INFO(LOG_TAG, "clear log trace");
+            palTraceClear();
+        }
+        break;
         case PAL_PARAM_ID_UHQA_FLAG:
         {
             pal_param_uhqa_t* param_uhqa_flag = (pal_param_uhqa_t*) param_payload;
@@ -8846,16 +8511,11 @@ int ResourceManager::setParameter(uint32_t param_id, void *param_payload,
         break;
         case PAL_PARAM_ID_HAPTICS_VOLUME:
         {
-            std::list<Stream*>::iterator sIter;
-            pal_stream_attributes st_attr;
-            for(sIter = mActiveStreams.begin(); sIter != mActiveStreams.end(); sIter++) {
-                (*sIter)->getStreamAttributes(&st_attr);
-                if (st_attr.type == PAL_STREAM_HAPTICS) {
-                    status = (*sIter)->setVolume((struct pal_volume_data *)param_payload);
-                    if (status) {
-                        PAL_ERR(LOG_TAG, "Failed to set volume for haptics");
-                        goto exit;
-                    }
+            for (auto str: mActiveStreams.group(ACTIVE_STREAMS_HAPTICS)) {
+                status = str->setVolume((struct pal_volume_data *)param_payload);
+                if (status) {
+                    PAL_ERR(LOG_TAG, "Failed to set volume for haptics");
+                    goto exit;
                 }
             }
         }
@@ -9074,8 +8734,8 @@ int ResourceManager::handleScreenStatusChange(pal_param_screen_state_t screen_st
         }
         screen_state_ = screen_state.screen_state;
         /* update
-         * for (typename std::vector<StreamSoundTrigger*>::iterator iter = active_streams_st.begin();
-         *    iter != active_streams_st.end(); iter++) {
+         * mActiveStreams.snapshot(ACTIVE_STREAMS_ST, stStreams);
+         * for (auto iter = stStreams.begin(); iter != stStreams.end(); iter++) {
          *   status = (*iter)->handleScreenState(screen_state_);
          *  }
          */
@@ -9151,7 +8811,7 @@ void ResourceManager::onChargingStateChange()
     bool use_lpi_temp = false;
 
     // no need to handle car mode if no Voice Stream exists
-    if (active_streams_st.size() == 0)
+    if (mActiveStreams.count(ACTIVE_STREAMS_ST) == 0)
         return;
 
     if (charging_state_ && use_lpi_) {
@@ -9165,11 +8825,11 @@ void ResourceManager::onChargingStateChange()
     }
 
     if (need_switch) {
-        if (active_streams_st.size())
+        if (mActiveStreams.count(ACTIVE_STREAMS_ST))
             st_streams.push_back(PAL_STREAM_VOICE_UI);
-        if (active_streams_acd.size())
+        if (mActiveStreams.count(ACTIVE_STREAMS_ACD))
             st_streams.push_back(PAL_STREAM_ACD);
-        if (active_streams_sensor_pcm_data.size())
+        if (mActiveStreams.count(ACTIVE_STREAMS_SENSOR_PCM_DATA))
             st_streams.push_back(PAL_STREAM_SENSOR_PCM_DATA);
 
         if (!checkAndUpdateDeferSwitchState(!use_lpi_temp)) {
@@ -9187,9 +8847,9 @@ void ResourceManager::onVUIStreamRegistered()
     if (!charging_state_ || !IsTransitToNonLPIOnChargingSupported())
         return;
 
-    if (active_streams_acd.size())
+    if (mActiveStreams.count(ACTIVE_STREAMS_ACD))
         st_streams.push_back(PAL_STREAM_ACD);
-    if (active_streams_sensor_pcm_data.size())
+    if (mActiveStreams.count(ACTIVE_STREAMS_SENSOR_PCM_DATA))
         st_streams.push_back(PAL_STREAM_SENSOR_PCM_DATA);
 
     if (use_lpi_) {
@@ -9206,9 +8866,9 @@ void ResourceManager::onVUIStreamDeregistered()
     if (!charging_state_ || !IsTransitToNonLPIOnChargingSupported())
         return;
 
-    if (active_streams_acd.size())
+    if (mActiveStreams.count(ACTIVE_STREAMS_ACD))
         st_streams.push_back(PAL_STREAM_ACD);
-    if (active_streams_sensor_pcm_data.size())
+    if (mActiveStreams.count(ACTIVE_STREAMS_SENSOR_PCM_DATA))
         st_streams.push_back(PAL_STREAM_SENSOR_PCM_DATA);
 
     if (!use_lpi_ && !concurrencyEnableCount) {
@@ -10735,6 +10395,7 @@ void ResourceManager::endTag(void *userdata, const XML_Char *tag_name)
 
     if (!strcmp(tag_name, "acd_platform_info")) {
         data->is_parsing_acd = false;
+        acd_info->PreloadModels();
         return;
     }
 
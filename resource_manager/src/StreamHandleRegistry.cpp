@@ -0,0 +1,280 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "PAL: StreamHandleRegistry"
+
+#include <errno.h>
+#include "StreamHandleRegistry.h"
+#include "PalCommon.h"
+
+#define SLOT_EMPTY     ((uintptr_t)0)
+#define SLOT_TOMBSTONE ((uintptr_t)1)
+
+#define STATE_USERS_MASK  ((uint64_t)0xFFFFFFFF)
+#define STATE_FLAGS_SHIFT 32
+#define STATE_FLAGS_MASK  ((uint64_t)0xFF << STATE_FLAGS_SHIFT)
+#define STATE_GEN_SHIFT   40
+
+#define STATE_USERS(st) ((uint32_t)((st) & STATE_USERS_MASK))
+#define STATE_FLAGS(st) ((uint32_t)(((st) & STATE_FLAGS_MASK) >> STATE_FLAGS_SHIFT))
+#define STATE_NEXT_GEN(st) \
+    ((((st) >> STATE_GEN_SHIFT) + 1) << STATE_GEN_SHIFT)
+
+static inline uint32_t slotHash(uintptr_t key)
+{
+    uint64_t h = ((uint64_t)key >> 4) * 0x9E3779B97F4A7C15ULL;
+
+    return (uint32_t)(h >> 32) & (STREAM_HANDLE_REGISTRY_SIZE - 1);
+}
+
+StreamHandleRegistry::StreamHandleRegistry()
+    : mLive(0)
+{
+    for (int i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++) {
+        mSlots[i].key.store(SLOT_EMPTY, std::memory_order_relaxed);
+        mSlots[i].state.store(0, std::memory_order_relaxed);
+    }
+}
+
+int32_t StreamHandleRegistry::findSlot(uintptr_t key)
+{
+    uint32_t idx = slotHash(key);
+    uintptr_t slotKey = SLOT_EMPTY;
+
+    for (int i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++) {
+        slotKey = mSlots[idx].key.load(std::memory_order_acquire);
+        if (slotKey == key)
+            return idx;
+        if (slotKey == SLOT_EMPTY)
+            break;
+        idx = (idx + 1) & (STREAM_HANDLE_REGISTRY_SIZE - 1);
+    }
+    return -ENOENT;
+}
+
+int32_t StreamHandleRegistry::findOrInsertSlot_l(uintptr_t key)
+{
+    uint32_t idx = slotHash(key);
+    int32_t freeIdx = -1;
+    uintptr_t slotKey = SLOT_EMPTY;
+    uint64_t st = 0;
+
+    for (int i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++) {
+        slotKey = mSlots[idx].key.load(std::memory_order_relaxed);
+        if (slotKey == key)
+            return idx;
+        if (slotKey == SLOT_TOMBSTONE && freeIdx < 0)
+            freeIdx = idx;
+        if (slotKey == SLOT_EMPTY) {
+            if (freeIdx < 0)
+                freeIdx = idx;
+            break;
+        }
+        idx = (idx + 1) & (STREAM_HANDLE_REGISTRY_SIZE - 1);
+    }
+
+    if (freeIdx < 0) {
+        PAL_ERR(LOG_TAG, "no free slot for handle %p", (void *)key);
+        return -ENOMEM;
+    }
+
+    /* new generation, no users, no flags, published before the key */
+    st = mSlots[freeIdx].state.load(std::memory_order_relaxed);
+    mSlots[freeIdx].state.store(STATE_NEXT_GEN(st), std::memory_order_release);
+    mSlots[freeIdx].key.store(key, std::memory_order_release);
+    mLive++;
+    return freeIdx;
+}
+
+int32_t StreamHandleRegistry::setFlags(const void *handle, uint32_t flags)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    int32_t idx = findOrInsertSlot_l((uintptr_t)handle);
+
+    if (idx < 0)
+        return idx;
+
+    mSlots[idx].state.fetch_or((uint64_t)flags << STATE_FLAGS_SHIFT,
+                               std::memory_order_acq_rel);
+    return 0;
+}
+
+int32_t StreamHandleRegistry::clearFlags(const void *handle, uint32_t flags)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    int32_t idx = findSlot((uintptr_t)handle);
+
+    if (idx < 0)
+        return idx;
+
+    mSlots[idx].state.fetch_and(~((uint64_t)flags << STATE_FLAGS_SHIFT),
+                                std::memory_order_acq_rel);
+    return 0;
+}
+
+bool StreamHandleRegistry::hasFlags(const void *handle, uint32_t flags)
+{
+    int32_t idx = findSlot((uintptr_t)handle);
+
+    if (idx < 0)
+        return false;
+
+    return (STATE_FLAGS(mSlots[idx].state.load(std::memory_order_acquire)) &
+            flags) == flags;
+}
+
+int32_t StreamHandleRegistry::erase(const void *handle)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    int32_t idx = findSlot((uintptr_t)handle);
+    uint64_t st = 0;
+
+    if (idx < 0)
+        return idx;
+
+    st = mSlots[idx].state.load(std::memory_order_relaxed);
+    if (STATE_USERS(st))
+        PAL_ERR(LOG_TAG, "handle %p erased with %u users", handle, STATE_USERS(st));
+
+    /* bump generation first so that in flight acquires fail their CAS */
+    mSlots[idx].state.store(STATE_NEXT_GEN(st), std::memory_order_release);
+    mSlots[idx].key.store(SLOT_TOMBSTONE, std::memory_order_release);
+    mLive--;
+    reclaimTombstones_l(idx);
+    return 0;
+}
+
+/*
+ * A tombstone followed by an empty slot ends every probe chain through
+ * it, so it can be emptied along with the tombstones right before it.
+ * Keeps misses from probing the whole table once handles have churned.
+ */
+void StreamHandleRegistry::reclaimTombstones_l(int32_t idx)
+{
+    uint32_t next = (idx + 1) & (STREAM_HANDLE_REGISTRY_SIZE - 1);
+
+    /* no key left for a lookup to miss */
+    if (mLive == 0) {
+        for (int i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++)
+            mSlots[i].key.store(SLOT_EMPTY, std::memory_order_release);
+        return;
+    }
+
+    if (mSlots[next].key.load(std::memory_order_relaxed) != SLOT_EMPTY)
+        return;
+
+    for (int i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++) {
+        if (mSlots[idx].key.load(std::memory_order_relaxed) != SLOT_TOMBSTONE)
+            break;
+        mSlots[idx].key.store(SLOT_EMPTY, std::memory_order_release);
+        idx = (idx - 1) & (STREAM_HANDLE_REGISTRY_SIZE - 1);
+    }
+}
+
+int32_t StreamHandleRegistry::deactivate(const void *handle, uint32_t *users)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    int32_t idx = findSlot((uintptr_t)handle);
+    uint64_t st = 0;
+    uint64_t activeBit = (uint64_t)STREAM_HANDLE_ACTIVE << STATE_FLAGS_SHIFT;
+
+    if (idx < 0)
+        return idx;
+
+    st = mSlots[idx].state.load(std::memory_order_acquire);
+    do {
+        if (!(st & activeBit))
+            return -EINVAL;
+    } while (!mSlots[idx].state.compare_exchange_weak(st, st & ~activeBit,
+                 std::memory_order_acq_rel, std::memory_order_acquire));
+
+    *users = STATE_USERS(st);
+    return 0;
+}
+
+int32_t StreamHandleRegistry::acquire(const void *handle)
+{
+    uintptr_t key = (uintptr_t)handle;
+    int32_t idx = findSlot(key);
+    uint64_t st = 0;
+    uint32_t required = STREAM_HANDLE_VALID | STREAM_HANDLE_ACTIVE;
+
+    if (idx < 0)
+        return -EINVAL;
+
+    st = mSlots[idx].state.load(std::memory_order_acquire);
+    do {
+        /* slot recycled meanwhile, generation check below covers later reuse */
+        if (mSlots[idx].key.load(std::memory_order_acquire) != key)
+            return -EINVAL;
+        if ((STATE_FLAGS(st) & required) != required)
+            return -EINVAL;
+        if (STATE_USERS(st) == STATE_USERS_MASK)
+            return -EBUSY;
+    } while (!mSlots[idx].state.compare_exchange_weak(st, st + 1,
+                 std::memory_order_acq_rel, std::memory_order_acquire));
+
+    return 0;
+}
+
+int32_t StreamHandleRegistry::release(const void *handle, bool *lastUser)
+{
+    int32_t idx = findSlot((uintptr_t)handle);
+    uint64_t st = 0;
+
+    *lastUser = false;
+    if (idx < 0)
+        return -EINVAL;
+
+    st = mSlots[idx].state.load(std::memory_order_acquire);
+    do {
+        if (STATE_USERS(st) == 0)
+            return -EINVAL;
+    } while (!mSlots[idx].state.compare_exchange_weak(st, st - 1,
+                 std::memory_order_acq_rel, std::memory_order_acquire));
+
+    *lastUser = (STATE_USERS(st) == 1) &&
+                !(STATE_FLAGS(st) & STREAM_HANDLE_ACTIVE);
+    return 0;
+}
+
+int32_t StreamHandleRegistry::getUsers(const void *handle)
+{
+    int32_t idx = findSlot((uintptr_t)handle);
+
+    if (idx < 0)
+        return -EINVAL;
+
+    return STATE_USERS(mSlots[idx].state.load(std::memory_order_acquire));
+}
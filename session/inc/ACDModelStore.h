@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef ACD_MODEL_STORE_H
+#define ACD_MODEL_STORE_H
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/*
+ * Read-only image of one ACD model file, laid out as the complete register
+ * multi sound model set param: the module param header and the register
+ * header sit at the end of an anonymous page and the model file is mapped
+ * right behind them, so the param goes to the session without copying the
+ * model.
+ */
+class ACDModelPayload {
+ public:
+    ACDModelPayload(void *base, size_t map_size, uint8_t *param_data,
+                    std::string bin_name);
+    ~ACDModelPayload();
+    void Prefetch();
+    uint8_t *GetParamData(uint32_t miid, uint32_t param_id);
+    const std::string &GetModelBinName() const { return bin_name_; }
+
+ private:
+    void *base_;
+    size_t map_size_;
+    uint8_t *param_data_;
+    std::string bin_name_;
+};
+
+/*
+ * Process wide store of mapped ACD models keyed by model UUID. Models stay
+ * mapped once used, so re-enabling a context does not touch the file again.
+ */
+class ACDModelStore {
+ public:
+    static int32_t GetModel(const std::string &bin_name, uint32_t model_uuid,
+                            std::shared_ptr<ACDModelPayload> &model);
+    static void PreloadModel(const std::string &bin_name, uint32_t model_uuid);
+
+ private:
+    static int32_t MapModel(const std::string &bin_name, uint32_t model_uuid,
+                            std::shared_ptr<ACDModelPayload> &model);
+    static std::mutex mutex_;
+    static std::map<uint32_t, std::shared_ptr<ACDModelPayload>> models_;
+};
+#endif // ACD_MODEL_STORE_H
@@ -42,8 +42,10 @@
 #include <algorithm>
 #include <expat.h>
 #include <map>
+#include <unordered_map>
 #include <regex>
 #include <sstream>
+#include <sys/stat.h>
 #include "Stream.h"
 #include "Device.h"
 #include "ResourceManager.h"
@@ -132,6 +134,11 @@ const std::map<std::string, selector_type_t> selectorstypeLUT {
     {std::string{ "SidetoneMode" },          SIDETONE_MODE_SEL},
 };
 
+/*
+ * kvPairs, kvInfo, allKVs and selector_type_t are stored as is in the KV
+ * snapshot (see serializeKVTable). Bump KV_SNAPSHOT_VERSION when any of
+ * them or the serializer changes.
+ */
 struct kvPairs {
     unsigned int key;
     unsigned int value;
@@ -148,6 +155,22 @@ struct allKVs {
     std::vector<kvInfo> keys_values;
 };
 
+/*
+ * Lookup tables compiled from one allKVs table once usecaseKvManager.xml
+ * is parsed, so that KV retrieval does not rescan the xml tables.
+ */
+struct kvSelectorIndex {
+    bool built;
+    /* id_type -> indices of the allKVs entries listing it, in xml order */
+    std::unordered_map<int32_t, std::vector<uint32_t>> type_entries;
+    /* id_type -> de-duplicated selector names used by those entries */
+    std::unordered_map<int32_t, std::vector<std::string>> type_selectors;
+    /* per allKVs entry: sorted selector tuple key -> first keys_values index */
+    std::vector<std::unordered_map<std::string, uint32_t>> exact_match;
+    /* per allKVs entry: keys_values indices with multi-valued selectors */
+    std::vector<std::vector<uint32_t>> multi_value;
+};
+
 typedef enum {
     TAG_USECASEXML_ROOT,
     TAG_STREAM_SEL,
@@ -163,6 +186,33 @@ typedef struct {
     uint16_t reserved;
 } __attribute__((packed)) legacyGefParamHeader;
 
+#define KV_SNAPSHOT_MAGIC 0x534B5650 /* "PVKS" */
+/*
+ * Snapshot layout version: 1 initial, 2 added xml_hash. Bump on any change
+ * to kvSnapshotHeader, the KV table structs above or serializeKVTable.
+ */
+#define KV_SNAPSHOT_VERSION 2
+
+/*
+ * Header of the binary snapshot of the tables parsed from usecaseKvManager.xml.
+ * The snapshot is only used when it was produced from the same xml file
+ * (path, size, mtime and content hash) and its payload checksum matches.
+ * Size and mtime are compared first so that a changed file is rejected
+ * without reading it.
+ */
+struct kvSnapshotHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t xml_path_hash;
+    uint32_t checksum;
+    uint32_t xml_hash;
+    uint32_t reserved;
+    uint64_t xml_size;
+    int64_t xml_mtime_sec;
+    int64_t xml_mtime_nsec;
+    uint64_t payload_size;
+};
+
 struct user_xml_data{
     char data_buf[1024];
     size_t offs;
@@ -181,6 +231,10 @@ protected:
    static std::vector<allKVs> all_streampps;
    static std::vector<allKVs> all_devices;
    static std::vector<allKVs> all_devicepps;
+   static kvSelectorIndex streams_index;
+   static kvSelectorIndex streampps_index;
+   static kvSelectorIndex devices_index;
+   static kvSelectorIndex devicepps_index;
 
 public:
     void payloadUsbAudioConfig(uint8_t** payload, size_t* size,
@@ -263,6 +317,7 @@ public:
     int populateCalKeyVector(Stream *s, std::vector <std::pair<int,int>> &ckv, int tag);
     int populateTagKeyVector(Stream *s, std::vector <std::pair<int,int>> &tkv, int tag, uint32_t* gsltag);
     void payloadTimestamp(std::shared_ptr<std::vector<uint8_t>>& module_payload, size_t *size, uint32_t moduleId);
+    void payloadSoftPauseParams(std::shared_ptr<std::vector<uint8_t>>& module_payload, size_t *size, uint32_t moduleId);
     static int init();
     static void endTag(void *userdata, const XML_Char *tag_name);
     static void startTag(void *userdata, const XML_Char *tag_name, const XML_Char **attr);
@@ -285,6 +340,17 @@ public:
     static bool findKVs(std::vector<std::pair<selector_type_t, std::string>>
         &filled_selector_pairs, uint32_t type, std::vector<allKVs> &any_type,
         std::vector<std::pair<int32_t, int32_t>> &keyVector);
+    static void buildKVIndex(std::vector<allKVs> &any_type, kvSelectorIndex &index);
+    static kvSelectorIndex* getKVIndex(std::vector<allKVs> &any_type);
+    static std::string getSelectorKey(
+        const std::vector<std::pair<selector_type_t, std::string>> &selector_pairs);
+    static int getKVXmlHash(const char *xmlFile, uint32_t *hash);
+    static int loadKVSnapshot(const char *xmlFile, const struct stat *xmlStat);
+    static void storeKVSnapshot(const char *xmlFile, const struct stat *xmlStat,
+        uint32_t xmlHash);
+    static void serializeKVTable(std::vector<allKVs> &any_type, std::vector<uint8_t> &buf);
+    static int deserializeKVTable(const uint8_t *buf, size_t size, size_t &offs,
+        std::vector<allKVs> &any_type);
     static std::string removeSpaces(const std::string& str);
     static std::vector<std::string> splitStrings(const std::string& str);
     static int getBtDeviceKV(int dev_id, std::vector<std::pair<int, int>> &deviceKV,
@@ -138,6 +138,10 @@ public:
     virtual int registerCallBack(session_callback cb __unused, uint64_t cookie __unused) {return 0;};
     virtual int drain(pal_drain_type_t type __unused) {return 0;};
     virtual int flush() {return 0;};
+    /* wake read/write blocked in the driver, session must be stopped */
+    virtual int abortIo(Stream *s __unused) {return 0;};
+    /* soft pause ramp period configured in the stream graph */
+    virtual int getSoftPauseRampUs(uint32_t *rampUs __unused) {return -EINVAL;};
     virtual void setEventPayload(uint32_t event_id __unused, void *payload __unused, size_t payload_size __unused) {  };
     virtual int getTimestamp(struct pal_session_time *stime __unused) {return 0;};
     /*TODO need to implement connect/disconnect in basecase*/
@@ -44,6 +44,7 @@
 #include <agm/agm_api.h>
 
 #define EARLY_EOS_DELAY_MS 150
+#define EVENT_PAYLOAD_POOL_SIZE 4
 
 class Stream;
 class Session;
@@ -55,6 +56,13 @@ struct agmMetaData {
         :buf(b),size(s) {}
 };
 
+/* preallocated read/write done payload handed to the stream callback */
+struct agmEventPayload {
+    struct pal_event_read_write_done_payload payload;
+    struct timespec ts;
+    bool inUse;
+};
+
 class SessionAgm : public Session
 {
 private:
@@ -76,6 +84,8 @@ private:
     struct agm_session_config *sess_config;
     struct agm_media_config *in_media_cfg, *out_media_cfg;
     struct agm_buffer_config in_buff_cfg {0,0,0}, out_buff_cfg = in_buff_cfg;
+    struct agmEventPayload eventPool[EVENT_PAYLOAD_POOL_SIZE];
+    std::mutex eventPoolMutex;
 public:
     SessionAgm(std::shared_ptr<ResourceManager> Rm);
     virtual ~SessionAgm();
@@ -115,6 +125,9 @@ public:
     uint64_t cbCookie;
     int32_t sessionId;
     Stream *streamHandle;
+    bool timestampMode;
+    struct pal_event_read_write_done_payload* acquireEventPayload();
+    void releaseEventPayload(struct pal_event_read_write_done_payload *rw_done_payload);
 };
 
 #endif //SESSION_AGM_H
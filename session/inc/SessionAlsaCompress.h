@@ -147,6 +147,7 @@ public:
     int drain(pal_drain_type_t type);
     int flush();
     int getTimestamp(struct pal_session_time *stime) override;
+    int getSoftPauseRampUs(uint32_t *rampUs) override;
     int setupSessionDevice(Stream* streamHandle, pal_stream_type_t streamType,
         std::shared_ptr<Device> deviceToConnect) override;
     int connectSessionDevice(Stream* streamHandle, pal_stream_type_t streamType,
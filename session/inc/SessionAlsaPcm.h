@@ -96,6 +96,8 @@ public:
     int registerCallBack(session_callback cb, uint64_t cookie) override;
     int drain(pal_drain_type_t type) override;
     int flush();
+    int abortIo(Stream *s) override;
+    int getSoftPauseRampUs(uint32_t *rampUs) override;
     int setupSessionDevice(Stream* streamHandle, pal_stream_type_t streamType,
         std::shared_ptr<Device> deviceToConnect) override;
     int connectSessionDevice(Stream* streamHandle, pal_stream_type_t streamType,
@@ -40,7 +40,11 @@
 
 #include <tinyalsa/asoundlib.h>
 #include <sound/asound.h>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
 
+#define TAGGED_INFO_PAYLOAD_SIZE 1024
 
 class Stream;
 class Session;
@@ -69,6 +73,15 @@ enum FeCtrlsIndex {
     FE_MAX_NUM_MIXER_CONTROLS,
 };
 
+/*
+ * Tag table of one graph, as returned by "<pcm> getTaggedInfo" for a
+ * (pcm device, backend) pair, together with its tag -> MIID lookup.
+ */
+struct tagModuleInfoCacheEntry {
+    std::vector<uint8_t> payload;
+    std::map<uint32_t, uint32_t> miids;
+};
+
 enum BeCtrlsIndex {
     BE_METADATA,
     BE_MEDIAFMT,
@@ -87,6 +100,30 @@ private:
     static struct mixer_ctl *getBeMixerControl(struct mixer *am, std::string beName,
         uint32_t idx);
     static struct mixer_ctl *getStaticMixerControl(struct mixer *am, std::string name);
+    static int getTagModuleInfo(struct mixer *mixer, int device, const char *intf_name,
+        std::shared_ptr<tagModuleInfoCacheEntry> &entry);
+    static std::mutex tagInfoCacheMutex;
+    static std::map<std::pair<int, std::string>,
+        std::shared_ptr<tagModuleInfoCacheEntry>> tagInfoCache;
+    /* protected by tagInfoCacheMutex */
+    static uint64_t tagInfoHits;
+    static uint64_t tagInfoMisses;
+    static uint64_t tagInfoInvalidated;
+    static std::mutex mixerCtlCacheMutex;
+    static std::map<struct mixer *,
+        std::unordered_map<std::string, struct mixer_ctl *>> mixerCtlCache;
+    /* protected by mixerCtlCacheMutex */
+    static uint64_t mixerCtlHits;
+    static uint64_t mixerCtlMisses;
+    static uint64_t mixerCtlDropped;
+    static std::mutex beCtlMutex;
+    static std::map<struct mixer_ctl *, std::vector<uint8_t>> beCtlBatch;
+    static std::thread::id beCtlBatchOwner;
+    static bool beCtlBatchOn;
+    static uint32_t beCtlBatchSkipped;
+    /* protected by beCtlMutex */
+    static uint64_t beCtlWrites;
+    static uint64_t beCtlSkipped;
 public:
     ~SessionAlsaUtils();
     static bool isRxDevice(uint32_t devId);
@@ -115,6 +152,17 @@ public:
                        int tag_id, uint32_t *miid);
     static int getTagsWithModuleInfo(struct mixer *mixer, int device, const char *intf_name,
                        uint8_t *payload);
+    static void invalidateTagModuleInfo(const std::vector<int> &DevIds);
+    static void invalidateTagModuleInfo(const std::string &backEndName);
+    static void invalidateTagModuleInfo();
+    static void getCacheStats(pal_param_session_cache_stats_t *stats);
+    static struct mixer_ctl *getMixerControl(struct mixer *am, const char *name);
+    static void clearMixerControlCache();
+    /* must be called before am is closed, a new mixer may reuse the address */
+    static void clearMixerControlCache(struct mixer *am);
+    static int setBeControl(struct mixer_ctl *ctl, const void *buf, size_t count);
+    static void beginBeControlBatch();
+    static uint32_t endBeControlBatch();
     static int setMixerParameter(struct mixer *mixer, int device,
                                  void *payload, int size);
     static int setStreamMetadataType(struct mixer *mixer, int device, const char *val);
@@ -123,6 +171,8 @@ public:
     static int setECRefPath(struct mixer *mixer, int device, const char *intf_name);
 
     static int getTimestamp(struct mixer *mixer, const std::vector<int> &DevIds, uint32_t spr_miid, struct pal_session_time *stime);
+    static int getSoftPauseRampUs(struct mixer *mixer, const std::vector<int> &DevIds,
+                                  const char *intf_name, uint32_t *rampUs);
     static int disconnectSessionDevice(Stream* streamHandle, pal_stream_type_t streamType,
         std::shared_ptr<ResourceManager> rm, struct pal_device &dAttr,
         const std::vector<int> &pcmDevIds,
@@ -64,6 +64,7 @@
 #define PARAM_ID_MEDIA_FORMAT 0x0800100C
 #define PARAM_ID_SOFT_PAUSE_START 0x0800102E
 #define PARAM_ID_SOFT_PAUSE_RESUME 0x0800102F
+#define PARAM_ID_SOFT_PAUSE_PARAMS 0x08001030
 #define PARAM_ID_VOL_CTRL_MULTICHANNEL_GAIN 0x08001038
 #define PARAM_ID_VOL_CTRL_MASTER_GAIN 0x08001035
 #define PLAYBACK_VOLUME_MASTER_GAIN_DEFAULT 0x2000
@@ -94,6 +95,14 @@
 #define SLIM_TX1 129
 #define SLIM_TX7 135
 
+/* Payload of PARAM_ID_SOFT_PAUSE_PARAMS in the soft pause module */
+struct softPauseParams {
+    uint32_t enable_flag;
+    uint32_t period;        /* ramp period in ms */
+    uint32_t step;          /* ramp step in us */
+    uint32_t ramping_curve;
+};
+
 struct gslCmdGetReadWriteBufInfo {
     uint32_t buff_size;
     uint32_t num_buffs;
@@ -99,6 +99,8 @@ class SoundTriggerEngineCapi : public SoundTriggerEngine {
     int32_t StopSoundEngine();
     int32_t StartKeywordDetection();
     int32_t StartUserVerification();
+    char *PeekProcessBuffer(char *copy_buff, size_t size, int32_t *read_size);
+    void ReleaseProcessBuffer(int32_t read_size);
     static void BufferThreadLoop(SoundTriggerEngineCapi *capi_engine);
 
     std::string lib_name_;
@@ -109,6 +111,8 @@ class SoundTriggerEngineCapi : public SoundTriggerEngine {
     std::mutex event_mutex_;
     st_sound_model_type_t detection_type_;
     bool processing_started_;
+    /* reader pinned between PeekProcessBuffer and ReleaseProcessBuffer */
+    bool process_buffer_pinned_;
     bool keyword_detected_;
     int32_t confidence_threshold_;
     uint32_t buffer_size_;
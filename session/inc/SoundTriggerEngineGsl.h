@@ -116,9 +116,16 @@ class SoundTriggerEngineGsl : public SoundTriggerEngine {
     }
     void UpdateState(eng_state_t state);
     void UpdateStateToActive() override;
+    /* SML merge/delete through SoundModelMergeCache, no engine state used */
+    static int32_t MergeSoundModels(uint32_t num_models,
+             listen_model_type *in_models[], listen_model_type *out_model);
+    static int32_t DeleteFromMergedModel(char **keyphrases,
+             uint32_t num_keyphrases, listen_model_type *in_model,
+             listen_model_type *out_model);
 
  private:
     int32_t StartBuffering(Stream *s);
+    size_t WriteMmapToRingBuffer(size_t offset, size_t size, FILE *dump_fd);
     int32_t RestartRecognition_l(Stream *s);
     int32_t UpdateSessionPayload(st_param_id_type_t param);
     int32_t ParseDetectionPayloadPDK(void *event_data);
@@ -142,10 +149,6 @@ class SoundTriggerEngineGsl : public SoundTriggerEngine {
     int32_t DeleteSoundModel(Stream *s);
     int32_t QuerySoundModel(SoundModelInfo *sm_info,
                             uint8_t *data, uint32_t data_size);
-    int32_t MergeSoundModels(uint32_t num_models, listen_model_type *in_models[],
-             listen_model_type *out_model);
-    int32_t DeleteFromMergedModel(char **keyphrases, uint32_t num_keyphrases,
-             listen_model_type *in_model, listen_model_type *out_model);
     int32_t ConstructAPMPayload(uint32_t param_id, uint8_t** payload,
                                 uint8_t* data, uint32_t data_size);
     int32_t ProcessStartRecognition(Stream *s);
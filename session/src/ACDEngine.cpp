@@ -31,6 +31,8 @@
 #define LOG_TAG "PAL: ACDEngine"
 
 #include "ACDEngine.h"
+#include "ACDModelStore.h"
+#include "PalLatencyStats.h"
 
 #include <cmath>
 #include <cutils/trace.h>
@@ -40,7 +42,6 @@
 #include "ResourceManager.h"
 #include "acd_api.h"
 
-#define FILENAME_LEN 128
 std::shared_ptr<ACDEngine> ACDEngine::eng_;
 
 ACDEngine::ACDEngine(Stream *s, std::shared_ptr<StreamConfig> sm_cfg) :
@@ -406,67 +407,43 @@ int32_t ACDEngine::RegDeregSoundModel(uint32_t sess_param_id, uint8_t *payload,
     if (status != 0)
         PAL_ERR(LOG_TAG, "Error:%d Failed to send sound model payload", status);
 
+    free(session_payload);
     return status;
 }
 
+/*
+ * The store keeps the model mapped as a complete register param, so it is
+ * sent as is instead of going through payloadCustomParam, which would copy
+ * the whole model into a new buffer on every context enable.
+ */
 int32_t ACDEngine::PopulateSoundModel(std::string model_file_name, uint32_t model_uuid)
 {
-    FILE *fp;
-    size_t size = 0, bytes_read = 0;
     int32_t status = 0;
-    void *payload = NULL;
-    char filename[FILENAME_LEN];
-    struct param_id_detection_engine_register_multi_sound_model_t *sm_data =
-           nullptr;
-
-    snprintf(filename, FILENAME_LEN, "%s%s", ACD_SM_FILEPATH, model_file_name.c_str());
-    fp = fopen(filename, "rb");
-    if (!fp) {
-        PAL_ERR(LOG_TAG, "Error:%d Unable to open soundmodel file '%s'", -EIO,
-            model_file_name.c_str());
-        return -EIO;
-    }
-    fseek(fp, 0, SEEK_END);
-    size = ftell(fp);
-    rewind(fp);
-    payload = calloc(1, size);
-    if (!payload) {
-        status = -ENOMEM;
-        goto close_fp;
-    }
+    uint32_t miid = 0;
+    uint32_t tag_id = CONTEXT_DETECTION_ENGINE;
+    std::shared_ptr<ACDModelPayload> model = nullptr;
+    PalLatencyScope latency(PAL_LATENCY_ACD_MODEL_LOAD);
 
-    bytes_read = fread((char*)payload, 1, size , fp);
-    if (bytes_read != size) {
-        status = -EIO;
-        PAL_ERR(LOG_TAG, "Error:%d failed to read data from soundmodel file' %s'\n",
-            status, model_file_name.c_str());
-        goto free_payload;
+    status = ACDModelStore::GetModel(model_file_name, model_uuid, model);
+    if (status) {
+        PAL_ERR(LOG_TAG, "Error:%d Failed to get soundmodel '%s'", status,
+            model_file_name.c_str());
+        return status;
     }
 
-    sm_data = (struct param_id_detection_engine_register_multi_sound_model_t *)
-         calloc(1, sizeof(
-         struct param_id_detection_engine_register_multi_sound_model_t) +
-         size);
-
-    if (sm_data == nullptr) {
-        status =  -ENOMEM;
-        PAL_ERR(LOG_TAG, "Error:%d Failed to allocate memory for sm_data", status);
-        goto free_smdata;
+    status = session_->getMIID(nullptr, tag_id, &miid);
+    if (status != 0) {
+        PAL_ERR(LOG_TAG, "Error:%d Failed to get miid for tag %x", status, tag_id);
+        return status;
     }
 
-    sm_data->model_id = model_uuid;
-    sm_data->model_size = size;
-    ar_mem_cpy(sm_data->model, size, payload, size);
-    size += (sizeof(param_id_detection_engine_register_multi_sound_model_t));
-
-    status = RegDeregSoundModel(PAL_PARAM_ID_LOAD_SOUND_MODEL, (uint8_t *)sm_data, size);
+    status = session_->setParameters(stream_handle_, tag_id,
+                 PAL_PARAM_ID_LOAD_SOUND_MODEL,
+                 model->GetParamData(miid,
+                     PARAM_ID_DETECTION_ENGINE_REGISTER_MULTI_SOUND_MODEL));
+    if (status != 0)
+        PAL_ERR(LOG_TAG, "Error:%d Failed to send sound model payload", status);
 
-free_smdata:
-    free(sm_data);
-free_payload:
-    free(payload);
-close_fp:
-    fclose(fp);
     return status;
 }
 
@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define LOG_TAG "PAL: ACDModelStore"
+#include "ACDModelStore.h"
+#include "PalCommon.h"
+#include "apm_api.h"
+#include "detection_cmn_api.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILENAME_LEN 128
+
+std::mutex ACDModelStore::mutex_;
+std::map<uint32_t, std::shared_ptr<ACDModelPayload>> ACDModelStore::models_;
+
+ACDModelPayload::ACDModelPayload(void *base, size_t map_size,
+    uint8_t *param_data, std::string bin_name) :
+    base_(base),
+    map_size_(map_size),
+    param_data_(param_data),
+    bin_name_(bin_name)
+{
+}
+
+ACDModelPayload::~ACDModelPayload()
+{
+    if (base_)
+        munmap(base_, map_size_);
+}
+
+void ACDModelPayload::Prefetch()
+{
+    /* start reading the model in now rather than on first context enable */
+    if (base_ && madvise(base_, map_size_, MADV_WILLNEED))
+        PAL_DBG(LOG_TAG, "madvise failed for '%s', errno %d",
+            bin_name_.c_str(), errno);
+}
+
+/*
+ * The register header and model behind the param header are fixed at map
+ * time; only the module instance and param id are filled in per send.
+ */
+uint8_t *ACDModelPayload::GetParamData(uint32_t miid, uint32_t param_id)
+{
+    struct apm_module_param_data_t *header =
+        (struct apm_module_param_data_t *)param_data_;
+
+    header->module_instance_id = miid;
+    header->param_id = param_id;
+    header->error_code = 0;
+    return param_data_;
+}
+
+int32_t ACDModelStore::MapModel(const std::string &bin_name,
+    uint32_t model_uuid, std::shared_ptr<ACDModelPayload> &model)
+{
+    int32_t status = 0;
+    int fd = -1;
+    struct stat st = {};
+    char filename[FILENAME_LEN];
+    long page_size = sysconf(_SC_PAGESIZE);
+    size_t hdr_size = sizeof(struct apm_module_param_data_t) +
+        sizeof(struct param_id_detection_engine_register_multi_sound_model_t);
+    size_t map_size = 0;
+    uint8_t *base = nullptr;
+    void *model_data = nullptr;
+    struct apm_module_param_data_t *header = nullptr;
+    struct param_id_detection_engine_register_multi_sound_model_t *hdr = nullptr;
+
+    if (page_size <= 0 || (size_t)page_size < hdr_size)
+        page_size = 4096;
+
+    snprintf(filename, FILENAME_LEN, "%s%s", ACD_SM_FILEPATH, bin_name.c_str());
+    fd = open(filename, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        PAL_ERR(LOG_TAG, "Error:%d Unable to open soundmodel file '%s'", -EIO,
+            bin_name.c_str());
+        return -EIO;
+    }
+
+    if (fstat(fd, &st) || st.st_size <= 0) {
+        status = -EIO;
+        PAL_ERR(LOG_TAG, "Error:%d invalid soundmodel file '%s'", status,
+            bin_name.c_str());
+        goto close_fd;
+    }
+
+    /*
+     * one anonymous page for the headers, the model file right after it; the
+     * 8 byte padding the session reads is only needed for a model size that
+     * is not 8 byte aligned, and then the last file page is partly zero fill
+     */
+    map_size = page_size + st.st_size;
+    base = (uint8_t *)mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        status = -ENOMEM;
+        PAL_ERR(LOG_TAG, "Error:%d failed to reserve %zu bytes for '%s'", status,
+            map_size, bin_name.c_str());
+        goto close_fd;
+    }
+
+    model_data = mmap(base + page_size, st.st_size, PROT_READ,
+                      MAP_PRIVATE | MAP_FIXED, fd, 0);
+    if (model_data == MAP_FAILED) {
+        status = -EIO;
+        PAL_ERR(LOG_TAG, "Error:%d failed to map soundmodel file '%s'", status,
+            bin_name.c_str());
+        munmap(base, map_size);
+        goto close_fd;
+    }
+
+    header = (struct apm_module_param_data_t *)(base + page_size - hdr_size);
+    header->param_size = hdr_size - sizeof(struct apm_module_param_data_t) +
+                         st.st_size;
+    hdr = (struct param_id_detection_engine_register_multi_sound_model_t *)
+          (header + 1);
+    hdr->model_id = model_uuid;
+    hdr->model_size = st.st_size;
+
+    model = std::make_shared<ACDModelPayload>(base, map_size, (uint8_t *)header,
+                bin_name);
+    PAL_INFO(LOG_TAG, "mapped soundmodel '%s' uuid 0x%x size %zu",
+        bin_name.c_str(), model_uuid, (size_t)st.st_size);
+
+close_fd:
+    close(fd);
+    return status;
+}
+
+int32_t ACDModelStore::GetModel(const std::string &bin_name,
+    uint32_t model_uuid, std::shared_ptr<ACDModelPayload> &model)
+{
+    int32_t status = 0;
+
+    mutex_.lock();
+    auto it = models_.find(model_uuid);
+    if (it != models_.end() && it->second->GetModelBinName() == bin_name) {
+        model = it->second;
+        goto exit;
+    }
+
+    status = MapModel(bin_name, model_uuid, model);
+    if (!status)
+        models_[model_uuid] = model;
+
+exit:
+    mutex_.unlock();
+    return status;
+}
+
+void ACDModelStore::PreloadModel(const std::string &bin_name,
+    uint32_t model_uuid)
+{
+    std::shared_ptr<ACDModelPayload> model = nullptr;
+
+    if (GetModel(bin_name, model_uuid, model)) {
+        PAL_ERR(LOG_TAG, "failed to preload soundmodel '%s'", bin_name.c_str());
+        return;
+    }
+
+    model->Prefetch();
+}
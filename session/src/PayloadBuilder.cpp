@@ -44,6 +44,9 @@
 #include "sp_vi.h"
 #include "sp_rx.h"
 #include "fluence_ffv_common_calibration.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 #if defined(FEATURE_IPQ_OPENWRT) || defined(LINUX_ENABLED)
 #define USECASE_XML_FILE "/etc/usecaseKvManager.xml"
@@ -52,6 +55,12 @@
 #endif
 
 #define USECASE_ARRAX_XML_FILE "/vendor/etc/usecaseKvManager_arrax.xml"
+
+#if defined(FEATURE_IPQ_OPENWRT) || defined(LINUX_ENABLED)
+#define USECASE_KV_SNAPSHOT_FILE "/var/cache/usecaseKvManager.bin"
+#else
+#define USECASE_KV_SNAPSHOT_FILE "/data/vendor/audio/usecaseKvManager.bin"
+#endif
 #define PARAM_ID_CHMIXER_COEFF 0x0800101F
 #define CUSTOM_STEREO_NUM_OUT_CH 0x0002
 #define CUSTOM_STEREO_NUM_IN_CH 0x0002
@@ -170,6 +179,10 @@ std::vector<allKVs> PayloadBuilder::all_streams;
 std::vector<allKVs> PayloadBuilder::all_streampps;
 std::vector<allKVs> PayloadBuilder::all_devices;
 std::vector<allKVs> PayloadBuilder::all_devicepps;
+kvSelectorIndex PayloadBuilder::streams_index;
+kvSelectorIndex PayloadBuilder::streampps_index;
+kvSelectorIndex PayloadBuilder::devices_index;
+kvSelectorIndex PayloadBuilder::devicepps_index;
 
 template <typename T>
 void PayloadBuilder::populateChannelMap(T pcmChannel, uint8_t numChannel)
@@ -641,6 +654,8 @@ void PayloadBuilder:: processKVSelectorData(struct user_xml_data *data,
                 selector_values[j].c_str());
         }
     }
+    /* kept sorted so that lookups can compare tuples without re-sorting */
+    std::sort(kvinfo.selector_pairs.begin(), kvinfo.selector_pairs.end());
 
     if (data->is_parsing_streams) {
         if (all_streams.size() > 0) {
@@ -850,6 +865,272 @@ void PayloadBuilder::handleData(void *userdata, const char *s, int len)
    }
 }
 
+static uint32_t kvSnapshotHash(const uint8_t *data, size_t size)
+{
+    uint32_t hash = 2166136261u; /* FNV-1a */
+
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void kvSnapshotPutU32(std::vector<uint8_t> &buf, uint32_t val)
+{
+    uint8_t *p = (uint8_t *)&val;
+    buf.insert(buf.end(), p, p + sizeof(val));
+}
+
+static void kvSnapshotPutString(std::vector<uint8_t> &buf, const std::string &str)
+{
+    kvSnapshotPutU32(buf, str.size());
+    buf.insert(buf.end(), str.begin(), str.end());
+}
+
+static int kvSnapshotGetU32(const uint8_t *buf, size_t size, size_t &offs, uint32_t &val)
+{
+    if (size - offs < sizeof(val))
+        return -EINVAL;
+    memcpy(&val, buf + offs, sizeof(val));
+    offs += sizeof(val);
+    return 0;
+}
+
+static int kvSnapshotGetString(const uint8_t *buf, size_t size, size_t &offs, std::string &str)
+{
+    uint32_t len = 0;
+
+    if (kvSnapshotGetU32(buf, size, offs, len) || (size - offs < len))
+        return -EINVAL;
+    str.assign((const char *)(buf + offs), len);
+    offs += len;
+    return 0;
+}
+
+void PayloadBuilder::serializeKVTable(std::vector<allKVs> &any_type, std::vector<uint8_t> &buf)
+{
+    kvSnapshotPutU32(buf, any_type.size());
+    for (auto &kvs : any_type) {
+        kvSnapshotPutU32(buf, kvs.id_type.size());
+        for (auto id : kvs.id_type)
+            kvSnapshotPutU32(buf, (uint32_t)id);
+        kvSnapshotPutU32(buf, kvs.keys_values.size());
+        for (auto &info : kvs.keys_values) {
+            kvSnapshotPutU32(buf, info.selector_names.size());
+            for (auto &name : info.selector_names)
+                kvSnapshotPutString(buf, name);
+            kvSnapshotPutU32(buf, info.selector_pairs.size());
+            for (auto &pair : info.selector_pairs) {
+                kvSnapshotPutU32(buf, (uint32_t)pair.first);
+                kvSnapshotPutString(buf, pair.second);
+            }
+            kvSnapshotPutU32(buf, info.kv_pairs.size());
+            for (auto &kv : info.kv_pairs) {
+                kvSnapshotPutU32(buf, kv.key);
+                kvSnapshotPutU32(buf, kv.value);
+            }
+        }
+    }
+}
+
+int PayloadBuilder::deserializeKVTable(const uint8_t *buf, size_t size, size_t &offs,
+    std::vector<allKVs> &any_type)
+{
+    uint32_t numTypes = 0, numIds = 0, numInfo = 0, num = 0, val = 0;
+    std::string str;
+
+    /* every entry takes at least one count word, bound counts before resizing */
+    if (kvSnapshotGetU32(buf, size, offs, numTypes) || numTypes > size - offs)
+        return -EINVAL;
+    any_type.resize(numTypes);
+    for (auto &kvs : any_type) {
+        if (kvSnapshotGetU32(buf, size, offs, numIds))
+            return -EINVAL;
+        for (uint32_t i = 0; i < numIds; i++) {
+            if (kvSnapshotGetU32(buf, size, offs, val))
+                return -EINVAL;
+            kvs.id_type.push_back((int)val);
+        }
+        if (kvSnapshotGetU32(buf, size, offs, numInfo) || numInfo > size - offs)
+            return -EINVAL;
+        kvs.keys_values.resize(numInfo);
+        for (auto &info : kvs.keys_values) {
+            if (kvSnapshotGetU32(buf, size, offs, num))
+                return -EINVAL;
+            for (uint32_t i = 0; i < num; i++) {
+                if (kvSnapshotGetString(buf, size, offs, str))
+                    return -EINVAL;
+                info.selector_names.push_back(str);
+            }
+            if (kvSnapshotGetU32(buf, size, offs, num))
+                return -EINVAL;
+            for (uint32_t i = 0; i < num; i++) {
+                if (kvSnapshotGetU32(buf, size, offs, val) ||
+                    kvSnapshotGetString(buf, size, offs, str))
+                    return -EINVAL;
+                info.selector_pairs.push_back(std::make_pair((selector_type_t)val, str));
+            }
+            if (kvSnapshotGetU32(buf, size, offs, num))
+                return -EINVAL;
+            for (uint32_t i = 0; i < num; i++) {
+                struct kvPairs kv = {};
+                if (kvSnapshotGetU32(buf, size, offs, kv.key) ||
+                    kvSnapshotGetU32(buf, size, offs, kv.value))
+                    return -EINVAL;
+                info.kv_pairs.push_back(kv);
+            }
+        }
+    }
+    return 0;
+}
+
+/* Content hash of the xml file the snapshot was built from */
+int PayloadBuilder::getKVXmlHash(const char *xmlFile, uint32_t *hash)
+{
+    int fd = -1;
+    struct stat st;
+    void *map = MAP_FAILED;
+
+    fd = open(xmlFile, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return -errno;
+    if (fstat(fd, &st) || st.st_size <= 0) {
+        close(fd);
+        return -EINVAL;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        PAL_ERR(LOG_TAG, "mmap of %s failed %s", xmlFile, strerror(errno));
+        return -ENOMEM;
+    }
+    *hash = kvSnapshotHash((const uint8_t *)map, st.st_size);
+    munmap(map, st.st_size);
+    return 0;
+}
+
+/*
+ * Load the KV tables from the snapshot written by a previous init, which
+ * avoids parsing usecaseKvManager.xml on every audio server start.
+ */
+int PayloadBuilder::loadKVSnapshot(const char *xmlFile, const struct stat *xmlStat)
+{
+    int ret = -EINVAL;
+    int fd = -1;
+    struct stat st;
+    void *map = MAP_FAILED;
+    const uint8_t *payload = NULL;
+    struct kvSnapshotHeader header;
+    size_t offs = 0;
+    uint32_t xmlHash = 0;
+
+    fd = open(USECASE_KV_SNAPSHOT_FILE, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        PAL_DBG(LOG_TAG, "no KV snapshot %s", USECASE_KV_SNAPSHOT_FILE);
+        goto done;
+    }
+    if (fstat(fd, &st) || st.st_size < (off_t)sizeof(header))
+        goto closeFile;
+
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        PAL_ERR(LOG_TAG, "mmap of KV snapshot failed %s", strerror(errno));
+        goto closeFile;
+    }
+
+    memcpy(&header, map, sizeof(header));
+    if (header.magic != KV_SNAPSHOT_MAGIC || header.version != KV_SNAPSHOT_VERSION ||
+        header.xml_path_hash != kvSnapshotHash((const uint8_t *)xmlFile, strlen(xmlFile)) ||
+        header.xml_size != (uint64_t)xmlStat->st_size ||
+        header.xml_mtime_sec != (int64_t)xmlStat->st_mtim.tv_sec ||
+        header.xml_mtime_nsec != (int64_t)xmlStat->st_mtim.tv_nsec ||
+        header.payload_size != (uint64_t)st.st_size - sizeof(header)) {
+        PAL_INFO(LOG_TAG, "KV snapshot is stale, reparsing %s", xmlFile);
+        goto unmap;
+    }
+
+    /* same size and mtime do not prove same content, e.g. after an image flash */
+    if (getKVXmlHash(xmlFile, &xmlHash) || header.xml_hash != xmlHash) {
+        PAL_INFO(LOG_TAG, "KV snapshot content hash mismatch, reparsing %s", xmlFile);
+        goto unmap;
+    }
+
+    payload = (const uint8_t *)map + sizeof(header);
+    if (header.checksum != kvSnapshotHash(payload, header.payload_size)) {
+        PAL_ERR(LOG_TAG, "KV snapshot checksum mismatch");
+        goto unmap;
+    }
+
+    if (deserializeKVTable(payload, header.payload_size, offs, all_streams) ||
+        deserializeKVTable(payload, header.payload_size, offs, all_streampps) ||
+        deserializeKVTable(payload, header.payload_size, offs, all_devices) ||
+        deserializeKVTable(payload, header.payload_size, offs, all_devicepps) ||
+        offs != header.payload_size) {
+        PAL_ERR(LOG_TAG, "KV snapshot is corrupted");
+        all_streams.clear();
+        all_streampps.clear();
+        all_devices.clear();
+        all_devicepps.clear();
+        goto unmap;
+    }
+    ret = 0;
+
+unmap:
+    munmap(map, st.st_size);
+closeFile:
+    close(fd);
+done:
+    return ret;
+}
+
+void PayloadBuilder::storeKVSnapshot(const char *xmlFile, const struct stat *xmlStat,
+    uint32_t xmlHash)
+{
+    std::vector<uint8_t> buf;
+    struct kvSnapshotHeader header;
+    std::string tmpFile = std::string(USECASE_KV_SNAPSHOT_FILE) + ".tmp";
+    FILE *file = NULL;
+    size_t written = 0;
+
+    buf.resize(sizeof(header));
+    serializeKVTable(all_streams, buf);
+    serializeKVTable(all_streampps, buf);
+    serializeKVTable(all_devices, buf);
+    serializeKVTable(all_devicepps, buf);
+
+    memset(&header, 0, sizeof(header));
+    header.magic = KV_SNAPSHOT_MAGIC;
+    header.version = KV_SNAPSHOT_VERSION;
+    header.xml_path_hash = kvSnapshotHash((const uint8_t *)xmlFile, strlen(xmlFile));
+    header.xml_hash = xmlHash;
+    header.xml_size = xmlStat->st_size;
+    header.xml_mtime_sec = xmlStat->st_mtim.tv_sec;
+    header.xml_mtime_nsec = xmlStat->st_mtim.tv_nsec;
+    header.payload_size = buf.size() - sizeof(header);
+    header.checksum = kvSnapshotHash(buf.data() + sizeof(header), header.payload_size);
+    memcpy(buf.data(), &header, sizeof(header));
+
+    /* write to a temporary file first so that a partial snapshot is never picked up */
+    file = fopen(tmpFile.c_str(), "wb");
+    if (!file) {
+        PAL_DBG(LOG_TAG, "cannot create KV snapshot %s", tmpFile.c_str());
+        return;
+    }
+    written = fwrite(buf.data(), 1, buf.size(), file);
+    if (fclose(file) || written != buf.size()) {
+        PAL_ERR(LOG_TAG, "KV snapshot write failed");
+        unlink(tmpFile.c_str());
+        return;
+    }
+    if (rename(tmpFile.c_str(), USECASE_KV_SNAPSHOT_FILE)) {
+        PAL_ERR(LOG_TAG, "KV snapshot rename failed %s", strerror(errno));
+        unlink(tmpFile.c_str());
+        return;
+    }
+    PAL_INFO(LOG_TAG, "KV snapshot stored, %zu bytes", buf.size());
+}
+
 int PayloadBuilder::init()
 {
     XML_Parser parser;
@@ -857,20 +1138,42 @@ int PayloadBuilder::init()
     int ret = 0;
     int bytes_read;
     void *buf = NULL;
+    const char *xmlFile = NULL;
+    struct stat xmlStat;
+    bool xmlStatValid = false;
+    uint32_t xmlHash = 0;
     struct user_xml_data tag_data;
     memset(&tag_data, 0, sizeof(tag_data));
     all_streams.clear();
     all_streampps.clear();
     all_devices.clear();
     all_devicepps.clear();
-
-    if (getSocId() == ARRAX_SOC_ID) {
-        PAL_INFO(LOG_TAG, "XML parsing started %s", USECASE_ARRAX_XML_FILE);
-        file = fopen(USECASE_ARRAX_XML_FILE, "r");
-    } else {
-        PAL_INFO(LOG_TAG, "XML parsing started %s", USECASE_XML_FILE);
-        file = fopen(USECASE_XML_FILE, "r");
+    streams_index.built = false;
+    streampps_index.built = false;
+    devices_index.built = false;
+    devicepps_index.built = false;
+
+    if (getSocId() == ARRAX_SOC_ID)
+        xmlFile = USECASE_ARRAX_XML_FILE;
+    else
+        xmlFile = USECASE_XML_FILE;
+
+    xmlStatValid = (stat(xmlFile, &xmlStat) == 0);
+    if (xmlStatValid && !loadKVSnapshot(xmlFile, &xmlStat)) {
+        PAL_INFO(LOG_TAG, "KV tables loaded from snapshot %s", USECASE_KV_SNAPSHOT_FILE);
+        buildKVIndex(all_streams, streams_index);
+        buildKVIndex(all_streampps, streampps_index);
+        buildKVIndex(all_devices, devices_index);
+        buildKVIndex(all_devicepps, devicepps_index);
+        goto done;
     }
+
+    /* hash before parsing so that an update during the parse makes the snapshot stale */
+    if (xmlStatValid && getKVXmlHash(xmlFile, &xmlHash))
+        xmlStatValid = false;
+
+    PAL_INFO(LOG_TAG, "XML parsing started %s", xmlFile);
+    file = fopen(xmlFile, "r");
     if (!file) {
         PAL_ERR(LOG_TAG, "Failed to open xml");
         ret = -EINVAL;
@@ -910,6 +1213,14 @@ int PayloadBuilder::init()
             break;
     }
 
+    if (xmlStatValid)
+        storeKVSnapshot(xmlFile, &xmlStat, xmlHash);
+
+    buildKVIndex(all_streams, streams_index);
+    buildKVIndex(all_streampps, streampps_index);
+    buildKVIndex(all_devices, devices_index);
+    buildKVIndex(all_devicepps, devicepps_index);
+
 freeParser:
     XML_ParserFree(parser);
 closeFile:
@@ -943,6 +1254,28 @@ void PayloadBuilder::payloadTimestamp(std::shared_ptr<std::vector<uint8_t>>& pay
     PAL_DBG(LOG_TAG, "payload %pK size %zu", payload->data(), *size);
 }
 
+void PayloadBuilder::payloadSoftPauseParams(std::shared_ptr<std::vector<uint8_t>>& payload,
+                                            size_t *size, uint32_t moduleId)
+{
+    size_t payloadSize, padBytes;
+    struct apm_module_param_data_t* header;
+    payloadSize = sizeof(struct apm_module_param_data_t) +
+                  sizeof(struct softPauseParams);
+    padBytes = PAL_PADDING_8BYTE_ALIGN(payloadSize);
+    payload = std::make_shared<std::vector<uint8_t>>(payloadSize + padBytes);
+    if (!payload) {
+        PAL_ERR(LOG_TAG, "payload malloc failed %s", strerror(errno));
+        return;
+    }
+    header = (struct apm_module_param_data_t*)payload->data();
+    header->module_instance_id = moduleId;
+    header->param_id = PARAM_ID_SOFT_PAUSE_PARAMS;
+    header->error_code = 0x0;
+    header->param_size = payloadSize -  sizeof(struct apm_module_param_data_t);
+    *size = payloadSize + padBytes;
+    PAL_DBG(LOG_TAG, "payload %pK size %zu", payload->data(), *size);
+}
+
 int PayloadBuilder::payloadACDBTunnelParam(uint8_t **alsaPayload,
             size_t *size, uint8_t *payload,
             const std::set <std::pair<int, int>> &acdbGKVSet,
@@ -2214,8 +2547,7 @@ bool PayloadBuilder::compareSelectorPairs(
     PAL_DBG(LOG_TAG, "Enter: selector size: %zu filled_sel size: %zu",
         selector_pairs.size(), filled_selector_pairs.size());
     if (selector_pairs.size() == filled_selector_pairs.size()) {
-        std::sort(filled_selector_pairs.begin(), filled_selector_pairs.end());
-        std::sort(selector_pairs.begin(), selector_pairs.end());
+        /* both sides are kept sorted, see buildKVIndex() and findKVs() */
         result = std::equal(selector_pairs.begin(), selector_pairs.end(),
             filled_selector_pairs.begin());
         if (result) {
@@ -2247,6 +2579,66 @@ bool PayloadBuilder::findKVs(std::vector<std::pair<selector_type_t, std::string>
     std::vector<std::pair<int, int>> &keyVector)
 {
     bool found = false;
+    bool unique = false;
+    std::string key;
+    kvSelectorIndex *index = getKVIndex(any_type);
+
+    std::sort(filled_selector_pairs.begin(), filled_selector_pairs.end());
+    if (index && index->built) {
+        auto entries = index->type_entries.find(type);
+        if (entries == index->type_entries.end())
+            return false;
+
+        key = getSelectorKey(filled_selector_pairs);
+        unique = std::adjacent_find(filled_selector_pairs.begin(),
+            filled_selector_pairs.end()) == filled_selector_pairs.end();
+        for (uint32_t i : entries->second) {
+            std::vector<kvInfo> &keys_values = any_type[i].keys_values;
+            int32_t match = -1;
+
+            auto exact = index->exact_match[i].find(key);
+            if (unique && exact != index->exact_match[i].end()) {
+                /*
+                 * keys_values are ordered by selector count, so only an
+                 * entry with multi-valued selectors can be a superset
+                 * match placed ahead of the exact tuple.
+                 */
+                match = exact->second;
+                for (uint32_t j : index->multi_value[i]) {
+                    if ((int32_t)j >= match)
+                        break;
+                    if (compareSelectorPairs(keys_values[j].selector_pairs,
+                            filled_selector_pairs)) {
+                        match = j;
+                        break;
+                    }
+                }
+            } else if (!filled_selector_pairs.empty()) {
+                for (int32_t j = 0; j < keys_values.size(); j++) {
+                    if (keys_values[j].selector_pairs.size() <
+                            filled_selector_pairs.size() && unique)
+                        continue;
+                    if (compareSelectorPairs(keys_values[j].selector_pairs,
+                            filled_selector_pairs)) {
+                        match = j;
+                        break;
+                    }
+                }
+            }
+            if (match < 0)
+                continue;
+
+            for (int32_t k = 0; k < keys_values[match].kv_pairs.size(); k++) {
+                keyVector.push_back(std::make_pair(keys_values[match].kv_pairs[k].key,
+                    keys_values[match].kv_pairs[k].value));
+                PAL_INFO(LOG_TAG, "key: 0x%x value: 0x%x\n",
+                    keys_values[match].kv_pairs[k].key,
+                    keys_values[match].kv_pairs[k].value);
+            }
+            found = true;
+        }
+        return found;
+    }
 
     for (int32_t i = 0; i < any_type.size(); i++) {
         if (isIdTypeAvailable(type, any_type[i].id_type)) {
@@ -2497,8 +2889,16 @@ bool PayloadBuilder::isIdTypeAvailable(int32_t type, std::vector<int>& id_type)
 std::vector<std::string> PayloadBuilder::retrieveSelectors(int32_t type, std::vector<allKVs> &any_type)
 {
     std::vector<std::string> gkv_selectors;
+    kvSelectorIndex *index = getKVIndex(any_type);
     PAL_DBG(LOG_TAG, "Enter: size_of_all :%zu type:%d", any_type.size(), type);
 
+    if (index && index->built) {
+        auto selectors = index->type_selectors.find(type);
+        if (selectors != index->type_selectors.end())
+            gkv_selectors = selectors->second;
+        return gkv_selectors;
+    }
+
     /* looping for all keys_and_values selectors and store in the gkv_selectors */
     for (int32_t i = 0; i < any_type.size(); i++) {
          if (isIdTypeAvailable(type, any_type[i].id_type)) {
@@ -2520,6 +2920,70 @@ std::vector<std::string> PayloadBuilder::retrieveSelectors(int32_t type, std::ve
     return gkv_selectors;
 }
 
+kvSelectorIndex* PayloadBuilder::getKVIndex(std::vector<allKVs> &any_type)
+{
+    if (&any_type == &all_streams)
+        return &streams_index;
+    if (&any_type == &all_streampps)
+        return &streampps_index;
+    if (&any_type == &all_devices)
+        return &devices_index;
+    if (&any_type == &all_devicepps)
+        return &devicepps_index;
+    return NULL;
+}
+
+std::string PayloadBuilder::getSelectorKey(
+    const std::vector<std::pair<selector_type_t, std::string>> &selector_pairs)
+{
+    std::string key;
+
+    /* selector_pairs must be sorted so that equal tuples give equal keys */
+    for (auto &pair : selector_pairs) {
+        key.push_back((char)pair.first);
+        key.append(pair.second);
+        key.push_back('\0');
+    }
+    return key;
+}
+
+void PayloadBuilder::buildKVIndex(std::vector<allKVs> &any_type, kvSelectorIndex &index)
+{
+    index.built = false;
+    index.type_entries.clear();
+    index.type_selectors.clear();
+    index.exact_match.clear();
+    index.exact_match.resize(any_type.size());
+    index.multi_value.clear();
+    index.multi_value.resize(any_type.size());
+
+    for (uint32_t i = 0; i < any_type.size(); i++) {
+        for (int32_t type : any_type[i].id_type) {
+            std::vector<uint32_t> &entries = index.type_entries[type];
+            if (!entries.empty() && entries.back() == i)
+                continue;
+            entries.push_back(i);
+            for (auto &kv : any_type[i].keys_values)
+                index.type_selectors[type].insert(index.type_selectors[type].end(),
+                    kv.selector_names.begin(), kv.selector_names.end());
+        }
+        for (uint32_t j = 0; j < any_type[i].keys_values.size(); j++) {
+            kvInfo &kv = any_type[i].keys_values[j];
+
+            /* emplace keeps the first entry for a duplicated tuple */
+            index.exact_match[i].emplace(getSelectorKey(kv.selector_pairs), j);
+            if (kv.selector_pairs.size() > kv.selector_names.size())
+                index.multi_value[i].push_back(j);
+        }
+    }
+    for (auto &selectors : index.type_selectors)
+        removeDuplicateSelectors(selectors.second);
+
+    index.built = true;
+    PAL_DBG(LOG_TAG, "indexed %zu kv tables for %zu id types",
+        any_type.size(), index.type_entries.size());
+}
+
 int PayloadBuilder::populateStreamKV(Stream* s,
         std::vector <std::pair<int,int>> &keyVector)
 {
@@ -34,6 +34,7 @@
 #include "Stream.h"
 #include "ResourceManager.h"
 #include "media_fmt_api.h"
+#include "PalLatencyStats.h"
 #include <sstream>
 #include <mutex>
 #include <fstream>
@@ -44,7 +45,6 @@
 void eventCallback(uint32_t session_id, struct agm_event_cb_params *event_params __unused,
                   void *client_data)
 {
-    struct pal_stream_attributes sAttr;
     SessionAgm *sessAgm = NULL;
     uint32_t event_id = 0;
     void *event_data = NULL;
@@ -65,15 +65,13 @@ void eventCallback(uint32_t session_id, struct agm_event_cb_params *event_params
     }
 
     PAL_VERBOSE(LOG_TAG, "event_callback session id %d event id %d", session_id, event_params->event_id);
-    sessAgm->streamHandle->getStreamAttributes(&sAttr);
 
     if (event_params->event_id == AGM_EVENT_READ_DONE ||
         event_params->event_id == AGM_EVENT_WRITE_DONE) {
 
-        rw_done_payload = (struct pal_event_read_write_done_payload *) calloc(1,
-                                     sizeof(struct pal_event_read_write_done_payload));
-        if(!rw_done_payload){
-            PAL_ERR(LOG_TAG, "Calloc allocation failed for rw_done_payload");
+        rw_done_payload = sessAgm->acquireEventPayload();
+        if (!rw_done_payload) {
+            PAL_ERR(LOG_TAG, "failed to get rw_done_payload");
             goto done;
         }
 
@@ -94,13 +92,7 @@ void eventCallback(uint32_t session_id, struct agm_event_cb_params *event_params
         rw_done_payload->buff.alloc_info.offset =
                                       agm_rw_done_payload->buff.alloc_info.offset;
 
-        if (sAttr.flags & PAL_STREAM_FLAG_TIMESTAMP) {
-            rw_done_payload->buff.ts = (struct timespec *)calloc(1, sizeof(struct timespec));
-
-            if(!rw_done_payload->buff.ts){
-                PAL_ERR(LOG_TAG, "Calloc allocation failed rw_done_payload buff");
-                goto done;
-            }
+        if (rw_done_payload->buff.ts) {
             rw_done_payload->buff.ts->tv_sec = agm_rw_done_payload->buff.timestamp/MICRO_SECS_PER_SEC;
             if (ULONG_MAX/MICRO_SECS_PER_SEC > rw_done_payload->buff.ts->tv_sec) {
                 rw_done_payload->buff.ts->tv_nsec = (agm_rw_done_payload->buff.timestamp -
@@ -109,9 +101,9 @@ void eventCallback(uint32_t session_id, struct agm_event_cb_params *event_params
                 rw_done_payload->buff.ts->tv_sec = 0;
                 rw_done_payload->buff.ts->tv_nsec = 0;
             }
+            PAL_VERBOSE(LOG_TAG, "tv_sec %llu", (unsigned long long)rw_done_payload->buff.ts->tv_sec);
+            PAL_VERBOSE(LOG_TAG, "tv_nsec %llu", (unsigned long long)rw_done_payload->buff.ts->tv_nsec);
         }
-        PAL_VERBOSE(LOG_TAG, "tv_sec %llu", (unsigned long long)rw_done_payload->buff.ts->tv_sec);
-        PAL_VERBOSE(LOG_TAG, "tv_nsec %llu", (unsigned long long)rw_done_payload->buff.ts->tv_nsec);
 
         if (event_params->event_id == AGM_EVENT_READ_DONE)
             event_id = PAL_STREAM_CBK_EVENT_READ_DONE;
@@ -137,16 +129,79 @@ void eventCallback(uint32_t session_id, struct agm_event_cb_params *event_params
        PAL_INFO(LOG_TAG, "no session cb registerd");
     }
 
-    if (rw_done_payload && rw_done_payload->buff.ts)
-        free(rw_done_payload->buff.ts);
-
     if (rw_done_payload)
-        free(rw_done_payload);
+        sessAgm->releaseEventPayload(rw_done_payload);
 
 done:
     return;
 }
 
+/*
+ * Read/write done payloads only live for the duration of the client
+ * callback, so they are taken from a small per session pool and returned
+ * once the callback is done. Heap allocation is only used when callbacks
+ * for more buffers than the pool holds are in flight at the same time.
+ */
+struct pal_event_read_write_done_payload* SessionAgm::acquireEventPayload()
+{
+    struct pal_event_read_write_done_payload *rw_done_payload = NULL;
+
+    eventPoolMutex.lock();
+    for (int i = 0; i < EVENT_PAYLOAD_POOL_SIZE; i++) {
+        if (!eventPool[i].inUse) {
+            eventPool[i].inUse = true;
+            rw_done_payload = &eventPool[i].payload;
+            memset(rw_done_payload, 0, sizeof(struct pal_event_read_write_done_payload));
+            if (timestampMode) {
+                memset(&eventPool[i].ts, 0, sizeof(struct timespec));
+                rw_done_payload->buff.ts = &eventPool[i].ts;
+            }
+            break;
+        }
+    }
+    eventPoolMutex.unlock();
+
+    if (rw_done_payload)
+        goto exit;
+
+    PAL_DBG(LOG_TAG, "event payload pool exhausted, allocating");
+    rw_done_payload = (struct pal_event_read_write_done_payload *) calloc(1,
+                                 sizeof(struct pal_event_read_write_done_payload));
+    if (!rw_done_payload) {
+        PAL_ERR(LOG_TAG, "Calloc allocation failed for rw_done_payload");
+        goto exit;
+    }
+
+    if (timestampMode) {
+        rw_done_payload->buff.ts = (struct timespec *)calloc(1, sizeof(struct timespec));
+        if (!rw_done_payload->buff.ts) {
+            PAL_ERR(LOG_TAG, "Calloc allocation failed rw_done_payload buff");
+            free(rw_done_payload);
+            rw_done_payload = NULL;
+        }
+    }
+
+exit:
+    return rw_done_payload;
+}
+
+void SessionAgm::releaseEventPayload(struct pal_event_read_write_done_payload *rw_done_payload)
+{
+    eventPoolMutex.lock();
+    for (int i = 0; i < EVENT_PAYLOAD_POOL_SIZE; i++) {
+        if (rw_done_payload == &eventPool[i].payload) {
+            eventPool[i].inUse = false;
+            eventPoolMutex.unlock();
+            return;
+        }
+    }
+    eventPoolMutex.unlock();
+
+    if (rw_done_payload->buff.ts)
+        free(rw_done_payload->buff.ts);
+    free(rw_done_payload);
+}
+
 int SessionAgm::getAgmCodecId(pal_audio_fmt_t fmt)
 {
     int id = -1;
@@ -234,6 +289,8 @@ SessionAgm::SessionAgm(std::shared_ptr<ResourceManager> Rm)
     this->cbCookie = 0;
     playback_started = false;
     playback_paused = false;
+    timestampMode = false;
+    memset(eventPool, 0, sizeof(eventPool));
 }
 
 SessionAgm::~SessionAgm()
@@ -243,6 +300,7 @@ SessionAgm::~SessionAgm()
 
 int SessionAgm::open(Stream * strm)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_OPEN);
     int status = -EINVAL;
     struct pal_stream_attributes sAttr;
     std::vector <std::pair<int, int>> streamKV;
@@ -262,8 +320,9 @@ int SessionAgm::open(Stream * strm)
     }
 
     audio_fmt = sAttr.out_media_config.aud_fmt_id;
+    timestampMode = (sAttr.flags & PAL_STREAM_FLAG_TIMESTAMP) ? true : false;
 
-    sessionIds = rm->allocateFrontEndIds(sAttr, 0);
+    sessionIds = rm->allocateFrontEndIds(sAttr, 0, strm);
     if (sessionIds.size() == 0) {
         PAL_ERR(LOG_TAG, "no more FE vailable");
         return -EINVAL;
@@ -371,6 +430,7 @@ exit:
 
 int SessionAgm::close(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_CLOSE);
     struct pal_stream_attributes sAttr;
     s->getStreamAttributes(&sAttr);
 
@@ -383,7 +443,7 @@ int SessionAgm::close(Stream * s)
     agm_session_close(agmSessHandle);
     PAL_DBG(LOG_TAG, "out of agmSessHandle close");
 
-    rm->freeFrontEndIds(sessionIds, sAttr, 0);
+    rm->freeFrontEndIds(sessionIds, sAttr, 0, s);
 
     return 0;
 }
@@ -422,6 +482,7 @@ exit:
 
 int SessionAgm::start(Stream * s __unused)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_START);
     int32_t status = 0;
     rm->voteSleepMonitor(s, true);
     if (agmSessHandle)
@@ -445,6 +506,7 @@ int SessionAgm::resume(Stream * s __unused)
 
 int SessionAgm::stop(Stream * s __unused)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_STOP);
     int32_t status = 0;
 
     if (agmSessHandle) {
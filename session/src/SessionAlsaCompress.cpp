@@ -35,6 +35,7 @@
 #include "ResourceManager.h"
 #include "media_fmt_api.h"
 #include "gapless_api.h"
+#include "PalLatencyStats.h"
 #include <agm/agm_api.h>
 #include <sstream>
 #include <mutex>
@@ -698,6 +699,7 @@ SessionAlsaCompress::~SessionAlsaCompress()
 
 int SessionAlsaCompress::open(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_OPEN);
     int status = -EINVAL;
     struct pal_stream_attributes sAttr;
     std::vector<std::shared_ptr<Device>> associatedDevices;
@@ -717,7 +719,7 @@ int SessionAlsaCompress::open(Stream * s)
         goto exit;
     }
 
-    compressDevIds = rm->allocateFrontEndIds(sAttr, 0);
+    compressDevIds = rm->allocateFrontEndIds(sAttr, 0, s);
     if (compressDevIds.size() == 0) {
         PAL_ERR(LOG_TAG, "no more FE vailable");
         return -EINVAL;
@@ -751,7 +753,7 @@ int SessionAlsaCompress::open(Stream * s)
             if (status) {
                 PAL_ERR(LOG_TAG, "session alsa utils open failed with %d",
                         status);
-                rm->freeFrontEndIds(compressDevIds, sAttr, 0);
+                rm->freeFrontEndIds(compressDevIds, sAttr, 0, s);
                 frontEndIdAllocated = false;
             }
             audio_fmt = sAttr.out_media_config.aud_fmt_id;
@@ -775,7 +777,7 @@ int SessionAlsaCompress::open(Stream * s)
             if (status) {
                 PAL_ERR(LOG_TAG, "session alsa utils open failed with %d",
                         status);
-                rm->freeFrontEndIds(compressDevIds, sAttr, 0);
+                rm->freeFrontEndIds(compressDevIds, sAttr, 0, s);
                 frontEndIdAllocated = false;
             }
             audio_fmt = sAttr.in_media_config.aud_fmt_id;
@@ -947,7 +949,7 @@ int SessionAlsaCompress::setTKV(Stream * s __unused, configType type, effect_pal
                 goto exit;
             }
             tagCntrlName<<stream<<compressDevIds.at(0)<<" "<<setParamTagControl;
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 status = -ENOENT;
@@ -1020,7 +1022,7 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, uint32_t tag1,
                 goto exit;
             }
             tagCntrlName << stream << compressDevIds.at(0) << " " << setParamTagControl;
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 status = -ENOENT;
@@ -1082,7 +1084,7 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, int tag)
     if (compressDevIds.size() > 0)
         beCntrlName<<stream<<compressDevIds.at(0)<<" "<<setBEControl;
 
-    ctl = mixer_get_ctl_by_name(mixer, beCntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, beCntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", beCntrlName.str().data());
         return -ENOENT;
@@ -1118,7 +1120,7 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, int tag)
             }
             //TODO: how to get the id '5'
             tagCntrlName<<stream<<compressDevIds.at(0)<<" "<<setParamTagControl;
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 return -ENOENT;
@@ -1157,7 +1159,7 @@ int SessionAlsaCompress::setConfig(Stream * s, configType type, int tag)
             status = SessionAlsaUtils::getCalMetadata(ckv, calConfig);
             //TODO: how to get the id '0'
             calCntrlName<<stream<<compressDevIds.at(0)<<" "<<setCalibrationControl;
-            ctl = mixer_get_ctl_by_name(mixer, calCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, calCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", calCntrlName.str().data());
                 return -ENOENT;
@@ -1231,6 +1233,7 @@ int SessionAlsaCompress::configureEarlyEOSDelay(void)
 
 int SessionAlsaCompress::start(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_START);
     struct compr_config compress_config;
     struct pal_stream_attributes sAttr;
     int32_t status = 0;
@@ -1491,6 +1494,7 @@ int SessionAlsaCompress::resume(Stream * s __unused)
 
 int SessionAlsaCompress::stop(Stream * s __unused)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_STOP);
     int32_t status = 0;
     size_t payload_size = 0;
     struct agm_event_reg_cfg event_cfg;
@@ -1542,6 +1546,7 @@ int SessionAlsaCompress::stop(Stream * s __unused)
 
 int SessionAlsaCompress::close(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_CLOSE);
     struct pal_stream_attributes sAttr;
     int32_t status = 0;
     std::string backendname;
@@ -1617,7 +1622,7 @@ int SessionAlsaCompress::close(Stream * s)
             status = 0;
         }
             }
-            rm->freeFrontEndIds(compressDevIds, sAttr, 0);
+            rm->freeFrontEndIds(compressDevIds, sAttr, 0, s);
             compress = NULL;
             freeCustomPayload();
             break;
@@ -1643,7 +1648,7 @@ int SessionAlsaCompress::close(Stream * s)
             }
             if (compress)
                 compress_close(compress);
-            rm->freeFrontEndIds(compressDevIds, sAttr, 0);
+            rm->freeFrontEndIds(compressDevIds, sAttr, 0, s);
             compress = NULL;
             break;
         case PAL_AUDIO_INPUT_OUTPUT:
@@ -1764,7 +1769,7 @@ struct mixer_ctl* SessionAlsaCompress::getFEMixerCtl(const char *controlName, in
 
     *device = compressDevIds.at(0);
     CntrlName << "COMPRESS" << compressDevIds.at(0) << " " << controlName;
-    ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, CntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
         return nullptr;
@@ -2052,6 +2057,14 @@ int SessionAlsaCompress::getTimestamp(struct pal_session_time *stime)
     return status;
 }
 
+int SessionAlsaCompress::getSoftPauseRampUs(uint32_t *rampUs)
+{
+    if (rxAifBackEnds.empty())
+        return -EINVAL;
+    return SessionAlsaUtils::getSoftPauseRampUs(mixer, compressDevIds,
+                                                rxAifBackEnds[0].second.data(), rampUs);
+}
+
 int SessionAlsaCompress::setECRef(Stream *s __unused, std::shared_ptr<Device> rx_dev __unused, bool is_enable __unused)
 {
     int status = 0;
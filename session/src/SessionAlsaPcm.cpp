@@ -78,6 +78,7 @@
 #include "audio_dam_buffer_api.h"
 #include "apm_api.h"
 #include "us_detect_api.h"
+#include "PalLatencyStats.h"
 #include <sys/ioctl.h>
 
 std::mutex SessionAlsaPcm::pcmLpmRefCntMtx;
@@ -119,6 +120,7 @@ int SessionAlsaPcm::prepare(Stream * s __unused)
 
 int SessionAlsaPcm::open(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_OPEN);
     int status = 0;
     struct pal_stream_attributes sAttr;
     std::vector<std::shared_ptr<Device>> associatedDevices;
@@ -159,22 +161,22 @@ int SessionAlsaPcm::open(Stream * s)
             sAttr.type == PAL_STREAM_SENSOR_PCM_DATA)
             ldir = TX_HOSTLESS;
 
-        pcmDevIds = rm->allocateFrontEndIds(sAttr, ldir);
+        pcmDevIds = rm->allocateFrontEndIds(sAttr, ldir, s);
         if (pcmDevIds.size() == 0) {
             PAL_ERR(LOG_TAG, "allocateFrontEndIds failed");
             status = -EINVAL;
             goto exit;
         }
     } else if (sAttr.direction == PAL_AUDIO_OUTPUT) {
-        pcmDevIds = rm->allocateFrontEndIds(sAttr, 0);
+        pcmDevIds = rm->allocateFrontEndIds(sAttr, 0, s);
         if (pcmDevIds.size() == 0) {
             PAL_ERR(LOG_TAG, "allocateFrontEndIds failed");
             status = -EINVAL;
             goto exit;
         }
     } else {
-        pcmDevRxIds = rm->allocateFrontEndIds(sAttr, RX_HOSTLESS);
-        pcmDevTxIds = rm->allocateFrontEndIds(sAttr, TX_HOSTLESS);
+        pcmDevRxIds = rm->allocateFrontEndIds(sAttr, RX_HOSTLESS, s);
+        pcmDevTxIds = rm->allocateFrontEndIds(sAttr, TX_HOSTLESS, s);
         if (!pcmDevRxIds.size() || !pcmDevTxIds.size()) {
             PAL_ERR(LOG_TAG, "allocateFrontEndIds failed");
             status = -EINVAL;
@@ -187,7 +189,7 @@ int SessionAlsaPcm::open(Stream * s)
             status = SessionAlsaUtils::open(s, rm, pcmDevIds, txAifBackEnds);
             if (status) {
                 PAL_ERR(LOG_TAG, "session alsa open failed with %d", status);
-                rm->freeFrontEndIds(pcmDevIds, sAttr, ldir);
+                rm->freeFrontEndIds(pcmDevIds, sAttr, ldir, s);
                 frontEndIdAllocated = false;
             }
             break;
@@ -195,12 +197,13 @@ int SessionAlsaPcm::open(Stream * s)
             status = SessionAlsaUtils::open(s, rm, pcmDevIds, rxAifBackEnds);
             if (status) {
                 PAL_ERR(LOG_TAG, "session alsa open failed with %d", status);
-                rm->freeFrontEndIds(pcmDevIds, sAttr, 0);
+                rm->freeFrontEndIds(pcmDevIds, sAttr, 0, s);
                 frontEndIdAllocated = false;
             }
             else if ((sAttr.type == PAL_STREAM_PCM_OFFLOAD) ||
                      (sAttr.type == PAL_STREAM_DEEP_BUFFER) ||
-                     (sAttr.type == PAL_STREAM_LOW_LATENCY)) {
+                     (sAttr.type == PAL_STREAM_LOW_LATENCY) ||
+                     (sAttr.type == PAL_STREAM_GENERIC)) {
                      // Register for Mixer Event callback for
                      // only playback related streams
                      status = rm->registerMixerEventCallback(pcmDevIds,
@@ -221,8 +224,8 @@ int SessionAlsaPcm::open(Stream * s)
                     rxAifBackEnds, txAifBackEnds);
             if (status) {
                 PAL_ERR(LOG_TAG, "session alsa open failed with %d", status);
-                rm->freeFrontEndIds(pcmDevRxIds, sAttr, RX_HOSTLESS);
-                rm->freeFrontEndIds(pcmDevTxIds, sAttr, TX_HOSTLESS);
+                rm->freeFrontEndIds(pcmDevRxIds, sAttr, RX_HOSTLESS, s);
+                rm->freeFrontEndIds(pcmDevTxIds, sAttr, TX_HOSTLESS, s);
                 frontEndIdAllocated = false;
             }
             break;
@@ -304,7 +307,7 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, uint32_t tag1,
                 status = -EINVAL;
                 goto exit;
             }
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 return -ENOENT;
@@ -344,7 +347,7 @@ struct mixer_ctl* SessionAlsaPcm::getFEMixerCtl(const char *controlName, int *de
 
     *device = pcmDevIds.at(0);
     CntrlName << "PCM" <<pcmDevIds.at(0) << " " << controlName;
-    ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, CntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
         return nullptr;
@@ -424,7 +427,6 @@ uint32_t SessionAlsaPcm::getMIID(const char *backendName, uint32_t tagId, uint32
         }
         device = pcmDevIds.at(0);
     }
-    /* REPLACE THIS WITH STORED INFO DURING INITIAL SETUP */
     if (backendName) {
         status = SessionAlsaUtils::getModuleInstanceId(mixer,
             device, backendName, tagId, miid);
@@ -481,7 +483,7 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, int tag)
                 beCntrlName << stream << pcmDevIds.at(0) << " " << setBEControl;
         }
 
-        ctl = mixer_get_ctl_by_name(mixer, beCntrlName.str().data());
+        ctl = SessionAlsaUtils::getMixerControl(mixer, beCntrlName.str().data());
         if (!ctl) {
             PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", beCntrlName.str().data());
             return -ENOENT;
@@ -532,7 +534,7 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, int tag)
                 goto exit;
             }
 
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 status = -ENOENT;
@@ -582,7 +584,7 @@ int SessionAlsaPcm::setConfig(Stream * s, configType type, int tag)
                 goto exit;
             }
 
-            ctl = mixer_get_ctl_by_name(mixer, calCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, calCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", calCntrlName.str().data());
                 status = -ENOENT;
@@ -699,7 +701,7 @@ int SessionAlsaPcm::setTKV(Stream * s, configType type, effect_pal_payload_t *ef
                 goto exit;
             }
 
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 status = -ENOENT;
@@ -794,6 +796,7 @@ void SessionAlsaPcm::releaseAdmFocus(Stream *s)
 
 int SessionAlsaPcm::start(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_START);
     struct pcm_config config;
     struct pal_stream_attributes sAttr;
     int32_t status = 0;
@@ -1282,7 +1285,8 @@ pcm_start:
                 }
             }
 
-            if (!status && isMixerEventCbRegd && !isPauseRegistrationDone) {
+            if (!status && isMixerEventCbRegd && !isPauseRegistrationDone &&
+                !rxAifBackEnds.empty()) {
                 // Stream supports Soft Pause and registration with RM is
                 // successful. So register for Soft pause callback from adsp.
                 payload_size = sizeof(struct agm_event_reg_cfg);
@@ -1409,6 +1413,7 @@ exit:
 
 int SessionAlsaPcm::stop(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_STOP);
     int status = 0;
     struct pal_stream_attributes sAttr;
     struct agm_event_reg_cfg event_cfg;
@@ -1548,6 +1553,7 @@ exit:
 
 int SessionAlsaPcm::close(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_CLOSE);
     int status = 0;
     struct pal_stream_attributes sAttr;
     std::string backendname;
@@ -1611,7 +1617,7 @@ int SessionAlsaPcm::close(Stream * s)
                 sAttr.type == PAL_STREAM_SENSOR_PCM_DATA)
                 ldir = TX_HOSTLESS;
 
-            rm->freeFrontEndIds(pcmDevIds, sAttr, ldir);
+            rm->freeFrontEndIds(pcmDevIds, sAttr, ldir, s);
             pcm = NULL;
             break;
         case PAL_AUDIO_OUTPUT:
@@ -1671,7 +1677,7 @@ int SessionAlsaPcm::close(Stream * s)
                     status = 0;
                 }
             }
-            rm->freeFrontEndIds(pcmDevIds, sAttr, 0);
+            rm->freeFrontEndIds(pcmDevIds, sAttr, 0, s);
             pcm = NULL;
             break;
         case PAL_AUDIO_INPUT | PAL_AUDIO_OUTPUT:
@@ -1704,8 +1710,8 @@ int SessionAlsaPcm::close(Stream * s)
                 status = errno;
                PAL_ERR(LOG_TAG, "pcm_close - tx failed %d", status);
             }
-            rm->freeFrontEndIds(pcmDevRxIds, sAttr, RX_HOSTLESS);
-            rm->freeFrontEndIds(pcmDevTxIds, sAttr, TX_HOSTLESS);
+            rm->freeFrontEndIds(pcmDevRxIds, sAttr, RX_HOSTLESS, s);
+            rm->freeFrontEndIds(pcmDevTxIds, sAttr, TX_HOSTLESS, s);
             pcmRx = NULL;
             pcmTx = NULL;
             break;
@@ -2547,7 +2553,7 @@ int SessionAlsaPcm::getParameters(Stream *s __unused, int tagId, uint32_t param_
         status = -EINVAL;
         goto exit;
     }
-    ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+    ctl = SessionAlsaUtils::getMixerControl(mixer, CntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
         status = -ENOENT;
@@ -2686,6 +2692,28 @@ int SessionAlsaPcm::flush()
     return status;
 }
 
+int SessionAlsaPcm::abortIo(Stream *s __unused)
+{
+    int status = 0;
+
+    /* drops the pcm, a blocked pcm_read/pcm_write returns with an error */
+    if (pcm) {
+        status = pcm_stop(pcm);
+        if (status)
+            PAL_ERR(LOG_TAG, "pcm_stop failed %d", status);
+    }
+
+    return status;
+}
+
+int SessionAlsaPcm::getSoftPauseRampUs(uint32_t *rampUs)
+{
+    if (rxAifBackEnds.empty())
+        return -EINVAL;
+    return SessionAlsaUtils::getSoftPauseRampUs(mixer, pcmDevIds,
+                                                rxAifBackEnds[0].second.data(), rampUs);
+}
+
 bool SessionAlsaPcm::isActive()
 {
     PAL_VERBOSE(LOG_TAG, "state = %d", mState);
@@ -2876,7 +2904,7 @@ int SessionAlsaPcm::createMmapBuffer(Stream *s, int32_t min_size_frames,
 
 
         CntrlName << stream << pcmDevIds.at(0) << " " << control;
-        ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+        ctl = SessionAlsaUtils::getMixerControl(mixer, CntrlName.str().data());
         if (!ctl) {
             PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
             status = -ENOENT;
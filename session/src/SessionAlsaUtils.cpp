@@ -35,6 +35,7 @@
 
 #include "SessionAlsaUtils.h"
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <set>
@@ -42,8 +43,10 @@
 //#include "SessionAlsaPcm.h"
 //#include "SessionAlsaCompress.h"
 #include "SessionAlsaVoice.h"
+#include "SessionGsl.h"
 #include "ResourceManager.h"
 #include "StreamSoundTrigger.h"
+#include "PalLatencyStats.h"
 #include <agm/agm_api.h>
 #include "spr_api.h"
 #include "apm_api.h"
@@ -86,6 +89,26 @@ struct agmMetaData {
         :buf(b),size(s) {}
 };
 
+std::mutex SessionAlsaUtils::mixerCtlCacheMutex;
+std::map<struct mixer *, std::unordered_map<std::string, struct mixer_ctl *>>
+    SessionAlsaUtils::mixerCtlCache;
+uint64_t SessionAlsaUtils::mixerCtlHits = 0;
+uint64_t SessionAlsaUtils::mixerCtlMisses = 0;
+uint64_t SessionAlsaUtils::mixerCtlDropped = 0;
+std::mutex SessionAlsaUtils::tagInfoCacheMutex;
+std::map<std::pair<int, std::string>, std::shared_ptr<tagModuleInfoCacheEntry>>
+    SessionAlsaUtils::tagInfoCache;
+uint64_t SessionAlsaUtils::tagInfoHits = 0;
+uint64_t SessionAlsaUtils::tagInfoMisses = 0;
+uint64_t SessionAlsaUtils::tagInfoInvalidated = 0;
+std::mutex SessionAlsaUtils::beCtlMutex;
+std::map<struct mixer_ctl *, std::vector<uint8_t>> SessionAlsaUtils::beCtlBatch;
+std::thread::id SessionAlsaUtils::beCtlBatchOwner;
+bool SessionAlsaUtils::beCtlBatchOn = false;
+uint32_t SessionAlsaUtils::beCtlBatchSkipped = 0;
+uint64_t SessionAlsaUtils::beCtlWrites = 0;
+uint64_t SessionAlsaUtils::beCtlSkipped = 0;
+
 SessionAlsaUtils::~SessionAlsaUtils()
 {
 
@@ -295,27 +318,157 @@ bool SessionAlsaUtils::isMmapUsecase(struct pal_stream_attributes sAttr)
 
 }
 
-struct mixer_ctl *SessionAlsaUtils::getStaticMixerControl(struct mixer *am, std::string name)
+struct mixer_ctl *SessionAlsaUtils::getMixerControl(struct mixer *am, const char *name)
 {
-    std::ostringstream cntrlName;
+    struct mixer_ctl *ctl = NULL;
+
+    if (!am || !name)
+        return NULL;
+
+    mixerCtlCacheMutex.lock();
+    auto mixerIt = mixerCtlCache.find(am);
+    if (mixerIt != mixerCtlCache.end()) {
+        auto ctlIt = mixerIt->second.find(name);
+        if (ctlIt != mixerIt->second.end())
+            ctl = ctlIt->second;
+    }
+    if (ctl)
+        mixerCtlHits++;
+    else
+        mixerCtlMisses++;
+    mixerCtlCacheMutex.unlock();
+    if (ctl)
+        return ctl;
+
+    /* controls are static per card, resolve each name only once */
+    ctl = mixer_get_ctl_by_name(am, name);
+    if (ctl) {
+        mixerCtlCacheMutex.lock();
+        mixerCtlCache[am][name] = ctl;
+        mixerCtlCacheMutex.unlock();
+    }
+    return ctl;
+}
+
+void SessionAlsaUtils::clearMixerControlCache()
+{
+    mixerCtlCacheMutex.lock();
+    for (auto &mixerIt : mixerCtlCache)
+        mixerCtlDropped += mixerIt.second.size();
+    mixerCtlCache.clear();
+    mixerCtlCacheMutex.unlock();
+}
+
+void SessionAlsaUtils::clearMixerControlCache(struct mixer *am)
+{
+    mixerCtlCacheMutex.lock();
+    auto mixerIt = mixerCtlCache.find(am);
+    if (mixerIt != mixerCtlCache.end()) {
+        mixerCtlDropped += mixerIt->second.size();
+        mixerCtlCache.erase(mixerIt);
+    }
+    mixerCtlCacheMutex.unlock();
+}
+
+/*
+ * Backend metadata, media format and group attributes are per backend,
+ * yet every stream connecting to a backend and every device open/start
+ * on it writes them again. While the calling thread owns a batch, a
+ * write identical to what the batch last sent on the same control is
+ * dropped. A write from any other thread forgets the control, so the
+ * batch never skips over it. The mutex is held across the write to keep
+ * the record in write order. count is in elements, as for
+ * mixer_ctl_set_array.
+ */
+int SessionAlsaUtils::setBeControl(struct mixer_ctl *ctl, const void *buf, size_t count)
+{
+    const uint8_t *data = (const uint8_t *)buf;
+    size_t size = 0;
+    bool owner = false;
+    int status = 0;
+
+    if (!ctl)
+        return -EINVAL;
 
-    cntrlName << name;
-    PAL_DBG(LOG_TAG, "mixer control name is %s", cntrlName.str().data());
+    switch (mixer_ctl_get_type(ctl)) {
+        case MIXER_CTL_TYPE_BYTE:
+            size = count;
+            break;
+        case MIXER_CTL_TYPE_INT:
+            size = count * sizeof(long);
+            break;
+        default:
+            /* not compared, always written */
+            break;
+    }
 
-    return mixer_get_ctl_by_name(am, cntrlName.str().data());
+    beCtlMutex.lock();
+    owner = size && beCtlBatchOn &&
+            beCtlBatchOwner == std::this_thread::get_id();
+    if (owner) {
+        auto it = beCtlBatch.find(ctl);
+        if (it != beCtlBatch.end() && it->second.size() == size &&
+            std::equal(it->second.begin(), it->second.end(), data)) {
+            beCtlBatchSkipped++;
+            beCtlSkipped++;
+            goto exit;
+        }
+    }
+
+    status = mixer_ctl_set_array(ctl, buf, count);
+    beCtlWrites++;
+    if (owner && !status)
+        beCtlBatch[ctl].assign(data, data + size);
+    else
+        beCtlBatch.erase(ctl);
+
+exit:
+    beCtlMutex.unlock();
+    return status;
+}
+
+void SessionAlsaUtils::beginBeControlBatch()
+{
+    beCtlMutex.lock();
+    beCtlBatch.clear();
+    beCtlBatchOwner = std::this_thread::get_id();
+    beCtlBatchOn = true;
+    beCtlBatchSkipped = 0;
+    beCtlMutex.unlock();
+}
+
+uint32_t SessionAlsaUtils::endBeControlBatch()
+{
+    uint32_t skipped = 0;
+
+    beCtlMutex.lock();
+    skipped = beCtlBatchSkipped;
+    beCtlBatch.clear();
+    beCtlBatchOwner = std::thread::id();
+    beCtlBatchOn = false;
+    beCtlBatchSkipped = 0;
+    beCtlMutex.unlock();
+
+    return skipped;
+}
+
+struct mixer_ctl *SessionAlsaUtils::getStaticMixerControl(struct mixer *am, std::string name)
+{
+    PAL_DBG(LOG_TAG, "mixer control name is %s", name.c_str());
+
+    return getMixerControl(am, name.c_str());
 }
 
 struct mixer_ctl *SessionAlsaUtils::getFeMixerControl(struct mixer *am, std::string feName,
         uint32_t idx)
 {
-    std::ostringstream cntrlName;
     struct mixer_ctl *ctl = NULL;
 
-    cntrlName << feName << feCtrlNames[idx];
-    PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
-    ctl = mixer_get_ctl_by_name(am, cntrlName.str().data());
+    feName.append(feCtrlNames[idx]);
+    PAL_DBG(LOG_TAG, "mixer control %s", feName.c_str());
+    ctl = getMixerControl(am, feName.c_str());
     if (!ctl)
-        PAL_FATAL(LOG_TAG, "invalid mixer control: %s", cntrlName.str().data());
+        PAL_FATAL(LOG_TAG, "invalid mixer control: %s", feName.c_str());
 
     return ctl;
 }
@@ -323,11 +476,9 @@ struct mixer_ctl *SessionAlsaUtils::getFeMixerControl(struct mixer *am, std::str
 struct mixer_ctl *SessionAlsaUtils::getBeMixerControl(struct mixer *am, std::string beName,
         uint32_t idx)
 {
-    std::ostringstream cntrlName;
-
-    cntrlName << beName << beCtrlNames[idx];
-    PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
-    return mixer_get_ctl_by_name(am, cntrlName.str().data());
+    beName.append(beCtrlNames[idx]);
+    PAL_DBG(LOG_TAG, "mixer control %s", beName.c_str());
+    return getMixerControl(am, beName.c_str());
 }
 
 int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManager> rmHandle,
@@ -360,6 +511,7 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
     PayloadBuilder* builder = nullptr;
 
     PAL_DBG(LOG_TAG, "Entry \n");
+    invalidateTagModuleInfo(DevIds);
 
     memset(&dAttr, 0, sizeof(pal_device));
     status = streamHandle->getStreamAttributes(&sAttr);
@@ -521,7 +673,7 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
 
         /** set mixer controls */
         if (deviceMetaData.size)
-            mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+            SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                     deviceMetaData.size);
         mixer_ctl_set_enum_by_string(feMixerCtrls[FE_CONTROL], be->second.data());
         if (streamDeviceMetaData.size) {
@@ -573,6 +725,8 @@ int SessionAlsaUtils::close(Stream * streamHandle, std::shared_ptr<ResourceManag
     struct mixer_ctl *beMetaDataMixerCtrl = nullptr;
     struct mixer *mixerHandle = nullptr;
 
+    invalidateTagModuleInfo(DevIds);
+
     status = streamHandle->getStreamAttributes(&sAttr);
     if(0 != status) {
         PAL_ERR(LOG_TAG, "getStreamAttributes Failed \n");
@@ -634,7 +788,7 @@ int SessionAlsaUtils::close(Stream * streamHandle, std::shared_ptr<ResourceManag
                 if (freeDevmeta->second == 0) {
                     PAL_INFO(LOG_TAG, "No need to free device metadata as device is still active");
                 } else {
-                    mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+                    SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                                     deviceMetaData.size);
                 }
             }
@@ -878,9 +1032,10 @@ int SessionAlsaUtils::setDeviceMetadata(std::shared_ptr<ResourceManager> rmHandl
     }
 
     if (deviceMetaData.size)
-        status = mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+        status = SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                         deviceMetaData.size);
 
+    invalidateTagModuleInfo(backEndName);
     free(deviceMetaData.buf);
     deviceMetaData.buf = nullptr;
 
@@ -944,8 +1099,8 @@ int SessionAlsaUtils::setDeviceMediaConfig(std::shared_ptr<ResourceManager> rmHa
         aif_group_atrr_config[3] = AGM_DATA_FORMAT_FIXED_POINT;
         aif_group_atrr_config[4] = rmHandle->activeGroupDevConfig->grp_dev_hwep_cfg.slot_mask;
 
-        mixer_ctl_set_array(ctl, &aif_group_atrr_config,
-                               sizeof(aif_group_atrr_config)/sizeof(aif_group_atrr_config[0]));
+        setBeControl(ctl, &aif_group_atrr_config,
+                     sizeof(aif_group_atrr_config)/sizeof(aif_group_atrr_config[0]));
         PAL_INFO(LOG_TAG, "%s rate ch fmt data_fmt slot_mask %ld %ld %ld %ld %ld\n", truncatedBeName.c_str(),
                 aif_group_atrr_config[0], aif_group_atrr_config[1], aif_group_atrr_config[2],
                 aif_group_atrr_config[3], aif_group_atrr_config[4]);
@@ -962,8 +1117,8 @@ int SessionAlsaUtils::setDeviceMediaConfig(std::shared_ptr<ResourceManager> rmHa
                      aif_media_config[0], aif_media_config[1],
                      aif_media_config[2], aif_media_config[3]);
 
-    return mixer_ctl_set_array(ctl, &aif_media_config,
-                               sizeof(aif_media_config)/sizeof(aif_media_config[0]));
+    return setBeControl(ctl, &aif_media_config,
+                        sizeof(aif_media_config)/sizeof(aif_media_config[0]));
 }
 
 int SessionAlsaUtils::getTimestamp(struct mixer *mixer, const std::vector<int> &DevIds,
@@ -991,7 +1146,7 @@ int SessionAlsaUtils::getTimestamp(struct mixer *mixer, const std::vector<int> &
         return -EINVAL;
     }
     CntrlName<<pcmDeviceName<<" "<<getParamControl;
-    ctl = mixer_get_ctl_by_name(mixer, CntrlName.str().data());
+    ctl = getMixerControl(mixer, CntrlName.str().data());
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
         return -ENOENT;
@@ -1032,112 +1187,128 @@ exit:
     return status;
 }
 
-int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const char *intf_name,
-                       int tag_id, uint32_t *miid)
+/*
+ * Reads the ramp period the soft pause module of the stream graph is
+ * configured with, so pause waits match the ramp the DSP really applies.
+ */
+int SessionAlsaUtils::getSoftPauseRampUs(struct mixer *mixer, const std::vector<int> &DevIds,
+                                         const char *intf_name, uint32_t *rampUs)
 {
+    int status = 0;
+    const char *getParamControl = "getParam";
     char *pcmDeviceName = NULL;
-    char const *control = "getTaggedInfo";
-    char *mixer_str;
+    std::ostringstream CntrlName;
     struct mixer_ctl *ctl;
-    int ctl_len = 0,ret = 0, i;
-    void *payload;
-    struct gsl_tag_module_info *tag_info;
-    struct gsl_tag_module_info_entry *tag_entry;
-    int offset = 0;
+    struct softPauseParams *params;
+    std::shared_ptr<std::vector<uint8_t>> payload = nullptr;
+    size_t payloadSize = 0;
+    uint32_t miid = 0;
     std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
+    PayloadBuilder* builder = NULL;
 
-    pcmDeviceName = rm->getDeviceNameFromID(device);
-    if(!pcmDeviceName){
-        PAL_ERR(LOG_TAG, "Device name from id %d not found", device);
+    if (DevIds.size() > 0) {
+        pcmDeviceName = rm->getDeviceNameFromID(DevIds.at(0));
+    } else {
+        PAL_ERR(LOG_TAG, "DevIds size is invalid");
         return -EINVAL;
     }
 
-    ret = setStreamMetadataType(mixer, device, intf_name);
-    if (ret)
-        return ret;
-
-    ctl_len = strlen(pcmDeviceName) + 1 + strlen(control) + 1;
-    mixer_str = (char *)calloc(1, ctl_len);
-    if (!mixer_str)
-        return -ENOMEM;
+    if (!pcmDeviceName || !intf_name) {
+        PAL_ERR(LOG_TAG, "Device or interface name not found");
+        return -EINVAL;
+    }
 
-    snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
+    status = getModuleInstanceId(mixer, DevIds.at(0), intf_name, PAUSE_TAG, &miid);
+    if (status) {
+        PAL_DBG(LOG_TAG, "no soft pause module in graph, status %d", status);
+        return status;
+    }
 
-    PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    CntrlName<<pcmDeviceName<<" "<<getParamControl;
+    ctl = getMixerControl(mixer, CntrlName.str().data());
     if (!ctl) {
-        PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
-        free(mixer_str);
-        return ENOENT;
+        PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", CntrlName.str().data());
+        return -ENOENT;
     }
 
-    payload = calloc(1024, sizeof(char));
+    builder = new PayloadBuilder();
+    builder->payloadSoftPauseParams(payload, &payloadSize, miid);
     if (!payload) {
-        free(mixer_str);
-        return -ENOMEM;
+        PAL_ERR(LOG_TAG, "soft pause payload formation failed");
+        status = -EINVAL;
+        goto exit;
     }
-
-    ret = mixer_ctl_get_array(ctl, payload, 1024);
-    if (ret < 0) {
-        PAL_ERR(LOG_TAG, "Failed to mixer_ctl_get_array\n");
-        free(payload);
-        free(mixer_str);
-        return ret;
+    status = mixer_ctl_set_array(ctl, payload->data(), payloadSize);
+    if (0 != status) {
+         PAL_ERR(LOG_TAG, "Set failed status = %d", status);
+         goto exit;
     }
-    tag_info = (struct gsl_tag_module_info *)payload;
-    PAL_DBG(LOG_TAG, "num of tags associated with stream %d is %d\n", device, tag_info->num_tags);
-    ret = -1;
-    tag_entry = (struct gsl_tag_module_info_entry *)(&tag_info->tag_module_entry[0]);
-    offset = 0;
-    for (i = 0; i < tag_info->num_tags; i++) {
-        tag_entry += offset/sizeof(struct gsl_tag_module_info_entry);
-
-        PAL_DBG(LOG_TAG, "tag id[%d] = 0x%x, num_modules = 0x%x\n", i, tag_entry->tag_id, tag_entry->num_modules);
-        offset = sizeof(struct gsl_tag_module_info_entry) + (tag_entry->num_modules * sizeof(struct gsl_module_id_info_entry));
-        if (tag_entry->tag_id == tag_id) {
-            struct gsl_module_id_info_entry *mod_info_entry;
-
-            if (tag_entry->num_modules) {
-                 mod_info_entry = &tag_entry->module_entry[0];
-                 *miid = mod_info_entry->module_iid;
-                 PAL_DBG(LOG_TAG, "MIID is 0x%x\n", *miid);
-                 ret = 0;
-                 break;
-            }
-        }
+    memset(payload->data(), 0, payloadSize);
+    status = mixer_ctl_get_array(ctl, payload->data(), payloadSize);
+    if (0 != status) {
+         PAL_ERR(LOG_TAG, "Get failed status = %d", status);
+         goto exit;
     }
-
-    if (*miid == 0) {
-         ret = -EINVAL;
-         PAL_ERR(LOG_TAG, "No matching MIID found for tag: 0x%x, error:%d", tag_id, ret);
+    params = (struct softPauseParams *)
+                     (payload->data() + sizeof(struct apm_module_param_data_t));
+    if (!params->period) {
+        status = -EINVAL;
+        goto exit;
     }
-
-    free(payload);
-    free(mixer_str);
-    return ret;
+    *rampUs = params->period * 1000;
+    PAL_DBG(LOG_TAG, "soft pause ramp %u ms, step %u us", params->period, params->step);
+exit:
+    if (builder) {
+       delete builder;
+       builder = NULL;
+    }
+    return status;
 }
 
-int SessionAlsaUtils::getTagsWithModuleInfo(struct mixer *mixer, int device, const char *intf_name,
-                                            uint8_t *payload)
+int SessionAlsaUtils::getTagModuleInfo(struct mixer *mixer, int device, const char *intf_name,
+                       std::shared_ptr<tagModuleInfoCacheEntry> &entry)
 {
     char *pcmDeviceName = NULL;
     char const *control = "getTaggedInfo";
     char *mixer_str;
     struct mixer_ctl *ctl;
-    int ctl_len = 0, ret = 0;
-    void *payload_;
-
+    int ctl_len = 0, ret = 0, i;
+    struct gsl_tag_module_info *tag_info;
+    struct gsl_tag_module_info_entry *tag_entry;
+    size_t offset = 0;
+    std::shared_ptr<tagModuleInfoCacheEntry> info = nullptr;
+    std::pair<int, std::string> key(device, intf_name);
     std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
+    uint64_t startNs = PalLatencyStats::isEnabled() ? PalLatencyStats::nowNs() : 0;
 
     pcmDeviceName = rm->getDeviceNameFromID(device);
+    if (!pcmDeviceName) {
+        PAL_ERR(LOG_TAG, "Device name from id %d not found", device);
+        return -EINVAL;
+    }
 
+    /*
+     * Tag scoped controls issued after this call rely on the backend
+     * selected here, so the selection is made even on a cache hit.
+     */
     ret = setStreamMetadataType(mixer, device, intf_name);
     if (ret)
         return ret;
 
-    if (!pcmDeviceName) {
-        PAL_ERR(LOG_TAG, "pcmDeviceName not initialized");
-        return -EINVAL;
+    tagInfoCacheMutex.lock();
+    auto it = tagInfoCache.find(key);
+    if (it != tagInfoCache.end()) {
+        entry = it->second;
+        tagInfoHits++;
+    } else {
+        tagInfoMisses++;
+    }
+    tagInfoCacheMutex.unlock();
+    if (entry) {
+        if (startNs)
+            PalLatencyStats::record(PAL_LATENCY_TAG_INFO_HIT,
+                                    PalLatencyStats::nowNs() - startNs);
+        return 0;
     }
 
     ctl_len = strlen(pcmDeviceName) + 1 + strlen(control) + 1;
@@ -1148,33 +1319,147 @@ int SessionAlsaUtils::getTagsWithModuleInfo(struct mixer *mixer, int device, con
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
         return ENOENT;
     }
 
-    payload_ = calloc(1024, sizeof(char));
-    if (!payload_) {
-        free(mixer_str);
-        return -ENOMEM;
-    }
-
-    ret = mixer_ctl_get_array(ctl, payload_, 1024);
+    info = std::make_shared<tagModuleInfoCacheEntry>();
+    info->payload.resize(TAGGED_INFO_PAYLOAD_SIZE, 0);
+    ret = mixer_ctl_get_array(ctl, info->payload.data(), TAGGED_INFO_PAYLOAD_SIZE);
     if (ret < 0) {
         PAL_ERR(LOG_TAG, "Failed to mixer_ctl_get_array\n");
-        free(payload);
         free(mixer_str);
         return ret;
     }
-    memcpy(payload, (uint8_t *)payload_, 1024);
 
-    free(payload_);
+    tag_info = (struct gsl_tag_module_info *)info->payload.data();
+    PAL_DBG(LOG_TAG, "num of tags associated with stream %d is %d\n", device, tag_info->num_tags);
+    tag_entry = (struct gsl_tag_module_info_entry *)(&tag_info->tag_module_entry[0]);
+    offset = (uint8_t *)tag_entry - info->payload.data();
+    for (i = 0; i < tag_info->num_tags; i++) {
+        if (offset + sizeof(struct gsl_tag_module_info_entry) > TAGGED_INFO_PAYLOAD_SIZE)
+            break;
+        PAL_DBG(LOG_TAG, "tag id[%d] = 0x%x, num_modules = 0x%x\n", i, tag_entry->tag_id,
+                tag_entry->num_modules);
+        /* the first tag entry listing modules wins, as in the kernel table order */
+        if (tag_entry->num_modules &&
+            info->miids.find(tag_entry->tag_id) == info->miids.end())
+            info->miids[tag_entry->tag_id] = tag_entry->module_entry[0].module_iid;
+
+        offset += sizeof(struct gsl_tag_module_info_entry) +
+                  (tag_entry->num_modules * sizeof(struct gsl_module_id_info_entry));
+        tag_entry = (struct gsl_tag_module_info_entry *)(info->payload.data() + offset);
+    }
+
+    tagInfoCacheMutex.lock();
+    tagInfoCache[key] = info;
+    tagInfoCacheMutex.unlock();
+    entry = info;
+    if (startNs)
+        PalLatencyStats::record(PAL_LATENCY_TAG_INFO_MISS,
+                                PalLatencyStats::nowNs() - startNs);
+
     free(mixer_str);
+    return 0;
+}
+
+int SessionAlsaUtils::getModuleInstanceId(struct mixer *mixer, int device, const char *intf_name,
+                       int tag_id, uint32_t *miid)
+{
+    int ret = 0;
+    std::shared_ptr<tagModuleInfoCacheEntry> entry = nullptr;
+
+    ret = getTagModuleInfo(mixer, device, intf_name, entry);
+    if (ret)
+        return ret;
+
+    auto it = entry->miids.find((uint32_t)tag_id);
+    if (it == entry->miids.end() || it->second == 0) {
+        ret = -EINVAL;
+        PAL_ERR(LOG_TAG, "No matching MIID found for tag: 0x%x, error:%d", tag_id, ret);
+        return ret;
+    }
+
+    *miid = it->second;
+    PAL_DBG(LOG_TAG, "MIID is 0x%x\n", *miid);
     return ret;
 }
 
+int SessionAlsaUtils::getTagsWithModuleInfo(struct mixer *mixer, int device, const char *intf_name,
+                                            uint8_t *payload)
+{
+    int ret = 0;
+    std::shared_ptr<tagModuleInfoCacheEntry> entry = nullptr;
+
+    ret = getTagModuleInfo(mixer, device, intf_name, entry);
+    if (ret)
+        return ret;
+
+    memcpy(payload, entry->payload.data(), TAGGED_INFO_PAYLOAD_SIZE);
+    return ret;
+}
+
+void SessionAlsaUtils::invalidateTagModuleInfo(const std::vector<int> &DevIds)
+{
+    tagInfoCacheMutex.lock();
+    for (auto it = tagInfoCache.begin(); it != tagInfoCache.end();) {
+        if (std::find(DevIds.begin(), DevIds.end(), it->first.first) != DevIds.end()) {
+            it = tagInfoCache.erase(it);
+            tagInfoInvalidated++;
+        } else
+            ++it;
+    }
+    tagInfoCacheMutex.unlock();
+}
+
+void SessionAlsaUtils::invalidateTagModuleInfo(const std::string &backEndName)
+{
+    tagInfoCacheMutex.lock();
+    for (auto it = tagInfoCache.begin(); it != tagInfoCache.end();) {
+        if (it->first.second == backEndName) {
+            it = tagInfoCache.erase(it);
+            tagInfoInvalidated++;
+        } else
+            ++it;
+    }
+    tagInfoCacheMutex.unlock();
+}
+
+void SessionAlsaUtils::invalidateTagModuleInfo()
+{
+    tagInfoCacheMutex.lock();
+    tagInfoInvalidated += tagInfoCache.size();
+    tagInfoCache.clear();
+    tagInfoCacheMutex.unlock();
+}
+
+void SessionAlsaUtils::getCacheStats(pal_param_session_cache_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    tagInfoCacheMutex.lock();
+    stats->tag_info_entries = tagInfoCache.size();
+    stats->tag_info_hits = tagInfoHits;
+    stats->tag_info_misses = tagInfoMisses;
+    stats->tag_info_invalidated = tagInfoInvalidated;
+    tagInfoCacheMutex.unlock();
+
+    mixerCtlCacheMutex.lock();
+    for (auto &mixerIt : mixerCtlCache)
+        stats->mixer_ctl_entries += mixerIt.second.size();
+    stats->mixer_ctl_hits = mixerCtlHits;
+    stats->mixer_ctl_misses = mixerCtlMisses;
+    stats->mixer_ctl_dropped = mixerCtlDropped;
+    mixerCtlCacheMutex.unlock();
+
+    beCtlMutex.lock();
+    stats->be_ctl_writes = beCtlWrites;
+    stats->be_ctl_skipped = beCtlSkipped;
+    beCtlMutex.unlock();
+}
+
 int SessionAlsaUtils::setMixerParameter(struct mixer *mixer, int device,
                                         void *payload, int size)
 {
@@ -1200,7 +1485,7 @@ int SessionAlsaUtils::setMixerParameter(struct mixer *mixer, int device,
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1236,7 +1521,7 @@ int SessionAlsaUtils::setStreamMetadataType(struct mixer *mixer, int device, con
     }
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1290,7 +1575,7 @@ int SessionAlsaUtils::registerMixerEvent(struct mixer *mixer, int device, void *
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1329,7 +1614,7 @@ int SessionAlsaUtils::setECRefPath(struct mixer *mixer, int device, const char *
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     printf("%s mixer -%s-\n", __func__, mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         printf("Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1366,7 +1651,7 @@ int SessionAlsaUtils::mixerWriteDatapathParams(struct mixer *mixer, int device,
     snprintf(mixer_str, ctl_len, "%s %s", pcmDeviceName, control);
 
     PAL_DBG(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
@@ -1421,6 +1706,8 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
         PAL_ERR(LOG_TAG, "RX and TX FE Dev Ids are empty");
         return -EINVAL;
     }
+    invalidateTagModuleInfo(RxDevIds);
+    invalidateTagModuleInfo(TxDevIds);
     status = streamHandle->getStreamAttributes(&sAttr);
     if(0 != status) {
         PAL_ERR(LOG_TAG, "getStreamAttributes Failed \n");
@@ -1646,7 +1933,7 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
         mixer_ctl_set_array(txFeMixerCtrls[FE_METADATA], (void *)streamTxMetaData.buf,
                 streamTxMetaData.size);
     if (deviceTxMetaData.size)
-        mixer_ctl_set_array(txBeMixerCtrl, (void *)deviceTxMetaData.buf,
+        SessionAlsaUtils::setBeControl(txBeMixerCtrl, (void *)deviceTxMetaData.buf,
                 deviceTxMetaData.size);
     if (streamDeviceTxMetaData.size) {
         mixer_ctl_set_enum_by_string(txFeMixerCtrls[FE_CONTROL], txBackEnds[0].second.data());
@@ -1661,7 +1948,7 @@ int SessionAlsaUtils::open(Stream * streamHandle, std::shared_ptr<ResourceManage
         mixer_ctl_set_array(rxFeMixerCtrls[FE_METADATA], (void *)streamRxMetaData.buf,
                 streamRxMetaData.size);
     if (deviceRxMetaData.size)
-        mixer_ctl_set_array(rxBeMixerCtrl, (void *)deviceRxMetaData.buf,
+        SessionAlsaUtils::setBeControl(rxBeMixerCtrl, (void *)deviceRxMetaData.buf,
                 deviceRxMetaData.size);
     if (streamDeviceRxMetaData.size) {
         mixer_ctl_set_enum_by_string(rxFeMixerCtrls[FE_CONTROL], rxBackEnds[0].second.data());
@@ -1722,6 +2009,7 @@ int SessionAlsaUtils::openDev(std::shared_ptr<ResourceManager> rmHandle,
     }
 
     PAL_DBG(LOG_TAG, "Ext EC Ref Open Dev is called");
+    invalidateTagModuleInfo(DevIds);
 
     if( DevIds.size() == 0)
     {
@@ -1767,7 +2055,7 @@ int SessionAlsaUtils::openDev(std::shared_ptr<ResourceManager> rmHandle,
 
     /** set mixer controls */
     if (deviceMetaData.size)
-        mixer_ctl_set_array(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
+        SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void *)deviceMetaData.buf,
                 deviceMetaData.size);
     mixer_ctl_set_enum_by_string(feMixerCtrls[FE_CONNECT], backEndName.data());
     deviceKV.clear();
@@ -1811,6 +2099,9 @@ int SessionAlsaUtils::close(Stream * streamHandle, std::shared_ptr<ResourceManag
     uint32_t streamDevicePropId[] = {0x08000010, 1, 0x3}; /** gsl_subgraph_platform_driver_props.xml */
     uint32_t i, rxDevNum, txDevNum;
 
+    invalidateTagModuleInfo(RxDevIds);
+    invalidateTagModuleInfo(TxDevIds);
+
     status = streamHandle->getStreamAttributes(&sAttr);
     if(0 != status) {
         PAL_ERR(LOG_TAG, "getStreamAttributes Failed \n");
@@ -1938,7 +2229,7 @@ int SessionAlsaUtils::close(Stream * streamHandle, std::shared_ptr<ResourceManag
             if (freeDevMeta->second == 0) {
                 PAL_INFO(LOG_TAG, "No need to free TX device metadata as device is still active");
             } else {
-                mixer_ctl_set_array(txBeMixerCtrl, (void *)deviceTxMetaData.buf,
+                SessionAlsaUtils::setBeControl(txBeMixerCtrl, (void *)deviceTxMetaData.buf,
                                     deviceTxMetaData.size);
             }
         }
@@ -1946,7 +2237,7 @@ int SessionAlsaUtils::close(Stream * streamHandle, std::shared_ptr<ResourceManag
             if (freeDevMeta->second == 0) {
                 PAL_INFO(LOG_TAG, "No need to free RX device metadata as device is still active");
             } else {
-                mixer_ctl_set_array(rxBeMixerCtrl, (void *)deviceRxMetaData.buf,
+                SessionAlsaUtils::setBeControl(rxBeMixerCtrl, (void *)deviceRxMetaData.buf,
                                     deviceRxMetaData.size);
             }
         }
@@ -1992,6 +2283,8 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
     int sub = 1;
     uint32_t i;
 
+    invalidateTagModuleInfo(pcmDevIds);
+
     switch (streamType) {
         case PAL_STREAM_COMPRESSED:
             disconnectCtrlName << COMPRESS_SND_DEV_NAME_PREFIX << pcmDevIds.at(0) << " disconnect";
@@ -2022,7 +2315,7 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
             break;
     }
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
-    disconnectCtrl = mixer_get_ctl_by_name(mixerHandle, disconnectCtrlName.str().data());
+    disconnectCtrl = getMixerControl(mixerHandle, disconnectCtrlName.str().data());
     if (!disconnectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", disconnectCtrlName.str().data());
         return -EINVAL;
@@ -2066,7 +2359,7 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
     if (activeStreamsDevices.size() > 1) {
         PAL_INFO(LOG_TAG, "No need to free device metadata since active streams present on device");
     } else {
-        mixer_ctl_set_array(beMetaDataMixerCtrl, (void*)deviceMetaData.buf,
+        SessionAlsaUtils::setBeControl(beMetaDataMixerCtrl, (void*)deviceMetaData.buf,
             deviceMetaData.size);
     }
 
@@ -2096,6 +2389,9 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
     struct mixer_ctl *txFeMixerCtrls[FE_MAX_NUM_MIXER_CONTROLS] = { nullptr };
     std::ostringstream txFeName;
 
+    invalidateTagModuleInfo(pcmTxDevIds);
+    invalidateTagModuleInfo(pcmRxDevIds);
+
     switch (streamType) {
          case PAL_STREAM_ULTRASOUND:
          case PAL_STREAM_LOOPBACK:
@@ -2120,7 +2416,7 @@ int SessionAlsaUtils::disconnectSessionDevice(Stream* streamHandle, pal_stream_t
             break;
     }
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
-    disconnectCtrl = mixer_get_ctl_by_name(mixerHandle, disconnectCtrlName.str().data());
+    disconnectCtrl = getMixerControl(mixerHandle, disconnectCtrlName.str().data());
     if (!disconnectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", disconnectCtrlName.str().data());
         return -EINVAL;
@@ -2150,6 +2446,8 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
     PayloadBuilder* builder = new PayloadBuilder();
     std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
 
+    invalidateTagModuleInfo(pcmDevIds);
+
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
     if (status) {
         PAL_ERR(LOG_TAG, "get mixer handle failed %d", status);
@@ -2259,7 +2557,7 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
          }
     }
 
-    connectCtrl = mixer_get_ctl_by_name(mixerHandle, connectCtrlName.str().data());
+    connectCtrl = getMixerControl(mixerHandle, connectCtrlName.str().data());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
         status = -EINVAL;
@@ -2298,6 +2596,9 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
         connectCtrlName << PCM_SND_DEV_NAME_PREFIX << pcmTxDevIds.at(0) << " connect";
     }
 
+    invalidateTagModuleInfo(pcmTxDevIds);
+    invalidateTagModuleInfo(pcmRxDevIds);
+
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
     if (status) {
         PAL_ERR(LOG_TAG, "get mixer handle failed %d", status);
@@ -2329,7 +2630,7 @@ int SessionAlsaUtils::connectSessionDevice(Session* sess, Stream* streamHandle,
         }
     }
 
-    connectCtrl = mixer_get_ctl_by_name(mixerHandle, connectCtrlName.str().data());
+    connectCtrl = getMixerControl(mixerHandle, connectCtrlName.str().data());
     if (!connectCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", connectCtrlName.str().data());
         status = -EINVAL;
@@ -2394,6 +2695,8 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     struct vsid_info vsidinfo = {};
     sidetone_mode_t sidetoneMode = SIDETONE_OFF;
 
+    invalidateTagModuleInfo(pcmDevIds);
+
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
     if (status) {
         PAL_VERBOSE(LOG_TAG, "get mixer handle failed %d", status);
@@ -2547,7 +2850,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
 
     status = rmHandle->getVirtualAudioMixer(&mixerHandle);
 
-    aifMdCtrl = mixer_get_ctl_by_name(mixerHandle, aifMdName.str().data());
+    aifMdCtrl = getMixerControl(mixerHandle, aifMdName.str().data());
     PAL_DBG(LOG_TAG, "mixer control %s", aifMdName.str().data());
     if (!aifMdCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", aifMdName.str().data());
@@ -2555,9 +2858,9 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
         goto freeMetaData;
     }
     if (deviceMetaData.size)
-        mixer_ctl_set_array(aifMdCtrl, (void *)deviceMetaData.buf, deviceMetaData.size);
+        SessionAlsaUtils::setBeControl(aifMdCtrl, (void *)deviceMetaData.buf, deviceMetaData.size);
 
-    feCtrl = mixer_get_ctl_by_name(mixerHandle, cntrlName.str().data());
+    feCtrl = getMixerControl(mixerHandle, cntrlName.str().data());
     PAL_DBG(LOG_TAG, "mixer control %s", cntrlName.str().data());
     if (!feCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", cntrlName.str().data());
@@ -2566,7 +2869,7 @@ int SessionAlsaUtils::setupSessionDevice(Stream* streamHandle, pal_stream_type_t
     }
     mixer_ctl_set_enum_by_string(feCtrl, aifBackEndsToConnect[0].second.data());
 
-    feMdCtrl = mixer_get_ctl_by_name(mixerHandle, feMdName.str().data());
+    feMdCtrl = getMixerControl(mixerHandle, feMdName.str().data());
     PAL_DBG(LOG_TAG, "mixer control %s", feMdName.str().data());
     if (!feMdCtrl) {
         PAL_ERR(LOG_TAG, "invalid mixer control: %s", feMdName.str().data());
@@ -74,6 +74,7 @@ IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <string>
 #include <agm/agm_api.h>
 #include "audio_route/audio_route.h"
+#include "PalLatencyStats.h"
 
 #define PAL_PADDING_8BYTE_ALIGN(x)  ((((x) + 7) & 7) ^ 7)
 #define MAX_VOL_INDEX 5
@@ -165,6 +166,7 @@ int SessionAlsaVoice::prepare(Stream * s __unused)
 
 int SessionAlsaVoice::open(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_OPEN);
     int status = -EINVAL;
     struct pal_stream_attributes sAttr;
     std::vector<std::shared_ptr<Device>> associatedDevices;
@@ -653,6 +655,7 @@ int SessionAlsaVoice::setTaggedSlotMask(Stream * s)
 
 int SessionAlsaVoice::start(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_START);
     struct pcm_config config;
     struct pal_stream_attributes sAttr;
     int32_t status = 0;
@@ -866,6 +869,7 @@ exit:
 
 int SessionAlsaVoice::stop(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_STOP);
     int status = 0;
     int txDevId = PAL_DEVICE_NONE;
     std::shared_ptr<Device> rxDevice = nullptr;
@@ -912,6 +916,7 @@ int SessionAlsaVoice::stop(Stream * s)
 
 int SessionAlsaVoice::close(Stream * s)
 {
+    PalLatencyScope latency(PAL_LATENCY_SESSION_CLOSE);
     int status = 0;
     struct pal_stream_attributes sAttr;
     std::string backendname;
@@ -1287,7 +1292,7 @@ int SessionAlsaVoice::payloadTaged(Stream * s, configType type, int tag,
                 goto exit;
             }
             tagCntrlName<<stream<<" "<<setParamTagControl;
-            ctl = mixer_get_ctl_by_name(mixer, tagCntrlName.str().data());
+            ctl = SessionAlsaUtils::getMixerControl(mixer, tagCntrlName.str().data());
             if (!ctl) {
                 PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", tagCntrlName.str().data());
                 return -ENOENT;
@@ -1787,7 +1792,7 @@ int SessionAlsaVoice::setVoiceMixerParameter(Stream * s, struct mixer *mixer,
     snprintf(mixer_str, ctl_len, "%s %s", stream, control);
 
     PAL_VERBOSE(LOG_TAG, "- mixer -%s-\n", mixer_str);
-    ctl = mixer_get_ctl_by_name(mixer, mixer_str);
+    ctl = SessionAlsaUtils::getMixerControl(mixer, mixer_str);
     if (!ctl) {
         PAL_ERR(LOG_TAG, "Invalid mixer control: %s\n", mixer_str);
         free(mixer_str);
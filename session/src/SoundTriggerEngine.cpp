@@ -105,7 +105,11 @@ int32_t SoundTriggerEngine::CreateBuffer(uint32_t buffer_size,
 
     PAL_DBG(LOG_TAG, "Enter");
     if (!buffer_) {
-        buffer_ = new PalRingBuffer(buffer_size);
+        /*
+         * Single writer (first stage LAB buffering) with one reader per
+         * second stage engine plus the stream, use lock free cursors.
+         */
+        buffer_ = new PalRingBuffer(buffer_size, RING_BUFFER_MODE_LOCK_FREE);
         if (!buffer_) {
             PAL_ERR(LOG_TAG, "Failed to allocate memory for ring buffer");
             status = -ENOMEM;
@@ -119,7 +123,12 @@ int32_t SoundTriggerEngine::CreateBuffer(uint32_t buffer_size,
         if (buffer_->getBufferSize() != buffer_size) {
             PAL_VERBOSE(LOG_TAG, "Resize the buffer %pK from old size: %zu to new size: %d",
                     buffer_, buffer_->getBufferSize(), buffer_size);
-            buffer_->resizeRingBuffer(buffer_size);
+            status = buffer_->resizeRingBuffer(buffer_size);
+            if (status) {
+                PAL_ERR(LOG_TAG, "Failed to resize ring buffer, status %d",
+                    status);
+                goto exit;
+            }
         }
         /* Reset the readers from existing list*/
         for (int32_t i = 0; i < reader_list.size(); i++)
@@ -128,10 +128,53 @@ void SoundTriggerEngineCapi::BufferThreadLoop(
     PAL_DBG(LOG_TAG, "Exit");
 }
 
+/*
+ * Returns ring buffer memory to process in place if the next size bytes
+ * are contiguous, otherwise copies them into copy_buff. The ring is pinned
+ * so a concurrent resize cannot free the span, caller must pass read_size
+ * to ReleaseProcessBuffer once processing is done.
+ */
+char *SoundTriggerEngineCapi::PeekProcessBuffer(char *copy_buff, size_t size,
+    int32_t *read_size)
+{
+    struct pal_ring_buffer_span span;
+
+    *read_size = 0;
+    if (reader_->pin())
+        return copy_buff;
+
+    *read_size = (int32_t)reader_->peek(size, &span);
+    if (*read_size == 0) {
+        reader_->unpin();
+        return copy_buff;
+    }
+    process_buffer_pinned_ = true;
+    if (span.size[1] == 0)
+        return span.data[0];
+
+    ar_mem_cpy(copy_buff, span.size[0], span.data[0], span.size[0]);
+    ar_mem_cpy(copy_buff + span.size[0], span.size[1], span.data[1],
+        span.size[1]);
+    return copy_buff;
+}
+
+void SoundTriggerEngineCapi::ReleaseProcessBuffer(int32_t read_size)
+{
+    if (!process_buffer_pinned_)
+        return;
+
+    if (read_size)
+        reader_->consume(read_size);
+    reader_->unpin();
+    process_buffer_pinned_ = false;
+}
+
 int32_t SoundTriggerEngineCapi::StartKeywordDetection()
 {
     int32_t status = 0;
     char *process_input_buff = nullptr;
+    char *process_buff = nullptr;
+    size_t bytes_copied = 0;
     capi_v2_err_t rc = CAPI_V2_EOK;
     capi_v2_stream_data_t *stream_input = nullptr;
     sva_result_t *result_cfg_ptr = nullptr;
@@ -238,32 +281,33 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
             if (reader_->advanceReadOffset(buffer_start_)) {
                 buffer_advanced = true;
             } else {
+                reader_->waitForDataOrExit(buffer_start_);
                 continue;
             }
         }
 
-        if (reader_->getUnreadSize() < buffer_size_)
+        if (reader_->getUnreadSize() < buffer_size_) {
+            reader_->waitForDataOrExit(buffer_size_);
             continue;
+        }
 
-        read_size = reader_->read((void*)process_input_buff, buffer_size_);
-        if (read_size == 0) {
+        process_buff = PeekProcessBuffer(process_input_buff, buffer_size_,
+            &read_size);
+        if (read_size == 0)
             continue;
-        } else if (read_size < 0) {
-            status = read_size;
-            PAL_ERR(LOG_TAG, "Failed to read from buffer, status %d", status);
-            goto exit;
-        }
+        if (process_buff == process_input_buff)
+            bytes_copied += read_size;
 
         PAL_INFO(LOG_TAG, "Processed: %u, start: %u, end: %u",
                  bytes_processed_, buffer_start_, buffer_end_);
         stream_input->bufs_num = 1;
         stream_input->buf_ptr->max_data_len = buffer_size_;
         stream_input->buf_ptr->actual_data_len = read_size;
-        stream_input->buf_ptr->data_ptr = (int8_t *)process_input_buff;
+        stream_input->buf_ptr->data_ptr = (int8_t *)process_buff;
 
         if (st_info_->GetEnableDebugDumps()) {
             ST_DBG_FILE_WRITE(keyword_detection_fd,
-                process_input_buff, read_size);
+                process_buff, read_size);
         }
 
         PAL_VERBOSE(LOG_TAG, "Calling Capi Process");
@@ -282,6 +326,8 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
             goto exit;
         }
 
+        /* release ring memory processed in place back to the writer */
+        ReleaseProcessBuffer(read_size);
         bytes_processed_ += read_size;
 
         capi_result.data_ptr = (int8_t*)result_cfg_ptr;
@@ -325,6 +371,8 @@ int32_t SoundTriggerEngineCapi::StartKeywordDetection()
     }
 
 exit:
+    /* drop the pin if processing bailed out before consuming */
+    ReleaseProcessBuffer(0);
 
     PAL_INFO(LOG_TAG, "Issuing capi_set_param for param %d",
                    SVA_ID_REINIT_ALL);
@@ -340,9 +388,10 @@ exit:
     process_end = std::chrono::steady_clock::now();
     process_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
         process_end - process_start).count();
-    PAL_INFO(LOG_TAG, "KW processing time: Bytes processed %u, Total processing "
-        "time %llums, Algo process time %llums, get result time %llums",
-        bytes_processed_, (long long)process_duration,
+    PAL_INFO(LOG_TAG, "KW processing time: Bytes processed %u, Bytes copied %zu, "
+        "Total processing time %llums, Algo process time %llums, "
+        "get result time %llums",
+        bytes_processed_, bytes_copied, (long long)process_duration,
         (long long)total_capi_process_duration,
         (long long)total_capi_get_param_duration);
     if (st_info_->GetEnableDebugDumps()) {
@@ -371,6 +420,8 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
 {
     int32_t status = 0;
     char *process_input_buff = nullptr;
+    char *process_buff = nullptr;
+    size_t bytes_copied = 0;
     capi_v2_err_t rc = CAPI_V2_EOK;
     capi_v2_stream_data_t *stream_input = nullptr;
     capi_v2_buf_t capi_uv_ptr;
@@ -511,31 +562,32 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
             if (reader_->advanceReadOffset(buffer_start_)) {
                 buffer_advanced = true;
             } else {
+                reader_->waitForDataOrExit(buffer_start_);
                 continue;
             }
         }
 
-        if (reader_->getUnreadSize() < buffer_size_)
+        if (reader_->getUnreadSize() < buffer_size_) {
+            reader_->waitForDataOrExit(buffer_size_);
             continue;
+        }
 
-        read_size = reader_->read((void*)process_input_buff, buffer_size_);
-        if (read_size == 0) {
+        process_buff = PeekProcessBuffer(process_input_buff, buffer_size_,
+            &read_size);
+        if (read_size == 0)
             continue;
-        } else if (read_size < 0) {
-            status = read_size;
-            PAL_ERR(LOG_TAG, "Failed to read from buffer, status %d", status);
-            goto exit;
-        }
+        if (process_buff == process_input_buff)
+            bytes_copied += read_size;
         PAL_INFO(LOG_TAG, "Processed: %u, start: %u, end: %u",
                  bytes_processed_, buffer_start_, buffer_end_);
         stream_input->bufs_num = 1;
         stream_input->buf_ptr->max_data_len = buffer_size_;
         stream_input->buf_ptr->actual_data_len = read_size;
-        stream_input->buf_ptr->data_ptr = (int8_t *)process_input_buff;
+        stream_input->buf_ptr->data_ptr = (int8_t *)process_buff;
 
         if (st_info_->GetEnableDebugDumps()) {
             ST_DBG_FILE_WRITE(user_verification_fd,
-                process_input_buff, read_size);
+                process_buff, read_size);
         }
 
         PAL_VERBOSE(LOG_TAG, "Calling Capi Process\n");
@@ -554,6 +606,8 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
             goto exit;
         }
 
+        /* release ring memory processed in place back to the writer */
+        ReleaseProcessBuffer(read_size);
         bytes_processed_ += read_size;
 
         capi_result.data_ptr = (int8_t*)result_cfg_ptr;
@@ -589,12 +643,14 @@ int32_t SoundTriggerEngineCapi::StartUserVerification()
     }
 
 exit:
+    ReleaseProcessBuffer(0);
     process_end = std::chrono::steady_clock::now();
     process_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
         process_end - process_start).count();
-    PAL_INFO(LOG_TAG, "UV processing time: Bytes processed %u, Total processing "
-        "time %llums, Algo process time %llums, get result time %llums",
-        bytes_processed_, (long long)process_duration,
+    PAL_INFO(LOG_TAG, "UV processing time: Bytes processed %u, Bytes copied %zu, "
+        "Total processing time %llums, Algo process time %llums, "
+        "get result time %llums",
+        bytes_processed_, bytes_copied, (long long)process_duration,
         (long long)total_capi_process_duration,
         (long long)total_capi_get_param_duration);
     if (st_info_->GetEnableDebugDumps()) {
@@ -643,6 +699,7 @@ SoundTriggerEngineCapi::SoundTriggerEngineCapi(
     engine_type_ = type;
     sm_cfg_ = sm_cfg;
     processing_started_ = false;
+    process_buffer_pinned_ = false;
     sm_data_ = nullptr;
     exit_thread_ = false;
     exit_buffering_ = false;
@@ -745,9 +802,11 @@ SoundTriggerEngineCapi::~SoundTriggerEngineCapi()
      */
     if (buffer_thread_handler_.joinable()) {
         processing_started_ = false;
+        exit_buffering_ = true;
+        if (reader_)
+            reader_->signalExit();
         std::unique_lock<std::mutex> lck(event_mutex_);
         exit_thread_ = true;
-        exit_buffering_ = true;
         cv_.notify_one();
         lck.unlock();
         buffer_thread_handler_.join();
@@ -872,6 +931,8 @@ int32_t SoundTriggerEngineCapi::StopSoundEngine()
     PAL_DBG(LOG_TAG, "Enter");
     {
         processing_started_ = false;
+        if (reader_)
+            reader_->signalExit();
         std::lock_guard<std::mutex> lck(event_mutex_);
         exit_thread_ = true;
         exit_buffering_ = true;
@@ -1072,6 +1133,8 @@ int32_t SoundTriggerEngineCapi::RestartRecognition(Stream *s __unused)
     processing_started_ = false;
     {
         exit_buffering_ = true;
+        if (reader_)
+            reader_->signalExit();
         std::lock_guard<std::mutex> event_lck(event_mutex_);
     }
     if (reader_) {
@@ -1096,6 +1159,8 @@ int32_t SoundTriggerEngineCapi::StopRecognition(Stream *s __unused)
     processing_started_ = false;
     {
         exit_buffering_ = true;
+        if (reader_)
+            reader_->signalExit();
         std::lock_guard<std::mutex> event_lck(event_mutex_);
     }
     if (reader_) {
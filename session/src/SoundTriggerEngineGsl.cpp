@@ -40,6 +40,7 @@
 #include "StreamSoundTrigger.h"
 #include "ResourceManager.h"
 #include "SoundTriggerPlatformInfo.h"
+#include "PalLatencyStats.h"
 
 // TODO: find another way to print debug logs by default
 #define ST_DBG_LOGS
@@ -227,11 +228,19 @@ int32_t SoundTriggerEngineGsl::StartBuffering(Stream *s) {
 
     std::memset(&buf, 0, sizeof(struct pal_buffer));
     buf.size = input_buf_size * input_buf_num;
-    buf.buffer = (uint8_t *)calloc(1, buf.size);
-    if (!buf.buffer) {
-        PAL_ERR(LOG_TAG, "buf.buffer allocation failed");
-        status = -ENOMEM;
-        goto exit;
+    /*
+     * Mmap data is copied straight into the ring buffer. Only the shared
+     * memory read path needs a staging buffer, session read fills a whole
+     * buf.size chunk which may straddle the ring wrap and has its dropped
+     * pre-roll bytes at the front.
+     */
+    if (mmap_buffer_size_ == 0) {
+        buf.buffer = (uint8_t *)calloc(1, buf.size);
+        if (!buf.buffer) {
+            PAL_ERR(LOG_TAG, "buf.buffer allocation failed");
+            status = -ENOMEM;
+            goto exit;
+        }
     }
 
     if (!IS_MODULE_TYPE_PDK(module_type_)) {
@@ -311,32 +320,16 @@ int32_t SoundTriggerEngineGsl::StartBuffering(Stream *s) {
                 goto exit;
             }
 
-            if (size_to_read != buf.size) {
-                buf.buffer = (uint8_t *)realloc(buf.buffer, size_to_read);
-                if (!buf.buffer) {
-                    PAL_ERR(LOG_TAG, "buf.buffer allocation failed");
-                    status = -ENOMEM;
-                    goto exit;
-                }
-                buf.size = size_to_read;
-            }
-
-            // TODO: directly write to PalRingBuffer with shared buffer pointer
-            if (read_offset + size_to_read <= mmap_buffer_size_) {
-                ar_mem_cpy(buf.buffer, size_to_read,
-                    (uint8_t *)mmap_buffer_.buffer + read_offset,
-                    size_to_read);
-                read_offset += size_to_read;
+            /* copy from mmap buffer straight into the ring buffer */
+            if (bytes_to_drop >= size_to_read) {
+                bytes_to_drop -= size_to_read;
             } else {
-                ar_mem_cpy(buf.buffer, mmap_buffer_size_ - read_offset,
-                    (uint8_t *)mmap_buffer_.buffer + read_offset,
-                    mmap_buffer_size_ - read_offset);
-                ar_mem_cpy(buf.buffer + mmap_buffer_size_ - read_offset,
-                    size_to_read + read_offset - mmap_buffer_size_,
-                    (uint8_t *)mmap_buffer_.buffer,
-                    size_to_read + read_offset - mmap_buffer_size_);
-                read_offset = size_to_read + read_offset - mmap_buffer_size_;
+                WriteMmapToRingBuffer(
+                    (read_offset + bytes_to_drop) % mmap_buffer_size_,
+                    size_to_read - bytes_to_drop, dsp_output_fd);
+                bytes_to_drop = 0;
             }
+            read_offset = (read_offset + size_to_read) % mmap_buffer_size_;
             size = size_to_read;
             PAL_VERBOSE(LOG_TAG, "read %d bytes from shared buffer", size);
             total_read_size += size;
@@ -356,8 +349,8 @@ int32_t SoundTriggerEngineGsl::StartBuffering(Stream *s) {
             total_read_size += size;
         }
         ATRACE_ASYNC_END("stEngine: lab read", (int32_t)module_type_);
-        // write data to ring buffer
-        if (size) {
+        // write data to ring buffer, mmap data is already written in place
+        if (size && mmap_buffer_size_ == 0) {
             size_t ret = 0;
             if (bytes_to_drop) {
                 if (size < bytes_to_drop) {
@@ -455,6 +448,34 @@ exit:
     return status;
 }
 
+size_t SoundTriggerEngineGsl::WriteMmapToRingBuffer(size_t offset,
+    size_t size, FILE *dump_fd) {
+    struct pal_ring_buffer_span span;
+    size_t reserved = 0;
+    size_t first_part = 0;
+    uint8_t *mmap_buf = (uint8_t *)mmap_buffer_.buffer;
+
+    reserved = buffer_->reserve(size, &span);
+    for (int i = 0; i < 2; i++) {
+        if (!span.size[i])
+            continue;
+        first_part = std::min(span.size[i], mmap_buffer_size_ - offset);
+        ar_mem_cpy((uint8_t *)span.data[i], first_part,
+            mmap_buf + offset, first_part);
+        if (span.size[i] > first_part)
+            ar_mem_cpy((uint8_t *)span.data[i] + first_part,
+                span.size[i] - first_part, mmap_buf,
+                span.size[i] - first_part);
+        if (st_info_->GetEnableDebugDumps()) {
+            ST_DBG_FILE_WRITE(dump_fd, span.data[i], span.size[i]);
+        }
+        offset = (offset + span.size[i]) % mmap_buffer_size_;
+    }
+
+    PAL_VERBOSE(LOG_TAG, "%zu written to ring buffer", reserved);
+    return buffer_->commit(reserved);
+}
+
 int32_t SoundTriggerEngineGsl::ParseDetectionPayloadPDK(void *event_data) {
     int32_t status = 0;
     uint32_t payload_size = 0;
@@ -1065,6 +1086,8 @@ int32_t SoundTriggerEngineGsl::MergeSoundModels(uint32_t num_models,
 
     listen_status_enum sm_ret = kSucess;
     int32_t status = 0;
+    std::string cache_key;
+    std::shared_ptr<SoundTriggerPlatformInfo> st_info = nullptr;
     std::shared_ptr<SoundModelLib>sml = SoundModelLib::GetInstance();
 
     if (!sml) {
@@ -1073,6 +1096,14 @@ int32_t SoundTriggerEngineGsl::MergeSoundModels(uint32_t num_models,
     }
 
     PAL_VERBOSE(LOG_TAG, "num_models to merge %d", num_models);
+    cache_key = SoundModelMergeCache::GetMergeKey(num_models, in_models);
+    if (!SoundModelMergeCache::Get(cache_key, num_models, in_models,
+                                   out_model)) {
+        PAL_INFO(LOG_TAG, "merged sound model size %d reused from cache",
+            out_model->size);
+        goto dump;
+    }
+
     sm_ret = sml->GetMergedModelSize_(num_models, in_models,
         &out_model->size);
     if ((sm_ret != kSucess) || !out_model->size) {
@@ -1100,8 +1131,11 @@ int32_t SoundTriggerEngineGsl::MergeSoundModels(uint32_t num_models,
         status = -EINVAL;
         goto cleanup;
     }
+    SoundModelMergeCache::Put(cache_key, num_models, in_models, out_model);
 
-    if (st_info_->GetEnableDebugDumps()) {
+dump:
+    st_info = SoundTriggerPlatformInfo::GetInstance();
+    if (st_info && st_info->GetEnableDebugDumps()) {
         ST_DBG_DECLARE(FILE *sm_fd = NULL;
             static int sm_cnt = 0);
         ST_DBG_FILE_OPEN_WR(sm_fd, ST_DEBUG_DUMP_LOCATION,
@@ -1266,6 +1300,8 @@ int32_t SoundTriggerEngineGsl::DeleteFromMergedModel(char **keyphrases,
     listen_status_enum sm_ret = kSucess;
     uint32_t out_model_sz = 0;
     int32_t status = 0;
+    std::string cache_key;
+    std::shared_ptr<SoundTriggerPlatformInfo> st_info = nullptr;
     std::shared_ptr<SoundModelLib>sml = SoundModelLib::GetInstance();
 
     out_model->data = nullptr;
@@ -1273,6 +1309,14 @@ int32_t SoundTriggerEngineGsl::DeleteFromMergedModel(char **keyphrases,
     merge_model.data = in_model->data;
     merge_model.size = in_model->size;
 
+    cache_key = SoundModelMergeCache::GetDeleteKey(in_model, keyphrases,
+        num_keyphrases);
+    if (!SoundModelMergeCache::Get(cache_key, 1, &in_model, out_model)) {
+        PAL_INFO(LOG_TAG, "sound model size %d after delete reused from cache",
+            out_model->size);
+        goto dump;
+    }
+
     for (uint32_t i = 0; i < num_keyphrases; i++) {
         sm_ret = sml->GetSizeAfterDeleting_(&merge_model, keyphrases[i],
                                                    nullptr, &out_model_sz);
@@ -1320,12 +1364,15 @@ int32_t SoundTriggerEngineGsl::DeleteFromMergedModel(char **keyphrases,
         merge_model.data = out_model->data;
         merge_model.size = out_model->size;
     }
+    SoundModelMergeCache::Put(cache_key, 1, &in_model, out_model);
 
-    if (st_info_->GetEnableDebugDumps()) {
+dump:
+    st_info = SoundTriggerPlatformInfo::GetInstance();
+    if (st_info && st_info->GetEnableDebugDumps()) {
         ST_DBG_DECLARE(FILE *sm_fd = NULL; static int sm_cnt = 0);
         ST_DBG_FILE_OPEN_WR(sm_fd, ST_DEBUG_DUMP_LOCATION,
             "st_smlib_output_deleted_sm", "bin", sm_cnt);
-        ST_DBG_FILE_WRITE(sm_fd, merge_model.data, merge_model.size);
+        ST_DBG_FILE_WRITE(sm_fd, out_model->data, out_model->size);
         ST_DBG_FILE_CLOSE(sm_fd);
         PAL_DBG(LOG_TAG, "SM returned from SML delete stored in: st_smlib_output_deleted_sm_%d.bin",
             sm_cnt);
@@ -1554,6 +1601,7 @@ int32_t SoundTriggerEngineGsl::HandleMultiStreamLoad(Stream *s, uint8_t *data,
 
     int32_t status = 0;
     bool restore_eng_state = false;
+    PalLatencyScope latency(PAL_LATENCY_ST_MULTI_MODEL_LOAD);
 
     PAL_DBG(LOG_TAG, "Enter");
     std::unique_lock<std::mutex> lck(mutex_);
@@ -1677,6 +1725,7 @@ int32_t SoundTriggerEngineGsl::HandleMultiStreamUnload(Stream *s) {
     int32_t status = 0;
 
     bool restore_eng_state = false;
+    PalLatencyScope latency(PAL_LATENCY_ST_MULTI_MODEL_UNLOAD);
 
     PAL_DBG(LOG_TAG, "Enter");
     std::unique_lock<std::mutex> lck(mutex_);
@@ -39,6 +39,7 @@
 #include <math.h>
 #include <memory>
 #include <mutex>
+#include <atomic>
 #include <exception>
 #include <semaphore.h>
 #include <errno.h>
@@ -63,6 +64,9 @@ typedef enum {
     STREAM_STOPPED
 } stream_state_t;
 
+/* max wait for blocking data path I/O to drain on stop/close/switch */
+#define IO_QUIESCE_TIMEOUT_MS 500
+
 #define BUF_SIZE_PLAYBACK 1024
 #define BUF_SIZE_CAPTURE 960
 #define NO_OF_BUF 4
@@ -125,7 +129,7 @@ typedef enum {
 /* Soft pause has to wait for ramp period to ensure volume stepping finishes.
  * This period of time was previously consumed in elite before acknowleging
  * pause completion. But it's not the case in Gecko.
- * FIXME: load the ramp period config from acdb.
+ * Default only, volume_ramp_period_ms in resource manager config overrides it.
  */
 #define VOLUME_RAMP_PERIOD (100*1000)
 
@@ -163,10 +167,37 @@ protected:
     stream_state_t currentState;
     stream_state_t cachedState;
     uint32_t mInstanceID = 0;
-    static std::condition_variable pauseCV;
-    static std::mutex pauseMutex;
+    /* soft pause ramp completion, signalled by EVENT_ID_SOFT_PAUSE_PAUSE_COMPLETE */
+    std::condition_variable mRampCV;
+    std::mutex mRampMutex;
+    bool mRampDone = false;
+    bool mRampEventExpected = false;
+    /* soft pause ramp read from the graph on first pause, 0 until known */
+    uint32_t mSoftPauseRampUs = 0;
+    bool mSoftPauseRampQueried = false;
+    void prepareRampWait(bool eventExpected = true);
+    void waitForRampDone(uint32_t rampPeriodUs);
+    uint32_t getSoftPauseRampUs();
     bool mutexLockedbyRm = false;
     sem_t mInUse;
+    /*
+     * Blocking session read/write run without mStreamMutex. I/O is counted
+     * in with mStreamMutex held, so holding it in quiesceIo_l blocks new
+     * I/O while in flight I/O is waited on mIoMutex. quiesceIo_l returns
+     * -ETIMEDOUT after timeoutMs. Once the session is stopped abortIo_l
+     * wakes I/O still blocked in the driver before waiting again.
+     * waitIoIdle(0) waits without limit and is only for callers that
+     * dropped mStreamMutex in a state that admits no new I/O.
+     */
+    std::atomic<uint32_t> mIoInFlight{0};
+    std::atomic<uint32_t> mIoWaiters{0};
+    std::mutex mIoMutex;
+    std::condition_variable mIoIdleCV;
+    void beginIo_l();
+    void endIo();
+    int32_t waitIoIdle(uint32_t timeoutMs);
+    int32_t quiesceIo_l(uint32_t timeoutMs = IO_QUIESCE_TIMEOUT_MS);
+    int32_t abortIo_l();
     int connectToDefaultDevice(Stream* streamHandle, uint32_t dir);
 public:
     virtual ~Stream() {};
@@ -238,6 +269,7 @@ public:
          uint32_t no_of_devices, struct modifier_kv *modifiers, uint32_t no_of_modifiers);
     bool isStreamAudioOutFmtSupported(pal_audio_fmt_t format);
     int32_t getTimestamp(struct pal_session_time *stime);
+    int32_t getTimestamp_l(struct pal_session_time *stime);
     int32_t handleBTDeviceNotReady(bool& a2dpSuspend);
     int disconnectStreamDevice(Stream* streamHandle,  pal_device_id_t dev_id);
     int disconnectStreamDevice_l(Stream* streamHandle,  pal_device_id_t dev_id);
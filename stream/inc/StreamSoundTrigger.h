@@ -194,8 +194,9 @@ class StreamSoundTrigger : public Stream {
     class EngineCfg {
      public:
         EngineCfg(int32_t id, std::shared_ptr<SoundTriggerEngine> engine,
-                  void *data, int32_t size)
-            : id_(id), engine_(engine), sm_data_(data), sm_size_(size) {}
+                  std::shared_ptr<uint8_t> blob, void *data, int32_t size)
+            : id_(id), engine_(engine), sm_blob_(blob), sm_data_(data),
+              sm_size_(size) {}
 
         ~EngineCfg() {}
 
@@ -206,6 +207,7 @@ class StreamSoundTrigger : public Stream {
 
         int32_t id_;
         std::shared_ptr<SoundTriggerEngine> engine_;
+        std::shared_ptr<uint8_t> sm_blob_; // keeps sm_data_ view valid
         void *sm_data_;
         int32_t sm_size_;
     };
@@ -500,6 +502,7 @@ class StreamSoundTrigger : public Stream {
     };
 
     pal_device_id_t GetAvailCaptureDevice();
+    static std::shared_ptr<uint8_t> AllocSoundModelBlob(uint32_t size);
     std::shared_ptr<SoundTriggerEngine> HandleEngineLoad(uint8_t *sm_data,
                          int32_t sm_size, listen_model_indicator_enum type,
                          st_module_type_t module_type);
@@ -562,6 +565,7 @@ class StreamSoundTrigger : public Stream {
     std::shared_ptr<SoundTriggerEngine> gsl_engine_;
     pal_st_sound_model_type_t sound_model_type_;
     std::shared_ptr<Device> ec_rx_dev_;
+    std::shared_ptr<uint8_t> sm_blob_;
     struct pal_st_phrase_sound_model *sm_config_;
     struct pal_st_recognition_config *rec_config_;
     uint32_t recognition_mode_;
@@ -570,6 +574,7 @@ class StreamSoundTrigger : public Stream {
     pal_stream_callback callback_;
     uint64_t cookie_;
     PalRingBufferReader *reader_;
+    std::shared_ptr<uint8_t> gsl_engine_model_blob_;
     uint8_t *gsl_engine_model_;
     uint32_t gsl_engine_model_size_;
     uint8_t *gsl_conf_levels_;
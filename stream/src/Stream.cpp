@@ -79,22 +79,76 @@
 
 std::shared_ptr<ResourceManager> Stream::rm = nullptr;
 std::mutex Stream::mBaseStreamMutex;
-std::mutex Stream::pauseMutex;
-std::condition_variable Stream::pauseCV;
 
 
 void Stream::handleSoftPauseCallBack(uint64_t hdl, uint32_t event_id,
                                         void *data __unused,
                                         uint32_t event_size __unused) {
+    Stream *s = reinterpret_cast<Stream *>(hdl);
 
     PAL_DBG(LOG_TAG,"Event id %x ", event_id);
 
-    if (event_id == EVENT_ID_SOFT_PAUSE_PAUSE_COMPLETE) {
+    if (event_id == EVENT_ID_SOFT_PAUSE_PAUSE_COMPLETE && s) {
         PAL_DBG(LOG_TAG, "Pause done");
-        pauseCV.notify_all();
+        s->mRampMutex.lock();
+        s->mRampDone = true;
+        s->mRampMutex.unlock();
+        s->mRampCV.notify_all();
     }
 }
 
+/*
+ * Must be called before the command that starts the ramp is issued.
+ * eventExpected is false for ramps the DSP does not report, e.g. the
+ * device PP mute, which are then always waited for in full.
+ */
+void Stream::prepareRampWait(bool eventExpected)
+{
+    mRampMutex.lock();
+    mRampDone = false;
+    mRampEventExpected = eventExpected;
+    mRampMutex.unlock();
+}
+
+/*
+ * Returns as soon as the soft pause complete event arrives when the session
+ * registered for it, with rampPeriodUs as upper bound. Without registration
+ * there is nothing to wait on, so the full ramp period is slept.
+ */
+void Stream::waitForRampDone(uint32_t rampPeriodUs)
+{
+    if (!mRampEventExpected || !session || !session->isPauseRegistrationDone) {
+        usleep(rampPeriodUs);
+        return;
+    }
+
+    std::unique_lock<std::mutex> rampLock(mRampMutex);
+    if (!mRampCV.wait_for(rampLock, std::chrono::microseconds(rampPeriodUs),
+                          [this] { return mRampDone; }))
+        PAL_INFO(LOG_TAG, "ramp complete event not received in %u us", rampPeriodUs);
+}
+
+/*
+ * Ramp period of the soft pause module in this stream's graph, read once.
+ * Falls back to the configured volume ramp period if the graph does not
+ * report one.
+ */
+uint32_t Stream::getSoftPauseRampUs()
+{
+    uint32_t rampUs = 0;
+
+    if (!mSoftPauseRampQueried && session) {
+        mSoftPauseRampQueried = true;
+        if (!session->getSoftPauseRampUs(&rampUs) && rampUs) {
+            PAL_INFO(LOG_TAG, "soft pause ramp from graph %u us, configured %u us",
+                     rampUs, rm->getVolumeRampPeriodUs());
+            mSoftPauseRampUs = rampUs;
+        }
+    }
+
+    return mSoftPauseRampUs ? mSoftPauseRampUs : rm->getVolumeRampPeriodUs();
+}
+
 Stream* Stream::create(struct pal_stream_attributes *sAttr, struct pal_device *dAttr,
     uint32_t noOfDevices, struct modifier_kv *modifiers, uint32_t noOfModifiers)
 {
@@ -821,6 +875,26 @@ exit:
     return status;
 }
 
+/* Caller holds the stream mutex; resource manager mutex is not taken. */
+int32_t Stream::getTimestamp_l(struct pal_session_time *stime)
+{
+    int32_t status = 0;
+
+    if (!stime || !session) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Invalid session time pointer or session, status %d", status);
+        goto exit;
+    }
+    if (rm->cardState == CARD_STATUS_OFFLINE) {
+        status = -EINVAL;
+        PAL_ERR(LOG_TAG, "Sound card offline, status %d", status);
+        goto exit;
+    }
+    status = session->getTimestamp(stime);
+exit:
+    return status;
+}
+
 int32_t Stream::handleBTDeviceNotReady(bool& a2dpSuspend)
 {
     int32_t status = 0;
@@ -1030,6 +1104,14 @@ int32_t Stream::disconnectStreamDevice_l(Stream* streamHandle, pal_device_id_t d
 {
     int32_t status = 0;
 
+    /* stream keeps running, I/O is not aborted, caller retries or fails the switch */
+    status = quiesceIo_l();
+    if (status) {
+        PAL_ERR(LOG_TAG, "I/O quiesce failed %d, device %d not disconnected",
+                status, dev_id);
+        goto exit;
+    }
+
     if (currentState == STREAM_IDLE) {
         for (int i = 0; i < mDevices.size(); i++) {
             if (dev_id == mDevices[i]->getSndDeviceId()) {
@@ -1775,9 +1857,63 @@ bool Stream::checkStreamMatch(pal_device_id_t pal_device_id,
     return match;
 }
 
+void Stream::beginIo_l()
+{
+    mIoInFlight.fetch_add(1, std::memory_order_seq_cst);
+}
+
+void Stream::endIo()
+{
+    if (mIoInFlight.fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+        mIoWaiters.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lck(mIoMutex);
+        mIoIdleCV.notify_all();
+    }
+}
+
+int32_t Stream::waitIoIdle(uint32_t timeoutMs)
+{
+    int32_t status = 0;
+    std::unique_lock<std::mutex> lck(mIoMutex);
+
+    mIoWaiters.fetch_add(1, std::memory_order_seq_cst);
+    if (!timeoutMs) {
+        mIoIdleCV.wait(lck, [this] {
+            return mIoInFlight.load(std::memory_order_seq_cst) == 0; });
+    } else if (!mIoIdleCV.wait_for(lck, std::chrono::milliseconds(timeoutMs), [this] {
+            return mIoInFlight.load(std::memory_order_seq_cst) == 0; })) {
+        PAL_ERR(LOG_TAG, "%u I/O still in flight after %u ms",
+                mIoInFlight.load(), timeoutMs);
+        status = -ETIMEDOUT;
+    }
+    mIoWaiters.fetch_sub(1, std::memory_order_seq_cst);
+
+    return status;
+}
+
+int32_t Stream::quiesceIo_l(uint32_t timeoutMs)
+{
+    return waitIoIdle(timeoutMs);
+}
+
+int32_t Stream::abortIo_l()
+{
+    int32_t status = 0;
+
+    PAL_ERR(LOG_TAG, "aborting %u I/O blocked in session", mIoInFlight.load());
+    if (session) {
+        status = session->abortIo(this);
+        if (status)
+            PAL_ERR(LOG_TAG, "session abort I/O failed %d", status);
+    }
+
+    return quiesceIo_l();
+}
+
 int Stream::initStreamSmph()
 {
-    return sem_init(&mInUse, 0, 1);
+    /* posted by the last user leaving once the stream is deactivated */
+    return sem_init(&mInUse, 0, 0);
 }
 
 int Stream::deinitStreamSmph()
@@ -41,8 +41,6 @@
 #define COMPRESS_OFFLOAD_FRAGMENT_SIZE (32 * 1024)
 #define COMPRESS_OFFLOAD_NUM_FRAGMENTS 4
 
-std::condition_variable cvPause;
-
 static void handleSessionCallBack(uint64_t hdl, uint32_t event_id, void *data,
                                   uint32_t event_size)
 {
@@ -51,8 +49,7 @@ static void handleSessionCallBack(uint64_t hdl, uint32_t event_id, void *data,
 
     PAL_DBG(LOG_TAG,"Event id %x ", event_id);
     if (event_id == EVENT_ID_SOFT_PAUSE_PAUSE_COMPLETE) {
-        PAL_DBG(LOG_TAG,"Pause Done");
-        cvPause.notify_all();
+        Stream::handleSoftPauseCallBack(hdl, event_id, data, event_size);
     }
     else {
         s = reinterpret_cast<Stream *>(hdl);
@@ -728,15 +725,17 @@ int32_t StreamCompress::setParameters(uint32_t param_id, void *payload)
             if (NULL != session) {
                 /* To avoid pop while switching channels, it is required to mute
                    the playback first and then swap the channel and unmute */
+                prepareRampWait(false);
                 setConfigStatus = session->setConfig(this, MODULE, DEVICEPP_MUTE);
                 if (setConfigStatus) {
                     PAL_INFO(LOG_TAG, "DevicePP Mute failed");
                 }
-                usleep(MUTE_RAMP_PERIOD); // Wait for mute to ramp down
+                waitForRampDone(MUTE_RAMP_PERIOD); // Wait for mute to ramp down
+                prepareRampWait(false);
                 status = session->setParameters(this, 0,
                                                 PAL_PARAM_ID_DEVICE_ROTATION,
                                                 payload);
-                usleep(MUTE_RAMP_PERIOD); // Wait for channel swap to take affect
+                waitForRampDone(MUTE_RAMP_PERIOD); // Wait for channel swap to take affect
                 setConfigStatus = session->setConfig(this, MODULE, DEVICEPP_UNMUTE);
                 if (setConfigStatus) {
                     PAL_INFO(LOG_TAG, "DevicePP Unmute failed");
@@ -861,7 +860,6 @@ int32_t StreamCompress::pause_l()
     struct pal_vol_ctrl_ramp_param ramp_param;
     struct pal_volume_data *voldata = NULL;
     struct pal_volume_data *volume = NULL;
-    std::unique_lock<std::mutex> pauseLock(pauseMutex);
 
     //AF will try to pause the stream during SSR.
     if (rm->cardState == CARD_STATUS_OFFLINE) {
@@ -916,16 +914,14 @@ int32_t StreamCompress::pause_l()
         volume = NULL;
         voldata = NULL;
 
+        prepareRampWait();
         status = session->setConfig(this, MODULE, PAUSE_TAG);
         if (0 != status) {
             PAL_ERR(LOG_TAG,"session setConfig for pause failed with status %d",status);
             goto exit;
         }
         PAL_DBG(LOG_TAG, "Waiting for Pause to complete");
-        if (session->isPauseRegistrationDone)
-            cvPause.wait_for(pauseLock, std::chrono::microseconds(VOLUME_RAMP_PERIOD));
-        else
-            usleep(VOLUME_RAMP_PERIOD);
+        waitForRampDone(getSoftPauseRampUs());
         isPaused = true;
         currentState = STREAM_PAUSED;
         PAL_VERBOSE(LOG_TAG,"session pause successful, state %d", currentState);
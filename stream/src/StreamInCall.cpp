@@ -122,6 +122,10 @@ StreamInCall::StreamInCall(const struct pal_stream_attributes *sattr, struct pal
 
     PAL_VERBOSE(LOG_TAG, "Create new Devices with no_of_devices - %d", no_of_devices);
 
+    // Register for Soft pause events
+    if (mStreamAttr->direction == PAL_AUDIO_OUTPUT)
+        session->registerCallBack(handleSoftPauseCallBack, (uint64_t)this);
+
     mStreamMutex.unlock();
     rm->registerStream(this);
     PAL_DBG(LOG_TAG, "Exit. state %d", currentState);
@@ -692,7 +696,6 @@ int32_t StreamInCall::mute(bool state)
 int32_t StreamInCall::pause_l()
 {
     int32_t status = 0;
-    std::unique_lock<std::mutex> pauseLock(pauseMutex);
     PAL_DBG(LOG_TAG, "Enter. session handle - %pK", session);
     if (rm->cardState == CARD_STATUS_OFFLINE) {
         cachedState = STREAM_PAUSED;
@@ -701,6 +704,7 @@ int32_t StreamInCall::pause_l()
         goto exit;
     }
 
+    prepareRampWait();
     status = session->setConfig(this, MODULE, PAUSE_TAG);
     if (0 != status) {
         PAL_ERR(LOG_TAG, "session setConfig for pause failed with status %d",
@@ -708,10 +712,7 @@ int32_t StreamInCall::pause_l()
         goto exit;
     }
     PAL_DBG(LOG_TAG, "Waiting for Pause to complete");
-    if (session->isPauseRegistrationDone)
-        pauseCV.wait_for(pauseLock, std::chrono::microseconds(VOLUME_RAMP_PERIOD));
-    else
-        usleep(VOLUME_RAMP_PERIOD);
+    waitForRampDone(getSoftPauseRampUs());
     isPaused = true;
     currentState = STREAM_PAUSED;
     PAL_DBG(LOG_TAG, "Exit. session setConfig successful");
@@ -302,6 +302,21 @@ int32_t  StreamPCM::close()
         mStreamMutex.lock();
     }
 
+    status = quiesceIo_l();
+    if (status)
+        status = abortIo_l();
+    if (status) {
+        /*
+         * I/O is stuck in the driver, it must be out before the session
+         * is closed. Stream is no longer started so no new I/O comes in,
+         * wait for it without holding the stream mutex.
+         */
+        PAL_ERR(LOG_TAG, "I/O quiesce failed %d, waiting without stream mutex",
+                status);
+        mStreamMutex.unlock();
+        waitIoIdle(0);
+        mStreamMutex.lock();
+    }
     rm->lockGraph();
     status = session->close(this);
     rm->unlockGraph();
@@ -729,6 +744,11 @@ int32_t StreamPCM::stop()
             PAL_ERR(LOG_TAG, "Stream type is not supported with status %d", status);
             break;
         }
+        /* session is stopped, in flight read/write return shortly */
+        if (quiesceIo_l() && abortIo_l()) {
+            PAL_ERR(LOG_TAG, "I/O still blocked in session after abort");
+            status = -ETIMEDOUT;
+        }
     } else if (currentState == STREAM_STOPPED || currentState == STREAM_IDLE) {
         PAL_INFO(LOG_TAG, "Stream is already in Stopped state %d", currentState);
         goto exit;
@@ -880,6 +900,7 @@ int32_t  StreamPCM::read(struct pal_buffer* buf)
         uint32_t sampleRate = mStreamAttr->in_media_config.sample_rate;
         struct pal_channel_info chInfo = mStreamAttr->in_media_config.ch_info;
 
+        mStreamMutex.unlock();
         streamSize = byteWidth * chInfo.channels;
         if ((streamSize == 0) || (sampleRate == 0)) {
             PAL_ERR(LOG_TAG, "stream_size= %d, srate = %d",
@@ -896,7 +917,11 @@ int32_t  StreamPCM::read(struct pal_buffer* buf)
     }
 
     if (currentState == STREAM_STARTED) {
+        /* blocking pcm read runs without stream mutex */
+        beginIo_l();
+        mStreamMutex.unlock();
         status = session->read(this, SHMEM_ENDPOINT, buf, &size);
+        endIo();
         if (0 != status) {
             PAL_ERR(LOG_TAG, "session read is failed with status %d", status);
             if (errno == -ENETRESET &&
@@ -917,15 +942,14 @@ int32_t  StreamPCM::read(struct pal_buffer* buf)
             }
         }
     } else {
+        mStreamMutex.unlock();
         PAL_ERR(LOG_TAG, "Stream not started yet, state %d", currentState);
         status = -EINVAL;
         goto exit;
     }
-    mStreamMutex.unlock();
     PAL_VERBOSE(LOG_TAG, "Exit. session read successful size - %d", size);
     return size;
 exit :
-    mStreamMutex.unlock();
     PAL_DBG(LOG_TAG, "Exit. session read failed status %d", status);
     return status;
 }
@@ -958,10 +982,10 @@ int32_t StreamPCM::write(struct pal_buffer* buf)
             status = -EINVAL;
             goto exit;
         }
+        mStreamMutex.unlock();
         size = buf->size;
         usleep((uint64_t)size * 1000000 / frameSize / sampleRate);
         PAL_DBG(LOG_TAG, "dropped buffer size - %d", size);
-        mStreamMutex.unlock();
         PAL_VERBOSE(LOG_TAG, "Exit size: %d", size);
         return size;
     }
@@ -969,8 +993,11 @@ int32_t StreamPCM::write(struct pal_buffer* buf)
     // we should allow writes to go through in Start/Pause state as well.
     if ((currentState == STREAM_STARTED) ||
         (currentState == STREAM_PAUSED) ) {
-        status = session->write(this, SHMEM_ENDPOINT, buf, &size, 0);
+        /* blocking pcm write runs without stream mutex */
+        beginIo_l();
         mStreamMutex.unlock();
+        status = session->write(this, SHMEM_ENDPOINT, buf, &size, 0);
+        endIo();
         if (0 != status) {
             PAL_ERR(LOG_TAG, "session write is failed with status %d", status);
 
@@ -1094,15 +1121,17 @@ int32_t  StreamPCM::setParameters(uint32_t param_id, void *payload)
             if (NULL != session) {
                 /* To avoid pop while switching channels, it is required to mute
                    the playback first and then swap the channel and unmute */
+                prepareRampWait(false);
                 setConfigStatus = session->setConfig(this, MODULE, DEVICEPP_MUTE);
                 if (setConfigStatus) {
                     PAL_INFO(LOG_TAG, "DevicePP Mute failed");
                 }
-                usleep(MUTE_RAMP_PERIOD); // Wait for Mute ramp down to happen
+                waitForRampDone(MUTE_RAMP_PERIOD); // Wait for Mute ramp down to happen
+                prepareRampWait(false);
                 status = session->setParameters(this, 0,
                                                 PAL_PARAM_ID_DEVICE_ROTATION,
                                                 payload);
-                usleep(MUTE_RAMP_PERIOD); // Wait for channel swap to take affect
+                waitForRampDone(MUTE_RAMP_PERIOD); // Wait for channel swap to take affect
                 setConfigStatus = session->setConfig(this, MODULE, DEVICEPP_UNMUTE);
                 if (setConfigStatus) {
                     PAL_INFO(LOG_TAG, "DevicePP Unmute failed");
@@ -1185,7 +1214,6 @@ int32_t StreamPCM::pause_l()
     struct pal_vol_ctrl_ramp_param ramp_param;
     struct pal_volume_data *voldata = NULL;
     struct pal_volume_data *volume = NULL;
-    std::unique_lock<std::mutex> pauseLock(pauseMutex);
     PAL_DBG(LOG_TAG, "Enter. session handle - %pK", session);
     if (rm->cardState == CARD_STATUS_OFFLINE) {
         cachedState = STREAM_PAUSED;
@@ -1236,6 +1264,7 @@ int32_t StreamPCM::pause_l()
         volume = NULL;
         voldata = NULL;
 
+        prepareRampWait();
         status = session->setConfig(this, MODULE, PAUSE_TAG);
         if (0 != status) {
            PAL_ERR(LOG_TAG, "session setConfig for pause failed with status %d",
@@ -1243,10 +1272,7 @@ int32_t StreamPCM::pause_l()
            goto exit;
         }
         PAL_DBG(LOG_TAG, "Waiting for Pause to complete");
-        if (session->isPauseRegistrationDone)
-            pauseCV.wait_for(pauseLock, std::chrono::microseconds(VOLUME_RAMP_PERIOD));
-        else
-            usleep(VOLUME_RAMP_PERIOD);
+        waitForRampDone(getSoftPauseRampUs());
         isPaused = true;
         currentState = STREAM_PAUSED;
         PAL_DBG(LOG_TAG, "session setConfig successful");
@@ -263,19 +263,14 @@ StreamSoundTrigger::~StreamSoundTrigger() {
     if (mStreamAttr)
         free(mStreamAttr);
 
-    if (gsl_engine_model_)
-        free(gsl_engine_model_);
-
     if (gsl_conf_levels_)
         free(gsl_conf_levels_);
 
     if (mVolumeData)
         free(mVolumeData);
 
-    if (sm_config_) {
-        free(sm_config_);
-        sm_config_ = nullptr;
-    }
+    sm_blob_.reset();
+    sm_config_ = nullptr;
 
     if (rec_config_) {
         free(rec_config_);
@@ -309,10 +304,8 @@ int32_t StreamSoundTrigger::close() {
     std::shared_ptr<StEventConfig> ev_cfg(new StUnloadEventConfig());
     status = cur_state_->ProcessEvent(ev_cfg);
 
-    if (sm_config_) {
-        free(sm_config_);
-        sm_config_ = nullptr;
-    }
+    sm_blob_.reset();
+    sm_config_ = nullptr;
 
     currentState = STREAM_IDLE;
     PAL_DBG(LOG_TAG, "Exit, status %d", status);
@@ -396,14 +389,18 @@ int32_t StreamSoundTrigger::read(struct pal_buffer* buf) {
 
     /*
      * st stream read pcm data from ringbuffer with almost no
-     * delay, sleep for some time after each read even if read
-     * fails or no enough data in ring buffer
+     * delay, wait until next buffer is available after each read
+     * if read fails or no enough data in ring buffer, bounded by
+     * one buffer duration. Sleep instead if reader is not enabled.
      */
     if (size <= 0 || reader_->getUnreadSize() < buf->size) {
         sleep_ms = (buf->size * BITS_PER_BYTE * MS_PER_SEC) /
             (sm_cfg_->GetSampleRate() * sm_cfg_->GetBitWidth() *
              sm_cfg_->GetOutChannels());
-        std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
+        if (reader_->isEnabled())
+            reader_->waitForData(buf->size, sleep_ms);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(sleep_ms));
     }
 
     PAL_VERBOSE(LOG_TAG, "Exit, read size %d", size);
@@ -994,6 +991,25 @@ void StreamSoundTrigger::CancelDelayedStop() {
     timer_wait_cond_.notify_one();
 }
 
+/*
+ * Sound models are copied once into a page aligned blob owned by the stream.
+ * Engines and the concurrency reload path keep views into it together with
+ * a reference, so no per-engine copy of (multi-MB) model data is needed.
+ */
+std::shared_ptr<uint8_t> StreamSoundTrigger::AllocSoundModelBlob(uint32_t size) {
+    void *buf = nullptr;
+    long page_size = sysconf(_SC_PAGESIZE);
+
+    if (page_size <= 0)
+        page_size = 4096;
+
+    if (posix_memalign(&buf, page_size, size) || !buf)
+        return nullptr;
+
+    memset(buf, 0, size);
+    return std::shared_ptr<uint8_t>((uint8_t *)buf, free);
+}
+
 std::shared_ptr<SoundTriggerEngine> StreamSoundTrigger::HandleEngineLoad(
     uint8_t *sm_data,
     int32_t sm_size,
@@ -1018,22 +1034,13 @@ std::shared_ptr<SoundTriggerEngine> StreamSoundTrigger::HandleEngineLoad(
 
     // cache 1st stage model for currency handling
     if (type == ST_SM_ID_SVA_F_STAGE_GMM) {
-        gsl_engine_model_ = (uint8_t *)realloc(gsl_engine_model_, sm_size);
-        if (!gsl_engine_model_) {
-            PAL_ERR(LOG_TAG, "Failed to allocate memory for gsl model");
-            goto unload_model;
-        }
-        ar_mem_cpy(gsl_engine_model_, sm_size, sm_data, sm_size);
+        gsl_engine_model_blob_ = sm_blob_;
+        gsl_engine_model_ = sm_data;
         gsl_engine_model_size_ = sm_size;
     }
 
     return engine;
 
-unload_model:
-    status = engine->UnloadSoundModel(this);
-    if (status)
-        PAL_ERR(LOG_TAG, "Failed to unload sound model, status %d", status);
-
 error_exit:
     return nullptr;
 }
@@ -1117,7 +1124,6 @@ int32_t StreamSoundTrigger::LoadSoundModel(
     int32_t i = 0;
     struct pal_st_phrase_sound_model *phrase_sm = nullptr;
     struct pal_st_sound_model *common_sm = nullptr;
-    uint8_t *ptr = nullptr;
     uint8_t *sm_payload = nullptr;
     uint8_t *sm_data = nullptr;
     int32_t sm_size = 0;
@@ -1174,10 +1180,9 @@ int32_t StreamSoundTrigger::LoadSoundModel(
     }
     if ((struct pal_st_sound_model *)sm_config_ != sound_model) {
         // Cache to use during SSR and other internal events handling.
-        if (sm_config_) {
-            free(sm_config_);
-        }
-        sm_config_ = (struct pal_st_phrase_sound_model *)calloc(1, sm_size);
+        sm_blob_ = AllocSoundModelBlob(common_sm->data_offset +
+                                       common_sm->data_size);
+        sm_config_ = (struct pal_st_phrase_sound_model *)sm_blob_.get();
         if (!sm_config_) {
             PAL_ERR(LOG_TAG, "sound model config allocation failed, status %d",
                     status);
@@ -1203,6 +1208,15 @@ int32_t StreamSoundTrigger::LoadSoundModel(
             recognition_mode_ = PAL_RECOGNITION_MODE_VOICE_TRIGGER;
         }
     }
+
+    /* Parse the cached copy so that engines can keep views into it */
+    sound_model = (struct pal_st_sound_model *)sm_config_;
+    if (sound_model->type == PAL_SOUND_MODEL_TYPE_KEYPHRASE) {
+        phrase_sm = sm_config_;
+        common_sm = (struct pal_st_sound_model *)&phrase_sm->common;
+    } else {
+        common_sm = sound_model;
+    }
     GetUUID(&uuid, sound_model);
     this->sm_cfg_ = this->st_info_->GetSmConfig(uuid);
     if (!this->sm_cfg_) {
@@ -1243,32 +1257,16 @@ int32_t StreamSoundTrigger::LoadSoundModel(
                     PAL_DBG(LOG_TAG, "Module type:%d, name: %s",
                         model_type_, mStreamSelector.c_str());
                     this->mInstanceID = this->rm->getStreamInstanceID(this);
-                    sm_size = big_sm->size +
-                        sizeof(struct pal_st_phrase_sound_model);
-                    sm_data = (uint8_t *)calloc(1, sm_size);
-                    if (!sm_data) {
-                        status = -ENOMEM;
-                        PAL_ERR(LOG_TAG, "sm_data allocation failed, status %d",
-                                status);
-                        goto error_exit;
-                    }
-                    ar_mem_cpy(sm_data, sizeof(*phrase_sm),
-                                     (char *)phrase_sm, sizeof(*phrase_sm));
-                    common_sm = (struct pal_st_sound_model *)sm_data;
-                    common_sm->data_size = big_sm->size;
-                    common_sm->data_offset += sizeof(SML_GlobalHeaderType) +
+                    sm_size = big_sm->size;
+                    sm_data = (uint8_t *)sm_payload +
+                        sizeof(SML_GlobalHeaderType) +
                         sizeof(SML_HeaderTypeV3) +
                         (hdr_v3->numModels * sizeof(SML_BigSoundModelTypeV3)) +
                         big_sm->offset;
-                    ar_mem_cpy(sm_data + sizeof(*phrase_sm), big_sm->size,
-                                     (char *)phrase_sm + common_sm->data_offset,
-                                     big_sm->size);
-                    common_sm->data_offset = sizeof(*phrase_sm);
-                    common_sm = (struct pal_st_sound_model *)&phrase_sm->common;
 
                     UpdateModelId((st_module_type_t)big_sm->versionMajor);
-                    gsl_engine_ = HandleEngineLoad(sm_data + sizeof(*phrase_sm),
-                                                     big_sm->size, big_sm->type,
+                    gsl_engine_ = HandleEngineLoad(sm_data, sm_size,
+                                                   big_sm->type,
                                          (st_module_type_t)big_sm->versionMajor);
                     if (!gsl_engine_) {
                         status = -EINVAL;
@@ -1277,7 +1275,8 @@ int32_t StreamSoundTrigger::LoadSoundModel(
 
                     engine_id = static_cast<int32_t>(ST_SM_ID_SVA_F_STAGE_GMM);
                     std::shared_ptr<EngineCfg> engine_cfg(new EngineCfg(
-                       engine_id, gsl_engine_, (void *) sm_data, sm_size));
+                       engine_id, gsl_engine_, sm_blob_, (void *) sm_data,
+                       sm_size));
 
                     AddEngine(engine_cfg);
                 } else if (big_sm->type != SML_ID_SVA_S_STAGE_UBM) {
@@ -1286,18 +1285,11 @@ int32_t StreamSoundTrigger::LoadSoundModel(
                         PAL_RECOGNITION_MODE_USER_IDENTIFICATION)))
                         continue;
                     sm_size = big_sm->size;
-                    ptr = (uint8_t *)sm_payload +
+                    sm_data = (uint8_t *)sm_payload +
                         sizeof(SML_GlobalHeaderType) +
                         sizeof(SML_HeaderTypeV3) +
                         (hdr_v3->numModels * sizeof(SML_BigSoundModelTypeV3)) +
                         big_sm->offset;
-                    sm_data = (uint8_t *)calloc(1, sm_size);
-                    if (!sm_data) {
-                        status = -ENOMEM;
-                        PAL_ERR(LOG_TAG, "Failed to alloc memory for sm_data");
-                        goto error_exit;
-                    }
-                    ar_mem_cpy(sm_data, sm_size, ptr, sm_size);
 
                     engine = HandleEngineLoad(sm_data, sm_size, big_sm->type,
                                       (st_module_type_t) big_sm->versionMajor);
@@ -1313,7 +1305,7 @@ int32_t StreamSoundTrigger::LoadSoundModel(
                     }
 
                     std::shared_ptr<EngineCfg> engine_cfg(new EngineCfg(
-                       engine_id, engine, (void *)sm_data, sm_size));
+                       engine_id, engine, sm_blob_, (void *)sm_data, sm_size));
 
                     AddEngine(engine_cfg);
                 }
@@ -1324,18 +1316,8 @@ int32_t StreamSoundTrigger::LoadSoundModel(
             }
         } else {
             // Parse sound model 2.0
-            sm_size = sizeof(*phrase_sm) + common_sm->data_size;
-            sm_data = (uint8_t *)calloc(1, sm_size);
-            if (!sm_data) {
-                PAL_ERR(LOG_TAG, "Failed to allocate memory for sm_data");
-                status = -ENOMEM;
-                goto error_exit;
-            }
-            ar_mem_cpy(sm_data, sizeof(*phrase_sm),
-                             (uint8_t *)phrase_sm, sizeof(*phrase_sm));
-            ar_mem_cpy(sm_data + sizeof(*phrase_sm), common_sm->data_size,
-                             (uint8_t*)phrase_sm + common_sm->data_offset,
-                             common_sm->data_size);
+            sm_size = common_sm->data_size;
+            sm_data = sm_payload;
 
             /*
              * For third party models, get module type and name from
@@ -1355,9 +1337,8 @@ int32_t StreamSoundTrigger::LoadSoundModel(
 
             this->mInstanceID = this->rm->getStreamInstanceID(this);
 
-            gsl_engine_ = HandleEngineLoad(sm_data + sizeof(*phrase_sm),
-                                 common_sm->data_size, ST_SM_ID_SVA_F_STAGE_GMM,
-                                 model_type_);
+            gsl_engine_ = HandleEngineLoad(sm_data, sm_size,
+                                 ST_SM_ID_SVA_F_STAGE_GMM, model_type_);
             if (!gsl_engine_) {
                 status = -EINVAL;
                 goto error_exit;
@@ -1365,24 +1346,15 @@ int32_t StreamSoundTrigger::LoadSoundModel(
 
             engine_id = static_cast<int32_t>(ST_SM_ID_SVA_F_STAGE_GMM);
             std::shared_ptr<EngineCfg> engine_cfg(new EngineCfg(
-                 engine_id, gsl_engine_, (void *) sm_data, sm_size));
+                 engine_id, gsl_engine_, sm_blob_, (void *) sm_data, sm_size));
 
             AddEngine(engine_cfg);
         }
     } else {
         // handle for generic sound model
         common_sm = sound_model;
-        sm_size = sizeof(*common_sm) + common_sm->data_size;
-        sm_data = (uint8_t *)calloc(1, sm_size);
-        if (!sm_data) {
-            PAL_ERR(LOG_TAG, "Failed to allocate memory for sm_data");
-            status = -ENOMEM;
-            goto error_exit;
-        }
-        ar_mem_cpy(sm_data, sizeof(*common_sm),
-            (uint8_t *)common_sm, sizeof(*common_sm));
-        ar_mem_cpy(sm_data + sizeof(*common_sm), common_sm->data_size,
-            (uint8_t*)common_sm + common_sm->data_offset, common_sm->data_size);
+        sm_size = common_sm->data_size;
+        sm_data = (uint8_t *)common_sm + common_sm->data_offset;
         if ((!sm_cfg_->isQCVAUUID() && !sm_cfg_->isQCMDUUID())) {
             SetModelType(sm_cfg_->GetModuleType());
             this->mStreamSelector = sm_cfg_->GetModuleName();
@@ -1394,9 +1366,8 @@ int32_t StreamSoundTrigger::LoadSoundModel(
             model_type_, mStreamSelector.c_str());
         this->mInstanceID = this->rm->getStreamInstanceID(this);
 
-        gsl_engine_ = HandleEngineLoad(sm_data + sizeof(*common_sm),
-                                common_sm->data_size, ST_SM_ID_SVA_F_STAGE_GMM,
-                                model_type_);
+        gsl_engine_ = HandleEngineLoad(sm_data, sm_size,
+                                ST_SM_ID_SVA_F_STAGE_GMM, model_type_);
         if (!gsl_engine_) {
             status = -EINVAL;
             goto error_exit;
@@ -1404,7 +1375,7 @@ int32_t StreamSoundTrigger::LoadSoundModel(
 
         engine_id = static_cast<int32_t>(ST_SM_ID_SVA_F_STAGE_GMM);
         std::shared_ptr<EngineCfg> engine_cfg(new EngineCfg(
-                engine_id, gsl_engine_, (void *) sm_data, sm_size));
+                engine_id, gsl_engine_, sm_blob_, (void *) sm_data, sm_size));
 
         AddEngine(engine_cfg);
     }
@@ -1413,18 +1384,10 @@ int32_t StreamSoundTrigger::LoadSoundModel(
 
 error_exit:
     /*
-     * Free sm_data allocated for engine which fails
-     * to create or load sound model first, and then
-     * release other engines which created or loaded
-     * successfully.
+     * Release engines which created or loaded successfully,
+     * their model views go away with the sound model blob.
      */
-    if (sm_data) {
-        free(sm_data);
-    }
     for (auto &eng: engines_) {
-        if (eng->sm_data_) {
-            free(eng->sm_data_);
-        }
         eng->GetEngine()->UnloadSoundModel(this);
     }
     engines_.clear();
@@ -1437,10 +1400,8 @@ error_exit:
         delete sm_info_;
         sm_info_ = nullptr;
     }
-    if (sm_config_) {
-        free(sm_config_);
-        sm_config_ = nullptr;
-    }
+    sm_blob_.reset();
+    sm_config_ = nullptr;
 exit:
     PAL_DBG(LOG_TAG, "Exit, status %d", status);
     return status;
@@ -1497,10 +1458,9 @@ int32_t StreamSoundTrigger::UpdateSoundModel(
     }
     if ((struct pal_st_sound_model *)sm_config_ != sound_model) {
         // Cache to use during SSR and other internal events handling.
-        if (sm_config_) {
-            free(sm_config_);
-        }
-        sm_config_ = (struct pal_st_phrase_sound_model *)calloc(1, sm_size);
+        sm_blob_ = AllocSoundModelBlob(common_sm->data_offset +
+                                       common_sm->data_size);
+        sm_config_ = (struct pal_st_phrase_sound_model *)sm_blob_.get();
         if (!sm_config_) {
             PAL_ERR(LOG_TAG, "sound model config allocation failed, status %d",
                     status);
@@ -2511,7 +2471,7 @@ int32_t StreamSoundTrigger::FillConfLevels(
 
     for (auto& eng: engines_) {
         if (eng->GetEngineId() == ST_SM_ID_SVA_F_STAGE_GMM) {
-            phrase_sm = (struct pal_st_phrase_sound_model *)eng->sm_data_;
+            phrase_sm = sm_config_;
             break;
         }
     }
@@ -3095,7 +3055,6 @@ int32_t StreamSoundTrigger::StIdle::ProcessEvent(
                     PAL_ERR(LOG_TAG, "Unload engine %d failed, status %d",
                             eng->GetEngineId(), status);
                 }
-                free(eng->sm_data_);
             }
             if(st_stream_.gsl_engine_)
                 st_stream_.gsl_engine_->ResetBufferReaders(st_stream_.reader_list_);
@@ -3321,7 +3280,6 @@ int32_t StreamSoundTrigger::StLoaded::ProcessEvent(
                             eng->GetEngineId(), status);
                     status = ret;
                 }
-                free(eng->sm_data_);
             }
 
             st_stream_.gsl_engine_->ResetBufferReaders(st_stream_.reader_list_);
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * A2DP start latency with the BT codec plugin registry. A low latency
+ * stream is opened, started, stopped and closed on a connected A2DP sink
+ * repeatedly. The first start after the audio server comes up loads the
+ * codec plugin and packs the encoder config, later starts with the same
+ * codec config reuse both. Wall time of open and start is reported for
+ * the first cycle and for the rest, together with the PAL side time of
+ * the plugin open and payload pack from the API latency stats, which
+ * need vendor.audio.pal.latency_stats set. Restart the audio server
+ * before the run to see the cold numbers.
+ *
+ * Usage: A2dpStartLatencyTest [iterations]
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+#define SETTLE_US (200 * 1000)
+
+static int openStart(pal_stream_handle_t **handle, uint64_t *openNs, uint64_t *startNs)
+{
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    uint64_t start;
+    int status;
+
+    memset(&attr, 0, sizeof(attr));
+    memset(&device, 0, sizeof(device));
+    attr.type = PAL_STREAM_LOW_LATENCY;
+    attr.direction = PAL_AUDIO_OUTPUT;
+    attr.out_media_config.sample_rate = 48000;
+    attr.out_media_config.bit_width = 16;
+    attr.out_media_config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    attr.out_media_config.ch_info.channels = 2;
+    attr.out_media_config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    attr.out_media_config.ch_info.ch_map[1] = PAL_CHMAP_CHANNEL_FR;
+    device.id = PAL_DEVICE_OUT_BLUETOOTH_A2DP;
+    device.config = attr.out_media_config;
+
+    start = palTestNowNs();
+    status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, handle);
+    *openNs = palTestNowNs() - start;
+    if (status || !*handle) {
+        fprintf(stderr, "pal_stream_open on A2DP failed %d, is a sink connected?\n",
+                status);
+        return status ? status : -EINVAL;
+    }
+    start = palTestNowNs();
+    status = pal_stream_start(*handle);
+    *startNs = palTestNowNs() - start;
+    if (status) {
+        fprintf(stderr, "pal_stream_start failed %d\n", status);
+        pal_stream_close(*handle);
+        *handle = NULL;
+    }
+    return status;
+}
+
+/* PAL side plugin open and pack since the last reset */
+static void reportPayloadStats(const char *name)
+{
+    pal_param_latency_stats_t *stats = NULL;
+    const pal_latency_hist_t *hist;
+    size_t size = 0;
+    int status;
+
+    status = pal_get_param(PAL_PARAM_ID_API_LATENCY_STATS, (void **)&stats, &size, NULL);
+    if (status || !stats || size < sizeof(*stats)) {
+        fprintf(stdout, "latency stats unavailable %d\n", status);
+        free(stats);
+        return;
+    }
+    hist = &stats->hist[PAL_LATENCY_BT_CODEC_PAYLOAD];
+    if (!hist->count)
+        fprintf(stdout, "%s: no codec payload samples, set vendor.audio.pal.latency_stats\n",
+                name);
+    else
+        fprintf(stdout, "%s codec payload: n %llu avg %llu us max %llu us\n", name,
+                (unsigned long long)hist->count,
+                (unsigned long long)(hist->total_us / hist->count),
+                (unsigned long long)hist->max_us);
+    free(stats);
+    pal_set_param(PAL_PARAM_ID_API_LATENCY_STATS, NULL, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    std::vector<uint64_t> firstOpenNs, firstStartNs, openNs, startNs;
+    pal_stream_handle_t *handle = NULL;
+    uint64_t o, s;
+    int status;
+
+    pal_set_param(PAL_PARAM_ID_API_LATENCY_STATS, NULL, 0);
+    for (int i = 0; i < iterations; i++) {
+        status = openStart(&handle, &o, &s);
+        PAL_TEST_CHECK(!status, "cycle %d failed %d", i, status);
+        if (status)
+            break;
+        (i ? openNs : firstOpenNs).push_back(o);
+        (i ? startNs : firstStartNs).push_back(s);
+        usleep(SETTLE_US);
+        pal_stream_stop(handle);
+        pal_stream_close(handle);
+        handle = NULL;
+        if (!i)
+            reportPayloadStats("first start");
+        usleep(SETTLE_US);
+    }
+    palTestReportLatency("first open", firstOpenNs);
+    palTestReportLatency("first start", firstStartNs);
+    palTestReportLatency("open", openNs);
+    palTestReportLatency("start", startNs);
+    reportPayloadStats("later starts");
+    return palTestResult("A2dpStartLatencyTest");
+}
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Suspend-to-switch latency of A2DP playback. A low latency stream is
+ * played on a connected A2DP sink while PAL_PARAM_ID_BT_A2DP_SUSPENDED
+ * is toggled. The suspend call returns once the muted streams have
+ * drained and been switched to speaker or handset, so its duration is
+ * the time audio is held back. The PAL side split between the drain wait
+ * and the switch is read from the API latency stats, which need
+ * vendor.audio.pal.latency_stats set. Drained streams must be released
+ * before the old fixed delay of twice the stream latency, given in ms as
+ * the second argument (default 2 * 40 ms for low latency over A2DP).
+ *
+ * Usage: A2dpSuspendLatencyTest [iterations] [fixed delay ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+#define BUF_SIZE 3840 /* 20 ms of 48 kHz stereo 16 bit */
+#define SETTLE_US (300 * 1000)
+
+static std::atomic<bool> done(false);
+
+static pal_stream_handle_t *openA2dpPlayback()
+{
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    pal_stream_handle_t *handle = NULL;
+    int status;
+
+    memset(&attr, 0, sizeof(attr));
+    memset(&device, 0, sizeof(device));
+    attr.type = PAL_STREAM_LOW_LATENCY;
+    attr.direction = PAL_AUDIO_OUTPUT;
+    attr.out_media_config.sample_rate = 48000;
+    attr.out_media_config.bit_width = 16;
+    attr.out_media_config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    attr.out_media_config.ch_info.channels = 2;
+    attr.out_media_config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    attr.out_media_config.ch_info.ch_map[1] = PAL_CHMAP_CHANNEL_FR;
+    device.id = PAL_DEVICE_OUT_BLUETOOTH_A2DP;
+    device.config = attr.out_media_config;
+
+    status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, &handle);
+    if (status || !handle) {
+        fprintf(stderr, "pal_stream_open on A2DP failed %d, is a sink connected?\n",
+                status);
+        return NULL;
+    }
+    status = pal_stream_start(handle);
+    if (status) {
+        fprintf(stderr, "pal_stream_start failed %d\n", status);
+        pal_stream_close(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+static void writer(pal_stream_handle_t *handle)
+{
+    static uint8_t silence[BUF_SIZE];
+    struct pal_buffer buf;
+
+    while (!done.load()) {
+        memset(&buf, 0, sizeof(buf));
+        buf.buffer = silence;
+        buf.size = sizeof(silence);
+        if (pal_stream_write(handle, &buf) < 0)
+            usleep(20 * 1000);
+    }
+}
+
+static int setSuspended(bool suspended)
+{
+    pal_param_bta2dp_t param;
+
+    memset(&param, 0, sizeof(param));
+    param.a2dp_suspended = suspended;
+    return pal_set_param(PAL_PARAM_ID_BT_A2DP_SUSPENDED, (void *)&param, sizeof(param));
+}
+
+static void reportStats(uint64_t fixedDelayMs)
+{
+    pal_param_latency_stats_t *stats = NULL;
+    const pal_latency_hist_t *suspend, *drain;
+    size_t size = 0;
+    int status;
+
+    status = pal_get_param(PAL_PARAM_ID_API_LATENCY_STATS, (void **)&stats, &size, NULL);
+    if (status || !stats || size < sizeof(*stats)) {
+        fprintf(stdout, "latency stats unavailable %d\n", status);
+        free(stats);
+        return;
+    }
+    suspend = &stats->hist[PAL_LATENCY_A2DP_SUSPEND];
+    drain = &stats->hist[PAL_LATENCY_A2DP_SUSPEND_DRAIN];
+    if (!suspend->count) {
+        fprintf(stdout, "latency stats disabled, set vendor.audio.pal.latency_stats\n");
+    } else {
+        fprintf(stdout, "a2dpSuspend: n %llu avg %llu us max %llu us\n",
+                (unsigned long long)suspend->count,
+                (unsigned long long)(suspend->total_us / suspend->count),
+                (unsigned long long)suspend->max_us);
+        if (drain->count) {
+            fprintf(stdout, "drain wait: n %llu avg %llu us max %llu us\n",
+                    (unsigned long long)drain->count,
+                    (unsigned long long)(drain->total_us / drain->count),
+                    (unsigned long long)drain->max_us);
+            PAL_TEST_CHECK(drain->total_us / drain->count < fixedDelayMs * 1000,
+                           "average drain wait %llu us not below the fixed %llu ms delay",
+                           (unsigned long long)(drain->total_us / drain->count),
+                           (unsigned long long)fixedDelayMs);
+        }
+    }
+    free(stats);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    uint64_t fixedDelayMs = argc > 2 ? atoi(argv[2]) : 2 * 40;
+    std::vector<uint64_t> suspendNs, resumeNs;
+    pal_stream_handle_t *handle;
+    uint64_t start;
+    int status;
+
+    handle = openA2dpPlayback();
+    if (!handle)
+        return 1;
+    std::thread t(writer, handle);
+    usleep(SETTLE_US);
+    pal_set_param(PAL_PARAM_ID_API_LATENCY_STATS, NULL, 0);
+
+    for (int i = 0; i < iterations; i++) {
+        start = palTestNowNs();
+        status = setSuspended(true);
+        suspendNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "suspend %d failed %d", i, status);
+        usleep(SETTLE_US);
+
+        start = palTestNowNs();
+        status = setSuspended(false);
+        resumeNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "resume %d failed %d", i, status);
+        usleep(SETTLE_US);
+    }
+    palTestReportLatency("suspend to switch", suspendNs);
+    palTestReportLatency("resume", resumeNs);
+    reportStats(fixedDelayMs);
+
+    done = true;
+    t.join();
+    pal_stream_stop(handle);
+    pal_stream_close(handle);
+    return palTestResult("A2dpSuspendLatencyTest");
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Harness for ACDModelStore. Checks that the param handed out for a model
+ * under ACD_SM_FILEPATH is the complete register multi sound model param,
+ * module header and register header followed by the file contents, with
+ * the 8 byte aligned size the session sends readable. Then compares what
+ * a context enable costs on the PAL side with the param sent as is against
+ * the previous path through payloadCustomParam: the session copy made
+ * while the session is idle is included, an active session writes the
+ * param to the mixer without a copy. Reports model sized allocations and
+ * time per enable for both.
+ *
+ * Usage: ACDModelStoreTest model_bin_name [iterations]
+ */
+
+#define PAL_TEST_COUNT_ALLOCS
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "ACDModelStore.h"
+#include "PayloadBuilder.h"
+#include "apm_api.h"
+#include "detection_cmn_api.h"
+#include "PalTestUtils.h"
+
+#ifndef ACD_SM_FILEPATH
+#define ACD_SM_FILEPATH "/vendor/etc/models/acd/"
+#endif
+
+#define TEST_MODEL_UUID 0x1234
+#define TEST_MIID 0x4001
+
+/* what SessionAlsaPcm::setParameters keeps of a param while idle */
+static uint8_t *sessionCopy(uint8_t *param)
+{
+    struct apm_module_param_data_t *header = (struct apm_module_param_data_t *)param;
+    size_t size = PAL_ALIGN_8BYTE(header->param_size + sizeof(*header));
+    uint8_t *copy = (uint8_t *)calloc(1, size);
+
+    if (copy)
+        memcpy(copy, param, size);
+    return copy;
+}
+
+static bool readFile(const std::string &path, std::vector<uint8_t> &data)
+{
+    FILE *fp = fopen(path.c_str(), "rb");
+    long size;
+
+    if (!fp)
+        return false;
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data.resize(size > 0 ? size : 0);
+    if (size <= 0 || fread(data.data(), 1, size, fp) != (size_t)size) {
+        fclose(fp);
+        return false;
+    }
+    fclose(fp);
+    return true;
+}
+
+static void checkLayout(const std::string &bin, const std::vector<uint8_t> &file)
+{
+    std::shared_ptr<ACDModelPayload> model, again;
+    struct apm_module_param_data_t *header;
+    struct param_id_detection_engine_register_multi_sound_model_t *reg;
+    uint8_t *param, *copy;
+    size_t size;
+
+    PAL_TEST_CHECK(!ACDModelStore::GetModel(bin, TEST_MODEL_UUID, model) && model,
+                   "GetModel failed for %s", bin.c_str());
+    if (!model)
+        return;
+    param = model->GetParamData(TEST_MIID,
+                PARAM_ID_DETECTION_ENGINE_REGISTER_MULTI_SOUND_MODEL);
+    PAL_TEST_CHECK(((uintptr_t)param & 7) == 0, "param not 8 byte aligned");
+    header = (struct apm_module_param_data_t *)param;
+    reg = (struct param_id_detection_engine_register_multi_sound_model_t *)(header + 1);
+    PAL_TEST_CHECK(header->module_instance_id == TEST_MIID, "miid 0x%x",
+                   header->module_instance_id);
+    PAL_TEST_CHECK(header->param_id == PARAM_ID_DETECTION_ENGINE_REGISTER_MULTI_SOUND_MODEL,
+                   "param id 0x%x", header->param_id);
+    PAL_TEST_CHECK(header->error_code == 0, "error code %u", header->error_code);
+    PAL_TEST_CHECK(header->param_size == sizeof(*reg) + file.size(),
+                   "param size %u for a %zu byte model", header->param_size, file.size());
+    PAL_TEST_CHECK(reg->model_id == TEST_MODEL_UUID, "model id 0x%x", reg->model_id);
+    PAL_TEST_CHECK(reg->model_size == file.size(), "model size %u", reg->model_size);
+    PAL_TEST_CHECK(!memcmp(reg + 1, file.data(), file.size()),
+                   "model data differs from %s", bin.c_str());
+
+    /* the session reads the padded size, this faults if the tail is unmapped */
+    copy = sessionCopy(param);
+    size = PAL_ALIGN_8BYTE(header->param_size + sizeof(*header));
+    PAL_TEST_CHECK(copy && !memcmp(copy, param, size), "padded param not readable");
+    free(copy);
+
+    /* a second module instance reuses the same mapping */
+    PAL_TEST_CHECK(!ACDModelStore::GetModel(bin, TEST_MODEL_UUID, again) && again == model,
+                   "model mapped again");
+    PAL_TEST_CHECK(again->GetParamData(TEST_MIID + 1,
+                       PARAM_ID_DETECTION_ENGINE_REGISTER_MULTI_SOUND_MODEL) == param &&
+                   header->module_instance_id == TEST_MIID + 1,
+                   "miid not updated in place");
+}
+
+/* one enable on the PAL side, previous path when legacy is set */
+static bool enable(const std::string &bin, bool legacy, bool idle)
+{
+    std::shared_ptr<ACDModelPayload> model;
+    PayloadBuilder builder;
+    struct apm_module_param_data_t *header;
+    uint8_t *param, *built = nullptr, *copy = nullptr;
+    size_t len = 0;
+
+    if (ACDModelStore::GetModel(bin, TEST_MODEL_UUID, model))
+        return false;
+    param = model->GetParamData(TEST_MIID,
+                PARAM_ID_DETECTION_ENGINE_REGISTER_MULTI_SOUND_MODEL);
+    if (legacy) {
+        header = (struct apm_module_param_data_t *)param;
+        if (builder.payloadCustomParam(&built, &len, (uint32_t *)(header + 1),
+                header->param_size, TEST_MIID,
+                PARAM_ID_DETECTION_ENGINE_REGISTER_MULTI_SOUND_MODEL) || !built)
+            return false;
+        param = built;
+    }
+    if (idle)
+        copy = sessionCopy(param);
+    free(copy);
+    free(built);
+    return true;
+}
+
+static void compareEnable(const std::string &bin, size_t modelSize, int iterations)
+{
+    static const char *names[] = {"legacy", "in place"};
+    std::vector<uint64_t> ns;
+    palTestAllocCount count;
+    uint64_t start;
+
+    palTestLargeAlloc = modelSize;
+    for (int idle = 1; idle >= 0; idle--) {
+        for (int legacy = 1; legacy >= 0; legacy--) {
+            uint64_t large = 0;
+            char name[64];
+
+            ns.clear();
+            for (int i = 0; i < iterations; i++) {
+                palTestCountStart();
+                start = palTestNowNs();
+                PAL_TEST_CHECK(enable(bin, legacy, idle), "enable failed");
+                ns.push_back(palTestNowNs() - start);
+                count = palTestCountStop();
+                large += count.largeAllocs;
+            }
+            snprintf(name, sizeof(name), "%s enable, %s session", names[!legacy],
+                     idle ? "idle" : "active");
+            fprintf(stdout, "%s: %.2f model sized allocations per enable\n", name,
+                    (double)large / iterations);
+            palTestReportLatency(name, ns);
+            if (!legacy)
+                PAL_TEST_CHECK(large == (uint64_t)(idle ? iterations : 0),
+                               "%s: %llu model sized allocations in %d enables", name,
+                               (unsigned long long)large, iterations);
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<uint8_t> file;
+    std::string bin;
+    int iterations = 200;
+
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s model_bin_name [iterations]\n", argv[0]);
+        return 1;
+    }
+    bin = argv[1];
+    if (argc > 2)
+        iterations = atoi(argv[2]);
+    if (!readFile(std::string(ACD_SM_FILEPATH) + bin, file)) {
+        fprintf(stderr, "cannot read %s%s\n", ACD_SM_FILEPATH, bin.c_str());
+        return 1;
+    }
+
+    checkLayout(bin, file);
+    compareEnable(bin, file.size(), iterations);
+    return palTestResult("ACDModelStoreTest");
+}
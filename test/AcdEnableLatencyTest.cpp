@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * ACD context enable latency, end to end. Opens an ACD stream on the VA
+ * mic the way the context manager does, enables the first context before
+ * start, which registers its model with the session still idle, starts
+ * the stream and then switches the context list between the two contexts
+ * given. With contexts of different models every switch registers one
+ * model with the session running and deregisters the other. Reports the
+ * wall time of the first enable and of the switches, and the PAL side
+ * model register time from the API latency stats, which need
+ * vendor.audio.pal.latency_stats set.
+ *
+ * Usage: AcdEnableLatencyTest iterations context_id context_id
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+static pal_param_payload *contextList(uint32_t contextId)
+{
+    struct pal_param_context_list *list;
+    pal_param_payload *payload;
+
+    payload = (pal_param_payload *)calloc(1, sizeof(pal_param_payload) +
+                                          sizeof(*list) + sizeof(uint32_t));
+    if (!payload)
+        return NULL;
+    payload->payload_size = sizeof(*list) + sizeof(uint32_t);
+    list = (struct pal_param_context_list *)payload->payload;
+    list->num_contexts = 1;
+    list->context_id[0] = contextId;
+    return payload;
+}
+
+static pal_stream_handle_t *openAcd()
+{
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    pal_stream_handle_t *handle = NULL;
+    int status;
+
+    memset(&attr, 0, sizeof(attr));
+    memset(&device, 0, sizeof(device));
+    attr.type = PAL_STREAM_ACD;
+    device.id = PAL_DEVICE_IN_HANDSET_VA_MIC;
+    device.config.bit_width = 16;
+    device.config.sample_rate = 16000;
+    device.config.ch_info.channels = 1;
+
+    status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, &handle);
+    if (status || !handle) {
+        fprintf(stderr, "pal_stream_open ACD failed %d\n", status);
+        return NULL;
+    }
+    return handle;
+}
+
+static void reportStats(const char *name)
+{
+    pal_param_latency_stats_t *stats = NULL;
+    const pal_latency_hist_t *load;
+    size_t size = 0;
+    int status;
+
+    status = pal_get_param(PAL_PARAM_ID_API_LATENCY_STATS, (void **)&stats, &size, NULL);
+    if (status || !stats || size < sizeof(*stats)) {
+        fprintf(stdout, "latency stats unavailable %d\n", status);
+        free(stats);
+        return;
+    }
+    load = &stats->hist[PAL_LATENCY_ACD_MODEL_LOAD];
+    if (!load->count)
+        fprintf(stdout, "%s: no samples, set vendor.audio.pal.latency_stats\n", name);
+    else
+        fprintf(stdout, "%s model register: n %llu avg %llu us max %llu us\n", name,
+                (unsigned long long)load->count,
+                (unsigned long long)(load->total_us / load->count),
+                (unsigned long long)load->max_us);
+    free(stats);
+    pal_set_param(PAL_PARAM_ID_API_LATENCY_STATS, NULL, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    pal_param_payload *contexts[2];
+    pal_stream_handle_t *handle;
+    std::vector<uint64_t> firstNs, switchNs;
+    int iterations;
+    uint64_t start;
+    int status;
+
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s iterations context_id context_id\n", argv[0]);
+        return 1;
+    }
+    iterations = atoi(argv[1]);
+    for (int i = 0; i < 2; i++) {
+        contexts[i] = contextList(strtoul(argv[i + 2], NULL, 0));
+        if (!contexts[i])
+            return 1;
+    }
+
+    handle = openAcd();
+    if (!handle)
+        return 1;
+
+    pal_set_param(PAL_PARAM_ID_API_LATENCY_STATS, NULL, 0);
+    start = palTestNowNs();
+    status = pal_stream_set_param(handle, PAL_PARAM_ID_CONTEXT_LIST, contexts[0]);
+    firstNs.push_back(palTestNowNs() - start);
+    PAL_TEST_CHECK(!status, "first enable failed %d", status);
+    reportStats("idle session");
+
+    status = pal_stream_start(handle);
+    PAL_TEST_CHECK(!status, "pal_stream_start failed %d", status);
+    for (int n = 1; n <= iterations && !status && !palTestErrors.load(); n++) {
+        start = palTestNowNs();
+        status = pal_stream_set_param(handle, PAL_PARAM_ID_CONTEXT_LIST,
+                                      contexts[n % 2]);
+        switchNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "switch %d failed %d", n, status);
+    }
+    palTestReportLatency("first enable, idle session", firstNs);
+    palTestReportLatency("context switch, running session", switchNs);
+    reportStats("running session");
+
+    pal_stream_stop(handle);
+    pal_stream_close(handle);
+    free(contexts[0]);
+    free(contexts[1]);
+    return palTestResult("AcdEnableLatencyTest");
+}
@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Tests for ActiveStreamRegistry: random register/deregister and
+ * device register/deregister sequences are checked against a plain
+ * reference model (registration order of all streams and of every
+ * group, counts, membership and the (device, stream) pairs per device
+ * id). Then times, for 24 and 64 registered streams, the layout
+ * ResourceManager used before (one std::list per group plus the list of
+ * all streams, std::find to deregister, a linear active_devices vector)
+ * against the registry for deregister/register, a per-group walk, the
+ * device active check and the concurrent tx stream selection.
+ *
+ * Usage: ActiveStreamRegistryTest [random iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <algorithm>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+#include "ActiveStreamRegistry.h"
+#include "PalTestUtils.h"
+
+#define STREAM(i) ((Stream *)(uintptr_t)(0x10000 + (i) * 0x40))
+#define STREAM_IDX(s) ((int)(((uintptr_t)(s) - 0x10000) / 0x40))
+#define MAX_STREAMS 64
+#define NUM_TX_DEVICES 6
+#define BENCH_ROUNDS 2000
+
+/* Device is never dereferenced, alias a fake address without an owner */
+static std::shared_ptr<Device> fakeDevice(int deviceId)
+{
+    return std::shared_ptr<Device>(std::shared_ptr<Device>(),
+                                   (Device *)(uintptr_t)(0x900000 + deviceId * 0x100));
+}
+
+static int txDeviceId(int i)
+{
+    return PAL_DEVICE_IN_HANDSET_MIC + (i % NUM_TX_DEVICES);
+}
+
+/* every stream type with a group, plus one without */
+static const pal_stream_type_t streamTypes[] = {
+    PAL_STREAM_LOW_LATENCY, PAL_STREAM_DEEP_BUFFER, PAL_STREAM_COMPRESSED,
+    PAL_STREAM_VOIP_TX, PAL_STREAM_VOIP_RX, PAL_STREAM_VOICE_CALL,
+    PAL_STREAM_PCM_OFFLOAD, PAL_STREAM_LOOPBACK, PAL_STREAM_GENERIC,
+    PAL_STREAM_VOICE_UI, PAL_STREAM_ULTRA_LOW_LATENCY, PAL_STREAM_PROXY,
+    PAL_STREAM_VOICE_CALL_MUSIC, PAL_STREAM_VOICE_CALL_RECORD,
+    PAL_STREAM_NON_TUNNEL, PAL_STREAM_HAPTICS, PAL_STREAM_ACD,
+    PAL_STREAM_ULTRASOUND, PAL_STREAM_RAW, PAL_STREAM_SENSOR_PCM_DATA,
+    PAL_STREAM_CONTEXT_PROXY, PAL_STREAM_VOICE_RECOGNITION,
+    PAL_STREAM_TRANSCODE,
+};
+#define NUM_TYPES (sizeof(streamTypes) / sizeof(streamTypes[0]))
+
+struct refModel {
+    std::list<std::pair<Stream *, pal_stream_type_t>> streams;
+    std::map<int, std::vector<ActiveStreamRegistry::devicePair>> devices;
+};
+
+static void checkAgainst(ActiveStreamRegistry &reg, refModel &ref)
+{
+    std::vector<Stream *> all;
+    std::vector<Stream *> expected;
+    size_t pairs = 0;
+
+    reg.snapshot(all);
+    for (auto &e : ref.streams)
+        expected.push_back(e.first);
+    PAL_TEST_CHECK(all == expected, "order of all streams differs");
+    PAL_TEST_CHECK(reg.size() == ref.streams.size(), "size %zu expected %zu",
+                   reg.size(), ref.streams.size());
+
+    for (int g = 0; g < ACTIVE_STREAMS_MAX; g++) {
+        std::vector<Stream *> members;
+
+        expected.clear();
+        for (auto &e : ref.streams) {
+            if (ActiveStreamRegistry::getGroup(e.second) == g)
+                expected.push_back(e.first);
+        }
+        reg.snapshot((active_stream_group_t)g, members);
+        PAL_TEST_CHECK(members == expected, "order of group %d differs", g);
+        PAL_TEST_CHECK(reg.count((active_stream_group_t)g) == expected.size(),
+                       "count of group %d differs", g);
+    }
+
+    for (int i = 0; i < MAX_STREAMS; i++) {
+        bool in = std::find_if(ref.streams.begin(), ref.streams.end(),
+                               [i](const std::pair<Stream *, pal_stream_type_t> &e) {
+                                   return e.first == STREAM(i);
+                               }) != ref.streams.end();
+        PAL_TEST_CHECK(reg.contains(STREAM(i)) == in, "membership of %d differs", i);
+    }
+
+    for (auto &d : ref.devices) {
+        auto iter = reg.devices().find(d.first);
+
+        if (d.second.empty())
+            continue;
+        pairs++;
+        PAL_TEST_CHECK(iter != reg.devices().end() && iter->second == d.second,
+                       "pairs of device %d differ", d.first);
+    }
+    PAL_TEST_CHECK(reg.devices().size() == pairs, "device ids %zu expected %zu",
+                   reg.devices().size(), pairs);
+}
+
+static void testBasic()
+{
+    ActiveStreamRegistry reg;
+    std::shared_ptr<Device> dev = fakeDevice(txDeviceId(0));
+
+    PAL_TEST_CHECK(reg.empty(), "new registry not empty");
+    PAL_TEST_CHECK(reg.add(STREAM(0), PAL_STREAM_LOW_LATENCY) == 0, "add failed");
+    PAL_TEST_CHECK(reg.add(STREAM(0), PAL_STREAM_LOW_LATENCY) == -EALREADY,
+                   "duplicate added");
+    PAL_TEST_CHECK(reg.add(STREAM(1), PAL_STREAM_TRANSCODE) == -EINVAL,
+                   "ungrouped type accepted");
+    PAL_TEST_CHECK(reg.contains(STREAM(1)) && reg.size() == 2,
+                   "ungrouped stream not tracked");
+    PAL_TEST_CHECK(reg.count(ACTIVE_STREAMS_MAX) == 0 &&
+                   reg.group(ACTIVE_STREAMS_MAX).empty(), "invalid group not empty");
+    PAL_TEST_CHECK(reg.remove(STREAM(1)) == 0, "remove failed");
+    PAL_TEST_CHECK(reg.remove(STREAM(1)) == -ENOENT, "removed twice");
+
+    PAL_TEST_CHECK(reg.addDevice(dev, txDeviceId(0), STREAM(0)) == 0, "addDevice failed");
+    PAL_TEST_CHECK(reg.addDevice(dev, txDeviceId(0), STREAM(0)) == -EINVAL,
+                   "duplicate device pair added");
+    PAL_TEST_CHECK(reg.hasDevice(dev, txDeviceId(0), STREAM(0)), "pair not found");
+    PAL_TEST_CHECK(!reg.hasDevice(dev, txDeviceId(0), STREAM(1)), "wrong pair found");
+    PAL_TEST_CHECK(reg.removeDevice(dev, txDeviceId(0), STREAM(1)) == -ENOENT,
+                   "unknown pair removed");
+    PAL_TEST_CHECK(reg.removeDevice(dev, txDeviceId(0), STREAM(0)) == 0,
+                   "removeDevice failed");
+    PAL_TEST_CHECK(reg.devices().empty(), "empty device id kept");
+}
+
+static void testRandom(uint32_t iterations)
+{
+    ActiveStreamRegistry reg;
+    refModel ref;
+
+    srand(17);
+    for (uint32_t n = 0; n < iterations; n++) {
+        int i = rand() % MAX_STREAMS;
+        int deviceId = txDeviceId(rand());
+        std::shared_ptr<Device> dev = fakeDevice(deviceId);
+        auto iter = std::find_if(ref.streams.begin(), ref.streams.end(),
+                                 [i](const std::pair<Stream *, pal_stream_type_t> &e) {
+                                     return e.first == STREAM(i);
+                                 });
+        std::vector<ActiveStreamRegistry::devicePair> &pairs = ref.devices[deviceId];
+        auto pair = std::find(pairs.begin(), pairs.end(), std::make_pair(dev, STREAM(i)));
+
+        switch (rand() % 4) {
+        case 0:
+        {
+            pal_stream_type_t type = streamTypes[rand() % NUM_TYPES];
+            int expected = iter != ref.streams.end() ? -EALREADY :
+                ActiveStreamRegistry::getGroup(type) == ACTIVE_STREAMS_MAX ? -EINVAL : 0;
+
+            PAL_TEST_CHECK(reg.add(STREAM(i), type) == expected, "add %d", i);
+            if (iter == ref.streams.end())
+                ref.streams.push_back(std::make_pair(STREAM(i), type));
+            break;
+        }
+        case 1:
+            PAL_TEST_CHECK(reg.remove(STREAM(i)) ==
+                           (iter == ref.streams.end() ? -ENOENT : 0), "remove %d", i);
+            if (iter != ref.streams.end())
+                ref.streams.erase(iter);
+            break;
+        case 2:
+            PAL_TEST_CHECK(reg.addDevice(dev, deviceId, STREAM(i)) ==
+                           (pair == pairs.end() ? 0 : -EINVAL), "addDevice %d", i);
+            if (pair == pairs.end())
+                pairs.push_back(std::make_pair(dev, STREAM(i)));
+            break;
+        default:
+            PAL_TEST_CHECK(reg.removeDevice(dev, deviceId, STREAM(i)) ==
+                           (pair == pairs.end() ? -ENOENT : 0), "removeDevice %d", i);
+            if (pair != pairs.end())
+                pairs.erase(pair);
+            break;
+        }
+        PAL_TEST_CHECK(reg.hasDevice(dev, deviceId, STREAM(i)) ==
+                       (std::find(pairs.begin(), pairs.end(),
+                                  std::make_pair(dev, STREAM(i))) != pairs.end()),
+                       "hasDevice %d", i);
+        checkAgainst(reg, ref);
+        if (palTestErrors.load())
+            break;
+    }
+}
+
+/* the layout ResourceManager kept before the registry */
+struct legacyStreams {
+    std::list<Stream *> all;
+    std::list<Stream *> groups[ACTIVE_STREAMS_MAX];
+    std::vector<ActiveStreamRegistry::devicePair> activeDevices;
+
+    void add(Stream *s, pal_stream_type_t type)
+    {
+        all.push_back(s);
+        groups[ActiveStreamRegistry::getGroup(type)].push_back(s);
+    }
+    void remove(Stream *s, pal_stream_type_t type)
+    {
+        std::list<Stream *> &group = groups[ActiveStreamRegistry::getGroup(type)];
+
+        group.erase(std::find(group.begin(), group.end(), s));
+        all.erase(std::find(all.begin(), all.end(), s));
+    }
+    bool isDeviceActive(std::shared_ptr<Device> d, Stream *s)
+    {
+        return std::find(activeDevices.begin(), activeDevices.end(),
+                         std::make_pair(d, s)) != activeDevices.end();
+    }
+};
+
+/* every stream is grouped, odd ones are tx on one or two devices */
+static pal_stream_type_t benchType(int i)
+{
+    return streamTypes[i % (NUM_TYPES - 1)];
+}
+
+static bool benchIsTx(Stream *s)
+{
+    pal_stream_type_t type = benchType(STREAM_IDX(s));
+
+    return (STREAM_IDX(s) & 1) && type != PAL_STREAM_PROXY &&
+           type != PAL_STREAM_ULTRA_LOW_LATENCY && type != PAL_STREAM_GENERIC;
+}
+
+/* stands in for checkECRef, rx on speaker pairs with the first two mics */
+static bool benchEcRef(std::shared_ptr<Device> tx)
+{
+    return tx == fakeDevice(txDeviceId(0)) || tx == fakeDevice(txDeviceId(1));
+}
+
+static std::vector<Stream *> legacyConcurrentTx(legacyStreams &l)
+{
+    std::vector<Stream *> txStreams;
+
+    for (Stream *s : l.all) {
+        int i = STREAM_IDX(s);
+
+        if (!benchIsTx(s))
+            continue;
+        /* associated devices of the stream */
+        for (int d = 0; d < 2; d++) {
+            std::shared_ptr<Device> dev = fakeDevice(txDeviceId(i + d * 3));
+
+            if (!l.isDeviceActive(dev, s))
+                continue;
+            if (benchEcRef(dev)) {
+                txStreams.push_back(s);
+                break;
+            }
+        }
+    }
+    return txStreams;
+}
+
+static std::vector<Stream *> registryConcurrentTx(ActiveStreamRegistry &reg)
+{
+    std::vector<Stream *> txStreams;
+
+    for (auto &devStreams : reg.devices()) {
+        std::shared_ptr<Device> checked = nullptr;
+        bool ecRef = false;
+
+        for (auto &pair : devStreams.second) {
+            if (pair.first != checked) {
+                checked = pair.first;
+                ecRef = benchEcRef(checked);
+            }
+            if (!ecRef || !reg.contains(pair.second) ||
+                std::find(txStreams.begin(), txStreams.end(), pair.second) !=
+                    txStreams.end() ||
+                !benchIsTx(pair.second))
+                continue;
+            txStreams.push_back(pair.second);
+        }
+    }
+    return txStreams;
+}
+
+static void bench(int numStreams)
+{
+    legacyStreams legacy;
+    ActiveStreamRegistry reg;
+    std::vector<uint64_t> legacyNs[4], regNs[4];
+    static const char *names[] = {"re-register", "group walk", "device active",
+                                  "concurrent tx"};
+    volatile size_t sink = 0;
+    char name[64];
+
+    srand(numStreams);
+    for (int i = 0; i < numStreams; i++) {
+        legacy.add(STREAM(i), benchType(i));
+        reg.add(STREAM(i), benchType(i));
+        if (!(i & 1))
+            continue;
+        for (int d = 0; d < 2; d++) {
+            std::shared_ptr<Device> dev = fakeDevice(txDeviceId(i + d * 3));
+
+            legacy.activeDevices.push_back(std::make_pair(dev, STREAM(i)));
+            reg.addDevice(dev, txDeviceId(i + d * 3), STREAM(i));
+        }
+    }
+
+    {
+        std::vector<Stream *> a = legacyConcurrentTx(legacy);
+        std::vector<Stream *> b = registryConcurrentTx(reg);
+
+        std::sort(a.begin(), a.end());
+        std::sort(b.begin(), b.end());
+        PAL_TEST_CHECK(!a.empty() && a == b, "concurrent tx streams differ at %d",
+                       numStreams);
+    }
+
+    for (int n = 0; n < BENCH_ROUNDS; n++) {
+        /* a random stream goes away and registers again */
+        int i = rand() % numStreams;
+        Stream *s = STREAM(i);
+        std::shared_ptr<Device> dev = fakeDevice(txDeviceId(i));
+        active_stream_group_t g = ActiveStreamRegistry::getGroup(benchType(i));
+        uint64_t start;
+
+        start = palTestNowNs();
+        legacy.remove(s, benchType(i));
+        legacy.add(s, benchType(i));
+        legacyNs[0].push_back(palTestNowNs() - start);
+        start = palTestNowNs();
+        reg.remove(s);
+        reg.add(s, benchType(i));
+        regNs[0].push_back(palTestNowNs() - start);
+
+        start = palTestNowNs();
+        for (Stream *m : legacy.groups[g])
+            sink += (uintptr_t)m;
+        legacyNs[1].push_back(palTestNowNs() - start);
+        start = palTestNowNs();
+        for (Stream *m : reg.group(g))
+            sink += (uintptr_t)m;
+        regNs[1].push_back(palTestNowNs() - start);
+
+        start = palTestNowNs();
+        sink += legacy.isDeviceActive(dev, s);
+        legacyNs[2].push_back(palTestNowNs() - start);
+        start = palTestNowNs();
+        sink += reg.hasDevice(dev, txDeviceId(i), s);
+        regNs[2].push_back(palTestNowNs() - start);
+
+        start = palTestNowNs();
+        sink += legacyConcurrentTx(legacy).size();
+        legacyNs[3].push_back(palTestNowNs() - start);
+        start = palTestNowNs();
+        sink += registryConcurrentTx(reg).size();
+        regNs[3].push_back(palTestNowNs() - start);
+    }
+
+    for (int k = 0; k < 4; k++) {
+        snprintf(name, sizeof(name), "%d streams %s legacy", numStreams, names[k]);
+        palTestReportLatency(name, legacyNs[k]);
+        snprintf(name, sizeof(name), "%d streams %s registry", numStreams, names[k]);
+        palTestReportLatency(name, regNs[k]);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t iterations = argc > 1 ? atoi(argv[1]) : 20000;
+
+    testBasic();
+    testRandom(iterations);
+    bench(24);
+    bench(MAX_STREAMS);
+    return palTestResult("ActiveStreamRegistryTest");
+}
@@ -0,0 +1,350 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Tests for the BtCodecPluginRegistry payload cache. Codec configs that
+ * hold the same field values over different struct padding must map to
+ * the same key, and changing any single field must change it. Random
+ * get/put sequences are checked against a reference LRU list, then the
+ * time of a hit on a full cache is reported.
+ *
+ * Usage: BtCodecPluginRegistryTest [random iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <list>
+#include <string>
+#include <vector>
+#include "BtCodecPluginRegistry.h"
+#include <bt_bundle.h>
+#include <bt_aptx.h>
+#include "PalTestUtils.h"
+
+#define BENCH_ROUNDS 20000
+
+static std::string keyOf(uint32_t codecFmt, void *codecInfo)
+{
+    std::string key;
+
+    BtCodecPluginRegistry::getPayloadKey(codecFmt, ENC, codecInfo, key);
+    return key;
+}
+
+static void fillSbc(audio_sbc_encoder_config_t *sbc, uint8_t pad)
+{
+    memset(sbc, pad, sizeof(*sbc));
+    sbc->subband = 8;
+    sbc->blk_len = 16;
+    sbc->sampling_rate = 48000;
+    sbc->channels = 3;
+    sbc->alloc = 0;
+    sbc->min_bitpool = 2;
+    sbc->max_bitpool = 51;
+    sbc->bitrate = 328000;
+    sbc->bits_per_sample = 16;
+}
+
+static void fillAptx(audio_aptx_encoder_config_t *aptx, uint8_t pad)
+{
+    memset(aptx, pad, sizeof(*aptx));
+    aptx->sampling_rate = 48000;
+    aptx->channels = 2;
+    aptx->bitrate = 352000;
+    aptx->bits_per_sample = 16;
+}
+
+static void fillLdac(audio_ldac_encoder_config_t *ldac, uint8_t pad)
+{
+    memset(ldac, pad, sizeof(*ldac));
+    ldac->sampling_rate = 96000;
+    ldac->bit_rate = 990000;
+    ldac->channel_mode = 1;
+    ldac->mtu = 679;
+    ldac->bits_per_sample = 24;
+    ldac->is_abr_enabled = true;
+    ldac->level_to_bitrate_map.num_levels = MAX_ABR_QUALITY_LEVELS;
+    for (int i = 0; i < MAX_ABR_QUALITY_LEVELS; i++) {
+        ldac->level_to_bitrate_map.bit_rate_level_map[i].link_quality_level = i;
+        ldac->level_to_bitrate_map.bit_rate_level_map[i].bitrate = 330000 * (i + 1);
+    }
+}
+
+static void fillAac(audio_aac_encoder_config_t *aac, struct aac_frame_size_control_t *ctl,
+                    struct aac_abr_control_t *abr, uint8_t pad)
+{
+    memset(aac, pad, sizeof(*aac));
+    memset(ctl, pad, sizeof(*ctl));
+    memset(abr, pad, sizeof(*abr));
+    ctl->ctl_type = PEAK_BIT_RATE;
+    ctl->ctl_value = 320000;
+    abr->is_abr_enabled = true;
+    abr->level_to_bitrate_map.num_levels = 2;
+    for (int i = 0; i < MAX_ABR_QUALITY_LEVELS; i++) {
+        abr->level_to_bitrate_map.bit_rate_level_map[i].link_quality_level = i;
+        abr->level_to_bitrate_map.bit_rate_level_map[i].bitrate = 128000 * (i + 1);
+    }
+    aac->enc_mode = 2;
+    aac->format_flag = 0;
+    aac->channels = 2;
+    aac->sampling_rate = 44100;
+    aac->bitrate = 320000;
+    aac->bits_per_sample = 16;
+    aac->frame_ctl = *ctl;
+    aac->size_control_struct = 1;
+    aac->frame_ctl_ptr = ctl;
+    aac->abr_size_control_struct = 1;
+    aac->abr_ctl_ptr = abr;
+}
+
+/* only field values reach the key, whatever sits in the padding */
+static void testPaddingIgnored()
+{
+    audio_sbc_encoder_config_t sbcA, sbcB;
+    audio_aptx_encoder_config_t aptxA, aptxB;
+    audio_ldac_encoder_config_t ldacA, ldacB;
+    audio_aac_encoder_config_t aacA, aacB;
+    struct aac_frame_size_control_t ctlA, ctlB;
+    struct aac_abr_control_t abrA, abrB;
+
+    fillSbc(&sbcA, 0xaa);
+    fillSbc(&sbcB, 0x55);
+    PAL_TEST_CHECK(keyOf(CODEC_TYPE_SBC, &sbcA) == keyOf(CODEC_TYPE_SBC, &sbcB),
+                   "SBC key depends on padding");
+
+    fillAptx(&aptxA, 0xaa);
+    fillAptx(&aptxB, 0x55);
+    PAL_TEST_CHECK(keyOf(CODEC_TYPE_APTX, &aptxA) == keyOf(CODEC_TYPE_APTX, &aptxB),
+                   "aptX key depends on padding");
+    PAL_TEST_CHECK(keyOf(CODEC_TYPE_APTX_HD, &aptxA) == keyOf(CODEC_TYPE_APTX_HD, &aptxB),
+                   "aptX HD key depends on padding");
+
+    fillLdac(&ldacA, 0xaa);
+    fillLdac(&ldacB, 0x55);
+    PAL_TEST_CHECK(keyOf(CODEC_TYPE_LDAC, &ldacA) == keyOf(CODEC_TYPE_LDAC, &ldacB),
+                   "LDAC key depends on padding");
+
+    fillAac(&aacA, &ctlA, &abrA, 0xaa);
+    fillAac(&aacB, &ctlB, &abrB, 0x55);
+    PAL_TEST_CHECK(keyOf(CODEC_TYPE_AAC, &aacA) == keyOf(CODEC_TYPE_AAC, &aacB),
+                   "AAC key depends on padding or pointer values");
+}
+
+#define CHECK_FIELD_CHANGES(fmt, base, cfg, field) \
+    do { \
+        (cfg) = (base); \
+        (cfg).field ^= 1; \
+        PAL_TEST_CHECK(keyOf(fmt, &(cfg)) != keyOf(fmt, &(base)), \
+                       "%s does not change the key", #field); \
+    } while (0)
+
+/* every field the plugins pack from must change the key */
+static void testFieldsChangeKey()
+{
+    audio_sbc_encoder_config_t sbc, sbcBase;
+    audio_aptx_encoder_config_t aptx, aptxBase;
+    audio_ldac_encoder_config_t ldac, ldacBase;
+    audio_aac_encoder_config_t aacA, aacB;
+    struct aac_frame_size_control_t ctlA, ctlB;
+    struct aac_abr_control_t abrA, abrB;
+
+    fillSbc(&sbcBase, 0);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_SBC, sbcBase, sbc, subband);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_SBC, sbcBase, sbc, blk_len);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_SBC, sbcBase, sbc, sampling_rate);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_SBC, sbcBase, sbc, channels);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_SBC, sbcBase, sbc, alloc);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_SBC, sbcBase, sbc, min_bitpool);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_SBC, sbcBase, sbc, max_bitpool);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_SBC, sbcBase, sbc, bitrate);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_SBC, sbcBase, sbc, bits_per_sample);
+
+    fillAptx(&aptxBase, 0);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_APTX, aptxBase, aptx, sampling_rate);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_APTX, aptxBase, aptx, channels);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_APTX, aptxBase, aptx, bitrate);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_APTX, aptxBase, aptx, bits_per_sample);
+
+    fillLdac(&ldacBase, 0);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_LDAC, ldacBase, ldac, sampling_rate);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_LDAC, ldacBase, ldac, bit_rate);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_LDAC, ldacBase, ldac, channel_mode);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_LDAC, ldacBase, ldac, mtu);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_LDAC, ldacBase, ldac, bits_per_sample);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_LDAC, ldacBase, ldac, level_to_bitrate_map.num_levels);
+    CHECK_FIELD_CHANGES(CODEC_TYPE_LDAC, ldacBase, ldac,
+                        level_to_bitrate_map.bit_rate_level_map[4].bitrate);
+    ldac = ldacBase;
+    ldac.is_abr_enabled = false;
+    PAL_TEST_CHECK(keyOf(CODEC_TYPE_LDAC, &ldac) != keyOf(CODEC_TYPE_LDAC, &ldacBase),
+                   "is_abr_enabled does not change the key");
+
+    /* pointed to AAC controls are inlined */
+    fillAac(&aacA, &ctlA, &abrA, 0);
+    fillAac(&aacB, &ctlB, &abrB, 0);
+    ctlB.ctl_value = 256000;
+    PAL_TEST_CHECK(keyOf(CODEC_TYPE_AAC, &aacA) != keyOf(CODEC_TYPE_AAC, &aacB),
+                   "frame_ctl_ptr value does not change the key");
+    ctlB = ctlA;
+    abrB.level_to_bitrate_map.bit_rate_level_map[1].bitrate = 1;
+    PAL_TEST_CHECK(keyOf(CODEC_TYPE_AAC, &aacA) != keyOf(CODEC_TYPE_AAC, &aacB),
+                   "abr_ctl_ptr map does not change the key");
+
+    PAL_TEST_CHECK(keyOf(CODEC_TYPE_APTX, &aptxBase) != keyOf(CODEC_TYPE_APTX_HD, &aptxBase),
+                   "codec format does not change the key");
+}
+
+static bt_enc_payload_t *makePayload(uint32_t tag)
+{
+    bt_enc_payload_t *p = (bt_enc_payload_t *)calloc(1, sizeof(bt_enc_payload_t) +
+                                                     sizeof(custom_block_t *));
+    /* putPayload deep copies, the source block can be reused */
+    static custom_block_t blk;
+    static uint32_t data;
+
+    data = tag;
+    blk.param_id = tag;
+    blk.payload_sz = sizeof(data);
+    blk.payload = (uint8_t *)&data;
+    p->sample_rate = 48000;
+    p->num_blks = 1;
+    p->blocks[0] = &blk;
+    return p;
+}
+
+/* cached payloads are deep copies tagged with param_id */
+static uint32_t tagOf(const std::shared_ptr<BtCodecPayload> &payload)
+{
+    if (!payload || !payload->get() || payload->get()->num_blks != 1)
+        return UINT32_MAX;
+    return payload->get()->blocks[0]->param_id;
+}
+
+static std::string lruKey(int i)
+{
+    return "lru-" + std::to_string(i);
+}
+
+/* random get/put against a reference least recently used list */
+static void testLru(int iterations)
+{
+    std::list<int> ref;
+    bt_enc_payload_t *src;
+
+    srand(1);
+    for (int n = 0; n < iterations; n++) {
+        int k = rand() % (BT_CODEC_PAYLOAD_CACHE_SIZE * 2);
+        auto it = std::find(ref.begin(), ref.end(), k);
+
+        if (rand() % 2) {
+            std::shared_ptr<BtCodecPayload> got =
+                BtCodecPluginRegistry::getPayload(lruKey(k));
+
+            PAL_TEST_CHECK((it != ref.end()) == (got != nullptr),
+                           "step %d key %d cached %d expected %d", n, k,
+                           got != nullptr, it != ref.end());
+            if (got)
+                PAL_TEST_CHECK(tagOf(got) == (uint32_t)k, "step %d key %d has tag %u",
+                               n, k, tagOf(got));
+            if (it != ref.end())
+                ref.splice(ref.end(), ref, it);
+        } else {
+            src = makePayload(k);
+            PAL_TEST_CHECK(tagOf(BtCodecPluginRegistry::putPayload(lruKey(k), src)) ==
+                           (uint32_t)k, "step %d put %d failed", n, k);
+            free(src);
+            if (it != ref.end()) {
+                ref.splice(ref.end(), ref, it);
+            } else {
+                if (ref.size() >= BT_CODEC_PAYLOAD_CACHE_SIZE)
+                    ref.pop_front();
+                ref.push_back(k);
+            }
+        }
+    }
+    for (int k = 0; k < BT_CODEC_PAYLOAD_CACHE_SIZE * 2; k++) {
+        bool cached = std::find(ref.begin(), ref.end(), k) != ref.end();
+
+        PAL_TEST_CHECK(cached == (BtCodecPluginRegistry::getPayload(lruKey(k)) != nullptr),
+                       "key %d cached state differs at the end", k);
+        if (cached)
+            ref.splice(ref.end(), ref, std::find(ref.begin(), ref.end(), k));
+    }
+}
+
+/* key build plus lookup, as Bluetooth::getPluginPayload does per start */
+static void benchHit()
+{
+    std::vector<uint64_t> keyNs, hitNs;
+    audio_ldac_encoder_config_t ldac;
+    bt_enc_payload_t *src;
+    std::string key;
+    uint64_t start;
+
+    for (int i = 0; i < BT_CODEC_PAYLOAD_CACHE_SIZE; i++) {
+        fillLdac(&ldac, 0);
+        ldac.bit_rate += i;
+        key = keyOf(CODEC_TYPE_LDAC, &ldac);
+        src = makePayload(i);
+        BtCodecPluginRegistry::putPayload(key, src);
+        free(src);
+    }
+    for (int n = 0; n < BENCH_ROUNDS; n++) {
+        fillLdac(&ldac, 0);
+        /* the least recently used entry, the far end of the list */
+        ldac.bit_rate += n % BT_CODEC_PAYLOAD_CACHE_SIZE;
+        start = palTestNowNs();
+        BtCodecPluginRegistry::getPayloadKey(CODEC_TYPE_LDAC, ENC, &ldac, key);
+        keyNs.push_back(palTestNowNs() - start);
+        start = palTestNowNs();
+        PAL_TEST_CHECK(BtCodecPluginRegistry::getPayload(key) != nullptr,
+                       "round %d missed", n);
+        hitNs.push_back(palTestNowNs() - start);
+    }
+    palTestReportLatency("LDAC key", keyNs);
+    palTestReportLatency("getPayload hit, full cache", hitNs);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 20000;
+
+    testPaddingIgnored();
+    testFieldsChangeKey();
+    testLru(iterations);
+    benchHit();
+    return palTestResult("BtCodecPluginRegistryTest");
+}
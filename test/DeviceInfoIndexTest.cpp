@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checks the device info index built by buildDeviceInfoIndex against the
+ * scan getDeviceInfo did over deviceInfo before the index existed. The
+ * tables parsed from the resource manager xml at pal_init are checked for
+ * every device, every stream type and every custom key listed plus an
+ * unknown one. Randomized tables with repeated devices, usecases and keys
+ * are checked the same way and the parsed tables restored afterwards.
+ * Per call latency of getDeviceInfo on both paths and of getDeviceConfig
+ * for common device and stream pairs is reported.
+ *
+ * Usage: DeviceInfoIndexTest [random tables]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include <set>
+#include <vector>
+#include "PalApi.h"
+#include "ResourceManager.h"
+#include "PalTestUtils.h"
+
+#define BENCH_LOOPS 2000
+
+class DeviceInfoIndexTest : public ResourceManager
+{
+public:
+    static void run(int randomTables);
+
+private:
+    static void scanDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type,
+        const std::string &key, struct pal_device_info *devinfo);
+    static bool sameInfo(const struct pal_device_info &a, const struct pal_device_info &b);
+    static uint32_t checkTables(const char *name, const std::vector<int> &devices,
+        const std::vector<int> &types, const std::vector<std::string> &keys);
+    static void checkParsed();
+    static void checkRandom(int randomTables);
+    static void benchmark();
+};
+
+/* getDeviceInfo as it was before the index, without the verbose logs */
+void DeviceInfoIndexTest::scanDeviceInfo(pal_device_id_t deviceId, pal_stream_type_t type,
+    const std::string &key, struct pal_device_info *devinfo)
+{
+    for (int32_t i = 0; i < deviceInfo.size(); i++) {
+        if (deviceId != deviceInfo[i].deviceId)
+            continue;
+        devinfo->max_channels = deviceInfo[i].max_channel;
+        devinfo->channels = deviceInfo[i].channel;
+        devinfo->sndDevName = deviceInfo[i].sndDevName;
+        devinfo->samplerate = deviceInfo[i].samplerate;
+        devinfo->isExternalECRefEnabledFlag = deviceInfo[i].isExternalECRefEnabled;
+        devinfo->priority = MIN_USECASE_PRIORITY;
+        devinfo->bit_width = deviceInfo[i].bit_width;
+        devinfo->bitFormatSupported = deviceInfo[i].bitFormatSupported;
+        devinfo->channels_overwrite = false;
+        devinfo->samplerate_overwrite = false;
+        devinfo->sndDevName_overwrite = false;
+        devinfo->bit_width_overwrite = false;
+        devinfo->fractionalSRSupported = deviceInfo[i].fractionalSRSupported;
+        for (int32_t j = 0; j < deviceInfo[i].usecase.size(); j++) {
+            usecase_info &usecase = deviceInfo[i].usecase[j];
+
+            if (type != usecase.type)
+                continue;
+            if (usecase.channel) {
+                devinfo->channels = usecase.channel;
+                devinfo->channels_overwrite = true;
+            }
+            if (usecase.samplerate) {
+                devinfo->samplerate = usecase.samplerate;
+                devinfo->samplerate_overwrite = true;
+            }
+            if (!(usecase.sndDevName).empty()) {
+                devinfo->sndDevName = usecase.sndDevName;
+                devinfo->sndDevName_overwrite = true;
+            }
+            if (usecase.priority)
+                devinfo->priority = usecase.priority;
+            if (usecase.bit_width) {
+                devinfo->bit_width = usecase.bit_width;
+                devinfo->bit_width_overwrite = true;
+            }
+            for (int32_t k = 0; k < usecase.config.size(); k++) {
+                usecase_custom_config_info &config = usecase.config[k];
+
+                if (config.key.compare(key))
+                    continue;
+                if (config.channel) {
+                    devinfo->channels = config.channel;
+                    devinfo->channels_overwrite = true;
+                }
+                if (config.samplerate) {
+                    devinfo->samplerate = config.samplerate;
+                    devinfo->samplerate_overwrite = true;
+                }
+                if (!(config.sndDevName).empty()) {
+                    devinfo->sndDevName = config.sndDevName;
+                    devinfo->sndDevName_overwrite = true;
+                }
+                if (config.priority && config.priority != MIN_USECASE_PRIORITY)
+                    devinfo->priority = config.priority;
+                if (config.bit_width) {
+                    devinfo->bit_width = config.bit_width;
+                    devinfo->bit_width_overwrite = true;
+                }
+                break;
+            }
+        }
+    }
+}
+
+bool DeviceInfoIndexTest::sameInfo(const struct pal_device_info &a,
+    const struct pal_device_info &b)
+{
+    return a.channels == b.channels && a.max_channels == b.max_channels &&
+           a.samplerate == b.samplerate && a.sndDevName == b.sndDevName &&
+           a.isExternalECRefEnabledFlag == b.isExternalECRefEnabledFlag &&
+           a.priority == b.priority && a.fractionalSRSupported == b.fractionalSRSupported &&
+           a.channels_overwrite == b.channels_overwrite &&
+           a.samplerate_overwrite == b.samplerate_overwrite &&
+           a.sndDevName_overwrite == b.sndDevName_overwrite &&
+           a.bit_width_overwrite == b.bit_width_overwrite &&
+           a.bit_width == b.bit_width && a.bitFormatSupported == b.bitFormatSupported;
+}
+
+/* devices, types and keys should include values absent from the tables */
+uint32_t DeviceInfoIndexTest::checkTables(const char *name, const std::vector<int> &devices,
+    const std::vector<int> &types, const std::vector<std::string> &keys)
+{
+    std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
+    struct pal_device_info indexed, scanned;
+    uint32_t queries = 0, mismatches = 0;
+
+    for (int dev : devices) {
+        for (int type : types) {
+            for (auto &key : keys) {
+                /* an unknown device leaves devinfo untouched on both paths */
+                indexed = {};
+                indexed.channels = -1;
+                scanned = indexed;
+                rm->getDeviceInfo((pal_device_id_t)dev, (pal_stream_type_t)type, key, &indexed);
+                scanDeviceInfo((pal_device_id_t)dev, (pal_stream_type_t)type, key, &scanned);
+                queries++;
+                if (!sameInfo(indexed, scanned)) {
+                    mismatches++;
+                    PAL_TEST_CHECK(false, "%s: dev %d type %d key '%s': index ch %d sr %d "
+                                   "snd %s prio %u, scan ch %d sr %d snd %s prio %u", name,
+                                   dev, type, key.c_str(), indexed.channels,
+                                   indexed.samplerate, indexed.sndDevName.c_str(),
+                                   indexed.priority, scanned.channels, scanned.samplerate,
+                                   scanned.sndDevName.c_str(), scanned.priority);
+                }
+            }
+        }
+    }
+    fprintf(stdout, "%s: %zu entries, %u queries, %u mismatches\n", name,
+            deviceInfo.size(), queries, mismatches);
+    return mismatches;
+}
+
+void DeviceInfoIndexTest::checkParsed()
+{
+    std::set<int> devices, types;
+    std::set<std::string> keys;
+
+    for (auto &dev : deviceInfo) {
+        devices.insert(dev.deviceId);
+        for (auto &usecase : dev.usecase) {
+            types.insert(usecase.type);
+            for (auto &config : usecase.config)
+                keys.insert(config.key);
+        }
+    }
+    for (int type = 0; type < PAL_STREAM_MAX; type++)
+        types.insert(type);
+    devices.insert(PAL_DEVICE_NONE);
+    keys.insert("");
+    keys.insert("device-info-index-test");
+
+    checkTables("parsed", std::vector<int>(devices.begin(), devices.end()),
+                std::vector<int>(types.begin(), types.end()),
+                std::vector<std::string>(keys.begin(), keys.end()));
+}
+
+void DeviceInfoIndexTest::checkRandom(int randomTables)
+{
+    const std::vector<int> devices = {PAL_DEVICE_OUT_HANDSET, PAL_DEVICE_OUT_SPEAKER,
+        PAL_DEVICE_OUT_USB_HEADSET, PAL_DEVICE_IN_HANDSET_MIC, PAL_DEVICE_IN_SPEAKER_MIC};
+    const std::vector<int> types = {PAL_STREAM_LOW_LATENCY, PAL_STREAM_DEEP_BUFFER,
+        PAL_STREAM_VOIP_RX, PAL_STREAM_VOICE_CALL, PAL_STREAM_COMPRESSED};
+    const std::vector<std::string> keys = {"", "speaker-safe", "unprocessed", "dual-mono"};
+    const std::vector<std::string> names = {"", "speaker", "handset", "speaker-safe"};
+    std::vector<int> queryDevices = devices, queryTypes = types;
+    std::vector<std::string> queryKeys = keys;
+    std::vector<deviceIn> parsed = deviceInfo;
+    std::mt19937 rng(1234);
+    uint32_t mismatches = 0;
+
+    /* zero means "not set" for most fields, so pick it often */
+    auto pick = [&rng](std::vector<int> values) {
+        return values[rng() % values.size()];
+    };
+
+    queryDevices.push_back(PAL_DEVICE_NONE);
+    queryTypes.push_back(PAL_STREAM_RAW);
+    queryKeys.push_back("device-info-index-test");
+
+    for (int t = 0; t < randomTables; t++) {
+        deviceInfo.clear();
+        for (int i = 0, n = 1 + rng() % 8; i < n; i++) {
+            deviceIn dev = {};
+
+            dev.deviceId = devices[rng() % devices.size()];
+            dev.max_channel = pick({2, 4, 8});
+            dev.channel = pick({0, 1, 2});
+            dev.samplerate = pick({0, 16000, 48000});
+            dev.sndDevName = names[rng() % names.size()];
+            dev.isExternalECRefEnabled = rng() & 1;
+            dev.fractionalSRSupported = rng() & 1;
+            dev.bit_width = pick({0, 16, 24});
+            dev.bitFormatSupported = PAL_AUDIO_FMT_DEFAULT_PCM;
+            for (int j = 0, m = rng() % 5; j < m; j++) {
+                usecase_info usecase = {};
+
+                usecase.type = types[rng() % types.size()];
+                usecase.channel = pick({0, 0, 1, 2});
+                usecase.samplerate = pick({0, 0, 16000, 96000});
+                usecase.sndDevName = names[rng() % names.size()];
+                usecase.priority = pick({0, 0, (int)MIN_USECASE_PRIORITY, 1, 5});
+                usecase.bit_width = pick({0, 0, 24, 32});
+                for (int k = 0, c = rng() % 4; k < c; k++) {
+                    usecase_custom_config_info config = {};
+
+                    config.key = keys[rng() % keys.size()];
+                    config.channel = pick({0, 1, 2});
+                    config.samplerate = pick({0, 8000, 48000});
+                    config.sndDevName = names[rng() % names.size()];
+                    config.priority = pick({0, (int)MIN_USECASE_PRIORITY, 2, 7});
+                    config.bit_width = pick({0, 16, 32});
+                    usecase.config.push_back(config);
+                }
+                dev.usecase.push_back(usecase);
+            }
+            deviceInfo.push_back(dev);
+        }
+        buildDeviceInfoIndex();
+        mismatches += checkTables("random", queryDevices, queryTypes, queryKeys);
+    }
+    fprintf(stdout, "random: %d tables, %u mismatches\n", randomTables, mismatches);
+
+    deviceInfo = parsed;
+    buildDeviceInfoIndex();
+}
+
+void DeviceInfoIndexTest::benchmark()
+{
+    std::shared_ptr<ResourceManager> rm = ResourceManager::getInstance();
+    const std::vector<std::pair<pal_device_id_t, pal_stream_type_t>> cases = {
+        {PAL_DEVICE_OUT_SPEAKER, PAL_STREAM_LOW_LATENCY},
+        {PAL_DEVICE_OUT_SPEAKER, PAL_STREAM_DEEP_BUFFER},
+        {PAL_DEVICE_OUT_HANDSET, PAL_STREAM_VOIP_RX},
+        {PAL_DEVICE_IN_HANDSET_MIC, PAL_STREAM_DEEP_BUFFER},
+        {PAL_DEVICE_IN_SPEAKER_MIC, PAL_STREAM_VOIP_TX},
+    };
+    std::vector<uint64_t> indexedNs, scanNs, configNs;
+    struct pal_stream_attributes sAttr;
+    struct pal_device_info info;
+    struct pal_device dAttr;
+    std::string key;
+    uint64_t start;
+
+    for (auto &c : cases) {
+        memset(&sAttr, 0, sizeof(sAttr));
+        sAttr.type = c.second;
+        sAttr.direction = c.first < PAL_DEVICE_IN_MIN ? PAL_AUDIO_OUTPUT : PAL_AUDIO_INPUT;
+        sAttr.in_media_config.sample_rate = 48000;
+        sAttr.in_media_config.bit_width = 16;
+        sAttr.out_media_config = sAttr.in_media_config;
+        for (int i = 0; i < BENCH_LOOPS; i++) {
+            start = palTestNowNs();
+            rm->getDeviceInfo(c.first, c.second, key, &info);
+            indexedNs.push_back(palTestNowNs() - start);
+
+            start = palTestNowNs();
+            scanDeviceInfo(c.first, c.second, key, &info);
+            scanNs.push_back(palTestNowNs() - start);
+
+            memset(&dAttr, 0, sizeof(dAttr));
+            dAttr.id = c.first;
+            start = palTestNowNs();
+            rm->getDeviceConfig(&dAttr, &sAttr);
+            configNs.push_back(palTestNowNs() - start);
+        }
+    }
+    palTestReportLatency("getDeviceInfo indexed", indexedNs);
+    palTestReportLatency("getDeviceInfo scan", scanNs);
+    palTestReportLatency("getDeviceConfig", configNs);
+}
+
+void DeviceInfoIndexTest::run(int randomTables)
+{
+    checkParsed();
+    benchmark();
+    checkRandom(randomTables);
+}
+
+int main(int argc, char *argv[])
+{
+    int randomTables = argc > 1 ? atoi(argv[1]) : 500;
+    int status = pal_init();
+
+    PAL_TEST_CHECK(!status, "pal_init failed %d", status);
+    if (!status) {
+        DeviceInfoIndexTest::run(randomTables);
+        pal_deinit();
+    }
+    return palTestResult("DeviceInfoIndexTest");
+}
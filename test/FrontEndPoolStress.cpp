@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Stress test for FrontEndPool: worker threads act as streams, each one
+ * allocating and releasing front ends under its own owner tag while a
+ * shadow table checks that no id is ever handed to two owners at once,
+ * getOwnedIds matches what the owner holds and the pool drains to zero.
+ * A shared pool and mismatched/double frees are checked as well.
+ *
+ * Usage: FrontEndPoolStress [threads] [iterations] [pool size]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include "FrontEndPool.h"
+#include "PalTestUtils.h"
+
+#define FE_ID_BASE 100
+
+static void worker(FrontEndPool *pool, std::vector<std::atomic<intptr_t>> *shadow,
+                   int tag, int iterations)
+{
+    const void *owner = (const void *)(intptr_t)tag;
+    std::mt19937 rng(tag);
+    std::vector<std::vector<int>> held;
+    std::vector<int> ids;
+    std::vector<int> owned;
+    std::vector<int> expected;
+    intptr_t prev = 0;
+    int32_t status = 0;
+
+    for (int it = 0; it < iterations; it++) {
+        if (held.empty() || (held.size() < 3 && (rng() & 1))) {
+            status = pool->allocate(1 + rng() % 2, owner, ids);
+            if (status) {
+                PAL_TEST_CHECK(status == -ENOENT, "allocate failed %d", status);
+                std::this_thread::yield();
+                continue;
+            }
+            for (int id : ids) {
+                prev = 0;
+                PAL_TEST_CHECK((*shadow)[id - FE_ID_BASE].compare_exchange_strong(prev, tag),
+                               "front end %d given to %d while owned by %ld", id, tag,
+                               (long)prev);
+            }
+            held.push_back(ids);
+        } else {
+            size_t idx = rng() % held.size();
+            for (int id : held[idx]) {
+                prev = tag;
+                PAL_TEST_CHECK((*shadow)[id - FE_ID_BASE].compare_exchange_strong(prev, 0),
+                               "front end %d released by %d but owned by %ld", id, tag,
+                               (long)prev);
+            }
+            status = pool->release(held[idx], owner);
+            PAL_TEST_CHECK(!status, "release failed %d", status);
+            held.erase(held.begin() + idx);
+        }
+
+        if (it % 64 == 0) {
+            owned.clear();
+            expected.clear();
+            pool->getOwnedIds(owner, owned);
+            for (auto &v : held)
+                expected.insert(expected.end(), v.begin(), v.end());
+            std::sort(owned.begin(), owned.end());
+            std::sort(expected.begin(), expected.end());
+            PAL_TEST_CHECK(owned == expected, "owner %d tracks %zu ids, holds %zu",
+                           tag, owned.size(), expected.size());
+        }
+    }
+
+    for (auto &v : held) {
+        for (int id : v)
+            (*shadow)[id - FE_ID_BASE].store(0);
+        PAL_TEST_CHECK(!pool->release(v, owner), "final release failed");
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int numThreads = argc > 1 ? atoi(argv[1]) : 8;
+    int iterations = argc > 2 ? atoi(argv[2]) : 100000;
+    int poolSize = argc > 3 ? atoi(argv[3]) : 12;
+    FrontEndPool pool;
+    FrontEndPool sharedPool;
+    std::vector<int> feIds;
+    std::vector<int> ids;
+    std::vector<std::thread> threads;
+    struct frontEndPoolStats stats;
+
+    if (numThreads <= 0 || iterations <= 0 || poolSize <= 0 ||
+        poolSize > FRONT_END_POOL_MAX_IDS) {
+        fprintf(stderr, "usage: %s [threads] [iterations] [pool size <= %d]\n",
+                argv[0], FRONT_END_POOL_MAX_IDS);
+        return 1;
+    }
+
+    std::vector<std::atomic<intptr_t>> shadow(poolSize);
+    for (int i = 0; i < poolSize; i++) {
+        feIds.push_back(FE_ID_BASE + i);
+        shadow[i].store(0);
+    }
+    pool.init(feIds, false);
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(worker, &pool, &shadow, i + 1, iterations);
+    for (auto &t : threads)
+        t.join();
+
+    pool.getStats(&stats);
+    PAL_TEST_CHECK(stats.inUse == 0, "%u front ends still in use", stats.inUse);
+    PAL_TEST_CHECK(stats.peak <= (uint32_t)poolSize, "peak %u above pool size", stats.peak);
+    fprintf(stdout, "exclusive: total %u peak %u failures %u\n",
+            stats.total, stats.peak, stats.failures);
+
+    /* double free and foreign id must be rejected */
+    PAL_TEST_CHECK(!pool.allocate(1, &pool, ids), "allocate after drain failed");
+    PAL_TEST_CHECK(!pool.release(ids, &pool), "release failed");
+    PAL_TEST_CHECK(pool.release(ids, &pool) == -EINVAL, "double free accepted");
+    PAL_TEST_CHECK(pool.release(std::vector<int>{FE_ID_BASE - 1}, &pool) == -EINVAL,
+                   "foreign front end accepted");
+
+    /* shared pool hands out the same ids without consuming them */
+    sharedPool.init(feIds, true);
+    for (int i = 0; i < 4; i++) {
+        PAL_TEST_CHECK(!sharedPool.allocate(1, &sharedPool, ids), "shared allocate failed");
+        PAL_TEST_CHECK(ids.size() == 1 && ids[0] == feIds.back(), "shared pool id mismatch");
+    }
+    sharedPool.getStats(&stats);
+    PAL_TEST_CHECK(stats.shared && stats.inUse == 0, "shared pool consumed ids");
+
+    return palTestResult("FrontEndPoolStress");
+}
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checks the KV selector index built at PayloadBuilder::init against
+ * the linear scan over the usecaseKvManager.xml tables. Queries are
+ * derived from every entry of the shipped tables: one value per
+ * selector, the other values of multi-valued selectors, each single
+ * selector on its own, the entry plus an unknown CustomConfig (so the
+ * CUSTOM_CONFIG_SEL fallback runs) and the empty tuple. Both paths must
+ * return the same status and keys/values in the same order. Per lookup
+ * latency of both paths is reported.
+ *
+ * Usage: KVSelectorIndexTest
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include "PayloadBuilder.h"
+#include "PalTestUtils.h"
+
+typedef std::vector<std::pair<selector_type_t, std::string>> selectorTuple;
+
+struct kvQuery {
+    uint32_t type;
+    selectorTuple tuple;
+};
+
+class KVIndexTest : public PayloadBuilder
+{
+public:
+    static void run();
+
+private:
+    static void addQueries(const kvInfo &kv, uint32_t type,
+        std::vector<kvQuery> &queries);
+    static void checkTable(const char *name, std::vector<allKVs> &table);
+};
+
+/* selector_pairs are sorted, so the values of one selector are adjacent */
+void KVIndexTest::addQueries(const kvInfo &kv, uint32_t type,
+    std::vector<kvQuery> &queries)
+{
+    selectorTuple first;
+    selectorTuple last;
+    bool hasCustom = false;
+
+    for (auto &pair : kv.selector_pairs) {
+        if (first.empty() || first.back().first != pair.first)
+            first.push_back(pair);
+        if (!last.empty() && last.back().first == pair.first)
+            last.back() = pair;
+        else
+            last.push_back(pair);
+        if (pair.first == CUSTOM_CONFIG_SEL)
+            hasCustom = true;
+    }
+
+    queries.push_back({type, first});
+    if (last != first)
+        queries.push_back({type, last});
+    if (first.size() > 1) {
+        for (auto &pair : first)
+            queries.push_back({type, selectorTuple(1, pair)});
+    }
+    if (!hasCustom) {
+        queries.push_back({type, first});
+        queries.back().tuple.push_back(
+            std::make_pair(CUSTOM_CONFIG_SEL, std::string("kv-index-test")));
+    }
+}
+
+void KVIndexTest::checkTable(const char *name, std::vector<allKVs> &table)
+{
+    kvSelectorIndex *index = getKVIndex(table);
+    std::vector<kvQuery> queries;
+    std::vector<uint64_t> indexedNs;
+    std::vector<uint64_t> linearNs;
+    std::vector<std::pair<int32_t, int32_t>> indexedKV;
+    std::vector<std::pair<int32_t, int32_t>> linearKV;
+    selectorTuple tuple;
+    char label[64];
+    uint32_t mismatches = 0;
+    int indexedStatus;
+    int linearStatus;
+    uint64_t start;
+
+    PAL_TEST_CHECK(index && index->built, "%s: index not built", name);
+    if (!index || !index->built)
+        return;
+
+    for (auto &entry : table) {
+        for (int32_t type : entry.id_type) {
+            queries.push_back({(uint32_t)type, selectorTuple()});
+            for (auto &kv : entry.keys_values)
+                addQueries(kv, type, queries);
+        }
+    }
+
+    for (auto &q : queries) {
+        /* retrieveKVs sorts the tuple and may drop CustomConfig, pass copies */
+        indexedKV.clear();
+        tuple = q.tuple;
+        start = palTestNowNs();
+        indexedStatus = retrieveKVs(tuple, q.type, table, indexedKV);
+        indexedNs.push_back(palTestNowNs() - start);
+
+        linearKV.clear();
+        tuple = q.tuple;
+        index->built = false;
+        start = palTestNowNs();
+        linearStatus = retrieveKVs(tuple, q.type, table, linearKV);
+        linearNs.push_back(palTestNowNs() - start);
+        index->built = true;
+
+        if (indexedStatus != linearStatus || indexedKV != linearKV) {
+            mismatches++;
+            PAL_TEST_CHECK(false, "%s: type %u, %zu selectors: index %d/%zu kvs, "
+                           "scan %d/%zu kvs", name, q.type, q.tuple.size(),
+                           indexedStatus, indexedKV.size(), linearStatus,
+                           linearKV.size());
+        }
+    }
+
+    fprintf(stdout, "%s: %zu tables, %zu queries, %u mismatches\n", name,
+            table.size(), queries.size(), mismatches);
+    snprintf(label, sizeof(label), "%s indexed", name);
+    palTestReportLatency(label, indexedNs);
+    snprintf(label, sizeof(label), "%s linear", name);
+    palTestReportLatency(label, linearNs);
+}
+
+void KVIndexTest::run()
+{
+    int status = init();
+
+    PAL_TEST_CHECK(!status, "PayloadBuilder init failed %d", status);
+    if (status)
+        return;
+
+    checkTable("streams", all_streams);
+    checkTable("streampps", all_streampps);
+    checkTable("devices", all_devices);
+    checkTable("devicepps", all_devicepps);
+}
+
+int main(int argc, char *argv[])
+{
+    KVIndexTest::run();
+
+    return palTestResult("KVSelectorIndexTest");
+}
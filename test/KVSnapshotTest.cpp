@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Cold and warm PayloadBuilder::init time and KV snapshot freshness.
+ * Cold runs remove the snapshot first so usecaseKvManager.xml is parsed
+ * and the snapshot stored, warm runs load the snapshot; p50/p99 of both
+ * are reported and the warm tables must equal the parsed ones. A copy of
+ * the xml is then modified in place without changing its size or mtime,
+ * which the content hash in the snapshot header must catch. The snapshot
+ * is rebuilt from the real xml before exiting.
+ *
+ * Usage: KVSnapshotTest [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <vector>
+#include "PayloadBuilder.h"
+#include "PalTestUtils.h"
+
+/* must match PayloadBuilder.cpp */
+#define USECASE_XML_FILE "/vendor/etc/usecaseKvManager.xml"
+#define USECASE_KV_SNAPSHOT_FILE "/data/vendor/audio/usecaseKvManager.bin"
+#define XML_COPY "/data/vendor/audio/kv_snapshot_test.xml"
+
+class KVSnapshotTest : public PayloadBuilder
+{
+public:
+    static void run(int iterations);
+
+private:
+    static std::vector<uint8_t> serializeAll();
+    static void clearAll();
+    static int copyFile(const char *from, const char *to);
+    static void checkContentHash();
+};
+
+std::vector<uint8_t> KVSnapshotTest::serializeAll()
+{
+    std::vector<uint8_t> buf;
+
+    serializeKVTable(all_streams, buf);
+    serializeKVTable(all_streampps, buf);
+    serializeKVTable(all_devices, buf);
+    serializeKVTable(all_devicepps, buf);
+    return buf;
+}
+
+void KVSnapshotTest::clearAll()
+{
+    all_streams.clear();
+    all_streampps.clear();
+    all_devices.clear();
+    all_devicepps.clear();
+}
+
+int KVSnapshotTest::copyFile(const char *from, const char *to)
+{
+    char buf[4096];
+    ssize_t n;
+    int in, out, ret = 0;
+
+    in = open(from, O_RDONLY);
+    if (in < 0)
+        return -1;
+    out = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return -1;
+    }
+    while ((n = read(in, buf, sizeof(buf))) > 0) {
+        if (write(out, buf, n) != n) {
+            ret = -1;
+            break;
+        }
+    }
+    close(in);
+    close(out);
+    return n < 0 ? -1 : ret;
+}
+
+void KVSnapshotTest::checkContentHash()
+{
+    struct stat before, after;
+    struct timespec times[2];
+    uint32_t hash = 0;
+    char c;
+    int fd;
+
+    PAL_TEST_CHECK(!copyFile(USECASE_XML_FILE, XML_COPY), "copy of %s failed",
+                   USECASE_XML_FILE);
+    if (stat(XML_COPY, &before) || before.st_size < 2 || getKVXmlHash(XML_COPY, &hash)) {
+        PAL_TEST_CHECK(false, "cannot stat or hash %s", XML_COPY);
+        unlink(XML_COPY);
+        return;
+    }
+    storeKVSnapshot(XML_COPY, &before, hash);
+    clearAll();
+    PAL_TEST_CHECK(!loadKVSnapshot(XML_COPY, &before), "snapshot of unchanged xml rejected");
+
+    /* flip one byte in the middle, keep size and restore the timestamps */
+    fd = open(XML_COPY, O_RDWR);
+    if (fd >= 0) {
+        if (pread(fd, &c, 1, before.st_size / 2) == 1) {
+            c ^= 0x20;
+            PAL_TEST_CHECK(pwrite(fd, &c, 1, before.st_size / 2) == 1, "modify failed");
+        }
+        close(fd);
+    }
+    times[0] = before.st_atim;
+    times[1] = before.st_mtim;
+    utimensat(AT_FDCWD, XML_COPY, times, 0);
+    stat(XML_COPY, &after);
+    PAL_TEST_CHECK(after.st_size == before.st_size &&
+                   after.st_mtim.tv_sec == before.st_mtim.tv_sec &&
+                   after.st_mtim.tv_nsec == before.st_mtim.tv_nsec,
+                   "size or mtime of the modified copy changed");
+    clearAll();
+    PAL_TEST_CHECK(loadKVSnapshot(XML_COPY, &after) != 0,
+                   "snapshot accepted for modified xml of same size and mtime");
+    unlink(XML_COPY);
+}
+
+void KVSnapshotTest::run(int iterations)
+{
+    std::vector<uint64_t> coldNs, warmNs, hashNs;
+    std::vector<uint8_t> parsed;
+    uint32_t hash = 0;
+    uint64_t start;
+    int status;
+
+    for (int i = 0; i < iterations; i++) {
+        unlink(USECASE_KV_SNAPSHOT_FILE);
+        start = palTestNowNs();
+        status = init();
+        coldNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "cold init failed %d", status);
+    }
+    parsed = serializeAll();
+    PAL_TEST_CHECK(access(USECASE_KV_SNAPSHOT_FILE, R_OK) == 0,
+                   "no snapshot stored at %s", USECASE_KV_SNAPSHOT_FILE);
+
+    for (int i = 0; i < iterations; i++) {
+        start = palTestNowNs();
+        status = init();
+        warmNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "warm init failed %d", status);
+        PAL_TEST_CHECK(serializeAll() == parsed, "snapshot tables differ from xml");
+
+        start = palTestNowNs();
+        getKVXmlHash(USECASE_XML_FILE, &hash);
+        hashNs.push_back(palTestNowNs() - start);
+    }
+
+    fprintf(stdout, "KV tables %zu bytes serialized\n", parsed.size());
+    palTestReportLatency("init cold (parse + store)", coldNs);
+    palTestReportLatency("init warm (snapshot)", warmNs);
+    palTestReportLatency("xml content hash", hashNs);
+
+    checkContentHash();
+
+    /* the snapshot now belongs to the copy, rebuild it for the real xml */
+    status = init();
+    PAL_TEST_CHECK(!status, "final init failed %d", status);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+
+    KVSnapshotTest::run(iterations);
+
+    return palTestResult("KVSnapshotTest");
+}
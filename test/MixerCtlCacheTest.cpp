@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checks that the SessionAlsaUtils mixer control cache does not outlive
+ * the mixer it was filled from. The card is opened, controls are looked
+ * up twice (miss, then hit on the same pointer), the mixer is dropped
+ * from the cache and closed the way ResourceManager does on SSR and on
+ * init failure, and then reopened. A new mixer may come back at the same
+ * address, so every lookup on it must match mixer_get_ctl_by_name on the
+ * new mixer rather than return a control of the closed one. Cached and
+ * uncached lookup latency over all controls of the card is reported.
+ * Run it with the audio HAL stopped or on the virtual card.
+ *
+ * Usage: MixerCtlCacheTest [card] [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <tinyalsa/asoundlib.h>
+#include "SessionAlsaUtils.h"
+#include "PalTestUtils.h"
+
+#define DEFAULT_CARD 100
+
+static void collectNames(struct mixer *am, std::vector<std::string> &names)
+{
+    unsigned int count = mixer_get_num_ctls(am);
+
+    names.clear();
+    for (unsigned int i = 0; i < count; i++) {
+        struct mixer_ctl *ctl = mixer_get_ctl(am, i);
+        const char *name = ctl ? mixer_ctl_get_name(ctl) : NULL;
+
+        /* lookup by name returns the first match, skip duplicates */
+        if (name && mixer_get_ctl_by_name(am, name) == ctl)
+            names.push_back(name);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned int card = argc > 1 ? atoi(argv[1]) : DEFAULT_CARD;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+    pal_param_session_cache_stats_t before, after;
+    std::vector<std::string> names;
+    std::vector<uint64_t> cachedNs, uncachedNs;
+    struct mixer *am, *oldAm;
+    uint32_t reused = 0;
+
+    am = mixer_open(card);
+    if (!am) {
+        fprintf(stderr, "mixer_open(%u) failed\n", card);
+        return 1;
+    }
+    collectNames(am, names);
+    if (names.empty()) {
+        fprintf(stderr, "card %u has no controls\n", card);
+        mixer_close(am);
+        return 1;
+    }
+
+    SessionAlsaUtils::getCacheStats(&before);
+    for (auto &name : names) {
+        struct mixer_ctl *first = SessionAlsaUtils::getMixerControl(am, name.c_str());
+        struct mixer_ctl *second = SessionAlsaUtils::getMixerControl(am, name.c_str());
+
+        PAL_TEST_CHECK(first == mixer_get_ctl_by_name(am, name.c_str()),
+                       "first lookup of %s does not match the mixer", name.c_str());
+        PAL_TEST_CHECK(second == first, "cached lookup of %s changed", name.c_str());
+    }
+    SessionAlsaUtils::getCacheStats(&after);
+    PAL_TEST_CHECK(after.mixer_ctl_misses - before.mixer_ctl_misses == names.size(),
+                   "misses %llu, expected %zu",
+                   (unsigned long long)(after.mixer_ctl_misses - before.mixer_ctl_misses),
+                   names.size());
+    PAL_TEST_CHECK(after.mixer_ctl_hits - before.mixer_ctl_hits == names.size(),
+                   "hits %llu, expected %zu",
+                   (unsigned long long)(after.mixer_ctl_hits - before.mixer_ctl_hits),
+                   names.size());
+    PAL_TEST_CHECK(after.mixer_ctl_entries >= names.size(),
+                   "%u entries cached, expected at least %zu",
+                   after.mixer_ctl_entries, names.size());
+
+    for (int i = 0; i < iterations; i++) {
+        SessionAlsaUtils::getCacheStats(&before);
+        oldAm = am;
+        SessionAlsaUtils::clearMixerControlCache(am);
+        mixer_close(am);
+        SessionAlsaUtils::getCacheStats(&after);
+        PAL_TEST_CHECK(after.mixer_ctl_dropped - before.mixer_ctl_dropped >= names.size(),
+                       "close dropped %llu entries, expected %zu",
+                       (unsigned long long)(after.mixer_ctl_dropped - before.mixer_ctl_dropped),
+                       names.size());
+
+        am = mixer_open(card);
+        if (!am) {
+            fprintf(stderr, "mixer_open(%u) failed on reopen %d\n", card, i);
+            return 1;
+        }
+        if (am == oldAm)
+            reused++;
+
+        SessionAlsaUtils::getCacheStats(&before);
+        for (auto &name : names) {
+            struct mixer_ctl *ctl = SessionAlsaUtils::getMixerControl(am, name.c_str());
+
+            PAL_TEST_CHECK(ctl == mixer_get_ctl_by_name(am, name.c_str()),
+                           "reopen %d: %s resolved to a control of the closed mixer",
+                           i, name.c_str());
+        }
+        SessionAlsaUtils::getCacheStats(&after);
+        PAL_TEST_CHECK(after.mixer_ctl_hits == before.mixer_ctl_hits,
+                       "reopen %d: %llu lookups hit entries of the closed mixer", i,
+                       (unsigned long long)(after.mixer_ctl_hits - before.mixer_ctl_hits));
+    }
+    fprintf(stdout, "reopen returned the old mixer address %u/%d times\n",
+            reused, iterations);
+
+    for (auto &name : names) {
+        uint64_t start = palTestNowNs();
+
+        SessionAlsaUtils::getMixerControl(am, name.c_str());
+        cachedNs.push_back(palTestNowNs() - start);
+        start = palTestNowNs();
+        mixer_get_ctl_by_name(am, name.c_str());
+        uncachedNs.push_back(palTestNowNs() - start);
+    }
+    fprintf(stdout, "%zu controls on card %u\n", names.size(), card);
+    palTestReportLatency("getMixerControl (cached)", cachedNs);
+    palTestReportLatency("mixer_get_ctl_by_name", uncachedNs);
+
+    SessionAlsaUtils::clearMixerControlCache(am);
+    mixer_close(am);
+    return palTestResult("MixerCtlCacheTest");
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Cold start time of PAL. Every iteration forks a child that runs
+ * pal_init and pal_deinit in a fresh process, so the config parses start
+ * from nothing but the page cache. The child times pal_init and reads the
+ * split from the API latency stats: the ResourceManager constructor, the
+ * usecaseKvManager.xml and mixer paths parses on their async tasks and
+ * the time the constructor blocks joining them. The serial estimate adds
+ * the task times back onto the constructor time minus the join wait.
+ * Needs vendor.audio.pal.latency_stats set and the audio HAL stopped.
+ *
+ * Usage: PalColdStartTest [iterations]
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+struct coldStartSample {
+    int status;
+    uint64_t initNs;
+    uint64_t rmInitUs;
+    uint64_t kvXmlUs;
+    uint64_t audioRouteUs;
+    uint64_t joinUs;
+};
+
+static void runChild(int fd)
+{
+    struct coldStartSample sample;
+    pal_param_latency_stats_t *stats = NULL;
+    size_t size = 0;
+    uint64_t start;
+
+    memset(&sample, 0, sizeof(sample));
+    start = palTestNowNs();
+    sample.status = pal_init();
+    sample.initNs = palTestNowNs() - start;
+    if (!sample.status &&
+        !pal_get_param(PAL_PARAM_ID_API_LATENCY_STATS, (void **)&stats, &size, NULL) &&
+        stats && size >= sizeof(*stats)) {
+        sample.rmInitUs = stats->hist[PAL_LATENCY_RM_INIT].total_us;
+        sample.kvXmlUs = stats->hist[PAL_LATENCY_RM_INIT_KV_XML].total_us;
+        sample.audioRouteUs = stats->hist[PAL_LATENCY_RM_INIT_AUDIO_ROUTE].total_us;
+        sample.joinUs = stats->hist[PAL_LATENCY_RM_INIT_JOIN].total_us;
+    }
+    free(stats);
+    if (write(fd, &sample, sizeof(sample)) != sizeof(sample))
+        fprintf(stderr, "sample write failed\n");
+    if (!sample.status)
+        pal_deinit();
+    _exit(0);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 10;
+    std::vector<uint64_t> initNs, rmInitNs, kvXmlNs, audioRouteNs, joinNs, serialNs;
+    struct coldStartSample sample;
+    bool haveStats = true;
+    int fds[2];
+    pid_t pid;
+
+    for (int i = 0; i < iterations; i++) {
+        if (pipe(fds)) {
+            PAL_TEST_CHECK(false, "pipe failed");
+            break;
+        }
+        pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            runChild(fds[1]);
+        }
+        close(fds[1]);
+        memset(&sample, 0, sizeof(sample));
+        if (pid < 0 || read(fds[0], &sample, sizeof(sample)) != sizeof(sample))
+            sample.status = -EIO;
+        close(fds[0]);
+        if (pid > 0)
+            waitpid(pid, NULL, 0);
+
+        PAL_TEST_CHECK(!sample.status, "pal_init %d failed %d", i, sample.status);
+        if (sample.status)
+            continue;
+        initNs.push_back(sample.initNs);
+        if (!sample.rmInitUs) {
+            haveStats = false;
+            continue;
+        }
+        rmInitNs.push_back(sample.rmInitUs * 1000);
+        kvXmlNs.push_back(sample.kvXmlUs * 1000);
+        audioRouteNs.push_back(sample.audioRouteUs * 1000);
+        joinNs.push_back(sample.joinUs * 1000);
+        serialNs.push_back((sample.rmInitUs - sample.joinUs + sample.kvXmlUs +
+                            sample.audioRouteUs) * 1000);
+    }
+
+    palTestReportLatency("pal_init", initNs);
+    if (!haveStats) {
+        fprintf(stdout, "latency stats disabled, set vendor.audio.pal.latency_stats\n");
+    } else {
+        palTestReportLatency("ResourceManager()", rmInitNs);
+        palTestReportLatency("  usecaseKvManager.xml task", kvXmlNs);
+        palTestReportLatency("  mixer paths task", audioRouteNs);
+        palTestReportLatency("  join wait", joinNs);
+        palTestReportLatency("ResourceManager() serial estimate", serialNs);
+    }
+    return palTestResult("PalColdStartTest");
+}
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * End to end device switch time with several playback streams running
+ * on one backend. Opens 4 to 8 low latency and deep buffer streams on
+ * the first device, then repeatedly moves the first stream between the
+ * two devices. When both devices share a backend, ResourceManager moves
+ * every stream along in one switch, which is checked after each switch
+ * through pal_stream_get_device. Reports the pal_stream_set_device time,
+ * the ResourceManager switch time from the API latency stats (needs
+ * vendor.audio.pal.latency_stats) and the backend config writes sent and
+ * skipped per switch from PAL_PARAM_ID_SESSION_CACHE_STATS.
+ *
+ * Usage: PalDeviceSwitchLatency [streams] [iterations] [device id] [device id]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+#define MIN_STREAMS 4
+#define MAX_STREAMS 8
+#define BUF_SIZE 3840 /* 20 ms of 48 kHz stereo 16 bit */
+#define SETTLE_US (200 * 1000)
+
+static std::atomic<bool> done(false);
+
+static int getCacheStats(pal_param_session_cache_stats_t *stats)
+{
+    void *payload = NULL;
+    size_t size = 0;
+    int status;
+
+    status = pal_get_param(PAL_PARAM_ID_SESSION_CACHE_STATS, &payload, &size, NULL);
+    if (status || !payload || size != sizeof(*stats)) {
+        free(payload);
+        return status ? status : -EINVAL;
+    }
+    memcpy(stats, payload, sizeof(*stats));
+    free(payload);
+    return 0;
+}
+
+static void setDevice(struct pal_device *device, pal_device_id_t id,
+                      struct pal_media_config *config)
+{
+    memset(device, 0, sizeof(*device));
+    device->id = id;
+    device->config = *config;
+}
+
+static pal_stream_handle_t *openPlayback(int idx, pal_device_id_t id)
+{
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    pal_stream_handle_t *handle = NULL;
+    int status;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.type = (idx & 1) ? PAL_STREAM_DEEP_BUFFER : PAL_STREAM_LOW_LATENCY;
+    attr.direction = PAL_AUDIO_OUTPUT;
+    attr.out_media_config.sample_rate = 48000;
+    attr.out_media_config.bit_width = 16;
+    attr.out_media_config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    attr.out_media_config.ch_info.channels = 2;
+    attr.out_media_config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    attr.out_media_config.ch_info.ch_map[1] = PAL_CHMAP_CHANNEL_FR;
+    setDevice(&device, id, &attr.out_media_config);
+
+    status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, &handle);
+    if (status || !handle) {
+        fprintf(stderr, "pal_stream_open %d on device %d failed %d\n", idx, id, status);
+        return NULL;
+    }
+    status = pal_stream_start(handle);
+    if (status) {
+        fprintf(stderr, "pal_stream_start %d failed %d\n", idx, status);
+        pal_stream_close(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+static void writer(pal_stream_handle_t *handle)
+{
+    static uint8_t silence[BUF_SIZE];
+    struct pal_buffer buf;
+
+    while (!done.load()) {
+        memset(&buf, 0, sizeof(buf));
+        buf.buffer = silence;
+        buf.size = sizeof(silence);
+        if (pal_stream_write(handle, &buf) < 0)
+            usleep(20 * 1000);
+    }
+}
+
+/* streams currently routed to id */
+static int countOnDevice(std::vector<pal_stream_handle_t *> &handles, pal_device_id_t id)
+{
+    struct pal_device device;
+    int n = 0;
+
+    for (auto h : handles) {
+        memset(&device, 0, sizeof(device));
+        if (!pal_stream_get_device(h, 1, &device) && device.id == id)
+            n++;
+    }
+    return n;
+}
+
+static void reportSwitchStats(int switches)
+{
+    pal_param_latency_stats_t *stats = NULL;
+    const pal_latency_hist_t *sw;
+    size_t size = 0;
+    int status;
+
+    status = pal_get_param(PAL_PARAM_ID_API_LATENCY_STATS, (void **)&stats, &size, NULL);
+    if (status || !stats || size < sizeof(*stats)) {
+        fprintf(stdout, "latency stats unavailable %d\n", status);
+        free(stats);
+        return;
+    }
+    sw = &stats->hist[PAL_LATENCY_RM_DEVICE_SWITCH];
+    if (!sw->count)
+        fprintf(stdout, "latency stats disabled, set vendor.audio.pal.latency_stats\n");
+    else
+        fprintf(stdout, "streamDevSwitch: n %llu (%d set_device) avg %llu us max %llu us\n",
+                (unsigned long long)sw->count, switches,
+                (unsigned long long)(sw->total_us / sw->count),
+                (unsigned long long)sw->max_us);
+    free(stats);
+}
+
+int main(int argc, char *argv[])
+{
+    int numStreams = argc > 1 ? atoi(argv[1]) : MIN_STREAMS;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+    pal_device_id_t devices[2] = {
+        argc > 3 ? (pal_device_id_t)atoi(argv[3]) : PAL_DEVICE_OUT_SPEAKER,
+        argc > 4 ? (pal_device_id_t)atoi(argv[4]) : PAL_DEVICE_OUT_HANDSET,
+    };
+    pal_param_session_cache_stats_t before, after;
+    std::vector<pal_stream_handle_t *> handles;
+    std::vector<std::thread> writers;
+    std::vector<uint64_t> switchNs;
+    struct pal_media_config config;
+    struct pal_device device;
+    bool haveCacheStats;
+    int followed = 0;
+    uint64_t start;
+    int status;
+
+    numStreams = std::min(std::max(numStreams, MIN_STREAMS), MAX_STREAMS);
+    for (int i = 0; i < numStreams; i++) {
+        pal_stream_handle_t *h = openPlayback(i, devices[0]);
+
+        if (!h)
+            break;
+        handles.push_back(h);
+        writers.push_back(std::thread(writer, h));
+    }
+    PAL_TEST_CHECK((int)handles.size() == numStreams, "opened %zu of %d streams",
+                   handles.size(), numStreams);
+    if (handles.empty())
+        goto exit;
+
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = 48000;
+    config.bit_width = 16;
+    config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    config.ch_info.channels = 2;
+    config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    config.ch_info.ch_map[1] = PAL_CHMAP_CHANNEL_FR;
+
+    usleep(SETTLE_US);
+    pal_set_param(PAL_PARAM_ID_API_LATENCY_STATS, NULL, 0);
+    haveCacheStats = !getCacheStats(&before);
+
+    for (int i = 0; i < iterations; i++) {
+        pal_device_id_t to = devices[(i + 1) & 1];
+
+        setDevice(&device, to, &config);
+        start = palTestNowNs();
+        status = pal_stream_set_device(handles[0], 1, &device);
+        switchNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "switch %d to device %d failed %d", i, to, status);
+        followed += countOnDevice(handles, to);
+        usleep(SETTLE_US);
+    }
+
+    fprintf(stdout, "%zu streams, %.1f on the new device after each switch\n",
+            handles.size(), iterations ? (double)followed / iterations : 0.0);
+    if (followed <= iterations)
+        fprintf(stdout, "devices %d and %d do not share a backend here, only one "
+                "stream moved per switch\n", devices[0], devices[1]);
+    palTestReportLatency("pal_stream_set_device", switchNs);
+    reportSwitchStats(iterations);
+    if (haveCacheStats && !getCacheStats(&after) && iterations)
+        fprintf(stdout, "backend config writes per switch: sent %.1f skipped %.1f\n",
+                (double)(after.be_ctl_writes - before.be_ctl_writes) / iterations,
+                (double)(after.be_ctl_skipped - before.be_ctl_skipped) / iterations);
+
+exit:
+    done = true;
+    for (auto &t : writers)
+        t.join();
+    for (auto h : handles) {
+        pal_stream_stop(h);
+        pal_stream_close(h);
+    }
+    return palTestResult("PalDeviceSwitchLatency");
+}
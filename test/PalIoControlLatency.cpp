@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Latency of control calls on a playback stream while another thread
+ * keeps a blocking pal_stream_write in flight, compared with the same
+ * calls on an idle started stream. Read/write run without the stream
+ * mutex, so set_volume and pause/resume must not wait for a write to
+ * complete: their p99 under I/O has to stay below the median time of
+ * one blocking write. Stop and close are timed with a write blocked,
+ * they have to return within the I/O quiesce budget. Run it with no
+ * other audio active.
+ *
+ * Usage: PalIoControlLatency [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+#define BUF_COUNT 4
+#define BUF_SIZE 3840 /* 20 ms of 48 kHz stereo 16 bit */
+#define STOP_BUDGET_NS (2 * 500 * 1000000ULL) /* twice IO_QUIESCE_TIMEOUT_MS */
+
+struct writerState {
+    std::atomic<bool> done{false};
+    std::atomic<uint64_t> writes{0};
+    std::vector<uint64_t> writeNs;
+};
+
+static pal_stream_handle_t *openPlayback()
+{
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    pal_buffer_config_t outCfg = {BUF_COUNT, BUF_SIZE, 0};
+    pal_stream_handle_t *handle = NULL;
+    int status;
+
+    memset(&attr, 0, sizeof(attr));
+    memset(&device, 0, sizeof(device));
+    attr.type = PAL_STREAM_LOW_LATENCY;
+    attr.direction = PAL_AUDIO_OUTPUT;
+    attr.out_media_config.sample_rate = 48000;
+    attr.out_media_config.bit_width = 16;
+    attr.out_media_config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    attr.out_media_config.ch_info.channels = 2;
+    attr.out_media_config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    attr.out_media_config.ch_info.ch_map[1] = PAL_CHMAP_CHANNEL_FR;
+    device.id = PAL_DEVICE_OUT_SPEAKER;
+    device.config = attr.out_media_config;
+
+    status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, &handle);
+    if (status || !handle) {
+        fprintf(stderr, "pal_stream_open failed %d\n", status);
+        return NULL;
+    }
+    status = pal_stream_set_buffer_size(handle, NULL, &outCfg);
+    if (!status)
+        status = pal_stream_start(handle);
+    if (status) {
+        fprintf(stderr, "stream setup failed %d\n", status);
+        pal_stream_close(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+static void writer(pal_stream_handle_t *handle, writerState *st)
+{
+    static uint8_t silence[BUF_SIZE];
+    struct pal_buffer buf;
+    uint64_t start;
+    ssize_t ret;
+
+    while (!st->done.load()) {
+        memset(&buf, 0, sizeof(buf));
+        buf.buffer = silence;
+        buf.size = sizeof(silence);
+        start = palTestNowNs();
+        ret = pal_stream_write(handle, &buf);
+        if (ret < 0)
+            break;
+        st->writeNs.push_back(palTestNowNs() - start);
+        st->writes.fetch_add(1);
+    }
+}
+
+static void measureControls(pal_stream_handle_t *handle, int iterations,
+                            std::vector<uint64_t> &volumeNs,
+                            std::vector<uint64_t> &pauseNs)
+{
+    uint8_t volBuf[sizeof(struct pal_volume_data) +
+                   sizeof(struct pal_channel_vol_kv)];
+    struct pal_volume_data *vol = (struct pal_volume_data *)volBuf;
+    uint64_t start;
+    int status;
+
+    vol->no_of_volpair = 1;
+    vol->volume_pair[0].channel_mask = 0x3;
+    for (int i = 0; i < iterations; i++) {
+        vol->volume_pair[0].vol = (i & 1) ? 1.0f : 0.5f;
+        start = palTestNowNs();
+        status = pal_stream_set_volume(handle, vol);
+        volumeNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "set_volume failed %d", status);
+
+        start = palTestNowNs();
+        status = pal_stream_pause(handle);
+        if (!status)
+            status = pal_stream_resume(handle);
+        pauseNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "pause/resume failed %d", status);
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(3));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    std::vector<uint64_t> idleVolume, idlePause, ioVolume, ioPause;
+    std::vector<uint64_t> stopNs;
+    pal_stream_handle_t *handle;
+    writerState st;
+    uint64_t writeP50;
+    uint64_t start;
+    int status;
+
+    if (iterations <= 0) {
+        fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+        return 1;
+    }
+
+    /* started stream with no writer, underruns are fine here */
+    handle = openPlayback();
+    if (!handle)
+        return 1;
+    measureControls(handle, iterations, idleVolume, idlePause);
+    pal_stream_stop(handle);
+    pal_stream_close(handle);
+
+    handle = openPlayback();
+    if (!handle)
+        return 1;
+    std::thread io(writer, handle, &st);
+    /* let the buffers fill so every write blocks */
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    measureControls(handle, iterations, ioVolume, ioPause);
+
+    /* stop with a write in flight goes through the I/O quiesce */
+    start = palTestNowNs();
+    status = pal_stream_stop(handle);
+    stopNs.push_back(palTestNowNs() - start);
+    PAL_TEST_CHECK(!status, "stop with I/O in flight failed %d", status);
+    st.done.store(true);
+    start = palTestNowNs();
+    status = pal_stream_close(handle);
+    stopNs.push_back(palTestNowNs() - start);
+    PAL_TEST_CHECK(!status, "close failed %d", status);
+    io.join();
+
+    PAL_TEST_CHECK(st.writes.load() > 0, "no write completed");
+    writeP50 = palTestPercentile(st.writeNs, 50);
+    palTestReportLatency("write call", st.writeNs);
+    palTestReportLatency("idle set_volume", idleVolume);
+    palTestReportLatency("idle pause/resume", idlePause);
+    palTestReportLatency("I/O set_volume", ioVolume);
+    palTestReportLatency("I/O pause/resume", ioPause);
+    palTestReportLatency("I/O stop, close", stopNs);
+
+    PAL_TEST_CHECK(palTestPercentile(ioVolume, 99) < writeP50,
+                   "set_volume p99 waits for write, %llu ns vs write %llu ns",
+                   (unsigned long long)palTestPercentile(ioVolume, 99),
+                   (unsigned long long)writeP50);
+    PAL_TEST_CHECK(stopNs.back() < STOP_BUDGET_NS && stopNs.front() < STOP_BUDGET_NS,
+                   "stop/close took %llu/%llu ns",
+                   (unsigned long long)stopNs.front(),
+                   (unsigned long long)stopNs.back());
+
+    return palTestResult("PalIoControlLatency");
+}
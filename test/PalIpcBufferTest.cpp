@@ -0,0 +1,321 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Per-buffer heap allocations, payload sized allocations and fd dups
+ * added by the HIDL server wrapper on ipc_pal_stream_write and
+ * ipc_pal_stream_read. The PAL service implementation is loaded in
+ * process and driven with the PalBuffer vectors the client sends, and
+ * the same buffers are also passed to pal_stream_write/pal_stream_read
+ * directly on the same stream. malloc, calloc and realloc are counted on
+ * the calling thread only, so the difference between the two paths is
+ * what the wrapper costs. A payload sized allocation is where a copy of
+ * the audio data would land. Binder marshalling is not part of this
+ * measurement. Stop the audio HAL before running it.
+ *
+ * Usage: PalIpcBufferTest [buffers]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <dirent.h>
+#include <errno.h>
+#include <vector>
+#include "pal_server_wrapper.h"
+#define PAL_TEST_COUNT_ALLOCS
+#include "PalTestUtils.h"
+
+#define BUF_SIZE 3840 /* 20 ms of 48 kHz stereo 16 bit */
+#define IN_BUF_SIZE 1920 /* 20 ms of 48 kHz mono 16 bit */
+
+using vendor::qti::hardware::pal::V1_0::implementation::PAL;
+using vendor::qti::hardware::pal::V1_0::IPALCallback;
+using vendor::qti::hardware::pal::V1_0::PalBuffer;
+using vendor::qti::hardware::pal::V1_0::PalDevice;
+using vendor::qti::hardware::pal::V1_0::PalStreamAttributes;
+using vendor::qti::hardware::pal::V1_0::ModifierKV;
+using vendor::qti::hardware::pal::V1_0::PalEventReadWriteDonePayload;
+using android::hardware::hidl_vec;
+using android::hardware::hidl_memory;
+using android::hardware::hidl_handle;
+using android::hardware::Return;
+
+class TestCallback : public IPALCallback {
+public:
+    Return<int32_t> event_callback(uint64_t, uint32_t, uint32_t,
+                                   const hidl_vec<uint8_t> &, uint64_t) override
+    {
+        return 0;
+    }
+    Return<int32_t> event_callback_rw_done(uint64_t, uint32_t, uint32_t,
+                                           const hidl_vec<PalEventReadWriteDonePayload> &,
+                                           uint64_t) override
+    {
+        return 0;
+    }
+};
+
+static int countFds()
+{
+    DIR *dir = opendir("/proc/self/fd");
+    struct dirent *ent;
+    int count = 0;
+
+    if (!dir)
+        return -1;
+    while ((ent = readdir(dir)))
+        count++;
+    closedir(dir);
+    return count;
+}
+
+static uint64_t openStream(PAL *pal, const sp<IPALCallback> &cb, bool input)
+{
+    hidl_vec<PalStreamAttributes> attr;
+    hidl_vec<PalDevice> dev;
+    hidl_vec<ModifierKV> mods;
+    struct pal_media_config config;
+    uint64_t handle = 0;
+    int32_t status = -EINVAL;
+
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = 48000;
+    config.bit_width = 16;
+    config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    config.ch_info.channels = input ? 1 : 2;
+    config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    config.ch_info.ch_map[1] = PAL_CHMAP_CHANNEL_FR;
+
+    attr.resize(1);
+    memset(attr.data(), 0, sizeof(PalStreamAttributes));
+    attr[0].type = (vendor::qti::hardware::pal::V1_0::PalStreamType)
+                   (input ? PAL_STREAM_DEEP_BUFFER : PAL_STREAM_LOW_LATENCY);
+    attr[0].direction = (vendor::qti::hardware::pal::V1_0::PalStreamDirection)
+                        (input ? PAL_AUDIO_INPUT : PAL_AUDIO_OUTPUT);
+    memcpy(input ? &attr[0].in_media_config : &attr[0].out_media_config,
+           &config, sizeof(config));
+    dev.resize(1);
+    dev[0].id = (vendor::qti::hardware::pal::V1_0::PalDeviceId)
+                (input ? PAL_DEVICE_IN_HANDSET_MIC : PAL_DEVICE_OUT_SPEAKER);
+    memcpy(&dev[0].config, &config, sizeof(config));
+
+    pal->ipc_pal_stream_open(attr, 1, dev, 0, mods, cb, 0,
+                             [&](int32_t ret, uint64_t streamHandle) {
+                                 status = ret;
+                                 handle = streamHandle;
+                             });
+    if (status || !handle) {
+        fprintf(stderr, "ipc_pal_stream_open(%s) failed %d\n",
+                input ? "input" : "output", status);
+        return 0;
+    }
+    status = pal_stream_start((pal_stream_handle_t *)handle);
+    if (status) {
+        fprintf(stderr, "pal_stream_start failed %d\n", status);
+        pal->ipc_pal_stream_close(handle);
+        return 0;
+    }
+    return handle;
+}
+
+/* the PalBuffer vector pal_client_wrapper sends */
+static void fillHidlBuffer(hidl_vec<PalBuffer> &vec, native_handle_t *nh,
+                           uint8_t *data, uint32_t size, bool external)
+{
+    PalBuffer *palBuff;
+
+    vec.resize(1);
+    palBuff = vec.data();
+    palBuff->size = size;
+    if (external)
+        palBuff->buffer.setToExternal(data, size);
+    palBuff->alloc_info.alloc_handle = hidl_memory("arpal_alloc_handle",
+                                                   hidl_handle(nh), 0);
+}
+
+static void report(const char *name, std::vector<palTestAllocCount> &ipc,
+                   std::vector<palTestAllocCount> &direct, int fds, int buffers,
+                   std::vector<uint64_t> &ipcNs, std::vector<uint64_t> &directNs)
+{
+    std::vector<uint64_t> a, b, p;
+    std::vector<uint64_t> da, db, dp;
+    char label[64];
+
+    for (auto &c : ipc) {
+        a.push_back(c.allocs);
+        b.push_back(c.bytes);
+        p.push_back(c.largeAllocs);
+    }
+    for (auto &c : direct) {
+        da.push_back(c.allocs);
+        db.push_back(c.bytes);
+        dp.push_back(c.largeAllocs);
+    }
+    fprintf(stdout, "%s per buffer (median, wrapper minus direct): "
+            "allocs %lld bytes %lld payload sized allocs %lld fds %.2f\n", name,
+            (long long)palTestPercentile(a, 50) - (long long)palTestPercentile(da, 50),
+            (long long)palTestPercentile(b, 50) - (long long)palTestPercentile(db, 50),
+            (long long)palTestPercentile(p, 50) - (long long)palTestPercentile(dp, 50),
+            buffers ? (double)fds / buffers : 0.0);
+    PAL_TEST_CHECK(palTestPercentile(p, 50) <= palTestPercentile(dp, 50),
+                   "%s: wrapper allocates a payload sized buffer", name);
+    snprintf(label, sizeof(label), "%s via wrapper", name);
+    palTestReportLatency(label, ipcNs);
+    snprintf(label, sizeof(label), "%s direct", name);
+    palTestReportLatency(label, directNs);
+}
+
+static void measureWrite(PAL *pal, const sp<IPALCallback> &cb, int buffers)
+{
+    static uint8_t silence[BUF_SIZE];
+    std::vector<palTestAllocCount> ipc, direct;
+    std::vector<uint64_t> ipcNs, directNs;
+    native_handle_t *nh = native_handle_create(1, 1);
+    hidl_vec<PalBuffer> vec;
+    struct pal_buffer buf;
+    uint64_t handle, start;
+    int fdsBefore, fdsAfter;
+
+    handle = openStream(pal, cb, false);
+    if (!handle || !nh) {
+        palTestErrors++;
+        goto exit;
+    }
+    nh->data[0] = nh->data[1] = 0;
+    palTestLargeAlloc = BUF_SIZE;
+
+    fillHidlBuffer(vec, nh, silence, sizeof(silence), true);
+    fdsBefore = countFds();
+    for (int i = 0; i < buffers; i++) {
+        start = palTestNowNs();
+        palTestCountStart();
+        pal->ipc_pal_stream_write(handle, vec);
+        ipc.push_back(palTestCountStop());
+        ipcNs.push_back(palTestNowNs() - start);
+    }
+    fdsAfter = countFds();
+
+    for (int i = 0; i < buffers; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.buffer = silence;
+        buf.size = sizeof(silence);
+        start = palTestNowNs();
+        palTestCountStart();
+        pal_stream_write((pal_stream_handle_t *)handle, &buf);
+        direct.push_back(palTestCountStop());
+        directNs.push_back(palTestNowNs() - start);
+    }
+    report("write", ipc, direct, fdsAfter - fdsBefore, buffers, ipcNs, directNs);
+
+    pal_stream_stop((pal_stream_handle_t *)handle);
+    pal->ipc_pal_stream_close(handle);
+exit:
+    if (nh)
+        native_handle_delete(nh);
+}
+
+static void measureRead(PAL *pal, const sp<IPALCallback> &cb, int buffers)
+{
+    static uint8_t data[IN_BUF_SIZE];
+    std::vector<palTestAllocCount> ipc, direct;
+    std::vector<uint64_t> ipcNs, directNs;
+    native_handle_t *nh = native_handle_create(1, 1);
+    hidl_vec<PalBuffer> vec;
+    struct pal_buffer buf;
+    uint64_t handle, start;
+    int fdsBefore, fdsAfter;
+
+    handle = openStream(pal, cb, true);
+    if (!handle || !nh) {
+        palTestErrors++;
+        goto exit;
+    }
+    nh->data[0] = nh->data[1] = 0;
+    palTestLargeAlloc = IN_BUF_SIZE;
+
+    fillHidlBuffer(vec, nh, NULL, sizeof(data), false);
+    fdsBefore = countFds();
+    for (int i = 0; i < buffers; i++) {
+        start = palTestNowNs();
+        palTestCountStart();
+        pal->ipc_pal_stream_read(handle, vec,
+                                 [](int32_t, const hidl_vec<PalBuffer> &) {});
+        ipc.push_back(palTestCountStop());
+        ipcNs.push_back(palTestNowNs() - start);
+    }
+    fdsAfter = countFds();
+
+    for (int i = 0; i < buffers; i++) {
+        memset(&buf, 0, sizeof(buf));
+        buf.buffer = data;
+        buf.size = sizeof(data);
+        start = palTestNowNs();
+        palTestCountStart();
+        pal_stream_read((pal_stream_handle_t *)handle, &buf);
+        direct.push_back(palTestCountStop());
+        directNs.push_back(palTestNowNs() - start);
+    }
+    /*
+     * The reply vector is the one payload sized allocation the read path
+     * needs, it is what gets marshalled back to the client.
+     */
+    for (auto &c : ipc)
+        if (c.largeAllocs)
+            c.largeAllocs--;
+    report("read", ipc, direct, fdsAfter - fdsBefore, buffers, ipcNs, directNs);
+
+    pal_stream_stop((pal_stream_handle_t *)handle);
+    pal->ipc_pal_stream_close(handle);
+exit:
+    if (nh)
+        native_handle_delete(nh);
+}
+
+int main(int argc, char *argv[])
+{
+    int buffers = argc > 1 ? atoi(argv[1]) : 100;
+    sp<PAL> pal = new PAL();
+    sp<IPALCallback> cb = new TestCallback();
+    int status;
+
+    status = pal_init();
+    if (status) {
+        fprintf(stderr, "pal_init failed %d\n", status);
+        return 1;
+    }
+    measureWrite(pal.get(), cb, buffers);
+    measureRead(pal.get(), cb, buffers);
+    pal_deinit();
+    return palTestResult("PalIpcBufferTest");
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Per call cost of PalLatencyScope. Times batches of calls to an empty
+ * out of line function with no scope, with a scope while stats are
+ * disabled and with a scope while they are enabled, first on one thread
+ * and then with several threads recording into the same point. Each
+ * reported sample is one batch of 1000 calls, so the microseconds
+ * printed per batch read as nanoseconds per call. Also checks that a
+ * disabled scope records nothing and an enabled one records every call.
+ *
+ * Usage: PalLatencyScopeOverhead [batches] [threads]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+#include "PalLatencyStats.h"
+#include "PalTestUtils.h"
+
+#define BATCH_CALLS 1000
+#define TEST_POINT PAL_LATENCY_STREAM_GET_PARAM
+
+static volatile uint32_t sink;
+
+static void __attribute__((noinline)) work()
+{
+    sink = sink + 1;
+}
+
+static void __attribute__((noinline)) workScoped()
+{
+    PalLatencyScope latency(TEST_POINT);
+
+    sink = sink + 1;
+}
+
+static uint64_t pointCount()
+{
+    static pal_param_latency_stats_t stats;
+
+    PalLatencyStats::get(&stats);
+    return stats.hist[TEST_POINT].count;
+}
+
+static void runBatches(void (*fn)(), uint32_t batches, std::vector<uint64_t> &ns)
+{
+    for (uint32_t b = 0; b < batches; b++) {
+        uint64_t start = palTestNowNs();
+
+        for (int i = 0; i < BATCH_CALLS; i++)
+            fn();
+        ns.push_back(palTestNowNs() - start);
+    }
+}
+
+static void measure(const char *name, void (*fn)(), uint32_t batches,
+                    uint32_t threads)
+{
+    std::vector<std::vector<uint64_t>> perThread(threads);
+    std::vector<std::thread> workers;
+    std::vector<uint64_t> ns;
+    char label[96];
+
+    for (uint32_t t = 1; t < threads; t++)
+        workers.push_back(std::thread(runBatches, fn, batches,
+                                      std::ref(perThread[t])));
+    runBatches(fn, batches, perThread[0]);
+    for (auto &w : workers)
+        w.join();
+    for (auto &v : perThread)
+        ns.insert(ns.end(), v.begin(), v.end());
+
+    snprintf(label, sizeof(label), "%s, %u thread(s), per %d calls", name,
+             threads, BATCH_CALLS);
+    palTestReportLatency(label, ns);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t batches = argc > 1 ? atoi(argv[1]) : 2000;
+    uint32_t threads = argc > 2 ? atoi(argv[2]) : 4;
+    uint64_t before;
+
+    PalLatencyStats::setEnabled(false);
+    PalLatencyStats::reset();
+
+    /* warm up the thread_local stats of the main thread */
+    PalLatencyStats::setEnabled(true);
+    workScoped();
+    PalLatencyStats::setEnabled(false);
+    PalLatencyStats::reset();
+
+    measure("no scope", work, batches, 1);
+
+    before = pointCount();
+    measure("scope disabled", workScoped, batches, 1);
+    PAL_TEST_CHECK(pointCount() == before, "disabled scope recorded %llu calls",
+                   (unsigned long long)(pointCount() - before));
+
+    PalLatencyStats::setEnabled(true);
+    before = pointCount();
+    measure("scope enabled", workScoped, batches, 1);
+    PAL_TEST_CHECK(pointCount() - before == (uint64_t)batches * BATCH_CALLS,
+                   "enabled scope recorded %llu of %llu calls",
+                   (unsigned long long)(pointCount() - before),
+                   (unsigned long long)batches * BATCH_CALLS);
+
+    PalLatencyStats::setEnabled(false);
+    measure("no scope", work, batches, threads);
+    measure("scope disabled", workScoped, batches, threads);
+    PalLatencyStats::setEnabled(true);
+    PalLatencyStats::reset();
+    measure("scope enabled", workScoped, batches, threads);
+    /* worker threads exited, their counts went to the retired totals */
+    PAL_TEST_CHECK(pointCount() == (uint64_t)batches * BATCH_CALLS * threads,
+                   "enabled scope recorded %llu of %llu calls on %u threads",
+                   (unsigned long long)pointCount(),
+                   (unsigned long long)batches * BATCH_CALLS * threads, threads);
+    PalLatencyStats::setEnabled(false);
+
+    return palTestResult("PalLatencyScopeOverhead");
+}
@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Pause, resume and speaker rotation latency of playback streams. A deep
+ * buffer stream (StreamPCM) and a compressed stream carrying PCM
+ * (StreamCompress) are played on speaker while being paused and resumed,
+ * and while PAL_PARAM_ID_DEVICE_ROTATION is flipped between LR and RL.
+ * Pause returns once the soft pause ramp of the graph has finished, so
+ * its p99 must stay below the configured ramp period plus some slack,
+ * given in ms as the second argument (default 100 + 50 ms). A stream type
+ * the target cannot open is reported and skipped.
+ *
+ * Usage: PalPauseRampLatency [iterations] [pause bound ms]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+#define BUF_SIZE 3840 /* 20 ms of 48 kHz stereo 16 bit */
+#define SETTLE_US (200 * 1000)
+
+static std::atomic<bool> done(false);
+static std::atomic<bool> paused(false);
+
+static pal_stream_handle_t *openPlayback(pal_stream_type_t type)
+{
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    pal_stream_handle_t *handle = NULL;
+    int status;
+
+    memset(&attr, 0, sizeof(attr));
+    memset(&device, 0, sizeof(device));
+    attr.type = type;
+    attr.direction = PAL_AUDIO_OUTPUT;
+    attr.out_media_config.sample_rate = 48000;
+    attr.out_media_config.bit_width = 16;
+    attr.out_media_config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    attr.out_media_config.ch_info.channels = 2;
+    attr.out_media_config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    attr.out_media_config.ch_info.ch_map[1] = PAL_CHMAP_CHANNEL_FR;
+    device.id = PAL_DEVICE_OUT_SPEAKER;
+    device.config = attr.out_media_config;
+
+    status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, &handle);
+    if (status || !handle) {
+        fprintf(stdout, "pal_stream_open of type %d failed %d, skipped\n", type, status);
+        return NULL;
+    }
+    status = pal_stream_start(handle);
+    if (status) {
+        fprintf(stderr, "pal_stream_start failed %d\n", status);
+        pal_stream_close(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+static void writer(pal_stream_handle_t *handle)
+{
+    static uint8_t silence[BUF_SIZE];
+    struct pal_buffer buf;
+
+    while (!done.load()) {
+        if (paused.load()) {
+            usleep(5 * 1000);
+            continue;
+        }
+        memset(&buf, 0, sizeof(buf));
+        buf.buffer = silence;
+        buf.size = sizeof(silence);
+        if (pal_stream_write(handle, &buf) < 0)
+            usleep(20 * 1000);
+    }
+}
+
+static int setRotation(pal_speaker_rotation_type rotation)
+{
+    pal_param_device_rotation_t param;
+
+    param.rotation_type = rotation;
+    return pal_set_param(PAL_PARAM_ID_DEVICE_ROTATION, (void *)&param, sizeof(param));
+}
+
+static void runStream(const char *name, pal_stream_type_t type, int iterations,
+                      uint64_t pauseBoundMs)
+{
+    std::vector<uint64_t> pauseNs, resumeNs, rotationNs;
+    pal_stream_handle_t *handle;
+    char label[64];
+    uint64_t start;
+    int status;
+
+    handle = openPlayback(type);
+    if (!handle)
+        return;
+    done = false;
+    paused = false;
+    std::thread t(writer, handle);
+    usleep(SETTLE_US);
+
+    for (int i = 0; i < iterations; i++) {
+        /* stop feeding first so pause does not race a blocked write */
+        paused = true;
+        start = palTestNowNs();
+        status = pal_stream_pause(handle);
+        pauseNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "%s pause %d failed %d", name, i, status);
+        usleep(SETTLE_US);
+
+        start = palTestNowNs();
+        status = pal_stream_resume(handle);
+        resumeNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "%s resume %d failed %d", name, i, status);
+        paused = false;
+        usleep(SETTLE_US);
+
+        start = palTestNowNs();
+        status = setRotation((i & 1) ? PAL_SPEAKER_ROTATION_LR : PAL_SPEAKER_ROTATION_RL);
+        rotationNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "%s rotation %d failed %d", name, i, status);
+        usleep(SETTLE_US);
+    }
+    setRotation(PAL_SPEAKER_ROTATION_LR);
+
+    snprintf(label, sizeof(label), "%s pause", name);
+    palTestReportLatency(label, pauseNs);
+    PAL_TEST_CHECK(palTestPercentile(pauseNs, 99) < pauseBoundMs * 1000000,
+                   "%s pause p99 %llu us above %llu ms", name,
+                   (unsigned long long)(palTestPercentile(pauseNs, 99) / 1000),
+                   (unsigned long long)pauseBoundMs);
+    snprintf(label, sizeof(label), "%s resume", name);
+    palTestReportLatency(label, resumeNs);
+    snprintf(label, sizeof(label), "%s rotation", name);
+    palTestReportLatency(label, rotationNs);
+
+    done = true;
+    t.join();
+    pal_stream_stop(handle);
+    pal_stream_close(handle);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 20;
+    uint64_t pauseBoundMs = argc > 2 ? atoi(argv[2]) : 100 + 50;
+
+    runStream("deep buffer", PAL_STREAM_DEEP_BUFFER, iterations, pauseBoundMs);
+    runStream("compress", PAL_STREAM_COMPRESSED, iterations, pauseBoundMs);
+    return palTestResult("PalPauseRampLatency");
+}
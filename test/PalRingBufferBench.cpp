@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Contention benchmark for PalRingBuffer: one writer pushing fixed size
+ * frames against N readers in RING_BUFFER_MODE_LOCKED and
+ * RING_BUFFER_MODE_LOCK_FREE, while an extra thread keeps adding/removing
+ * a pinned reader and attempting a resize to exercise the reader snapshot
+ * and the resize rejection. Data is verified on every read.
+ *
+ * Usage: PalRingBufferBench [readers] [seconds] [frame bytes]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "PalRingBuffer.h"
+#include "PalTestUtils.h"
+
+#define BENCH_BUFFER_SIZE (64 * 1024)
+
+struct bench_result {
+    uint64_t written;
+    uint64_t read;
+    uint64_t errors;
+    uint64_t churns;
+    uint64_t resizeRejected;
+    double seconds;
+    std::vector<uint64_t> writeNs;
+};
+
+static void fillFrame(uint8_t *frame, size_t size, uint64_t pos)
+{
+    for (size_t i = 0; i < size; i++)
+        frame[i] = (uint8_t)(pos + i);
+}
+
+static bool checkFrame(const uint8_t *frame, size_t size, uint64_t pos)
+{
+    for (size_t i = 0; i < size; i++) {
+        if (frame[i] != (uint8_t)(pos + i))
+            return false;
+    }
+    return true;
+}
+
+static void runBench(pal_ring_buffer_mode mode, int numReaders, int seconds,
+                     size_t frameSize, struct bench_result *res)
+{
+    PalRingBuffer ring(BENCH_BUFFER_SIZE, mode);
+    std::vector<PalRingBufferReader *> readers;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stop(false);
+    std::atomic<uint64_t> readTotal(0);
+    std::atomic<uint64_t> errors(0);
+    std::atomic<uint64_t> churns(0);
+    std::atomic<uint64_t> rejected(0);
+    uint64_t written = 0;
+
+    for (int i = 0; i < numReaders; i++) {
+        readers.push_back(ring.newReader());
+        readers[i]->updateState(READER_ENABLED);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < numReaders; i++) {
+        threads.emplace_back([&, i]() {
+            std::vector<uint8_t> buf(frameSize);
+            uint64_t pos = 0;
+            struct pal_ring_buffer_span span;
+            size_t got = 0;
+
+            while (!stop.load(std::memory_order_relaxed)) {
+                /* odd readers use zero copy peek/consume under a pin */
+                if (i & 1) {
+                    if (readers[i]->pin())
+                        continue;
+                    got = readers[i]->peek(frameSize, &span);
+                    if (got &&
+                        (!checkFrame((uint8_t *)span.data[0], span.size[0], pos) ||
+                         !checkFrame((uint8_t *)span.data[1], span.size[1],
+                                     pos + span.size[0])))
+                        errors.fetch_add(1, std::memory_order_relaxed);
+                    readers[i]->unpin();
+                    got = readers[i]->consume(got);
+                } else {
+                    int32_t ret = readers[i]->read(buf.data(), frameSize);
+                    got = ret > 0 ? (size_t)ret : 0;
+                    if (got && !checkFrame(buf.data(), got, pos))
+                        errors.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (!got) {
+                    readers[i]->waitForData(1, 5);
+                    continue;
+                }
+                pos += got;
+                readTotal.fetch_add(got, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    /*
+     * churn: short lived reader added/removed under the writer, resize
+     * must be rejected while that reader holds a pin on the ring.
+     */
+    threads.emplace_back([&]() {
+        while (!stop.load(std::memory_order_relaxed)) {
+            PalRingBufferReader *reader = ring.newReader();
+            if (!reader->pin()) {
+                if (ring.resizeRingBuffer(BENCH_BUFFER_SIZE) == -EBUSY)
+                    rejected.fetch_add(1, std::memory_order_relaxed);
+                else
+                    errors.fetch_add(1, std::memory_order_relaxed);
+                reader->unpin();
+            }
+            ring.removeReader(reader);
+            delete reader;
+            churns.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+    });
+
+    std::thread writer([&]() {
+        std::vector<uint8_t> frame(frameSize);
+        size_t ret = 0;
+        size_t offset = 0;
+        uint64_t t0 = 0;
+
+        fillFrame(frame.data(), frameSize, written);
+        res->writeNs.clear();
+        while (!stop.load(std::memory_order_relaxed)) {
+            t0 = palTestNowNs();
+            ret = ring.write(frame.data() + offset, frameSize - offset);
+            /* cap the samples, the first few seconds are representative */
+            if (res->writeNs.size() < 4000000)
+                res->writeNs.push_back(palTestNowNs() - t0);
+            written += ret;
+            offset += ret;
+            if (offset == frameSize) {
+                offset = 0;
+                fillFrame(frame.data(), frameSize, written);
+            } else if (!ret) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop.store(true);
+    for (int i = 0; i < numReaders; i++)
+        readers[i]->signalExit();
+    writer.join();
+    for (auto &t : threads)
+        t.join();
+
+    res->seconds = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+    res->written = written;
+    res->read = readTotal.load();
+    res->errors = errors.load();
+    res->churns = churns.load();
+    res->resizeRejected = rejected.load();
+}
+
+/*
+ * Single thread cost of one write and one read in each mode, without
+ * contention. Shows the fixed overhead of the lock free path against a
+ * plain uncontended mutex, independent of the core count.
+ */
+static void runUncontended(pal_ring_buffer_mode mode, const char *name,
+                           size_t frameSize, int iterations)
+{
+    PalRingBuffer ring(BENCH_BUFFER_SIZE, mode);
+    PalRingBufferReader *reader = ring.newReader();
+    std::vector<uint8_t> frame(frameSize);
+    std::vector<uint64_t> writeNs;
+    std::vector<uint64_t> readNs;
+    char label[64];
+    uint64_t t0 = 0;
+
+    reader->updateState(READER_ENABLED);
+    writeNs.reserve(iterations);
+    readNs.reserve(iterations);
+    for (int i = 0; i < iterations; i++) {
+        t0 = palTestNowNs();
+        ring.write(frame.data(), frameSize);
+        writeNs.push_back(palTestNowNs() - t0);
+        t0 = palTestNowNs();
+        reader->read(frame.data(), frameSize);
+        readNs.push_back(palTestNowNs() - t0);
+    }
+    snprintf(label, sizeof(label), "%-9s write %zu bytes", name, frameSize);
+    palTestReportLatency(label, writeNs);
+    snprintf(label, sizeof(label), "%-9s read  %zu bytes", name, frameSize);
+    palTestReportLatency(label, readNs);
+}
+
+int main(int argc, char *argv[])
+{
+    int numReaders = argc > 1 ? atoi(argv[1]) : 3;
+    int seconds = argc > 2 ? atoi(argv[2]) : 2;
+    size_t frameSize = argc > 3 ? (size_t)atoi(argv[3]) : 640;
+    struct bench_result res;
+    const char *names[] = {"locked", "lock free"};
+    char label[64];
+    pal_ring_buffer_mode modes[] = {RING_BUFFER_MODE_LOCKED,
+                                    RING_BUFFER_MODE_LOCK_FREE};
+
+    if (numReaders <= 0 || seconds <= 0 || frameSize == 0 ||
+        frameSize > BENCH_BUFFER_SIZE) {
+        fprintf(stderr, "usage: %s [readers] [seconds] [frame bytes]\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 0; i < 2; i++)
+        runUncontended(modes[i], names[i], frameSize, 200000);
+
+    for (int i = 0; i < 2; i++) {
+        runBench(modes[i], numReaders, seconds, frameSize, &res);
+        fprintf(stdout, "%-9s readers %d: write %.1f MB/s, read %.1f MB/s, "
+                "churn %llu (resize rejected %llu), errors %llu\n",
+                names[i], numReaders,
+                res.written / res.seconds / (1024 * 1024),
+                res.read / res.seconds / (1024 * 1024),
+                (unsigned long long)res.churns,
+                (unsigned long long)res.resizeRejected,
+                (unsigned long long)res.errors);
+        snprintf(label, sizeof(label), "%-9s readers %d: write call", names[i],
+                 numReaders);
+        palTestReportLatency(label, res.writeNs);
+        PAL_TEST_CHECK(!res.errors, "%s: %llu data errors", names[i],
+                       (unsigned long long)res.errors);
+    }
+
+    return palTestResult("PalRingBufferBench");
+}
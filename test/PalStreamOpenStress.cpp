@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Concurrent open/close of mixed stream types through the PAL client,
+ * so front ends are allocated and released by the resource manager
+ * from many threads at once. Each thread loops over a random stream
+ * type, opens it, optionally starts/stops it and closes it. Front end
+ * pool occupancy is read back with PAL_PARAM_ID_FE_POOL_STATS: no
+ * pool may go above its size while running, and every pool must be
+ * back at its starting occupancy once all threads are done. Run it
+ * with no other audio active.
+ *
+ * Usage: PalStreamOpenStress [threads] [iterations] [start 0|1]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+struct streamConfig {
+    pal_stream_type_t type;
+    pal_stream_direction_t direction;
+    pal_device_id_t device;
+};
+
+static const streamConfig configs[] = {
+    {PAL_STREAM_LOW_LATENCY, PAL_AUDIO_OUTPUT, PAL_DEVICE_OUT_SPEAKER},
+    {PAL_STREAM_DEEP_BUFFER, PAL_AUDIO_OUTPUT, PAL_DEVICE_OUT_SPEAKER},
+    {PAL_STREAM_PCM_OFFLOAD, PAL_AUDIO_OUTPUT, PAL_DEVICE_OUT_SPEAKER},
+    {PAL_STREAM_VOIP_RX, PAL_AUDIO_OUTPUT, PAL_DEVICE_OUT_SPEAKER},
+    {PAL_STREAM_VOIP_TX, PAL_AUDIO_INPUT, PAL_DEVICE_IN_HANDSET_MIC},
+    {PAL_STREAM_LOW_LATENCY, PAL_AUDIO_INPUT, PAL_DEVICE_IN_HANDSET_MIC},
+    {PAL_STREAM_DEEP_BUFFER, PAL_AUDIO_INPUT, PAL_DEVICE_IN_HANDSET_MIC},
+};
+
+static std::atomic<uint32_t> opened(0);
+static std::atomic<uint32_t> openFailed(0);
+
+static void fillMediaConfig(struct pal_media_config *config)
+{
+    config->sample_rate = 48000;
+    config->bit_width = 16;
+    config->aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    config->ch_info.channels = 2;
+    config->ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    config->ch_info.ch_map[1] = PAL_CHMAP_CHANNEL_FR;
+}
+
+static int getPoolStats(pal_param_fe_pool_stats_t *stats)
+{
+    void *payload = NULL;
+    size_t size = 0;
+    int status;
+
+    status = pal_get_param(PAL_PARAM_ID_FE_POOL_STATS, &payload, &size, NULL);
+    if (status || !payload || size != sizeof(*stats)) {
+        free(payload);
+        return status ? status : -EINVAL;
+    }
+    memcpy(stats, payload, sizeof(*stats));
+    free(payload);
+    return 0;
+}
+
+static void checkPools(const pal_param_fe_pool_stats_t &stats)
+{
+    for (uint32_t i = 0; i < stats.num_pools && i < PAL_FE_POOL_STATS_MAX; i++)
+        PAL_TEST_CHECK(stats.pool[i].in_use <= stats.pool[i].total,
+                       "pool %u in use %u above size %u", i,
+                       stats.pool[i].in_use, stats.pool[i].total);
+}
+
+static void worker(int tag, int iterations, bool start)
+{
+    std::mt19937 rng(tag);
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    pal_stream_handle_t *handle;
+    const streamConfig *cfg;
+    int32_t status;
+
+    for (int it = 0; it < iterations; it++) {
+        cfg = &configs[rng() % (sizeof(configs) / sizeof(configs[0]))];
+
+        memset(&attr, 0, sizeof(attr));
+        memset(&device, 0, sizeof(device));
+        attr.type = cfg->type;
+        attr.direction = cfg->direction;
+        if (cfg->direction == PAL_AUDIO_OUTPUT)
+            fillMediaConfig(&attr.out_media_config);
+        else
+            fillMediaConfig(&attr.in_media_config);
+        device.id = cfg->device;
+        fillMediaConfig(&device.config);
+
+        handle = NULL;
+        status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, &handle);
+        if (status || !handle) {
+            /* concurrency limits may refuse a stream, that is not a leak */
+            openFailed.fetch_add(1);
+            continue;
+        }
+        opened.fetch_add(1);
+
+        if (start && !pal_stream_start(handle))
+            pal_stream_stop(handle);
+
+        status = pal_stream_close(handle);
+        PAL_TEST_CHECK(!status, "close of type %d failed %d", cfg->type, status);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    int numThreads = argc > 1 ? atoi(argv[1]) : 8;
+    int iterations = argc > 2 ? atoi(argv[2]) : 200;
+    bool start = argc > 3 ? atoi(argv[3]) != 0 : false;
+    pal_param_fe_pool_stats_t before;
+    pal_param_fe_pool_stats_t during;
+    pal_param_fe_pool_stats_t after;
+    std::vector<std::thread> threads;
+    std::atomic<bool> done(false);
+    int status;
+
+    if (numThreads <= 0 || iterations <= 0) {
+        fprintf(stderr, "usage: %s [threads] [iterations] [start 0|1]\n",
+                argv[0]);
+        return 1;
+    }
+
+    status = getPoolStats(&before);
+    if (status) {
+        fprintf(stderr, "PAL_PARAM_ID_FE_POOL_STATS not available %d\n", status);
+        return 1;
+    }
+
+    for (int i = 0; i < numThreads; i++)
+        threads.emplace_back(worker, i + 1, iterations, start);
+
+    /* sample occupancy while the workers run */
+    std::thread monitor([&]() {
+        while (!done.load()) {
+            if (!getPoolStats(&during))
+                checkPools(during);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    });
+
+    for (auto &t : threads)
+        t.join();
+    done.store(true);
+    monitor.join();
+
+    PAL_TEST_CHECK(!getPoolStats(&after), "pool stats query failed");
+    for (uint32_t i = 0; i < after.num_pools && i < PAL_FE_POOL_STATS_MAX; i++) {
+        PAL_TEST_CHECK(after.pool[i].in_use == before.pool[i].in_use,
+                       "pool %u leaked, in use %u before %u after", i,
+                       before.pool[i].in_use, after.pool[i].in_use);
+        fprintf(stdout, "pool %u: total %u peak %u failures %u\n", i,
+                after.pool[i].total, after.pool[i].peak,
+                after.pool[i].failures);
+    }
+    fprintf(stdout, "opened %u, refused %u\n", opened.load(),
+            openFailed.load());
+
+    return palTestResult("PalStreamOpenStress");
+}
@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Helpers shared by the executables under test/: failure counting,
+ * a PASS/FAIL summary, monotonic time, latency percentiles and peak
+ * RSS. Header only, each test is a single translation unit.
+ */
+
+#ifndef PAL_TEST_UTILS_H
+#define PAL_TEST_UTILS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+static std::atomic<uint32_t> palTestErrors(0);
+
+#define PAL_TEST_CHECK(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: ", __func__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            palTestErrors.fetch_add(1); \
+        } \
+    } while (0)
+
+/* prints the summary line, returns the exit code for main */
+static inline int palTestResult(const char *name)
+{
+    uint32_t errors = palTestErrors.load();
+
+    fprintf(stdout, "%s: %s, %u errors\n", name, errors ? "FAIL" : "PASS",
+            errors);
+    return errors ? 1 : 0;
+}
+
+static inline uint64_t palTestNowNs()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* sorts samples in place */
+static inline uint64_t palTestPercentile(std::vector<uint64_t> &samples,
+                                         uint32_t pct)
+{
+    size_t idx;
+
+    if (samples.empty())
+        return 0;
+    std::sort(samples.begin(), samples.end());
+    idx = (samples.size() - 1) * pct / 100;
+    return samples[idx];
+}
+
+/* "<name>: n <count> p50 <us> p99 <us> max <us>" */
+static inline void palTestReportLatency(const char *name,
+                                        std::vector<uint64_t> &samplesNs)
+{
+    uint64_t p50 = palTestPercentile(samplesNs, 50);
+    uint64_t p99 = palTestPercentile(samplesNs, 99);
+    uint64_t max = samplesNs.empty() ? 0 : samplesNs.back();
+
+    fprintf(stdout, "%s: n %zu p50 %.3f us p99 %.3f us max %.3f us\n", name,
+            samplesNs.size(), p50 / 1000.0, p99 / 1000.0, max / 1000.0);
+}
+
+/*
+ * kB value of a /proc/<pid>/status field such as "VmHWM:" or "VmRSS:",
+ * pid 0 for this process, -1 on error
+ */
+static inline long palTestStatusKb(int pid, const char *field)
+{
+    char path[64];
+    char line[128];
+    size_t len = strlen(field);
+    long kb = -1;
+    FILE *fp;
+
+    if (pid)
+        snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    else
+        snprintf(path, sizeof(path), "/proc/self/status");
+    fp = fopen(path, "r");
+    if (!fp)
+        return -1;
+    while (fgets(line, sizeof(line), fp)) {
+        if (!strncmp(line, field, len)) {
+            kb = strtol(line + len, NULL, 10);
+            break;
+        }
+    }
+    fclose(fp);
+    return kb;
+}
+
+/* peak resident set size in kB from /proc/self/status, -1 on error */
+static inline long palTestPeakRssKb()
+{
+    return palTestStatusKb(0, "VmHWM:");
+}
+
+/* restarts VmHWM of a process at its current RSS, needs root for others */
+static inline int palTestResetPeakRss(int pid)
+{
+    char path[64];
+    FILE *fp;
+    int ret;
+
+    if (pid)
+        snprintf(path, sizeof(path), "/proc/%d/clear_refs", pid);
+    else
+        snprintf(path, sizeof(path), "/proc/self/clear_refs");
+    fp = fopen(path, "w");
+    if (!fp)
+        return -1;
+    ret = fputs("5", fp) < 0 ? -1 : 0;
+    if (fclose(fp))
+        ret = -1;
+    return ret;
+}
+
+#ifdef PAL_TEST_COUNT_ALLOCS
+/*
+ * Heap allocation counting for tests that define PAL_TEST_COUNT_ALLOCS
+ * before including this header. malloc, calloc and realloc are
+ * interposed for the whole process (link with -rdynamic), but only
+ * calls made on a thread between palTestCountStart() and
+ * palTestCountStop() are counted. Allocations of at least
+ * palTestLargeAlloc bytes are also counted separately.
+ */
+#include <dlfcn.h>
+
+struct palTestAllocCount {
+    uint64_t allocs;
+    uint64_t bytes;
+    uint64_t largeAllocs;
+};
+
+static thread_local bool palTestCounting;
+static thread_local palTestAllocCount palTestAllocs;
+static size_t palTestLargeAlloc = SIZE_MAX;
+
+static inline void palTestCountStart()
+{
+    palTestAllocs = {};
+    palTestCounting = true;
+}
+
+static inline palTestAllocCount palTestCountStop()
+{
+    palTestCounting = false;
+    return palTestAllocs;
+}
+
+static inline void palTestCountAlloc(size_t size)
+{
+    if (!palTestCounting)
+        return;
+    palTestAllocs.allocs++;
+    palTestAllocs.bytes += size;
+    if (size >= palTestLargeAlloc)
+        palTestAllocs.largeAllocs++;
+}
+
+/* the first dlsym may allocate, serve it from a static arena */
+static char palTestBootArena[4096];
+static size_t palTestBootUsed;
+
+static inline void *palTestBootAlloc(size_t size)
+{
+    void *p;
+
+    size = (size + 15) & ~(size_t)15;
+    if (palTestBootUsed + size > sizeof(palTestBootArena))
+        return NULL;
+    p = palTestBootArena + palTestBootUsed;
+    palTestBootUsed += size;
+    return p;
+}
+
+extern "C" void *malloc(size_t size)
+{
+    static void *(*realMalloc)(size_t);
+    static bool resolving;
+
+    if (!realMalloc) {
+        if (resolving)
+            return palTestBootAlloc(size);
+        resolving = true;
+        realMalloc = (void *(*)(size_t))dlsym(RTLD_NEXT, "malloc");
+        resolving = false;
+    }
+    palTestCountAlloc(size);
+    return realMalloc(size);
+}
+
+extern "C" void *calloc(size_t n, size_t size)
+{
+    static void *(*realCalloc)(size_t, size_t);
+    static bool resolving;
+
+    if (!realCalloc) {
+        if (resolving)
+            return palTestBootAlloc(n * size);
+        resolving = true;
+        realCalloc = (void *(*)(size_t, size_t))dlsym(RTLD_NEXT, "calloc");
+        resolving = false;
+    }
+    palTestCountAlloc(n * size);
+    return realCalloc(n, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    static void *(*realRealloc)(void *, size_t);
+
+    if (!realRealloc)
+        realRealloc = (void *(*)(void *, size_t))dlsym(RTLD_NEXT, "realloc");
+    palTestCountAlloc(size);
+    return realRealloc(ptr, size);
+}
+
+extern "C" void free(void *ptr)
+{
+    static void (*realFree)(void *);
+
+    if ((char *)ptr >= palTestBootArena &&
+        (char *)ptr < palTestBootArena + sizeof(palTestBootArena))
+        return;
+    if (!realFree)
+        realFree = (void (*)(void *))dlsym(RTLD_NEXT, "free");
+    realFree(ptr);
+}
+#endif
+
+#endif
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Tests for the binary trace backend of the PAL log macros. A thread
+ * logs and exits, a second thread reuses its ring, and the decoded
+ * trace must show each record with the tid of the thread that wrote
+ * it. Then times a two argument PAL_DBG in batches of 1000 calls with
+ * the level off, with PAL_LOG_TRACE set and through logcat, so the
+ * microseconds printed per batch read as nanoseconds per call. The
+ * logcat case runs a tenth of the batches to keep the log readable.
+ *
+ * Usage: PalTraceTest [batches]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PalCommon.h"
+#include "PalTrace.h"
+#include "PalTestUtils.h"
+
+#define LOG_TAG "PalTraceTest"
+#define BATCH_CALLS 1000
+
+static pid_t logFromThread(const char *name)
+{
+    pid_t tid = (pid_t)syscall(SYS_gettid);
+
+    PAL_DBG(LOG_TAG, "record from %s tid %d", name, tid);
+    return tid;
+}
+
+/* tid in the header of the decoded line holding text, -1 if missing */
+static pid_t recordTid(const std::string &out, const char *text)
+{
+    size_t pos = out.find(text);
+    size_t start;
+    int tid;
+
+    if (pos == std::string::npos)
+        return -1;
+    start = out.rfind('\n', pos);
+    start = start == std::string::npos ? 0 : start + 1;
+    if (sscanf(out.c_str() + start, "%*u.%*u %d", &tid) != 1)
+        return -1;
+    return tid;
+}
+
+static void testRingReuseTid()
+{
+    std::string out;
+    pid_t first = 0, second = 0;
+
+    pal_log_lvl = PAL_LOG_ERR | PAL_LOG_DBG | PAL_LOG_TRACE;
+    palTraceClear();
+
+    /* the second thread starts after the first released its ring */
+    std::thread([&first] { first = logFromThread("first"); }).join();
+    std::thread([&second] { second = logFromThread("second"); }).join();
+    PAL_TEST_CHECK(first != second, "threads share tid %d", first);
+
+    palTraceDecode(out);
+    PAL_TEST_CHECK(recordTid(out, "record from first") == first,
+                   "first record not tagged with tid %d:\n%s", first, out.c_str());
+    PAL_TEST_CHECK(recordTid(out, "record from second") == second,
+                   "second record not tagged with tid %d:\n%s", second, out.c_str());
+}
+
+static void measure(const char *name, uint32_t lvl, uint32_t batches)
+{
+    std::vector<uint64_t> ns;
+    char label[64];
+
+    pal_log_lvl = lvl;
+    for (uint32_t b = 0; b < batches; b++) {
+        uint64_t start = palTestNowNs();
+
+        for (int i = 0; i < BATCH_CALLS; i++)
+            PAL_DBG(LOG_TAG, "stream %pK state %d", &ns, i);
+        ns.push_back(palTestNowNs() - start);
+    }
+    snprintf(label, sizeof(label), "PAL_DBG %s, per %d calls", name, BATCH_CALLS);
+    palTestReportLatency(label, ns);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t batches = argc > 1 ? atoi(argv[1]) : 1000;
+    uint32_t saved = pal_log_lvl;
+
+    testRingReuseTid();
+
+    measure("level off", PAL_LOG_ERR, batches);
+    measure("trace ring", PAL_LOG_ERR | PAL_LOG_DBG | PAL_LOG_TRACE, batches);
+    measure("logcat", PAL_LOG_ERR | PAL_LOG_DBG, batches / 10 ? batches / 10 : 1);
+    palTraceClear();
+
+    pal_log_lvl = saved;
+    return palTestResult("PalTraceTest");
+}
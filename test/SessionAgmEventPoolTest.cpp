@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checks that read/write done events on the non-tunnel (SessionAgm)
+ * path are served from the per session payload pool. AGM events are fed
+ * to the session event callback directly, without a DSP session, and
+ * heap allocations on the delivering thread are counted. Once the pool
+ * is warm a sequence of events must not allocate, with and without
+ * timestamp mode, and neither may as many concurrent callbacks as the
+ * pool holds. One more in-flight callback falls back to the heap. The
+ * payload handed to the stream callback is checked against the event.
+ *
+ * Usage: SessionAgmEventPoolTest [events]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "SessionAgm.h"
+#define PAL_TEST_COUNT_ALLOCS
+#include "PalTestUtils.h"
+
+#define TEST_SESSION_ID 42
+#define TEST_TIMESTAMP_US 3500123ULL
+
+void eventCallback(uint32_t session_id, struct agm_event_cb_params *event_params,
+                   void *client_data);
+
+struct callbackState {
+    std::mutex lock;
+    std::condition_variable cv;
+    uint32_t expectedTag;
+    bool timestamps;
+    uint32_t entered;
+    uint32_t hold;       /* callbacks to park until released */
+    bool release;
+};
+
+static callbackState cbState;
+
+static void streamCallback(uint64_t cookie, uint32_t event_id, void *event_data,
+                           uint32_t event_size)
+{
+    struct pal_event_read_write_done_payload *rw =
+        (struct pal_event_read_write_done_payload *)event_data;
+    std::unique_lock<std::mutex> guard(cbState.lock);
+
+    PAL_TEST_CHECK(rw && event_size == sizeof(*rw), "bad payload %p size %u",
+                   event_data, event_size);
+    if (rw) {
+        PAL_TEST_CHECK(rw->tag == cbState.expectedTag, "tag %u, expected %u",
+                       rw->tag, cbState.expectedTag);
+        PAL_TEST_CHECK(!!rw->buff.ts == cbState.timestamps, "ts %p in %s mode",
+                       rw->buff.ts, cbState.timestamps ? "timestamp" : "plain");
+        if (rw->buff.ts)
+            PAL_TEST_CHECK(rw->buff.ts->tv_sec == TEST_TIMESTAMP_US / 1000000 &&
+                           rw->buff.ts->tv_nsec == (TEST_TIMESTAMP_US % 1000000) * 1000,
+                           "ts %ld.%09ld", (long)rw->buff.ts->tv_sec,
+                           (long)rw->buff.ts->tv_nsec);
+    }
+    cbState.entered++;
+    cbState.cv.notify_all();
+    if (cbState.hold) {
+        cbState.hold--;
+        cbState.cv.wait(guard, [] { return cbState.release; });
+    }
+}
+
+static std::vector<uint8_t> makeEvent(uint32_t eventId, uint32_t tag)
+{
+    std::vector<uint8_t> raw(sizeof(struct agm_event_cb_params) +
+                             sizeof(struct agm_event_read_write_done_payload));
+    struct agm_event_cb_params *params = (struct agm_event_cb_params *)raw.data();
+    struct agm_event_read_write_done_payload *rw =
+        (struct agm_event_read_write_done_payload *)params->event_payload;
+
+    params->event_id = eventId;
+    params->event_payload_size = sizeof(*rw);
+    rw->tag = tag;
+    rw->buff.size = 3840;
+    rw->buff.timestamp = TEST_TIMESTAMP_US;
+    return raw;
+}
+
+static void runSequential(SessionAgm *session, int events, bool timestamps)
+{
+    std::vector<uint8_t> writeDone = makeEvent(AGM_EVENT_WRITE_DONE, 7);
+    std::vector<uint8_t> readDone = makeEvent(AGM_EVENT_READ_DONE, 7);
+    std::vector<uint64_t> samplesNs;
+    palTestAllocCount count;
+    uint64_t allocs = 0;
+    uint64_t start;
+
+    session->timestampMode = timestamps;
+    cbState.timestamps = timestamps;
+    cbState.expectedTag = 7;
+
+    /* warm up: first use of the pool and of the logging paths */
+    eventCallback(TEST_SESSION_ID, (struct agm_event_cb_params *)writeDone.data(), session);
+
+    for (int i = 0; i < events; i++) {
+        std::vector<uint8_t> &ev = (i & 1) ? readDone : writeDone;
+
+        start = palTestNowNs();
+        palTestCountStart();
+        eventCallback(TEST_SESSION_ID, (struct agm_event_cb_params *)ev.data(), session);
+        count = palTestCountStop();
+        samplesNs.push_back(palTestNowNs() - start);
+        allocs += count.allocs;
+    }
+    PAL_TEST_CHECK(allocs == 0, "%s: %llu allocations over %d events",
+                   timestamps ? "timestamp mode" : "plain mode",
+                   (unsigned long long)allocs, events);
+    palTestReportLatency(timestamps ? "rw done event (timestamp mode)" :
+                         "rw done event", samplesNs);
+}
+
+/* parks inFlight - 1 callbacks, then counts allocations of one more event */
+static uint64_t allocsWithInFlight(SessionAgm *session, uint32_t inFlight)
+{
+    std::vector<uint8_t> writeDone = makeEvent(AGM_EVENT_WRITE_DONE, 9);
+    std::vector<std::thread> parked;
+    palTestAllocCount count;
+
+    session->timestampMode = true;
+    cbState.timestamps = true;
+    cbState.expectedTag = 9;
+    cbState.entered = 0;
+    cbState.hold = inFlight - 1;
+    cbState.release = false;
+
+    for (uint32_t i = 0; i + 1 < inFlight; i++)
+        parked.emplace_back([&] {
+            eventCallback(TEST_SESSION_ID,
+                          (struct agm_event_cb_params *)writeDone.data(), session);
+        });
+    {
+        std::unique_lock<std::mutex> guard(cbState.lock);
+        cbState.cv.wait(guard, [&] { return cbState.entered == inFlight - 1; });
+    }
+
+    palTestCountStart();
+    eventCallback(TEST_SESSION_ID, (struct agm_event_cb_params *)writeDone.data(), session);
+    count = palTestCountStop();
+
+    {
+        std::lock_guard<std::mutex> guard(cbState.lock);
+        cbState.release = true;
+        cbState.cv.notify_all();
+    }
+    for (auto &t : parked)
+        t.join();
+    return count.allocs;
+}
+
+int main(int argc, char *argv[])
+{
+    int events = argc > 1 ? atoi(argv[1]) : 10000;
+    SessionAgm *session = new SessionAgm(nullptr);
+    uint64_t allocs;
+
+    session->sessionId = TEST_SESSION_ID;
+    session->registerCallBack(streamCallback, 0);
+
+    runSequential(session, events, false);
+    runSequential(session, events, true);
+
+    allocs = allocsWithInFlight(session, EVENT_PAYLOAD_POOL_SIZE);
+    PAL_TEST_CHECK(allocs == 0, "%llu allocations with %d callbacks in flight",
+                   (unsigned long long)allocs, EVENT_PAYLOAD_POOL_SIZE);
+    allocs = allocsWithInFlight(session, EVENT_PAYLOAD_POOL_SIZE + 1);
+    PAL_TEST_CHECK(allocs >= 2, "%llu allocations with %d callbacks in flight, "
+                   "expected payload and timestamp", (unsigned long long)allocs,
+                   EVENT_PAYLOAD_POOL_SIZE + 1);
+    /* the overflow payload went back to the heap, the pool is whole again */
+    allocs = allocsWithInFlight(session, EVENT_PAYLOAD_POOL_SIZE);
+    PAL_TEST_CHECK(allocs == 0, "pool not restored after overflow, %llu allocations",
+                   (unsigned long long)allocs);
+
+    delete session;
+    return palTestResult("SessionAgmEventPoolTest");
+}
@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Sound trigger model load/unload latency on a shared engine. One voice
+ * UI stream is opened per model file given, each loading its model, so
+ * every load after the first merges into the engine model and every
+ * close but the last deletes from it. The whole set is loaded and
+ * closed again each iteration, so from the second iteration on the
+ * merge and delete results come from the SML merge cache. Reports the
+ * wall time of the merging loads and the deleting closes, first
+ * iteration against the rest, and the PAL side time from the API
+ * latency stats, which need vendor.audio.pal.latency_stats set.
+ * Models must be SVA models for the QC vendor uuid.
+ *
+ * Usage: SoundModelLoadLatencyTest iterations model:keyphrase model:keyphrase...
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+static const struct st_uuid qcVendorUuid = {
+    0x68ab2d40, 0xe860, 0x11e3, 0x95ef, {0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b}
+};
+
+/* pal_param_payload holding a keyphrase sound model and its data */
+static pal_param_payload *readModel(const std::string &arg)
+{
+    struct pal_st_phrase_sound_model *sm;
+    pal_param_payload *payload;
+    std::string path = arg.substr(0, arg.find(':'));
+    std::string keyphrase = arg.find(':') == std::string::npos ? "" :
+                            arg.substr(arg.find(':') + 1);
+    FILE *fp = fopen(path.c_str(), "rb");
+    long size;
+
+    if (!fp) {
+        fprintf(stderr, "cannot open %s\n", path.c_str());
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    payload = (pal_param_payload *)calloc(1, sizeof(pal_param_payload) +
+                                          sizeof(*sm) + size);
+    if (!payload) {
+        fclose(fp);
+        return NULL;
+    }
+    payload->payload_size = sizeof(*sm) + size;
+    sm = (struct pal_st_phrase_sound_model *)payload->payload;
+    sm->common.type = PAL_SOUND_MODEL_TYPE_KEYPHRASE;
+    sm->common.vendor_uuid = qcVendorUuid;
+    sm->common.data_size = size;
+    sm->common.data_offset = sizeof(*sm);
+    sm->num_phrases = 1;
+    sm->phrases[0].id = 1;
+    sm->phrases[0].recognition_mode = PAL_RECOGNITION_MODE_VOICE_TRIGGER;
+    snprintf(sm->phrases[0].text, sizeof(sm->phrases[0].text), "%s", keyphrase.c_str());
+    if (fread((uint8_t *)sm + sizeof(*sm), 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "short read on %s\n", path.c_str());
+        free(payload);
+        payload = NULL;
+    }
+    fclose(fp);
+    return payload;
+}
+
+static pal_stream_handle_t *openVoiceUi()
+{
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    pal_stream_handle_t *handle = NULL;
+    int status;
+
+    memset(&attr, 0, sizeof(attr));
+    memset(&device, 0, sizeof(device));
+    attr.type = PAL_STREAM_VOICE_UI;
+    attr.direction = PAL_AUDIO_INPUT;
+    attr.in_media_config.sample_rate = 16000;
+    attr.in_media_config.bit_width = 16;
+    attr.in_media_config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    attr.in_media_config.ch_info.channels = 1;
+    attr.in_media_config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    device.id = PAL_DEVICE_IN_HANDSET_VA_MIC;
+    device.config = attr.in_media_config;
+
+    status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, &handle);
+    if (status || !handle) {
+        fprintf(stderr, "pal_stream_open voice UI failed %d\n", status);
+        return NULL;
+    }
+    return handle;
+}
+
+static void reportStats(const char *name)
+{
+    pal_param_latency_stats_t *stats = NULL;
+    const pal_latency_hist_t *load, *unload;
+    size_t size = 0;
+    int status;
+
+    status = pal_get_param(PAL_PARAM_ID_API_LATENCY_STATS, (void **)&stats, &size, NULL);
+    if (status || !stats || size < sizeof(*stats)) {
+        fprintf(stdout, "latency stats unavailable %d\n", status);
+        free(stats);
+        return;
+    }
+    load = &stats->hist[PAL_LATENCY_ST_MULTI_MODEL_LOAD];
+    unload = &stats->hist[PAL_LATENCY_ST_MULTI_MODEL_UNLOAD];
+    if (!load->count && !unload->count) {
+        fprintf(stdout, "%s: no samples, set vendor.audio.pal.latency_stats\n", name);
+    } else {
+        if (load->count)
+            fprintf(stdout, "%s engine load: n %llu avg %llu us max %llu us\n", name,
+                    (unsigned long long)load->count,
+                    (unsigned long long)(load->total_us / load->count),
+                    (unsigned long long)load->max_us);
+        if (unload->count)
+            fprintf(stdout, "%s engine unload: n %llu avg %llu us max %llu us\n", name,
+                    (unsigned long long)unload->count,
+                    (unsigned long long)(unload->total_us / unload->count),
+                    (unsigned long long)unload->max_us);
+    }
+    free(stats);
+    pal_set_param(PAL_PARAM_ID_API_LATENCY_STATS, NULL, 0);
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<pal_param_payload *> models;
+    std::vector<pal_stream_handle_t *> handles;
+    std::vector<uint64_t> firstLoadNs, firstCloseNs, loadNs, closeNs;
+    int iterations;
+    uint64_t start;
+    int status;
+
+    if (argc < 4) {
+        fprintf(stderr, "Usage: %s iterations model:keyphrase model:keyphrase...\n",
+                argv[0]);
+        return 1;
+    }
+    iterations = atoi(argv[1]);
+    for (int i = 2; i < argc; i++) {
+        pal_param_payload *model = readModel(argv[i]);
+
+        if (!model)
+            return 1;
+        models.push_back(model);
+    }
+
+    pal_set_param(PAL_PARAM_ID_API_LATENCY_STATS, NULL, 0);
+    for (int n = 0; n < iterations && !palTestErrors.load(); n++) {
+        for (size_t i = 0; i < models.size(); i++) {
+            pal_stream_handle_t *handle = openVoiceUi();
+
+            PAL_TEST_CHECK(handle, "iteration %d open %zu failed", n, i);
+            if (!handle)
+                break;
+            handles.push_back(handle);
+            start = palTestNowNs();
+            status = pal_stream_set_param(handle, PAL_PARAM_ID_LOAD_SOUND_MODEL,
+                                          models[i]);
+            /* the first model of a set loads without a merge */
+            if (i)
+                (n ? loadNs : firstLoadNs).push_back(palTestNowNs() - start);
+            PAL_TEST_CHECK(!status, "iteration %d load %zu failed %d", n, i, status);
+        }
+        while (!handles.empty()) {
+            start = palTestNowNs();
+            status = pal_stream_close(handles.back());
+            if (handles.size() > 1)
+                (n ? closeNs : firstCloseNs).push_back(palTestNowNs() - start);
+            PAL_TEST_CHECK(!status, "iteration %d close failed %d", n, status);
+            handles.pop_back();
+        }
+        if (!n)
+            reportStats("first iteration");
+    }
+    palTestReportLatency("first merging load", firstLoadNs);
+    palTestReportLatency("first deleting close", firstCloseNs);
+    palTestReportLatency("merging load", loadNs);
+    palTestReportLatency("deleting close", closeNs);
+    reportStats("later iterations");
+
+    for (auto m : models)
+        free(m);
+    return palTestResult("SoundModelLoadLatencyTest");
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Memory and time cost of loading one sound trigger model. A voice UI
+ * stream is opened and the model loaded, then the stream is closed, for
+ * the given number of iterations. PAL runs in the audio HAL, so the
+ * peak RSS is read from that process: VmHWM is restarted through
+ * clear_refs (needs root) before each load, and the growth of VmHWM
+ * over the RSS before the load is reported next to the model size.
+ * StreamSoundTrigger keeps one copy of the model for all stages, so the
+ * peak growth should stay near one model size plus what the engine and
+ * SML allocate. The load time is the wall time of the load set_param.
+ * The HAL is found by name unless its pid is given.
+ *
+ * Usage: SoundModelLoadRssTest [-p hal pid] iterations model:keyphrase
+ */
+
+#include <dirent.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+static const struct st_uuid qcVendorUuid = {
+    0x68ab2d40, 0xe860, 0x11e3, 0x95ef, {0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b}
+};
+
+static const char *halNames[] = {
+    "android.hardware.audio.service",
+    "audiohalservice",
+};
+
+static int findHalPid()
+{
+    DIR *dir = opendir("/proc");
+    struct dirent *ent;
+    char path[64];
+    char cmd[256];
+    int pid = 0;
+    FILE *fp;
+
+    if (!dir)
+        return 0;
+    while (!pid && (ent = readdir(dir))) {
+        int cand = atoi(ent->d_name);
+
+        if (cand <= 0)
+            continue;
+        snprintf(path, sizeof(path), "/proc/%d/cmdline", cand);
+        fp = fopen(path, "r");
+        if (!fp)
+            continue;
+        memset(cmd, 0, sizeof(cmd));
+        if (!fread(cmd, 1, sizeof(cmd) - 1, fp)) {
+            fclose(fp);
+            continue;
+        }
+        fclose(fp);
+        for (auto name : halNames) {
+            if (strstr(cmd, name))
+                pid = cand;
+        }
+    }
+    closedir(dir);
+    return pid;
+}
+
+/* pal_param_payload holding a keyphrase sound model and its data */
+static pal_param_payload *readModel(const std::string &arg, uint32_t *modelSize)
+{
+    struct pal_st_phrase_sound_model *sm;
+    pal_param_payload *payload;
+    std::string path = arg.substr(0, arg.find(':'));
+    std::string keyphrase = arg.find(':') == std::string::npos ? "" :
+                            arg.substr(arg.find(':') + 1);
+    FILE *fp = fopen(path.c_str(), "rb");
+    long size;
+
+    if (!fp) {
+        fprintf(stderr, "cannot open %s\n", path.c_str());
+        return NULL;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    payload = (pal_param_payload *)calloc(1, sizeof(pal_param_payload) +
+                                          sizeof(*sm) + size);
+    if (!payload) {
+        fclose(fp);
+        return NULL;
+    }
+    payload->payload_size = sizeof(*sm) + size;
+    sm = (struct pal_st_phrase_sound_model *)payload->payload;
+    sm->common.type = PAL_SOUND_MODEL_TYPE_KEYPHRASE;
+    sm->common.vendor_uuid = qcVendorUuid;
+    sm->common.data_size = size;
+    sm->common.data_offset = sizeof(*sm);
+    sm->num_phrases = 1;
+    sm->phrases[0].id = 1;
+    sm->phrases[0].recognition_mode = PAL_RECOGNITION_MODE_VOICE_TRIGGER;
+    snprintf(sm->phrases[0].text, sizeof(sm->phrases[0].text), "%s", keyphrase.c_str());
+    if (fread((uint8_t *)sm + sizeof(*sm), 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "short read on %s\n", path.c_str());
+        free(payload);
+        payload = NULL;
+    }
+    fclose(fp);
+    *modelSize = size;
+    return payload;
+}
+
+static pal_stream_handle_t *openVoiceUi()
+{
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    pal_stream_handle_t *handle = NULL;
+    int status;
+
+    memset(&attr, 0, sizeof(attr));
+    memset(&device, 0, sizeof(device));
+    attr.type = PAL_STREAM_VOICE_UI;
+    attr.direction = PAL_AUDIO_INPUT;
+    attr.in_media_config.sample_rate = 16000;
+    attr.in_media_config.bit_width = 16;
+    attr.in_media_config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    attr.in_media_config.ch_info.channels = 1;
+    attr.in_media_config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    device.id = PAL_DEVICE_IN_HANDSET_VA_MIC;
+    device.config = attr.in_media_config;
+
+    status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, &handle);
+    if (status || !handle) {
+        fprintf(stderr, "pal_stream_open voice UI failed %d\n", status);
+        return NULL;
+    }
+    return handle;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<uint64_t> loadNs, peakKb, residentKb;
+    pal_stream_handle_t *handle;
+    pal_param_payload *model;
+    uint32_t modelSize = 0;
+    long rssBefore, hwm, rssLoaded;
+    int iterations, pid = 0, arg = 1;
+    bool peakValid = true;
+    uint64_t start;
+    int status;
+
+    if (argc > 2 && !strcmp(argv[1], "-p")) {
+        pid = atoi(argv[2]);
+        arg = 3;
+    }
+    if (argc - arg < 2) {
+        fprintf(stderr, "Usage: %s [-p hal pid] iterations model:keyphrase\n", argv[0]);
+        return 1;
+    }
+    iterations = atoi(argv[arg]);
+    model = readModel(argv[arg + 1], &modelSize);
+    if (!model)
+        return 1;
+    if (!pid)
+        pid = findHalPid();
+    if (pid <= 0) {
+        fprintf(stderr, "audio HAL process not found, pass -p\n");
+        free(model);
+        return 1;
+    }
+    fprintf(stdout, "audio HAL pid %d, model %u kB\n", pid, modelSize / 1024);
+
+    for (int n = 0; n < iterations; n++) {
+        handle = openVoiceUi();
+        PAL_TEST_CHECK(handle, "iteration %d open failed", n);
+        if (!handle)
+            break;
+        usleep(100 * 1000);
+
+        rssBefore = palTestStatusKb(pid, "VmRSS:");
+        if (palTestResetPeakRss(pid)) {
+            if (peakValid)
+                fprintf(stdout, "cannot reset VmHWM of %d: %s, peak not reported\n",
+                        pid, strerror(errno));
+            peakValid = false;
+        }
+        start = palTestNowNs();
+        status = pal_stream_set_param(handle, PAL_PARAM_ID_LOAD_SOUND_MODEL, model);
+        loadNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(!status, "iteration %d load failed %d", n, status);
+        hwm = palTestStatusKb(pid, "VmHWM:");
+        rssLoaded = palTestStatusKb(pid, "VmRSS:");
+        PAL_TEST_CHECK(rssBefore > 0 && hwm > 0 && rssLoaded > 0,
+                       "cannot read /proc/%d/status", pid);
+        if (peakValid && hwm >= rssBefore)
+            peakKb.push_back(hwm - rssBefore);
+        if (rssLoaded >= rssBefore)
+            residentKb.push_back(rssLoaded - rssBefore);
+
+        status = pal_stream_close(handle);
+        PAL_TEST_CHECK(!status, "iteration %d close failed %d", n, status);
+        usleep(100 * 1000);
+    }
+
+    palTestReportLatency("load", loadNs);
+    if (!peakKb.empty())
+        fprintf(stdout, "peak RSS growth during load: p50 %llu kB max %llu kB, %.2f model sizes\n",
+                (unsigned long long)palTestPercentile(peakKb, 50),
+                (unsigned long long)peakKb.back(),
+                modelSize ? palTestPercentile(peakKb, 50) * 1024.0 / modelSize : 0.0);
+    if (!residentKb.empty())
+        fprintf(stdout, "RSS held after load: p50 %llu kB max %llu kB\n",
+                (unsigned long long)palTestPercentile(residentKb, 50),
+                (unsigned long long)residentKb.back());
+
+    free(model);
+    return palTestResult("SoundModelLoadRssTest");
+}
@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Harness for the SML merge cache behind SoundTriggerEngineGsl. The
+ * SoundModelLib entry points are replaced with a fake SML: merge writes
+ * a marker and the inputs in the order they were passed, delete drops
+ * the last byte and mixes in the keyphrase, so every result can be
+ * recomputed and a cached result in the wrong order shows up. Each case
+ * calls SoundTriggerEngineGsl::MergeSoundModels or DeleteFromMergedModel
+ * and checks whether SML was called and what came back. Inputs whose
+ * digests collide must miss. Then merge and delete of 768 kB and 512 kB
+ * models are timed with and without the cache, the fake SML taking the
+ * given time per call (default 20 ms). A merge and a delete entry of
+ * that pair, inputs included, fit in the cache together.
+ *
+ * Usage: SoundModelMergeCacheTest [fake SML cost us] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "SoundTriggerEngineGsl.h"
+#include "SoundTriggerUtils.h"
+#include "PalTestUtils.h"
+
+static uint32_t gSmlCalls = 0;
+static uint64_t gSmlCostNs = 0;
+
+typedef std::vector<uint8_t> Blob;
+
+static listen_model_type toModel(Blob &b)
+{
+    listen_model_type m;
+
+    m.data = b.data();
+    m.size = b.size();
+    return m;
+}
+
+static void smlCost()
+{
+    uint64_t end = palTestNowNs() + gSmlCostNs;
+
+    gSmlCalls++;
+    while (palTestNowNs() < end)
+        ;
+}
+
+/* reference results */
+static Blob fakeMerge(const std::vector<Blob> &in)
+{
+    Blob out = {'M'};
+
+    for (auto &b : in)
+        out.insert(out.end(), b.begin(), b.end());
+    return out;
+}
+
+static Blob fakeDelete(const Blob &in, const char *keyphrase)
+{
+    Blob out(in.begin(), in.end() - 1);
+    size_t len = strlen(keyphrase);
+
+    for (size_t i = 0; i < out.size(); i++)
+        out[i] ^= keyphrase[i % len];
+    return out;
+}
+
+static listen_status_enum smlMergedSize(uint16_t numModels,
+    listen_model_type *pModels[], uint32_t *nOutputModelSize)
+{
+    *nOutputModelSize = 1;
+    for (uint16_t i = 0; i < numModels; i++)
+        *nOutputModelSize += pModels[i]->size;
+    return kSucess;
+}
+
+static listen_status_enum smlMerge(uint16_t numModels,
+    listen_model_type *pModels[], listen_model_type *pMergedModel)
+{
+    std::vector<Blob> in;
+    Blob out;
+
+    for (uint16_t i = 0; i < numModels; i++)
+        in.emplace_back(pModels[i]->data, pModels[i]->data + pModels[i]->size);
+    out = fakeMerge(in);
+    if (pMergedModel->size < out.size())
+        return kFailed;
+    memcpy(pMergedModel->data, out.data(), out.size());
+    pMergedModel->size = out.size();
+    smlCost();
+    return kSucess;
+}
+
+static listen_status_enum smlSizeAfterDeleting(listen_model_type *pInputModel,
+    keywordId_t keywordId, userId_t userId, uint32_t *nOutputModelSize)
+{
+    *nOutputModelSize = pInputModel->size - 1;
+    return kSucess;
+}
+
+static listen_status_enum smlDelete(listen_model_type *pInputModel,
+    keywordId_t keywordId, userId_t userId, listen_model_type *pResultModel)
+{
+    Blob in(pInputModel->data, pInputModel->data + pInputModel->size);
+    Blob out = fakeDelete(in, keywordId);
+
+    if (pResultModel->size < out.size())
+        return kFailed;
+    memcpy(pResultModel->data, out.data(), out.size());
+    pResultModel->size = out.size();
+    smlCost();
+    return kSucess;
+}
+
+static bool installFakeSml()
+{
+    std::shared_ptr<SoundModelLib> sml = SoundModelLib::GetInstance();
+
+    if (!sml)
+        return false;
+    sml->GetMergedModelSize_ = smlMergedSize;
+    sml->MergeModels_ = smlMerge;
+    sml->GetSizeAfterDeleting_ = smlSizeAfterDeleting;
+    sml->DeleteFromModel_ = smlDelete;
+    return true;
+}
+
+static Blob merge(std::vector<Blob> in)
+{
+    std::vector<listen_model_type> models;
+    std::vector<listen_model_type *> ptrs;
+    listen_model_type out = {nullptr, 0};
+    int32_t status;
+    Blob res;
+
+    for (auto &b : in)
+        models.push_back(toModel(b));
+    for (auto &m : models)
+        ptrs.push_back(&m);
+
+    status = SoundTriggerEngineGsl::MergeSoundModels(ptrs.size(), ptrs.data(), &out);
+    PAL_TEST_CHECK(!status, "MergeSoundModels failed %d", status);
+    if (!status)
+        res.assign(out.data, out.data + out.size);
+    free(out.data);
+    return res;
+}
+
+static Blob deleteKeyphrase(Blob in, const char *keyphrase)
+{
+    listen_model_type model = toModel(in);
+    listen_model_type out = {nullptr, 0};
+    char *keyphrases[] = {(char *)keyphrase};
+    int32_t status;
+    Blob res;
+
+    status = SoundTriggerEngineGsl::DeleteFromMergedModel(keyphrases, 1, &model, &out);
+    PAL_TEST_CHECK(!status, "DeleteFromMergedModel failed %d", status);
+    if (!status)
+        res.assign(out.data, out.data + out.size);
+    free(out.data);
+    return res;
+}
+
+static std::string mergeKey(std::vector<Blob> in)
+{
+    std::vector<listen_model_type> models;
+    std::vector<listen_model_type *> ptrs;
+
+    for (auto &b : in)
+        models.push_back(toModel(b));
+    for (auto &m : models)
+        ptrs.push_back(&m);
+    return SoundModelMergeCache::GetMergeKey(ptrs.size(), ptrs.data());
+}
+
+static Blob fromWords(uint64_t w1, uint64_t w2)
+{
+    Blob b(2 * sizeof(uint64_t));
+
+    memcpy(b.data(), &w1, sizeof(w1));
+    memcpy(b.data() + sizeof(w1), &w2, sizeof(w2));
+    return b;
+}
+
+/*
+ * The cache digest is a word folded FNV-1a, so the second word can
+ * cancel any difference in the first. Builds two 16 byte models with
+ * the same size and digest but different bytes.
+ */
+static void makeCollision(Blob &a, Blob &b)
+{
+    const uint64_t basis = 0xcbf29ce484222325ULL;
+    const uint64_t prime = 0x100000001b3ULL;
+    uint64_t h1 = (basis ^ 1) * prime;
+    uint64_t h2 = (basis ^ 2) * prime;
+
+    a = fromWords(1, 0x5a5a5a5a);
+    b = fromWords(2, 0x5a5a5a5a ^ h1 ^ h2);
+}
+
+static void testMergeHit()
+{
+    Blob a = {1, 2, 3, 4, 5};
+    Blob b = {9, 8, 7};
+    Blob res;
+    uint32_t calls;
+
+    res = merge({a, b});
+    PAL_TEST_CHECK(res == fakeMerge({a, b}), "first merge is wrong");
+    calls = gSmlCalls;
+    res = merge({a, b});
+    PAL_TEST_CHECK(gSmlCalls == calls, "repeated merge called SML");
+    PAL_TEST_CHECK(res == fakeMerge({a, b}), "repeated merge returned different model");
+
+    /* SML output depends on input order, a reordered merge is a new one */
+    res = merge({b, a});
+    PAL_TEST_CHECK(gSmlCalls == calls + 1, "reordered merge hit the cache");
+    PAL_TEST_CHECK(res == fakeMerge({b, a}), "reordered merge returned the other order");
+    calls = gSmlCalls;
+    res = merge({a, b});
+    PAL_TEST_CHECK(gSmlCalls == calls, "merge in first order was evicted by reorder");
+    PAL_TEST_CHECK(res == fakeMerge({a, b}), "merge in first order is wrong");
+
+    b.push_back(6);
+    res = merge({a, b});
+    PAL_TEST_CHECK(gSmlCalls == calls + 1, "merge of changed input hit the cache");
+    PAL_TEST_CHECK(res == fakeMerge({a, b}), "merge of changed input is wrong");
+}
+
+static void testMergeCollision()
+{
+    Blob base = {0x11, 0x22, 0x33};
+    Blob c1;
+    Blob c2;
+    Blob res;
+    uint32_t calls;
+
+    makeCollision(c1, c2);
+    PAL_TEST_CHECK(c1 != c2, "collision inputs are identical");
+    PAL_TEST_CHECK(mergeKey({base, c1}) == mergeKey({base, c2}),
+                   "collision inputs did not share a cache key");
+
+    merge({base, c1});
+    calls = gSmlCalls;
+    res = merge({base, c2});
+    PAL_TEST_CHECK(gSmlCalls == calls + 1, "colliding merge hit the cache");
+    PAL_TEST_CHECK(res == fakeMerge({base, c2}),
+                   "colliding merge returned the other model");
+
+    /* the newer entry replaced the older one under the shared key */
+    calls = gSmlCalls;
+    res = merge({base, c2});
+    PAL_TEST_CHECK(gSmlCalls == calls, "merge after collision called SML");
+    PAL_TEST_CHECK(res == fakeMerge({base, c2}), "merge after collision is wrong");
+}
+
+static void testDelete()
+{
+    Blob m1;
+    Blob m2;
+    Blob res;
+    uint32_t calls;
+
+    makeCollision(m1, m2);
+    res = deleteKeyphrase(m1, "hey");
+    PAL_TEST_CHECK(res == fakeDelete(m1, "hey"), "first delete is wrong");
+    calls = gSmlCalls;
+    res = deleteKeyphrase(m1, "hey");
+    PAL_TEST_CHECK(gSmlCalls == calls, "repeated delete called SML");
+    PAL_TEST_CHECK(res == fakeDelete(m1, "hey"), "repeated delete is wrong");
+
+    calls = gSmlCalls;
+    res = deleteKeyphrase(m1, "hello");
+    PAL_TEST_CHECK(gSmlCalls == calls + 1, "delete of other keyphrase hit the cache");
+    PAL_TEST_CHECK(res == fakeDelete(m1, "hello"), "delete of other keyphrase is wrong");
+
+    calls = gSmlCalls;
+    res = deleteKeyphrase(m2, "hey");
+    PAL_TEST_CHECK(gSmlCalls == calls + 1, "delete from colliding model hit the cache");
+    PAL_TEST_CHECK(res == fakeDelete(m2, "hey"),
+                   "delete from colliding model returned the other model");
+}
+
+static void testEviction()
+{
+    /* inputs count towards the cap, each entry holds 3 MB so two fit */
+    Blob a(768 * 1024, 0xa);
+    Blob b(768 * 1024, 0xb);
+    Blob c(768 * 1024, 0xc);
+    Blob huge(ST_MERGED_SM_CACHE_MAX_BYTES / 2, 0xd);
+    uint32_t calls;
+
+    merge({a, b});
+    merge({b, c});
+    merge({a, c});
+    calls = gSmlCalls;
+    merge({a, c});
+    merge({b, c});
+    PAL_TEST_CHECK(gSmlCalls == calls, "recent entries were evicted");
+    merge({a, b});
+    PAL_TEST_CHECK(gSmlCalls == calls + 1, "oldest entry was not evicted");
+
+    /* too big to cache at all */
+    merge({huge});
+    calls = gSmlCalls;
+    merge({huge});
+    PAL_TEST_CHECK(gSmlCalls == calls + 1, "oversized entry was cached");
+}
+
+/*
+ * The engine merges on a second model load and deletes on unload. Times
+ * the first load/unload of a keyword pair, then repeats of the same pair
+ * that the cache serves.
+ */
+static void benchLoadUnload(uint64_t costUs, int rounds)
+{
+    Blob merged(768 * 1024, 0x1);
+    Blob incoming(512 * 1024, 0x2);
+    std::vector<uint64_t> loadMissNs, loadHitNs, unloadMissNs, unloadHitNs;
+    uint64_t start;
+    uint32_t calls;
+    Blob res;
+
+    gSmlCostNs = costUs * 1000;
+    for (int n = 0; n < rounds; n++) {
+        /* a new pair every round, then the same pair again */
+        merged[0] = n;
+        calls = gSmlCalls;
+        start = palTestNowNs();
+        res = merge({merged, incoming});
+        loadMissNs.push_back(palTestNowNs() - start);
+        start = palTestNowNs();
+        deleteKeyphrase(res, "hey");
+        unloadMissNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(gSmlCalls == calls + 2, "round %d first load/unload did not call SML", n);
+
+        calls = gSmlCalls;
+        start = palTestNowNs();
+        res = merge({merged, incoming});
+        loadHitNs.push_back(palTestNowNs() - start);
+        start = palTestNowNs();
+        deleteKeyphrase(res, "hey");
+        unloadHitNs.push_back(palTestNowNs() - start);
+        PAL_TEST_CHECK(gSmlCalls == calls, "round %d repeated load/unload called SML", n);
+    }
+    gSmlCostNs = 0;
+    palTestReportLatency("merge, SML", loadMissNs);
+    palTestReportLatency("merge, cached", loadHitNs);
+    palTestReportLatency("delete, SML", unloadMissNs);
+    palTestReportLatency("delete, cached", unloadHitNs);
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t costUs = argc > 1 ? strtoull(argv[1], NULL, 10) : 20000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 20;
+
+    if (!installFakeSml()) {
+        fprintf(stderr, "no SoundModelLib instance\n");
+        return 1;
+    }
+    testMergeHit();
+    testMergeCollision();
+    testDelete();
+    testEviction();
+    benchLoadUnload(costUs, rounds);
+
+    printf("SML calls %u\n", gSmlCalls);
+    return palTestResult("SoundModelMergeCacheTest");
+}
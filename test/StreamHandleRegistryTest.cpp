@@ -0,0 +1,247 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Tests for StreamHandleRegistry: handle validation and the
+ * valid/active flag rules, users draining after deactivate, stale
+ * generation rejection when a handle is erased and registered again
+ * while acquirers race with it, and tombstone reuse/reclaim once the
+ * table has been filled and emptied. Also reports lookup latency for
+ * hits and misses before and after churn.
+ *
+ * Usage: StreamHandleRegistryTest [churn iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "StreamHandleRegistry.h"
+#include "PalTestUtils.h"
+
+#define HANDLE(i) ((const void *)(uintptr_t)(0x10000 + (i) * 0x40))
+
+static void testValidation()
+{
+    StreamHandleRegistry reg;
+    const void *h = HANDLE(1);
+    bool lastUser = true;
+    uint32_t users = 0;
+
+    PAL_TEST_CHECK(reg.acquire(h) == -EINVAL, "unknown handle acquired");
+    PAL_TEST_CHECK(!reg.hasFlags(h, STREAM_HANDLE_VALID), "unknown handle valid");
+    PAL_TEST_CHECK(reg.release(h, &lastUser) == -EINVAL && !lastUser,
+                   "unknown handle released");
+    PAL_TEST_CHECK(reg.getUsers(h) == -EINVAL, "unknown handle has users");
+    PAL_TEST_CHECK(reg.erase(h) == -ENOENT, "unknown handle erased");
+    PAL_TEST_CHECK(reg.deactivate(h, &users) == -ENOENT, "unknown handle deactivated");
+
+    /* registered but not yet opened */
+    PAL_TEST_CHECK(reg.setFlags(h, STREAM_HANDLE_VALID) == 0, "setFlags failed");
+    PAL_TEST_CHECK(reg.acquire(h) == -EINVAL, "inactive handle acquired");
+
+    PAL_TEST_CHECK(reg.setFlags(h, STREAM_HANDLE_ACTIVE) == 0, "setFlags failed");
+    PAL_TEST_CHECK(reg.hasFlags(h, STREAM_HANDLE_VALID | STREAM_HANDLE_ACTIVE),
+                   "flags not set");
+    PAL_TEST_CHECK(reg.acquire(h) == 0, "acquire failed");
+    PAL_TEST_CHECK(reg.acquire(h) == 0, "acquire failed");
+    PAL_TEST_CHECK(reg.getUsers(h) == 2, "users %d", reg.getUsers(h));
+
+    /* close: no new users, last one out is reported */
+    PAL_TEST_CHECK(reg.deactivate(h, &users) == 0 && users == 2,
+                   "deactivate users %u", users);
+    PAL_TEST_CHECK(reg.deactivate(h, &users) == -EINVAL, "double deactivate");
+    PAL_TEST_CHECK(reg.acquire(h) == -EINVAL, "deactivated handle acquired");
+    PAL_TEST_CHECK(reg.release(h, &lastUser) == 0 && !lastUser, "early last user");
+    PAL_TEST_CHECK(reg.release(h, &lastUser) == 0 && lastUser, "last user missed");
+    PAL_TEST_CHECK(reg.release(h, &lastUser) == -EINVAL, "release underflow");
+
+    /* unregistered from the active list */
+    PAL_TEST_CHECK(reg.clearFlags(h, STREAM_HANDLE_VALID) == 0, "clearFlags failed");
+    PAL_TEST_CHECK(!reg.hasFlags(h, STREAM_HANDLE_VALID), "flag not cleared");
+    PAL_TEST_CHECK(reg.erase(h) == 0, "erase failed");
+    PAL_TEST_CHECK(reg.getUsers(h) == -EINVAL, "erased handle found");
+}
+
+static void testReregister()
+{
+    StreamHandleRegistry reg;
+    const void *h = HANDLE(2);
+
+    reg.setFlags(h, STREAM_HANDLE_VALID | STREAM_HANDLE_ACTIVE);
+    reg.acquire(h);
+    reg.erase(h);
+
+    /* same pointer handed out again, nothing carries over */
+    PAL_TEST_CHECK(reg.setFlags(h, STREAM_HANDLE_VALID) == 0, "setFlags failed");
+    PAL_TEST_CHECK(reg.getUsers(h) == 0, "stale users %d", reg.getUsers(h));
+    PAL_TEST_CHECK(!reg.hasFlags(h, STREAM_HANDLE_ACTIVE), "stale active flag");
+    PAL_TEST_CHECK(reg.acquire(h) == -EINVAL, "acquired before open");
+}
+
+/*
+ * Acquirers race with a closer that deactivates, waits for users to
+ * drain, erases and registers the same pointer again. An acquire that
+ * read the old state must fail its CAS on the bumped generation, so the
+ * closer never erases with users and every successful acquire is
+ * matched by a successful release.
+ */
+static void testStaleGeneration(int iterations)
+{
+    StreamHandleRegistry reg;
+    const void *h = HANDLE(3);
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> acquired(0);
+    std::vector<std::thread> acquirers;
+    uint32_t users = 0;
+    bool lastUser = false;
+
+    reg.setFlags(h, STREAM_HANDLE_VALID | STREAM_HANDLE_ACTIVE);
+    for (int t = 0; t < 3; t++) {
+        acquirers.emplace_back([&]() {
+            bool last = false;
+
+            while (!done.load()) {
+                if (!reg.acquire(h)) {
+                    acquired.fetch_add(1);
+                    PAL_TEST_CHECK(reg.getUsers(h) > 0, "acquired without users");
+                    PAL_TEST_CHECK(reg.release(h, &last) == 0, "release failed");
+                }
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    for (int i = 0; i < iterations; i++) {
+        PAL_TEST_CHECK(reg.deactivate(h, &users) == 0, "deactivate failed");
+        while (reg.getUsers(h) > 0)
+            std::this_thread::yield();
+        PAL_TEST_CHECK(reg.acquire(h) == -EINVAL, "acquired while closing");
+        PAL_TEST_CHECK(reg.getUsers(h) == 0, "users %d at erase", reg.getUsers(h));
+        reg.erase(h);
+        reg.setFlags(h, STREAM_HANDLE_VALID | STREAM_HANDLE_ACTIVE);
+        std::this_thread::yield();
+    }
+    done.store(true);
+    for (auto &t : acquirers)
+        t.join();
+
+    PAL_TEST_CHECK(reg.getUsers(h) == 0, "users left %d", reg.getUsers(h));
+    PAL_TEST_CHECK(reg.release(h, &lastUser) == -EINVAL, "release underflow");
+    fprintf(stdout, "stale generation: %d reopen, %llu acquires\n", iterations,
+            (unsigned long long)acquired.load());
+}
+
+/* returns the p50 miss latency in ns */
+static uint64_t measureLookups(StreamHandleRegistry &reg, int count, const char *tag)
+{
+    std::vector<uint64_t> hit;
+    std::vector<uint64_t> miss;
+    char name[64];
+    uint64_t start;
+
+    for (int round = 0; round < 200; round++) {
+        for (int i = 0; i < count; i++) {
+            start = palTestNowNs();
+            reg.getUsers(HANDLE(i));
+            hit.push_back(palTestNowNs() - start);
+            start = palTestNowNs();
+            reg.getUsers(HANDLE(100000 + i));
+            miss.push_back(palTestNowNs() - start);
+        }
+    }
+    snprintf(name, sizeof(name), "%s lookup hit", tag);
+    palTestReportLatency(name, hit);
+    snprintf(name, sizeof(name), "%s lookup miss", tag);
+    palTestReportLatency(name, miss);
+    return palTestPercentile(miss, 50);
+}
+
+/*
+ * Fill the table, empty it and fill it again with other pointers: the
+ * second fill only fits if tombstones are reused or reclaimed. Misses
+ * after the churn must not get slower than on a fresh table of the same
+ * load, which is what reclaiming trailing tombstones is for.
+ */
+static void testTombstones()
+{
+    StreamHandleRegistry reg;
+    uint64_t freshMiss;
+    uint64_t churnedMiss;
+    int i;
+
+    for (i = 0; i < 32; i++)
+        reg.setFlags(HANDLE(i), STREAM_HANDLE_VALID | STREAM_HANDLE_ACTIVE);
+    freshMiss = measureLookups(reg, 32, "fresh");
+    for (i = 0; i < 32; i++)
+        reg.erase(HANDLE(i));
+
+    for (i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++)
+        PAL_TEST_CHECK(reg.setFlags(HANDLE(1000 + i), STREAM_HANDLE_VALID) == 0,
+                       "fill %d failed", i);
+    PAL_TEST_CHECK(reg.setFlags(HANDLE(5000), STREAM_HANDLE_VALID) == -ENOMEM,
+                   "table over full");
+    for (i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++)
+        PAL_TEST_CHECK(reg.erase(HANDLE(1000 + i)) == 0, "erase %d failed", i);
+
+    for (i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++)
+        PAL_TEST_CHECK(reg.setFlags(HANDLE(2000 + i), STREAM_HANDLE_VALID) == 0,
+                       "refill %d failed", i);
+    for (i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++)
+        PAL_TEST_CHECK(reg.getUsers(HANDLE(2000 + i)) == 0, "refill %d lost", i);
+    for (i = 0; i < STREAM_HANDLE_REGISTRY_SIZE; i++)
+        reg.erase(HANDLE(2000 + i));
+
+    for (i = 0; i < 32; i++)
+        reg.setFlags(HANDLE(i), STREAM_HANDLE_VALID | STREAM_HANDLE_ACTIVE);
+    churnedMiss = measureLookups(reg, 32, "churned");
+    /* a miss probing the whole table is two orders of magnitude slower */
+    PAL_TEST_CHECK(churnedMiss < freshMiss * 4 + 200,
+                   "miss %llu ns after churn, %llu ns fresh",
+                   (unsigned long long)churnedMiss, (unsigned long long)freshMiss);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 5000;
+
+    testValidation();
+    testReregister();
+    testStaleGeneration(iterations);
+    testTombstones();
+
+    return palTestResult("StreamHandleRegistryTest");
+}
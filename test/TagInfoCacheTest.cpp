@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Checks that the session tag table (getTaggedInfo / MIID) cache does
+ * not outlive the graph it was read from. A playback stream is opened
+ * and started, which fills the cache for its pcm device, then closed,
+ * which must drop those entries, then opened again, which must read the
+ * tables from the kernel rather than hit stale entries. Counters come
+ * from PAL_PARAM_ID_SESSION_CACHE_STATS. With vendor.audio.pal.latency_stats
+ * set, hit and miss lookup latency is reported from the API latency
+ * stats. Run it with no other audio active.
+ *
+ * Usage: TagInfoCacheTest [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include "PalApi.h"
+#include "PalTestUtils.h"
+
+static int getCacheStats(pal_param_session_cache_stats_t *stats)
+{
+    void *payload = NULL;
+    size_t size = 0;
+    int status;
+
+    status = pal_get_param(PAL_PARAM_ID_SESSION_CACHE_STATS, &payload, &size, NULL);
+    if (status || !payload || size != sizeof(*stats)) {
+        free(payload);
+        return status ? status : -EINVAL;
+    }
+    memcpy(stats, payload, sizeof(*stats));
+    free(payload);
+    return 0;
+}
+
+static pal_stream_handle_t *openAndStart()
+{
+    struct pal_stream_attributes attr;
+    struct pal_device device;
+    pal_stream_handle_t *handle = NULL;
+    int status;
+
+    memset(&attr, 0, sizeof(attr));
+    memset(&device, 0, sizeof(device));
+    attr.type = PAL_STREAM_LOW_LATENCY;
+    attr.direction = PAL_AUDIO_OUTPUT;
+    attr.out_media_config.sample_rate = 48000;
+    attr.out_media_config.bit_width = 16;
+    attr.out_media_config.aud_fmt_id = PAL_AUDIO_FMT_PCM_S16_LE;
+    attr.out_media_config.ch_info.channels = 2;
+    attr.out_media_config.ch_info.ch_map[0] = PAL_CHMAP_CHANNEL_FL;
+    attr.out_media_config.ch_info.ch_map[1] = PAL_CHMAP_CHANNEL_FR;
+    device.id = PAL_DEVICE_OUT_SPEAKER;
+    device.config = attr.out_media_config;
+
+    status = pal_stream_open(&attr, 1, &device, 0, NULL, NULL, 0, &handle);
+    if (status || !handle) {
+        PAL_TEST_CHECK(false, "pal_stream_open failed %d", status);
+        return NULL;
+    }
+    status = pal_stream_start(handle);
+    if (status) {
+        PAL_TEST_CHECK(false, "pal_stream_start failed %d", status);
+        pal_stream_close(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+static void closeStream(pal_stream_handle_t *handle)
+{
+    PAL_TEST_CHECK(!pal_stream_stop(handle), "pal_stream_stop failed");
+    PAL_TEST_CHECK(!pal_stream_close(handle), "pal_stream_close failed");
+}
+
+static void checkReopen()
+{
+    pal_param_session_cache_stats_t idle, running, closed, reopened;
+    pal_stream_handle_t *handle;
+
+    if (getCacheStats(&idle)) {
+        PAL_TEST_CHECK(false, "PAL_PARAM_ID_SESSION_CACHE_STATS not available");
+        return;
+    }
+
+    handle = openAndStart();
+    if (!handle)
+        return;
+    getCacheStats(&running);
+    PAL_TEST_CHECK(running.tag_info_misses > idle.tag_info_misses,
+                   "start did not read a tag table");
+    PAL_TEST_CHECK(running.tag_info_entries > idle.tag_info_entries,
+                   "no tag table cached while running");
+    fprintf(stdout, "start: %llu misses, %llu hits, %u entries\n",
+            (unsigned long long)(running.tag_info_misses - idle.tag_info_misses),
+            (unsigned long long)(running.tag_info_hits - idle.tag_info_hits),
+            running.tag_info_entries);
+
+    closeStream(handle);
+    getCacheStats(&closed);
+    PAL_TEST_CHECK(closed.tag_info_invalidated > running.tag_info_invalidated,
+                   "close dropped no tag table");
+    PAL_TEST_CHECK(closed.tag_info_entries <= idle.tag_info_entries,
+                   "%u entries left after close, %u before open",
+                   closed.tag_info_entries, idle.tag_info_entries);
+
+    /* same config reuses the same pcm device, it must read the table again */
+    handle = openAndStart();
+    if (!handle)
+        return;
+    getCacheStats(&reopened);
+    PAL_TEST_CHECK(reopened.tag_info_misses > closed.tag_info_misses,
+                   "reopen served from stale tag tables");
+    closeStream(handle);
+}
+
+static void reportLatency(const pal_latency_hist_t &hist, const char *name)
+{
+    if (!hist.count) {
+        fprintf(stdout, "%s: no samples\n", name);
+        return;
+    }
+    /* bucket 0 holds calls under 1 us */
+    fprintf(stdout, "%s: n %llu avg %llu us max %llu us, %.1f%% under 1 us\n",
+            name, (unsigned long long)hist.count,
+            (unsigned long long)(hist.total_us / hist.count),
+            (unsigned long long)hist.max_us,
+            100.0 * hist.buckets[0] / hist.count);
+}
+
+static void measure(int iterations)
+{
+    pal_param_latency_stats_t *stats = NULL;
+    pal_stream_handle_t *handle;
+    size_t size = 0;
+    int status;
+
+    pal_set_param(PAL_PARAM_ID_API_LATENCY_STATS, NULL, 0);
+    for (int i = 0; i < iterations; i++) {
+        handle = openAndStart();
+        if (!handle)
+            return;
+        closeStream(handle);
+    }
+
+    status = pal_get_param(PAL_PARAM_ID_API_LATENCY_STATS, (void **)&stats, &size, NULL);
+    if (status || !stats || size < sizeof(*stats)) {
+        fprintf(stdout, "latency stats unavailable %d\n", status);
+        free(stats);
+        return;
+    }
+    if (!stats->hist[PAL_LATENCY_TAG_INFO_HIT].count &&
+        !stats->hist[PAL_LATENCY_TAG_INFO_MISS].count)
+        fprintf(stdout, "latency stats disabled, set vendor.audio.pal.latency_stats\n");
+    reportLatency(stats->hist[PAL_LATENCY_TAG_INFO_HIT], "tag info hit");
+    reportLatency(stats->hist[PAL_LATENCY_TAG_INFO_MISS], "tag info miss");
+    reportLatency(stats->hist[PAL_LATENCY_STREAM_START], "stream start");
+    free(stats);
+}
+
+int main(int argc, char *argv[])
+{
+    int iterations = argc > 1 ? atoi(argv[1]) : 50;
+
+    checkReopen();
+    measure(iterations);
+
+    return palTestResult("TagInfoCacheTest");
+}
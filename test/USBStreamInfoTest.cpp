@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Fixture tests for USBCardConfig::parseStreamInfo. Each fixture is a
+ * /proc/asound/cardN/stream0 dump with the altsets it must produce.
+ * Also checks that a cached stream capability is only found for the
+ * same card address, usbid and stream0 header line.
+ *
+ * Usage: USBStreamInfoTest
+ */
+
+#include <stdio.h>
+#include <vector>
+#include "USBAudio.h"
+
+struct AltsetExpect {
+    usb_usecase_type_t type;
+    unsigned int bit_width;
+    bool big_endian;
+    unsigned int channels;
+    bool continuous_rates;
+    std::vector<unsigned int> rates;
+    unsigned long service_interval_us;
+};
+
+struct Fixture {
+    const char *name;
+    const char *stream_info;
+    std::vector<AltsetExpect> altsets;
+};
+
+static const Fixture fixtures[] = {
+    {
+        "playback and capture",
+        "Logitech USB Headset at usb-xhci-hcd.0.auto-1, full speed : USB Audio\n"
+        "\n"
+        "Playback:\n"
+        "  Interface 1\n"
+        "    Altset 1\n"
+        "    Format: S16_LE\n"
+        "    Channels: 2\n"
+        "    Endpoint: 0x01 (1 OUT) (ADAPTIVE)\n"
+        "    Rates: 8000, 11025, 16000, 22050, 32000, 44100, 48000\n"
+        "    Data packet interval: 1000 us\n"
+        "    Bits: 16\n"
+        "  Interface 1\n"
+        "    Altset 2\n"
+        "    Format: S24_3LE\n"
+        "    Channels: 2\n"
+        "    Endpoint: 0x01 (1 OUT) (ADAPTIVE)\n"
+        "    Rates: 48000, 96000\n"
+        "    Data packet interval: 125 us\n"
+        "    Bits: 24\n"
+        "\n"
+        "Capture:\n"
+        "  Interface 2\n"
+        "    Altset 1\n"
+        "    Format: S16_LE\n"
+        "    Channels: 1\n"
+        "    Endpoint: 0x82 (2 IN) (ASYNC)\n"
+        "    Rates: 16000, 48000\n"
+        "    Data packet interval: 1 ms\n",
+        {
+            {USB_PLAYBACK, 16, false, 2, false,
+             {8000, 11025, 16000, 22050, 32000, 44100, 48000}, 1000},
+            {USB_PLAYBACK, 24, false, 2, false, {48000, 96000}, 125},
+            {USB_CAPTURE, 16, false, 1, false, {16000, 48000}, 1000},
+        },
+    },
+    {
+        "continuous rates",
+        "DAC at usb-xhci-hcd.0.auto-1, high speed : USB Audio\n"
+        "\n"
+        "Playback:\n"
+        "  Interface 1\n"
+        "    Altset 1\n"
+        "    Format: S32_BE\n"
+        "    Channels: 8\n"
+        "    Endpoint: 0x01 (1 OUT) (ASYNC)\n"
+        "    Rates: 8000 - 192000 (continuous)\n"
+        "    Data packet interval: 125 us\n"
+        "  Interface 1\n"
+        "    Altset 2\n"
+        "    Format: S16_LE\n"
+        "    Channels: 2\n"
+        "    Rates: 44100 - 48000 (continuous)\n",
+        {
+            {USB_PLAYBACK, 32, true, 8, true, {8000, 192000}, 125},
+            {USB_PLAYBACK, 16, false, 2, true, {44100, 48000},
+             DEFAULT_SERVICE_INTERVAL_US},
+        },
+    },
+    {
+        "status running",
+        "USB Headset at usb-xhci-hcd.0.auto-1, full speed : USB Audio\n"
+        "\n"
+        "Playback:\n"
+        "  Status: Running\n"
+        "    Interface = 1\n"
+        "    Altset = 1\n"
+        "    Packet Size = 196\n"
+        "    Momentary freq = 48000 Hz (0x30.0000)\n"
+        "  Interface 1\n"
+        "    Altset 1\n"
+        "    Format: S16_LE\n"
+        "    Channels: 2\n"
+        "    Rates: 48000\n"
+        "    Data packet interval: 1000 us\n"
+        "\n"
+        "Capture:\n"
+        "  Status: Running\n"
+        "    Interface = 2\n"
+        "    Altset = 1\n"
+        "    Packet Size = 98\n"
+        "    Momentary freq = 48000 Hz (0x30.0000)\n"
+        "  Interface 2\n"
+        "    Altset = 1\n"
+        "    Format: S16_LE\n"
+        "    Channels: 1\n"
+        "    Rates: 48000\n"
+        "    Data packet interval: 1000 us\n",
+        {
+            {USB_PLAYBACK, 16, false, 2, false, {48000}, 1000},
+            {USB_CAPTURE, 16, false, 1, false, {48000}, 1000},
+        },
+    },
+    {
+        "incomplete altsets",
+        "Playback:\n"
+        "  Interface 1\n"
+        "    Altset 1\n"
+        "    Format: FLOAT_LE\n"
+        "    Channels: 2\n"
+        "    Rates: 48000\n"
+        "  Interface 1\n"
+        "    Altset 2\n"
+        "    Format: S16_LE\n"
+        "    Rates: 48000\n"
+        "  Interface 1\n"
+        "    Altset 3\n"
+        "    Format: S16_LE\n"
+        "    Channels: 2\n"
+        "    Rates: 48000\n",
+        {
+            {USB_PLAYBACK, 16, false, 2, false, {48000},
+             DEFAULT_SERVICE_INTERVAL_US},
+        },
+    },
+};
+
+static int checkFixture(const Fixture &f)
+{
+    std::vector<usb_altset_cap_t> altsets;
+    int errors = 0;
+
+    USBCardConfig::parseStreamInfo(f.stream_info, altsets);
+    if (altsets.size() != f.altsets.size()) {
+        fprintf(stderr, "%s: %zu altsets, expected %zu\n", f.name,
+                altsets.size(), f.altsets.size());
+        return 1;
+    }
+
+    for (size_t i = 0; i < altsets.size(); i++) {
+        const usb_altset_cap_t &got = altsets[i];
+        const AltsetExpect &exp = f.altsets[i];
+
+        if (got.type != exp.type || got.bit_width != exp.bit_width ||
+            got.big_endian != exp.big_endian || got.channels != exp.channels ||
+            got.continuous_rates != exp.continuous_rates ||
+            got.rates != exp.rates ||
+            got.service_interval_us != exp.service_interval_us) {
+            fprintf(stderr, "%s: altset %zu got type %d bw %u be %d ch %u "
+                    "cont %d rates %zu interval %lu\n", f.name, i, got.type,
+                    got.bit_width, got.big_endian, got.channels,
+                    got.continuous_rates, got.rates.size(),
+                    got.service_interval_us);
+            errors++;
+        }
+    }
+
+    return errors;
+}
+
+struct CacheLookup {
+    const char *name;
+    struct pal_usb_device_address addr;
+    const char *usbid;
+    const char *header;
+    bool hit;
+};
+
+static int checkCache()
+{
+    static const char *header =
+        "Logitech USB Headset at usb-xhci-hcd.0.auto-1, full speed : USB Audio";
+    static const CacheLookup lookups[] = {
+        {"same device", {1, 0}, "046d:0a44", header, true},
+        {"other card", {2, 0}, "046d:0a44", header, false},
+        {"other device number", {1, 1}, "046d:0a44", header, false},
+        {"other device on the card", {1, 0}, "0b0e:0412", header, false},
+        {"other speed", {1, 0}, "046d:0a44",
+         "Logitech USB Headset at usb-xhci-hcd.0.auto-1, high speed : USB Audio", false},
+        {"other port", {1, 0}, "046d:0a44",
+         "Logitech USB Headset at usb-xhci-hcd.0.auto-2, full speed : USB Audio", false},
+    };
+    std::shared_ptr<usb_stream_cap_t> cap = std::make_shared<usb_stream_cap_t>();
+    std::shared_ptr<usb_stream_cap_t> replaced = std::make_shared<usb_stream_cap_t>();
+    struct pal_usb_device_address addr = {1, 0};
+    int errors = 0;
+
+    cap->usbid = "046d:0a44";
+    cap->header = header;
+    USBCardConfig::cacheStreamCapability(addr, cap);
+    for (auto &l : lookups) {
+        bool hit = USBCardConfig::findStreamCapability(l.addr, l.usbid, l.header) == cap;
+
+        if (hit != l.hit) {
+            fprintf(stderr, "cache %s: %s, expected %s\n", l.name,
+                    hit ? "hit" : "miss", l.hit ? "hit" : "miss");
+            errors++;
+        }
+    }
+
+    /* a reparse after a reconnect replaces the entry of the address */
+    replaced->usbid = "0b0e:0412";
+    replaced->header = "Jabra EVOLVE at usb-xhci-hcd.0.auto-1, full speed : USB Audio";
+    USBCardConfig::cacheStreamCapability(addr, replaced);
+    if (USBCardConfig::findStreamCapability(addr, cap->usbid, cap->header) ||
+        USBCardConfig::findStreamCapability(addr, replaced->usbid,
+                                            replaced->header) != replaced) {
+        fprintf(stderr, "cache entry not replaced on reconnect\n");
+        errors++;
+    }
+
+    return errors;
+}
+
+int main(int argc, char *argv[])
+{
+    int errors = 0;
+
+    for (auto &f : fixtures)
+        errors += checkFixture(f);
+    errors += checkCache();
+
+    printf("%zu fixtures, errors %d\n",
+           sizeof(fixtures) / sizeof(fixtures[0]), errors);
+    return errors ? 1 : 0;
+}
@@ -148,6 +148,8 @@ class ACDPlatformInfo : public SoundTriggerXml {
     bool GetConcurrentVoiceCallEnable() const;
     bool GetConcurrentVoipCallEnable() const;
     bool GetLowLatencyBargeinEnable() const;
+    bool GetPreloadModels() const;
+    void PreloadModels();
     bool IsACDEnabled() const;
     std::shared_ptr<StreamConfig> GetStreamConfig(const ACDUUID& uuid) const;
     std::shared_ptr<CaptureProfile> GetCapProfile(const std::string& name) const;
@@ -166,6 +168,7 @@ class ACDPlatformInfo : public SoundTriggerXml {
     bool concurrent_voice_call_;
     bool concurrent_voip_call_;
     bool low_latency_bargein_enable_;
+    bool preload_models_;
     std::map<ACDUUID, std::shared_ptr<StreamConfig>> acd_cfg_list_;
     acd_cap_profile_map_t capture_profile_map_;
     std::shared_ptr<SoundTriggerXml> curr_child_;
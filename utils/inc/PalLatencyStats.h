@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PAL_LATENCY_STATS_H
+#define PAL_LATENCY_STATS_H
+
+#include <stdint.h>
+#include <time.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "PalDefs.h"
+
+/*
+ * Latency histograms for PAL entry points, session transitions and device
+ * transitions. Disabled by default, vendor.audio.pal.latency_stats or the
+ * api_latency_stats config param turns it on; when off a scope costs one
+ * relaxed load and no clock read. Each thread accumulates into its own
+ * thread_local histograms with plain single writer stores, get merges all
+ * live threads plus the totals of exited ones. reset bumps an epoch that
+ * every thread checks before its next record, so no one writes a foreign
+ * thread's counters.
+ */
+class PalLatencyStats
+{
+public:
+    static void record(pal_latency_point_t point, uint64_t ns);
+    static void get(pal_param_latency_stats_t *stats);
+    static void reset();
+    static void setEnabled(bool enable);
+    static inline bool isEnabled()
+    {
+        return mEnabled.load(std::memory_order_relaxed);
+    }
+
+    static inline uint64_t nowNs()
+    {
+        struct timespec ts;
+
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    }
+
+private:
+    struct hist {
+        std::atomic<uint64_t> count;
+        std::atomic<uint64_t> totalUs;
+        std::atomic<uint64_t> maxUs;
+        std::atomic<uint64_t> buckets[PAL_LATENCY_HIST_BUCKETS];
+    };
+    struct threadStats {
+        threadStats();
+        ~threadStats();
+        std::atomic<uint32_t> epoch;
+        hist points[PAL_LATENCY_POINT_MAX];
+    };
+    static void clearThread(threadStats *ts);
+    static void mergeThread(threadStats *ts, pal_latency_hist_t *out);
+    static std::atomic<bool> mEnabled;
+    static std::atomic<uint32_t> mEpoch;
+    static std::mutex mMutex;
+    static std::vector<threadStats *> mThreads;
+    /* accumulated by threads that exited during the current epoch */
+    static pal_latency_hist_t mRetired[PAL_LATENCY_POINT_MAX];
+};
+
+/* records the time spent in the enclosing scope while stats are enabled */
+class PalLatencyScope
+{
+public:
+    PalLatencyScope(pal_latency_point_t point) :
+        mPoint(point),
+        mStartNs(PalLatencyStats::isEnabled() ? PalLatencyStats::nowNs() : 0) {}
+    ~PalLatencyScope()
+    {
+        if (mStartNs)
+            PalLatencyStats::record(mPoint, PalLatencyStats::nowNs() - mStartNs);
+    }
+
+private:
+    pal_latency_point_t mPoint;
+    uint64_t mStartNs;
+};
+
+#endif
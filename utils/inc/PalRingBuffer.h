@@ -34,6 +34,8 @@
 
 
 #include <stdlib.h>
+#include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -45,54 +47,122 @@
 #define PALRINGBUFFER_H_
 
 #define DEFAULT_PAL_RING_BUFFER_SIZE 4096 * 10
+#define PAL_RING_BUFFER_MAX_READERS 16
+#define PAL_RING_BUFFER_CACHE_LINE  64
 
 typedef enum {
     READER_DISABLED = 0,
     READER_ENABLED = 1,
 } pal_ring_buffer_reader_state;
 
+/*
+ * RING_BUFFER_MODE_LOCKED serializes write and every reader access on the
+ * ring buffer mutex. RING_BUFFER_MODE_LOCK_FREE is meant for one writer and
+ * one or more readers: write/read/advanceReadOffset/getUnreadSize only touch
+ * the atomic cursors, the mutex is kept for reader list and reset/resize.
+ * Lock free writers walk a fixed array of reader slots, and resize is
+ * rejected while any lock free access or reader pin is active.
+ */
+typedef enum {
+    RING_BUFFER_MODE_LOCKED = 0,
+    RING_BUFFER_MODE_LOCK_FREE = 1,
+} pal_ring_buffer_mode;
+
+/* up to two contiguous regions of ring memory, second one after wrap */
+struct pal_ring_buffer_span {
+    char *data[2];
+    size_t size[2];
+};
+
 class PalRingBuffer;
 
 class PalRingBufferReader {
  public:
      PalRingBufferReader(PalRingBuffer *buffer)
          : ringBuffer_(buffer),
-           unreadSize_(0),
-           readOffset_(0),
-           state_(READER_DISABLED) {}
+           readCursor_(0),
+           ioRefs_(0),
+           state_(READER_DISABLED),
+           exitRequested_(false) {}
 
     ~PalRingBufferReader() {};
 
     size_t advanceReadOffset(size_t advanceSize);
     int32_t read(void* readBuffer, size_t readSize);
+    /*
+     * Zero copy access to unread data: peek returns the readable size (up
+     * to size) and fills span with ring memory, which stays valid until
+     * consume releases it back to the writer.
+     */
+    size_t peek(size_t size, struct pal_ring_buffer_span *span);
+    size_t consume(size_t size);
+    /*
+     * Keep ring memory alive across a peek/process/consume window, resize
+     * fails with -EBUSY while pinned. pin returns -EBUSY if a resize is in
+     * progress, every successful pin must be paired with unpin.
+     */
+    int32_t pin();
+    void unpin();
     void updateState(pal_ring_buffer_reader_state state);
     void getIndices(uint32_t *startIndice, uint32_t *endIndice);
     size_t getUnreadSize();
     void reset();
-    bool isEnabled() { return state_ == READER_ENABLED; }
+    /*
+     * Block until at least bytes are unread. Returns 0 on success,
+     * -ETIMEDOUT on timeout, -EINVAL if the reader is disabled meanwhile
+     * and -ECANCELED once signalExit is called.
+     */
+    int32_t waitForData(size_t bytes, uint32_t timeoutMs);
+    int32_t waitForDataOrExit(size_t bytes);
+    /* wake up waiters, sticky until reader is enabled or reset again */
+    void signalExit();
+    bool isEnabled() { return state_.load(std::memory_order_acquire) == READER_ENABLED; }
 
     friend class PalRingBuffer;
     friend class StreamSoundTrigger;
 
  protected:
     PalRingBuffer *ringBuffer_;
-    size_t unreadSize_;
-    size_t readOffset_;
-    pal_ring_buffer_reader_state state_;
+    /*
+     * total bytes consumed by this reader since last reset, on its own
+     * cache line with the reader's lock free accesses and pins
+     */
+    alignas(PAL_RING_BUFFER_CACHE_LINE) std::atomic<uint64_t> readCursor_;
+    std::atomic<uint32_t> ioRefs_;
+    std::atomic<pal_ring_buffer_reader_state> state_;
+    bool exitRequested_;
+    size_t unreadSize_l();
+    int32_t waitForData_l(size_t bytes, bool timed, uint32_t timeoutMs);
+    int32_t read_l(void* readBuffer, size_t readSize);
+    size_t advanceReadOffset_l(size_t advanceSize);
+    void reset_l();
 };
 
 class PalRingBuffer {
  public:
-    explicit PalRingBuffer(size_t bufferSize)
+    explicit PalRingBuffer(size_t bufferSize,
+                           pal_ring_buffer_mode mode = RING_BUFFER_MODE_LOCKED)
         : buffer_((char*)(new char[bufferSize])),
           startIndex(0),
           endIndex(0),
-          writeOffset_(0),
-          bufferEnd_(bufferSize) {}
+          writeCursor_(0),
+          bufferEnd_(bufferSize),
+          mode_(mode),
+          walkPhase_(0),
+          walkWaiters_(0),
+          writerIoRefs_(0),
+          resizing_(false),
+          writerPinned_(false),
+          waiters_(0) {
+        for (int i = 0; i < PAL_RING_BUFFER_MAX_READERS; i++)
+            readerSlots_[i].store(nullptr, std::memory_order_relaxed);
+        walkers_[0].store(0, std::memory_order_relaxed);
+        walkers_[1].store(0, std::memory_order_relaxed);
+    }
 
     ~PalRingBuffer() {
         if (buffer_)
-            delete buffer_;
+            delete[] buffer_;
 
         for (int i = 0; i < readOffsets_.size(); i++)
             delete readOffsets_[i];
@@ -104,21 +174,69 @@ class PalRingBuffer {
     size_t read(std::shared_ptr<PalRingBufferReader>reader, void* readBuffer,
                 size_t readSize);
     size_t write(void* writeBuffer, size_t writeSize);
+    /*
+     * Zero copy write for the single writer: reserve returns the writable
+     * size (up to size) and fills span with free ring memory, commit
+     * publishes the first size bytes of it to the readers. Every reserve
+     * must be followed by a commit, even of 0 bytes, to release the span.
+     */
+    size_t reserve(size_t size, struct pal_ring_buffer_span *span);
+    size_t commit(size_t size);
     size_t getFreeSize();
     void updateIndices(uint32_t startIndice, uint32_t endIndice);
     void reset();
     size_t getBufferSize() { return bufferEnd_; };
-    void resizeRingBuffer(size_t bufferSize);
+    int32_t resizeRingBuffer(size_t bufferSize);
+    pal_ring_buffer_mode getMode() { return mode_; };
+    bool isLockFree() { return mode_ == RING_BUFFER_MODE_LOCK_FREE; };
 
  protected:
     std::mutex mutex_;
     char* buffer_;
     uint32_t startIndex;
     uint32_t endIndex;
-    size_t writeOffset_;
+    /* total bytes written, offset is cursor % bufferEnd_ */
+    alignas(PAL_RING_BUFFER_CACHE_LINE) std::atomic<uint64_t> writeCursor_;
     size_t bufferEnd_;
+    pal_ring_buffer_mode mode_;
     std::vector<PalRingBufferReader*> readOffsets_;
-    void updateUnReadSize(size_t writtenSize);
+    /*
+     * Readers as seen by getFreeSize_l, which lock free writers call
+     * without the mutex. Slots are only changed under the mutex. A walk
+     * counts itself in walkers_[walkPhase_]. removeReader clears the slot,
+     * flips the phase and sleeps until the old phase drains, after which
+     * no walker can still see the reader and the caller may free it.
+     */
+    std::atomic<PalRingBufferReader*> readerSlots_[PAL_RING_BUFFER_MAX_READERS];
+    std::atomic<uint32_t> walkPhase_;
+    std::atomic<uint32_t> walkers_[2];
+    std::atomic<uint32_t> walkWaiters_;
+    std::mutex walkMutex_;
+    std::condition_variable walkCond_;
+    /*
+     * Lock free writer accesses currently touching buffer_, readers count
+     * theirs in their own ioRefs_ so the hot path never shares a counter.
+     */
+    std::atomic<uint32_t> writerIoRefs_;
+    std::atomic<bool> resizing_;
+    /* reserve pins the span for the single writer until commit */
+    bool writerPinned_;
+    /* waiters of data, notified by writer only when someone is waiting */
+    std::mutex waitMutex_;
+    std::condition_variable dataCond_;
+    std::atomic<uint32_t> waiters_;
+    void notifyWaiters();
+    uint32_t enterWalk();
+    void exitWalk(uint32_t phase);
+    void waitForWalkers_l();
+    bool enterIo(std::atomic<uint32_t> &refs);
+    void exitIo(std::atomic<uint32_t> &refs);
+    size_t getFreeSize_l();
+    size_t write_l(void* writeBuffer, size_t writeSize);
+    void copyOut(uint64_t cursor, void *dst, size_t size);
+    void copyIn(uint64_t cursor, void *src, size_t size);
+    void getSpan(uint64_t cursor, size_t size, struct pal_ring_buffer_span *span);
+    size_t commit_l(size_t size);
     friend class PalRingBufferReader;
 };
 #endif
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PAL_TRACE_H
+#define PAL_TRACE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+#include <atomic>
+#include <string>
+
+/* records kept per thread, must be a power of 2 */
+#define PAL_TRACE_RECORDS   128
+#define PAL_TRACE_MAX_RINGS 64
+#define PAL_TRACE_MAX_ARGS  8
+#define PAL_TRACE_STR_POOL  64
+#define PAL_TRACE_NO_STR    0xFF
+
+/*
+ * Binary log record. The format string, tag and function name are
+ * string literals, so only their pointers are kept. palTraceLog walks
+ * the format to pull each argument, including '*' widths, with its real
+ * type and stores it in a 64 bit slot; %s arguments are also copied
+ * into the string pool since they may not outlive the call.
+ */
+struct palTraceRecord {
+    std::atomic<uint32_t> seq;   /* odd while the owner thread writes it */
+    uint32_t line;
+    uint64_t tsNs;
+    const char *tag;
+    const char *func;
+    const char *fmt;
+    uint8_t level;
+    uint8_t nargs;
+    uint8_t strOff[PAL_TRACE_MAX_ARGS];
+    pid_t tid;                   /* writer, a ring is reused across threads */
+    uint64_t args[PAL_TRACE_MAX_ARGS];
+    char str[PAL_TRACE_STR_POOL];
+};
+
+/* written only by the owning thread, read by palTraceDecode */
+struct palTraceRing {
+    std::atomic<uint32_t> head;
+    std::atomic<bool> inUse;
+    pid_t tid;                   /* current owner */
+    palTraceRecord records[PAL_TRACE_RECORDS];
+};
+
+palTraceRing *palTraceGetRing();
+/* decode all rings into text, oldest record first */
+void palTraceDecode(std::string &out);
+void palTraceClear();
+
+#endif
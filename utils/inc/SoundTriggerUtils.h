@@ -30,11 +30,19 @@
 #ifndef SOUND_TRIGGER_UTILS_H
 #define SOUND_TRIGGER_UTILS_H
 
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "PalDefs.h"
 #include "ListenSoundModelLib.h"
 
 #define MAX_KW_USERS_NAME_LEN (2 * MAX_STRING_LEN)
 #define MAX_CONF_LEVEL_VALUE 100
+#define ST_MERGED_SM_CACHE_MAX_BYTES (8 * 1024 * 1024)
 
 enum {
     SML_PARSER_SUCCESS = 0,
@@ -430,6 +438,44 @@ class SoundModelLib {
     void *sml_lib_handle_;
 };
 
+/*
+ * Process wide LRU of SML merge/delete results. Merged models are a pure
+ * function of their inputs and input order, so engines reloading the same keyword set
+ * (stream reopen, SSR, concurrency) reuse the earlier SML output instead
+ * of merging again. The key is only a digest, so each entry also keeps
+ * its input models and a hit is returned only if they match byte for
+ * byte. Total size, inputs included, is capped at
+ * ST_MERGED_SM_CACHE_MAX_BYTES.
+ */
+class SoundModelMergeCache {
+ public:
+    static std::string GetMergeKey(uint32_t num_models,
+                                   listen_model_type *in_models[]);
+    static std::string GetDeleteKey(listen_model_type *in_model,
+                                    char **keyphrases, uint32_t num_keyphrases);
+    static int32_t Get(const std::string &key, uint32_t num_models,
+                       listen_model_type *in_models[],
+                       listen_model_type *out_model);
+    static void Put(const std::string &key, uint32_t num_models,
+                    listen_model_type *in_models[], listen_model_type *model);
+
+ private:
+    struct CacheEntry {
+        std::string key;
+        std::vector<std::vector<uint8_t>> inputs;  /* in SML call order */
+        std::vector<uint8_t> model;
+        size_t size;
+    };
+    static std::string GetModelDigest(listen_model_type *model);
+    static bool InputsMatch(const CacheEntry &entry, uint32_t num_models,
+        listen_model_type *in_models[]);
+    static std::mutex mutex_;
+    static std::list<CacheEntry> lru_;
+    static std::unordered_map<std::string,
+        std::list<CacheEntry>::iterator> entries_;
+    static size_t total_size_;
+};
+
 class SoundModelInfo {
 public:
     SoundModelInfo();
@@ -29,6 +29,7 @@
  */
 
 #include "ACDPlatformInfo.h"
+#include "ACDModelStore.h"
 
 #include <errno.h>
 
@@ -335,6 +336,7 @@ ACDPlatformInfo::ACDPlatformInfo() :
     concurrent_voice_call_(false),
     concurrent_voip_call_(false),
     low_latency_bargein_enable_(false),
+    preload_models_(false),
     curr_child_(nullptr)
 {
 }
@@ -379,6 +381,24 @@ bool ACDPlatformInfo::GetLowLatencyBargeinEnable() const {
     return low_latency_bargein_enable_;
 }
 
+bool ACDPlatformInfo::GetPreloadModels() const {
+    return preload_models_;
+}
+
+/* map every configured model up front so the first context enable finds it */
+void ACDPlatformInfo::PreloadModels() {
+    if (!acd_enable_ || !preload_models_)
+        return;
+
+    for (auto &acd_cfg : acd_cfg_list_) {
+        for (auto &sm_info : acd_cfg.second->GetSoundModelList()) {
+            if (!sm_info->GetModelBinName().empty())
+                ACDModelStore::PreloadModel(sm_info->GetModelBinName(),
+                                            sm_info->GetModelUUID());
+        }
+    }
+}
+
 bool ACDPlatformInfo::IsACDEnabled() const {
     return acd_enable_;
 }
@@ -477,6 +497,9 @@ void ACDPlatformInfo::HandleStartTag(const char* tag,
                        concurrent_capture_) {
                 low_latency_bargein_enable_ =
                     !strncasecmp(attribs[++i], "true", 4) ? true : false;
+            } else if (!strcmp(attribs[i], "preload_models")) {
+                preload_models_ =
+                    !strncasecmp(attribs[++i], "true", 4) ? true : false;
             } else {
                 PAL_INFO(LOG_TAG, "Invalid attribute %s", attribs[i++]);
             }
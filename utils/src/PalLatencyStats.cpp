@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <algorithm>
+#include "PalLatencyStats.h"
+
+std::atomic<bool> PalLatencyStats::mEnabled(false);
+std::atomic<uint32_t> PalLatencyStats::mEpoch(0);
+std::mutex PalLatencyStats::mMutex;
+std::vector<PalLatencyStats::threadStats *> PalLatencyStats::mThreads;
+pal_latency_hist_t PalLatencyStats::mRetired[PAL_LATENCY_POINT_MAX];
+
+static inline uint32_t bucketIndex(uint64_t us)
+{
+    uint32_t idx;
+
+    if (!us)
+        return 0;
+    idx = 64 - __builtin_clzll(us);
+    return idx < PAL_LATENCY_HIST_BUCKETS ? idx : PAL_LATENCY_HIST_BUCKETS - 1;
+}
+
+/* only the owning thread writes, a relaxed load/store pair is enough */
+static inline void bump(std::atomic<uint64_t> &v, uint64_t delta)
+{
+    v.store(v.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+PalLatencyStats::threadStats::threadStats()
+{
+    clearThread(this);
+    epoch.store(mEpoch.load(std::memory_order_acquire), std::memory_order_release);
+    std::lock_guard<std::mutex> lock(mMutex);
+    mThreads.push_back(this);
+}
+
+PalLatencyStats::threadStats::~threadStats()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (epoch.load(std::memory_order_acquire) ==
+        mEpoch.load(std::memory_order_relaxed))
+        mergeThread(this, mRetired);
+    mThreads.erase(std::remove(mThreads.begin(), mThreads.end(), this),
+                   mThreads.end());
+}
+
+void PalLatencyStats::clearThread(threadStats *ts)
+{
+    for (int p = 0; p < PAL_LATENCY_POINT_MAX; p++) {
+        hist *h = &ts->points[p];
+
+        h->count.store(0, std::memory_order_relaxed);
+        h->totalUs.store(0, std::memory_order_relaxed);
+        h->maxUs.store(0, std::memory_order_relaxed);
+        for (int b = 0; b < PAL_LATENCY_HIST_BUCKETS; b++)
+            h->buckets[b].store(0, std::memory_order_relaxed);
+    }
+}
+
+void PalLatencyStats::mergeThread(threadStats *ts, pal_latency_hist_t *out)
+{
+    for (int p = 0; p < PAL_LATENCY_POINT_MAX; p++) {
+        hist *h = &ts->points[p];
+        uint64_t max = h->maxUs.load(std::memory_order_relaxed);
+
+        out[p].count += h->count.load(std::memory_order_relaxed);
+        out[p].total_us += h->totalUs.load(std::memory_order_relaxed);
+        if (max > out[p].max_us)
+            out[p].max_us = max;
+        for (int b = 0; b < PAL_LATENCY_HIST_BUCKETS; b++)
+            out[p].buckets[b] += h->buckets[b].load(std::memory_order_relaxed);
+    }
+}
+
+void PalLatencyStats::record(pal_latency_point_t point, uint64_t ns)
+{
+    static thread_local threadStats local;
+    uint32_t epoch = mEpoch.load(std::memory_order_acquire);
+    hist *h;
+    uint64_t us = ns / 1000;
+
+    if ((uint32_t)point >= PAL_LATENCY_POINT_MAX)
+        return;
+
+    /* stats were reset since this thread last recorded */
+    if (local.epoch.load(std::memory_order_relaxed) != epoch) {
+        clearThread(&local);
+        local.epoch.store(epoch, std::memory_order_release);
+    }
+
+    h = &local.points[point];
+    bump(h->count, 1);
+    bump(h->totalUs, us);
+    bump(h->buckets[bucketIndex(us)], 1);
+    if (us > h->maxUs.load(std::memory_order_relaxed))
+        h->maxUs.store(us, std::memory_order_relaxed);
+}
+
+void PalLatencyStats::get(pal_param_latency_stats_t *stats)
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    uint32_t epoch = mEpoch.load(std::memory_order_relaxed);
+
+    memset(stats, 0, sizeof(*stats));
+    stats->num_points = PAL_LATENCY_POINT_MAX;
+    stats->num_buckets = PAL_LATENCY_HIST_BUCKETS;
+    memcpy(stats->hist, mRetired, sizeof(mRetired));
+
+    for (auto ts : mThreads) {
+        if (ts->epoch.load(std::memory_order_acquire) == epoch)
+            mergeThread(ts, stats->hist);
+    }
+}
+
+void PalLatencyStats::reset()
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    mEpoch.fetch_add(1, std::memory_order_acq_rel);
+    memset(mRetired, 0, sizeof(mRetired));
+}
+
+void PalLatencyStats::setEnabled(bool enable)
+{
+    mEnabled.store(enable, std::memory_order_relaxed);
+}
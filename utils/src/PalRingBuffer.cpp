@@ -31,47 +31,137 @@
 #ifdef LINUX_ENABLED
 #include <algorithm>
 #endif
+#include <chrono>
 #include "PalRingBuffer.h"
 #include "PalCommon.h"
 #define LOG_TAG "PAL: PalRingBuffer"
 
+uint32_t PalRingBuffer::enterWalk()
+{
+    uint32_t phase = 0;
+
+    /*
+     * Count in the current phase, retry if a remover flipped it meanwhile.
+     * Once the count is seen under the phase it was taken for, the remover
+     * either sees it and waits or flipped first and cleared the slot before.
+     */
+    while (true) {
+        phase = walkPhase_.load(std::memory_order_seq_cst);
+        walkers_[phase].fetch_add(1, std::memory_order_seq_cst);
+        if (walkPhase_.load(std::memory_order_seq_cst) == phase)
+            return phase;
+        walkers_[phase].fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+void PalRingBuffer::exitWalk(uint32_t phase)
+{
+    if (walkers_[phase].fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+        walkWaiters_.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(walkMutex_);
+        walkCond_.notify_all();
+    }
+}
+
+/* called with mutex_ held, so flips are serialized */
+void PalRingBuffer::waitForWalkers_l()
+{
+    uint32_t old = walkPhase_.load(std::memory_order_relaxed);
+    std::unique_lock<std::mutex> lock(walkMutex_);
+
+    walkPhase_.store(old ^ 1, std::memory_order_seq_cst);
+    walkWaiters_.fetch_add(1, std::memory_order_seq_cst);
+    walkCond_.wait(lock, [&]() {
+        return walkers_[old].load(std::memory_order_seq_cst) == 0;
+    });
+    walkWaiters_.fetch_sub(1, std::memory_order_seq_cst);
+}
+
 int32_t PalRingBuffer::removeReader(PalRingBufferReader *reader)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
     auto iter = std::find(readOffsets_.begin(), readOffsets_.end(), reader);
-    if (iter != readOffsets_.end())
-        readOffsets_.erase(iter);
+
+    if (iter == readOffsets_.end())
+        return 0;
+
+    readOffsets_.erase(iter);
+    for (int i = 0; i < PAL_RING_BUFFER_MAX_READERS; i++) {
+        if (readerSlots_[i].load(std::memory_order_relaxed) == reader) {
+            readerSlots_[i].store(nullptr, std::memory_order_seq_cst);
+            break;
+        }
+    }
+    /* reserve and lock free writers walk without mutex_ */
+    waitForWalkers_l();
 
     return 0;
 }
 
+bool PalRingBuffer::enterIo(std::atomic<uint32_t> &refs)
+{
+    refs.fetch_add(1, std::memory_order_seq_cst);
+    if (resizing_.load(std::memory_order_seq_cst)) {
+        refs.fetch_sub(1, std::memory_order_seq_cst);
+        return false;
+    }
+    return true;
+}
+
+void PalRingBuffer::exitIo(std::atomic<uint32_t> &refs)
+{
+    refs.fetch_sub(1, std::memory_order_release);
+}
+
 size_t PalRingBuffer::read(std::shared_ptr<PalRingBufferReader>reader __unused,
                            void* readBuffer __unused, size_t readSize __unused)
 {
     return 0;
 }
 
-size_t PalRingBuffer::getFreeSize()
+/*
+ * Free size is derived from the slowest enabled reader. Disabled readers
+ * keep accumulating unread data but never hold back the writer, their
+ * unread size is clamped to the buffer size once they get enabled.
+ */
+size_t PalRingBuffer::getFreeSize_l()
 {
-
     size_t freeSize = bufferEnd_;
-    std::vector<PalRingBufferReader*>::iterator it;
-
-    for (it = readOffsets_.begin(); it != readOffsets_.end(); it++) {
-        if ((*(it))->state_ == READER_ENABLED)
-            freeSize = std::min(freeSize, bufferEnd_ - (*(it))->unreadSize_);
+    uint64_t writeCursor = writeCursor_.load(std::memory_order_relaxed);
+    uint64_t unread = 0;
+    uint32_t phase = enterWalk();
+    PalRingBufferReader *reader = nullptr;
+
+    for (int i = 0; i < PAL_RING_BUFFER_MAX_READERS; i++) {
+        reader = readerSlots_[i].load(std::memory_order_acquire);
+        if (!reader ||
+            reader->state_.load(std::memory_order_acquire) != READER_ENABLED)
+            continue;
+        unread = writeCursor - reader->readCursor_.load(std::memory_order_acquire);
+        if (unread >= bufferEnd_) {
+            freeSize = 0;
+            break;
+        }
+        freeSize = std::min(freeSize, bufferEnd_ - (size_t)unread);
     }
+    exitWalk(phase);
     return freeSize;
 }
 
-void PalRingBuffer::updateUnReadSize(size_t writtenSize)
+size_t PalRingBuffer::getFreeSize()
 {
-    int32_t i = 0;
-    std::vector<PalRingBufferReader*>::iterator it;
-
-    for (it = readOffsets_.begin(); it != readOffsets_.end(); it++, i++) {
-        (*(it))->unreadSize_ += writtenSize;
-        PAL_VERBOSE(LOG_TAG, "Reader (%d), unreadSize(%zu)", i, (*(it))->unreadSize_);
+    size_t freeSize = 0;
+
+    if (isLockFree()) {
+        if (!enterIo(writerIoRefs_))
+            return 0;
+        freeSize = getFreeSize_l();
+        exitIo(writerIoRefs_);
+        return freeSize;
     }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return getFreeSize_l();
 }
 
 void PalRingBuffer::updateIndices(uint32_t startIndice, uint32_t endIndice)
@@ -81,48 +171,157 @@ void PalRingBuffer::updateIndices(uint32_t startIndice, uint32_t endIndice)
     PAL_VERBOSE(LOG_TAG, "start index = %u, end index = %u", startIndex, endIndex);
 }
 
-size_t PalRingBuffer::write(void* writeBuffer, size_t writeSize)
+void PalRingBuffer::copyIn(uint64_t cursor, void *src, size_t size)
 {
-    /* update the unread size for each reader*/
-    mutex_.lock();
-    size_t freeSize = getFreeSize();
-    size_t writtenSize = 0;
-    int32_t i = 0;
+    size_t offset = cursor % bufferEnd_;
+    size_t firstPart = 0;
+
+    //buffer wrapped around
+    if (offset + size > bufferEnd_) {
+        firstPart = bufferEnd_ - offset;
+        ar_mem_cpy(buffer_ + offset, firstPart, src, firstPart);
+        ar_mem_cpy(buffer_, size - firstPart, (char*)src + firstPart,
+                   size - firstPart);
+    } else {
+        ar_mem_cpy(buffer_ + offset, size, src, size);
+    }
+}
+
+void PalRingBuffer::copyOut(uint64_t cursor, void *dst, size_t size)
+{
+    size_t offset = cursor % bufferEnd_;
+    size_t firstPart = 0;
+
+    //unread data wrapped around
+    if (offset + size > bufferEnd_) {
+        firstPart = bufferEnd_ - offset;
+        ar_mem_cpy(dst, firstPart, buffer_ + offset, firstPart);
+        ar_mem_cpy((char*)dst + firstPart, size - firstPart, buffer_,
+                   size - firstPart);
+    } else {
+        ar_mem_cpy(dst, size, buffer_ + offset, size);
+    }
+}
+
+void PalRingBuffer::getSpan(uint64_t cursor, size_t size,
+                            struct pal_ring_buffer_span *span)
+{
+    size_t offset = cursor % bufferEnd_;
+
+    span->data[0] = buffer_ + offset;
+    span->data[1] = buffer_;
+    if (offset + size > bufferEnd_) {
+        span->size[0] = bufferEnd_ - offset;
+        span->size[1] = size - span->size[0];
+    } else {
+        span->size[0] = size;
+        span->size[1] = 0;
+    }
+}
+
+size_t PalRingBuffer::reserve(size_t size, struct pal_ring_buffer_span *span)
+{
+    size_t sizeToReserve = 0;
+
+    span->size[0] = 0;
+    span->size[1] = 0;
+    /* reserved span stays pinned until the matching commit */
+    if (!enterIo(writerIoRefs_))
+        return 0;
+    writerPinned_ = true;
+
+    sizeToReserve = std::min(size, getFreeSize_l());
+    /* free region only grows while readers consume, safe without lock */
+    getSpan(writeCursor_.load(std::memory_order_relaxed), sizeToReserve, span);
+    return sizeToReserve;
+}
+
+size_t PalRingBuffer::commit_l(size_t size)
+{
+    uint64_t writeCursor = writeCursor_.load(std::memory_order_relaxed);
+    size_t sizeToCommit = std::min(size, getFreeSize_l());
+
+    writeCursor += sizeToCommit;
+    writeCursor_.store(writeCursor, std::memory_order_seq_cst);
+    if (sizeToCommit && waiters_.load(std::memory_order_seq_cst))
+        notifyWaiters();
+    PAL_VERBOSE(LOG_TAG, "committed %zu, writeOffset(%zu)", sizeToCommit,
+                (size_t)(writeCursor % bufferEnd_));
+    return sizeToCommit;
+}
+
+size_t PalRingBuffer::commit(size_t size)
+{
+    size_t committed = 0;
+
+    if (!writerPinned_)
+        return 0;
+
+    if (isLockFree()) {
+        committed = commit_l(size);
+    } else {
+        std::lock_guard<std::mutex> lock(mutex_);
+        committed = commit_l(size);
+    }
+    writerPinned_ = false;
+    exitIo(writerIoRefs_);
+
+    return committed;
+}
+
+size_t PalRingBuffer::write_l(void* writeBuffer, size_t writeSize)
+{
+    uint64_t writeCursor = writeCursor_.load(std::memory_order_relaxed);
+    size_t freeSize = getFreeSize_l();
     size_t sizeToCopy = 0;
 
-    PAL_DBG(LOG_TAG, "Enter. freeSize(%zu), writeOffset(%zu)", freeSize, writeOffset_);
+    PAL_DBG(LOG_TAG, "Enter. freeSize(%zu), writeOffset(%zu)", freeSize,
+            (size_t)(writeCursor % bufferEnd_));
 
     if (writeSize <= freeSize)
         sizeToCopy = writeSize;
     else
         sizeToCopy = freeSize;
 
-    if (sizeToCopy) {
-        //buffer wrapped around
-        if (writeOffset_ + sizeToCopy > bufferEnd_) {
-            i = bufferEnd_ - writeOffset_;
-
-            ar_mem_cpy(buffer_ + writeOffset_, i, writeBuffer, i);
-            writtenSize += i;
-            sizeToCopy -= writtenSize;
-            ar_mem_cpy(buffer_, sizeToCopy, (char*)writeBuffer + writtenSize,
-                             sizeToCopy);
-            writtenSize += sizeToCopy;
-            writeOffset_ = sizeToCopy;
-        } else {
-            ar_mem_cpy(buffer_ + writeOffset_, sizeToCopy, writeBuffer,
-                             sizeToCopy);
-            writeOffset_ += sizeToCopy;
-            writtenSize = sizeToCopy;
-        }
+    if (sizeToCopy)
+        copyIn(writeCursor, writeBuffer, sizeToCopy);
+
+    /* publish the data to all readers */
+    writeCursor += sizeToCopy;
+    writeCursor_.store(writeCursor, std::memory_order_seq_cst);
+    if (sizeToCopy && waiters_.load(std::memory_order_seq_cst))
+        notifyWaiters();
+    PAL_DBG(LOG_TAG, "Exit. writeOffset(%zu)", (size_t)(writeCursor % bufferEnd_));
+    return sizeToCopy;
+}
+
+size_t PalRingBuffer::write(void* writeBuffer, size_t writeSize)
+{
+    size_t written = 0;
+
+    if (isLockFree()) {
+        if (!enterIo(writerIoRefs_))
+            return 0;
+        written = write_l(writeBuffer, writeSize);
+        exitIo(writerIoRefs_);
+        return written;
     }
-    updateUnReadSize(writtenSize);
-    writeOffset_ = writeOffset_ % bufferEnd_;
-    PAL_DBG(LOG_TAG, "Exit. writeOffset(%zu)", writeOffset_);
-    mutex_.unlock();
-    return writtenSize;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    return write_l(writeBuffer, writeSize);
+}
+
+void PalRingBuffer::notifyWaiters()
+{
+    std::lock_guard<std::mutex> lock(waitMutex_);
+    dataCond_.notify_all();
 }
 
+/*
+ * Cursors are never rewound: a lock free reader racing with reset would
+ * otherwise see write < read and compute a huge unread size. Readers are
+ * moved up to the write cursor instead, which drops all unread data.
+ */
 void PalRingBuffer::reset()
 {
     std::vector<PalRingBufferReader*>::iterator it;
@@ -130,136 +329,188 @@ void PalRingBuffer::reset()
     mutex_.lock();
     startIndex = 0;
     endIndex = 0;
-    writeOffset_ = 0;
-    mutex_.unlock();
-
-    /* Reset all the associated readers */
+    waitMutex_.lock();
     for (it = readOffsets_.begin(); it != readOffsets_.end(); it++)
-        (*(it))->reset();
+        (*(it))->reset_l();
+    waitMutex_.unlock();
+    mutex_.unlock();
+    dataCond_.notify_all();
 }
 
-void PalRingBuffer::resizeRingBuffer(size_t bufferSize)
+int32_t PalRingBuffer::resizeRingBuffer(size_t bufferSize)
 {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<PalRingBufferReader*>::iterator it;
+    uint32_t busy = 0;
+
+    /*
+     * Lock free writers/readers and pinned spans never take the mutex,
+     * refuse to free buffer_ under them instead of waiting on the I/O path.
+     */
+    resizing_.store(true, std::memory_order_seq_cst);
+    busy = writerIoRefs_.load(std::memory_order_seq_cst);
+    for (it = readOffsets_.begin(); it != readOffsets_.end(); it++)
+        busy += (*(it))->ioRefs_.load(std::memory_order_seq_cst);
+    if (busy) {
+        PAL_ERR(LOG_TAG, "Cannot resize ring buffer with %u active accessors",
+                busy);
+        resizing_.store(false, std::memory_order_release);
+        return -EBUSY;
+    }
+
     if (buffer_) {
         delete[] buffer_;
         buffer_ = nullptr;
     }
     buffer_ = (char *)new char[bufferSize];
     bufferEnd_ = bufferSize;
+    resizing_.store(false, std::memory_order_release);
+
+    return 0;
+}
+
+size_t PalRingBufferReader::unreadSize_l()
+{
+    return (size_t)(ringBuffer_->writeCursor_.load(std::memory_order_seq_cst) -
+                    readCursor_.load(std::memory_order_relaxed));
+}
+
+int32_t PalRingBufferReader::read_l(void* readBuffer, size_t bufferSize)
+{
+    uint64_t writeCursor = ringBuffer_->writeCursor_.load(std::memory_order_acquire);
+    uint64_t readCursor = readCursor_.load(std::memory_order_relaxed);
+    size_t unreadSize = (size_t)(writeCursor - readCursor);
+    size_t readSize = 0;
+
+    // Return 0 when no data can be read for current reader
+    if (unreadSize == 0)
+        return 0;
+
+    // Only data of one buffer length is retained
+    if (unreadSize > ringBuffer_->bufferEnd_) {
+        readCursor = writeCursor - ringBuffer_->bufferEnd_;
+        unreadSize = ringBuffer_->bufferEnd_;
+    }
+
+    readSize = std::min(bufferSize, unreadSize);
+    ringBuffer_->copyOut(readCursor, readBuffer, readSize);
+    /* hand the consumed region back to the writer only after copying */
+    readCursor_.store(readCursor + readSize, std::memory_order_release);
+
+    return (int32_t)readSize;
 }
 
 int32_t PalRingBufferReader::read(void* readBuffer, size_t bufferSize)
 {
-    int32_t readSize = 0;
+    int32_t status = 0;
 
-    if (state_ == READER_DISABLED)
+    if (!isEnabled())
         return -EINVAL;
 
-    // Return 0 when no data can be read for current reader
-    if (unreadSize_ == 0)
+    if (ringBuffer_->isLockFree()) {
+        if (!ringBuffer_->enterIo(ioRefs_))
+            return 0;
+        status = read_l(readBuffer, bufferSize);
+        ringBuffer_->exitIo(ioRefs_);
+        return status;
+    }
+
+    std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+    return read_l(readBuffer, bufferSize);
+}
+
+size_t PalRingBufferReader::peek(size_t size, struct pal_ring_buffer_span *span)
+{
+    uint64_t writeCursor = 0;
+    uint64_t readCursor = 0;
+    size_t unreadSize = 0;
+
+    span->size[0] = 0;
+    span->size[1] = 0;
+    if (!isEnabled())
         return 0;
 
-    ringBuffer_->mutex_.lock();
+    writeCursor = ringBuffer_->writeCursor_.load(std::memory_order_acquire);
+    readCursor = readCursor_.load(std::memory_order_relaxed);
+    unreadSize = (size_t)(writeCursor - readCursor);
+    // Only data of one buffer length is retained
+    if (unreadSize > ringBuffer_->bufferEnd_) {
+        readCursor = writeCursor - ringBuffer_->bufferEnd_;
+        readCursor_.store(readCursor, std::memory_order_release);
+        unreadSize = ringBuffer_->bufferEnd_;
+    }
 
-    // when writeOffset leads readOffset
-    if (ringBuffer_->writeOffset_ > readOffset_) {
-        unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
-
-        if (bufferSize >= unreadSize_) {
-            ar_mem_cpy(readBuffer, unreadSize_, ringBuffer_->buffer_ +
-                             readOffset_, unreadSize_);
-            readOffset_ += unreadSize_;
-            readSize = unreadSize_;
-            unreadSize_ = 0;
-        } else {
-            ar_mem_cpy(readBuffer, unreadSize_, ringBuffer_->buffer_ +
-                             readOffset_, bufferSize);
-            readOffset_ += bufferSize;
-            readSize = bufferSize;
-            unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
-        }
-    } else {
-        //When readOffset leads WriteOffset
-        int32_t freeClientSize = bufferSize;
-        int32_t i = ringBuffer_->bufferEnd_ - readOffset_;
-
-        if (bufferSize >= i) {
-            ar_mem_cpy(readBuffer, i, (char*)(ringBuffer_->buffer_ +
-                             readOffset_), i);
-            readSize = i;
-            freeClientSize -= readSize;
-            unreadSize_ = ringBuffer_->writeOffset_;
-            readOffset_ = 0;
-            //copy remaining unread buffer
-            if (freeClientSize > unreadSize_) {
-                ar_mem_cpy((char *)readBuffer + readSize, unreadSize_,
-                                 ringBuffer_->buffer_, unreadSize_);
-                readSize += unreadSize_;
-                readOffset_ = unreadSize_;
-                unreadSize_ = 0;
-            } else {
-                //copy whatever we can
-                ar_mem_cpy((char *)readBuffer + readSize, freeClientSize,
-                                 ringBuffer_->buffer_, freeClientSize);
-                readSize += freeClientSize;
-                readOffset_ = freeClientSize;
-                unreadSize_ = ringBuffer_->writeOffset_ - readOffset_;
-            }
-
-        } else {
-            ar_mem_cpy(readBuffer, bufferSize, ringBuffer_->buffer_ +
-                             readOffset_, bufferSize);
-            readSize = bufferSize;
-            readOffset_ += bufferSize;
-            unreadSize_ = ringBuffer_->bufferEnd_ - readOffset_ +
-                          ringBuffer_->writeOffset_;
-        }
+    unreadSize = std::min(size, unreadSize);
+    ringBuffer_->getSpan(readCursor, unreadSize, span);
+    return unreadSize;
+}
+
+size_t PalRingBufferReader::consume(size_t size)
+{
+    return advanceReadOffset(size);
+}
+
+int32_t PalRingBufferReader::pin()
+{
+    if (!ringBuffer_->enterIo(ioRefs_)) {
+        PAL_ERR(LOG_TAG, "Ring buffer is being resized, cannot pin");
+        return -EBUSY;
     }
-    ringBuffer_->mutex_.unlock();
-    return readSize;
+    return 0;
 }
 
-size_t PalRingBufferReader::advanceReadOffset(size_t advanceSize)
+void PalRingBufferReader::unpin()
 {
-    size_t size_advanced = 0;
+    ringBuffer_->exitIo(ioRefs_);
+}
 
-    std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+size_t PalRingBufferReader::advanceReadOffset_l(size_t advanceSize)
+{
+    size_t unreadSize = unreadSize_l();
 
-    /* add code to advance the offset here*/
-    if (unreadSize_ < advanceSize) {
+    if (unreadSize < advanceSize) {
         PAL_ERR(LOG_TAG, "Cannot advance read offset %zu greater than unread size %zu",
-            advanceSize, unreadSize_);
-        return size_advanced;
+            advanceSize, unreadSize);
+        return 0;
     }
 
-    unreadSize_ -= advanceSize;
-    if (readOffset_ + advanceSize < ringBuffer_->bufferEnd_) {
-        readOffset_ += advanceSize;
-    } else {
-        readOffset_ = readOffset_ + advanceSize - ringBuffer_->bufferEnd_;
-    }
-    size_advanced += advanceSize;
+    readCursor_.fetch_add(advanceSize, std::memory_order_release);
 
-    return size_advanced;
+    return advanceSize;
+}
+
+size_t PalRingBufferReader::advanceReadOffset(size_t advanceSize)
+{
+    /* only moves the cursor, no buffer memory access to guard */
+    if (ringBuffer_->isLockFree())
+        return advanceReadOffset_l(advanceSize);
+
+    std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
+    return advanceReadOffset_l(advanceSize);
 }
 
 void PalRingBufferReader::updateState(pal_ring_buffer_reader_state state)
 {
+    uint64_t writeCursor = 0;
+
     PAL_DBG(LOG_TAG, "update reader state to %d", state);
     std::lock_guard<std::mutex> lock(ringBuffer_->mutex_);
 
-    if (state_ == READER_DISABLED && state == READER_ENABLED) {
-        if (unreadSize_ > ringBuffer_->bufferEnd_)
-           unreadSize_ = ringBuffer_->bufferEnd_;
-
-        if (unreadSize_ <= ringBuffer_->writeOffset_) {
-            readOffset_ = ringBuffer_->writeOffset_ - unreadSize_;
-        } else {
-            readOffset_ = ringBuffer_->writeOffset_ +
-                ringBuffer_->bufferEnd_ - unreadSize_;
-        }
+    if (state_.load(std::memory_order_relaxed) == READER_DISABLED &&
+        state == READER_ENABLED) {
+        writeCursor = ringBuffer_->writeCursor_.load(std::memory_order_acquire);
+        if (writeCursor - readCursor_.load(std::memory_order_relaxed) >
+            ringBuffer_->bufferEnd_)
+            readCursor_.store(writeCursor - ringBuffer_->bufferEnd_,
+                              std::memory_order_release);
     }
-    state_ = state;
+    {
+        std::lock_guard<std::mutex> waitLock(ringBuffer_->waitMutex_);
+        if (state == READER_ENABLED)
+            exitRequested_ = false;
+        state_.store(state, std::memory_order_release);
+    }
+    ringBuffer_->dataCond_.notify_all();
 }
 
 void PalRingBufferReader::getIndices(uint32_t *startIndice, uint32_t *endIndice)
@@ -272,23 +523,99 @@ void PalRingBufferReader::getIndices(uint32_t *startIndice, uint32_t *endIndice)
 
 size_t PalRingBufferReader::getUnreadSize()
 {
-    PAL_VERBOSE(LOG_TAG, "unread size %zu", unreadSize_);
-    return unreadSize_;
+    size_t unreadSize = unreadSize_l();
+
+    PAL_VERBOSE(LOG_TAG, "unread size %zu", unreadSize);
+    return unreadSize;
+}
+
+/* called with mutex_ and waitMutex_ of the ring buffer held */
+void PalRingBufferReader::reset_l()
+{
+    exitRequested_ = false;
+    state_.store(READER_DISABLED, std::memory_order_release);
+    readCursor_.store(ringBuffer_->writeCursor_.load(std::memory_order_acquire),
+                      std::memory_order_release);
 }
 
 void PalRingBufferReader::reset()
 {
     ringBuffer_->mutex_.lock();
-    readOffset_ = 0;
-    unreadSize_ = 0;
-    state_ = READER_DISABLED;
+    ringBuffer_->waitMutex_.lock();
+    reset_l();
+    ringBuffer_->waitMutex_.unlock();
     ringBuffer_->mutex_.unlock();
+    ringBuffer_->dataCond_.notify_all();
+}
+
+int32_t PalRingBufferReader::waitForData_l(size_t bytes, bool timed,
+                                           uint32_t timeoutMs)
+{
+    int32_t status = 0;
+    auto timeout = std::chrono::steady_clock::now() +
+                   std::chrono::milliseconds(timeoutMs);
+    std::unique_lock<std::mutex> lock(ringBuffer_->waitMutex_);
+
+    ringBuffer_->waiters_.fetch_add(1, std::memory_order_seq_cst);
+    while (true) {
+        if (exitRequested_) {
+            status = -ECANCELED;
+            break;
+        }
+        if (!isEnabled()) {
+            status = -EINVAL;
+            break;
+        }
+        if (unreadSize_l() >= bytes)
+            break;
+        if (!timed) {
+            ringBuffer_->dataCond_.wait(lock);
+        } else if (ringBuffer_->dataCond_.wait_until(lock, timeout) ==
+                   std::cv_status::timeout) {
+            status = unreadSize_l() >= bytes ? 0 : -ETIMEDOUT;
+            break;
+        }
+    }
+    ringBuffer_->waiters_.fetch_sub(1, std::memory_order_seq_cst);
+
+    return status;
+}
+
+int32_t PalRingBufferReader::waitForData(size_t bytes, uint32_t timeoutMs)
+{
+    return waitForData_l(bytes, true, timeoutMs);
+}
+
+int32_t PalRingBufferReader::waitForDataOrExit(size_t bytes)
+{
+    return waitForData_l(bytes, false, 0);
+}
+
+void PalRingBufferReader::signalExit()
+{
+    {
+        std::lock_guard<std::mutex> lock(ringBuffer_->waitMutex_);
+        exitRequested_ = true;
+    }
+    ringBuffer_->dataCond_.notify_all();
 }
 
 PalRingBufferReader* PalRingBuffer::newReader()
 {
-    PalRingBufferReader* readOffset =
-                  new PalRingBufferReader(this);
-    readOffsets_.push_back(readOffset);
-    return readOffset;
+    PalRingBufferReader* readOffset = nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (int i = 0; i < PAL_RING_BUFFER_MAX_READERS; i++) {
+        if (readerSlots_[i].load(std::memory_order_relaxed))
+            continue;
+        readOffset = new PalRingBufferReader(this);
+        readOffset->readCursor_.store(writeCursor_.load(std::memory_order_acquire));
+        readOffsets_.push_back(readOffset);
+        readerSlots_[i].store(readOffset, std::memory_order_release);
+        return readOffset;
+    }
+
+    PAL_ERR(LOG_TAG, "no free reader slot, max %d readers",
+            PAL_RING_BUFFER_MAX_READERS);
+    return nullptr;
 }
@@ -0,0 +1,423 @@
+/*
+ * Copyright (c) 2023 Qualcomm Innovation Center, Inc. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted (subject to the limitations in the
+ * disclaimer below) provided that the following conditions are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *
+ *     * Neither the name of Qualcomm Innovation Center, Inc. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * NO EXPRESS OR IMPLIED LICENSES TO ANY PARTY'S PATENT RIGHTS ARE
+ * GRANTED BY THIS LICENSE. THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT
+ * HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+ * GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER
+ * IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "PalTrace.h"
+#include "PalCommon.h"
+
+static std::mutex ringsMutex;
+static palTraceRing *rings[PAL_TRACE_MAX_RINGS];
+static std::atomic<uint32_t> numRings(0);
+/* records older than this were cleared */
+static std::atomic<uint64_t> clearTsNs(0);
+
+/* hands the ring back for reuse when its thread exits */
+class palTraceRingOwner
+{
+public:
+    palTraceRing *ring = nullptr;
+    bool acquired = false;
+    ~palTraceRingOwner()
+    {
+        if (ring)
+            ring->inUse.store(false, std::memory_order_release);
+    }
+};
+
+static palTraceRing *palTraceAcquireRing()
+{
+    palTraceRing *ring = nullptr;
+    uint32_t n;
+
+    ringsMutex.lock();
+    n = numRings.load(std::memory_order_relaxed);
+    for (uint32_t i = 0; i < n; i++) {
+        if (!rings[i]->inUse.load(std::memory_order_acquire)) {
+            ring = rings[i];
+            break;
+        }
+    }
+    if (!ring && n < PAL_TRACE_MAX_RINGS) {
+        ring = new (std::nothrow) palTraceRing();
+        if (ring) {
+            rings[n] = ring;
+            numRings.store(n + 1, std::memory_order_release);
+        }
+    }
+    if (ring) {
+        ring->inUse.store(true, std::memory_order_relaxed);
+        ring->tid = (pid_t)syscall(SYS_gettid);
+    }
+    ringsMutex.unlock();
+    return ring;
+}
+
+palTraceRing *palTraceGetRing()
+{
+    static thread_local palTraceRingOwner owner;
+
+    if (!owner.acquired) {
+        owner.acquired = true;
+        owner.ring = palTraceAcquireRing();
+    }
+    return owner.ring;
+}
+
+void palTraceClear()
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    clearTsNs.store((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec,
+                    std::memory_order_relaxed);
+}
+
+/* one conversion, parsed from just past its '%' */
+struct palTraceSpec {
+    const char *flags;   /* flags, width and precision */
+    size_t flagsLen;
+    int stars;           /* '*' widths/precisions, each takes an int arg */
+    char length[4];
+    char conv;           /* 0 if the format ended early */
+};
+
+static const char *parseSpec(const char *p, palTraceSpec &s)
+{
+    size_t len = 0;
+
+    s.flags = p;
+    s.stars = 0;
+    while (*p && strchr("-+ #0123456789.*", *p)) {
+        if (*p == '*')
+            s.stars++;
+        p++;
+    }
+    s.flagsLen = p - s.flags;
+    while (*p && strchr("hljztL", *p)) {
+        if (len < sizeof(s.length) - 1)
+            s.length[len++] = *p;
+        p++;
+    }
+    s.length[len] = '\0';
+    s.conv = *p;
+    if (!*p)
+        return p;
+    p++;
+    /* kernel style %pK, print it as a plain pointer */
+    if (s.conv == 'p' && *p == 'K')
+        p++;
+    return p;
+}
+
+static bool isTraceConv(char conv)
+{
+    return conv && strchr("diuxXocfFeEgGaAsp", conv);
+}
+
+static void palTracePutStr(palTraceRecord *r, uint8_t &used, int i,
+                           const char *s)
+{
+    size_t len;
+
+    r->args[i] = (uintptr_t)s;
+    r->strOff[i] = PAL_TRACE_NO_STR;
+    if (!s || used >= PAL_TRACE_STR_POOL)
+        return;
+
+    len = strnlen(s, PAL_TRACE_STR_POOL - used - 1);
+    memcpy(r->str + used, s, len);
+    r->str[used + len] = '\0';
+    r->strOff[i] = used;
+    used += len + 1;
+}
+
+void palTraceLog(uint8_t level, const char *tag, const char *func,
+                 uint32_t line, const char *fmt, ...)
+{
+    palTraceRing *ring = palTraceGetRing();
+    palTraceRecord *r;
+    palTraceSpec s;
+    struct timespec ts;
+    va_list ap;
+    const char *p = fmt;
+    uint32_t head;
+    uint32_t seq;
+    uint64_t v;
+    double d;
+    uint8_t used = 0;
+    int n = 0;
+
+    if (!ring)
+        return;
+
+    head = ring->head.load(std::memory_order_relaxed);
+    r = &ring->records[head & (PAL_TRACE_RECORDS - 1)];
+    seq = r->seq.load(std::memory_order_relaxed);
+    r->seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    r->tsNs = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    r->line = line;
+    r->tag = tag;
+    r->func = func;
+    r->fmt = fmt;
+    r->level = level;
+    r->tid = ring->tid;
+
+    /*
+     * va_arg needs the promoted type of each argument, so take it from
+     * the format the same way printf would. Stop at the first
+     * conversion that is not understood, the decoder prints '?' for it.
+     */
+    va_start(ap, fmt);
+    while (n < PAL_TRACE_MAX_ARGS && (p = strchr(p, '%'))) {
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+        p = parseSpec(p + 1, s);
+        if (!isTraceConv(s.conv) || n + s.stars >= PAL_TRACE_MAX_ARGS)
+            break;
+        for (int i = 0; i < s.stars; i++) {
+            r->args[n] = (uint64_t)(int64_t)va_arg(ap, int);
+            r->strOff[n++] = PAL_TRACE_NO_STR;
+        }
+
+        switch (s.conv) {
+            case 'd':
+            case 'i':
+                if (!strcmp(s.length, "ll") || s.length[0] == 'j')
+                    v = (uint64_t)(int64_t)va_arg(ap, long long);
+                else if (s.length[0] == 'l')
+                    v = (uint64_t)(int64_t)va_arg(ap, long);
+                else if (s.length[0] == 'z')
+                    v = (uint64_t)(int64_t)va_arg(ap, ssize_t);
+                else if (s.length[0] == 't')
+                    v = (uint64_t)(int64_t)va_arg(ap, ptrdiff_t);
+                else if (!strcmp(s.length, "hh"))
+                    v = (uint64_t)(int64_t)(signed char)va_arg(ap, int);
+                else if (s.length[0] == 'h')
+                    v = (uint64_t)(int64_t)(short)va_arg(ap, int);
+                else
+                    v = (uint64_t)(int64_t)va_arg(ap, int);
+                break;
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                if (!strcmp(s.length, "ll") || s.length[0] == 'j')
+                    v = va_arg(ap, unsigned long long);
+                else if (s.length[0] == 'l')
+                    v = va_arg(ap, unsigned long);
+                else if (s.length[0] == 'z')
+                    v = va_arg(ap, size_t);
+                else if (s.length[0] == 't')
+                    v = (uint64_t)va_arg(ap, ptrdiff_t);
+                else if (!strcmp(s.length, "hh"))
+                    v = (unsigned char)va_arg(ap, unsigned int);
+                else if (s.length[0] == 'h')
+                    v = (unsigned short)va_arg(ap, unsigned int);
+                else
+                    v = va_arg(ap, unsigned int);
+                break;
+            case 'c':
+                v = (uint64_t)(int64_t)va_arg(ap, int);
+                break;
+            case 's':
+                palTracePutStr(r, used, n++, va_arg(ap, const char *));
+                continue;
+            case 'p':
+                v = (uintptr_t)va_arg(ap, void *);
+                break;
+            default:
+                /* floating point */
+                if (s.length[0] == 'L')
+                    d = (double)va_arg(ap, long double);
+                else
+                    d = va_arg(ap, double);
+                memcpy(&v, &d, sizeof(v));
+                break;
+        }
+        r->args[n] = v;
+        r->strOff[n++] = PAL_TRACE_NO_STR;
+    }
+    va_end(ap);
+    r->nargs = n;
+
+    r->seq.store(seq + 2, std::memory_order_release);
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+static void appendArg(std::string &out, const palTraceRecord &r, int idx,
+                      char *spec, size_t specLen, char conv)
+{
+    char buf[128];
+    uint64_t v = r.args[idx];
+    double d;
+
+    switch (conv) {
+        case 'd':
+        case 'i':
+            snprintf(spec + specLen, 4, "ll%c", conv);
+            snprintf(buf, sizeof(buf), spec, (long long)(int64_t)v);
+            break;
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+            snprintf(spec + specLen, 4, "ll%c", conv);
+            snprintf(buf, sizeof(buf), spec, (unsigned long long)v);
+            break;
+        case 'c':
+            snprintf(spec + specLen, 2, "%c", conv);
+            snprintf(buf, sizeof(buf), spec, (int)v);
+            break;
+        case 's':
+            snprintf(spec + specLen, 2, "%c", conv);
+            snprintf(buf, sizeof(buf), spec,
+                     r.strOff[idx] != PAL_TRACE_NO_STR ? r.str + r.strOff[idx] :
+                     (v ? "(dropped)" : "(null)"));
+            break;
+        case 'p':
+            snprintf(buf, sizeof(buf), "%p", (void *)(uintptr_t)v);
+            break;
+        default:
+            memcpy(&d, &v, sizeof(d));
+            snprintf(spec + specLen, 2, "%c", conv);
+            snprintf(buf, sizeof(buf), spec, d);
+            break;
+    }
+    out += buf;
+}
+
+static void formatRecord(std::string &out, const palTraceRecord &r)
+{
+    const char *p = r.fmt;
+    palTraceSpec s;
+    char spec[64];
+    size_t len;
+    int arg = 0;
+
+    while (*p) {
+        if (*p != '%') {
+            out += *p++;
+            continue;
+        }
+        if (p[1] == '%') {
+            out += '%';
+            p += 2;
+            continue;
+        }
+
+        p = parseSpec(p + 1, s);
+        if (!isTraceConv(s.conv) || arg + s.stars >= r.nargs) {
+            /* argument was not recorded, keep the rest of the format */
+            out += "?";
+            out += p;
+            break;
+        }
+
+        /* rebuild flags, width and precision with each '*' resolved */
+        spec[0] = '%';
+        len = 1;
+        for (size_t i = 0; i < s.flagsLen && len < sizeof(spec) - 16; i++) {
+            if (s.flags[i] == '*')
+                len += snprintf(spec + len, 12, "%d", (int)(int64_t)r.args[arg++]);
+            else
+                spec[len++] = s.flags[i];
+        }
+        appendArg(out, r, arg++, spec, len, s.conv);
+    }
+}
+
+void palTraceDecode(std::string &out)
+{
+    std::vector<palTraceRecord *> copies;
+    palTraceRecord *copy;
+    palTraceRecord *rec;
+    uint32_t seq;
+    char hdr[160];
+    uint64_t since = clearTsNs.load(std::memory_order_relaxed);
+
+    ringsMutex.lock();
+    for (uint32_t i = 0; i < numRings.load(std::memory_order_acquire); i++) {
+        for (int j = 0; j < PAL_TRACE_RECORDS; j++) {
+            rec = &rings[i]->records[j];
+            seq = rec->seq.load(std::memory_order_acquire);
+            if ((seq & 1) || !rec->fmt)
+                continue;
+            copy = (palTraceRecord *)malloc(sizeof(palTraceRecord));
+            if (!copy)
+                break;
+            memcpy((void *)copy, (const void *)rec, sizeof(palTraceRecord));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            /* overwritten while copying */
+            if (rec->seq.load(std::memory_order_relaxed) != seq || !copy->fmt ||
+                copy->tsNs < since) {
+                free(copy);
+                continue;
+            }
+            copies.push_back(copy);
+        }
+    }
+    ringsMutex.unlock();
+
+    std::sort(copies.begin(), copies.end(),
+              [](const palTraceRecord *a, const palTraceRecord *b) {
+                  return a->tsNs < b->tsNs;
+              });
+
+    for (auto r : copies) {
+        snprintf(hdr, sizeof(hdr), "%llu.%06llu %5d %c %s: %s: %u: ",
+                 (unsigned long long)(r->tsNs / 1000000000ULL),
+                 (unsigned long long)((r->tsNs % 1000000000ULL) / 1000),
+                 (int)r->tid,
+                 r->level == PAL_LOG_VERBOSE ? 'V' :
+                 r->level == PAL_LOG_DBG ? 'D' : 'I',
+                 r->tag ? r->tag : "", r->func, r->line);
+        out += hdr;
+        formatRecord(out, *r);
+        out += '\n';
+        free(r);
+    }
+}
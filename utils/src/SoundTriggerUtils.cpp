@@ -254,6 +254,155 @@ SoundModelLib::~SoundModelLib()
     }
 }
 
+std::mutex SoundModelMergeCache::mutex_;
+std::list<SoundModelMergeCache::CacheEntry> SoundModelMergeCache::lru_;
+std::unordered_map<std::string,
+    std::list<SoundModelMergeCache::CacheEntry>::iterator>
+    SoundModelMergeCache::entries_;
+size_t SoundModelMergeCache::total_size_ = 0;
+
+std::string SoundModelMergeCache::GetModelDigest(listen_model_type *model)
+{
+    /* 64 bit FNV-1a, folded a word at a time to keep large models cheap */
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    uint64_t word = 0;
+    uint32_t i = 0;
+    char digest[32] = {0};
+
+    for (; i + sizeof(word) <= model->size; i += sizeof(word)) {
+        memcpy(&word, model->data + i, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    for (; i < model->size; i++)
+        hash = (hash ^ model->data[i]) * 0x100000001b3ULL;
+
+    snprintf(digest, sizeof(digest), "%08x:%016llx", model->size,
+        (unsigned long long)hash);
+    return std::string(digest);
+}
+
+std::string SoundModelMergeCache::GetMergeKey(uint32_t num_models,
+    listen_model_type *in_models[])
+{
+    std::string key = "M";
+
+    /*
+     * SML does not document merge as commutative, so models are keyed in
+     * the order they are passed. The engine always passes the current
+     * merged model first and the incoming model second.
+     */
+    for (uint32_t i = 0; i < num_models; i++)
+        key += "|" + GetModelDigest(in_models[i]);
+
+    return key;
+}
+
+std::string SoundModelMergeCache::GetDeleteKey(listen_model_type *in_model,
+    char **keyphrases, uint32_t num_keyphrases)
+{
+    std::string key = "D|" + GetModelDigest(in_model);
+
+    for (uint32_t i = 0; i < num_keyphrases; i++) {
+        key += "|";
+        key += keyphrases[i];
+    }
+
+    return key;
+}
+
+bool SoundModelMergeCache::InputsMatch(const CacheEntry &entry,
+    uint32_t num_models, listen_model_type *in_models[])
+{
+    if (entry.inputs.size() != num_models)
+        return false;
+
+    for (uint32_t i = 0; i < num_models; i++) {
+        if (entry.inputs[i].size() != in_models[i]->size ||
+            memcmp(entry.inputs[i].data(), in_models[i]->data,
+                in_models[i]->size))
+            return false;
+    }
+    return true;
+}
+
+int32_t SoundModelMergeCache::Get(const std::string &key, uint32_t num_models,
+    listen_model_type *in_models[], listen_model_type *out_model)
+{
+    int32_t status = 0;
+
+    mutex_.lock();
+    auto it = entries_.find(key);
+    if (it == entries_.end()) {
+        status = -ENOENT;
+        goto exit;
+    }
+    if (!InputsMatch(*it->second, num_models, in_models)) {
+        PAL_INFO(LOG_TAG, "cache key matched but input models differ");
+        status = -ENOENT;
+        goto exit;
+    }
+    lru_.splice(lru_.begin(), lru_, it->second);
+
+    out_model->data = (uint8_t *)calloc(1, it->second->model.size());
+    if (!out_model->data) {
+        PAL_ERR(LOG_TAG, "cached sound model allocation failed");
+        status = -ENOMEM;
+        goto exit;
+    }
+    memcpy(out_model->data, it->second->model.data(),
+        it->second->model.size());
+    out_model->size = it->second->model.size();
+
+exit:
+    mutex_.unlock();
+    return status;
+}
+
+void SoundModelMergeCache::Put(const std::string &key, uint32_t num_models,
+    listen_model_type *in_models[], listen_model_type *model)
+{
+    size_t size = 0;
+
+    if (!model->data || !model->size)
+        return;
+
+    size = model->size;
+    for (uint32_t i = 0; i < num_models; i++)
+        size += in_models[i]->size;
+    if (size > ST_MERGED_SM_CACHE_MAX_BYTES)
+        return;
+
+    mutex_.lock();
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        total_size_ -= it->second->size;
+        lru_.erase(it->second);
+        entries_.erase(it);
+    }
+
+    while (!lru_.empty() &&
+           total_size_ + size > ST_MERGED_SM_CACHE_MAX_BYTES) {
+        PAL_VERBOSE(LOG_TAG, "evict cached sound model, size %zu",
+            lru_.back().size);
+        total_size_ -= lru_.back().size;
+        entries_.erase(lru_.back().key);
+        lru_.pop_back();
+    }
+
+    lru_.emplace_front();
+    lru_.front().key = key;
+    for (uint32_t i = 0; i < num_models; i++)
+        lru_.front().inputs.emplace_back(in_models[i]->data,
+            in_models[i]->data + in_models[i]->size);
+    lru_.front().model.assign(model->data, model->data + model->size);
+    lru_.front().size = size;
+    entries_[key] = lru_.begin();
+    total_size_ += size;
+    PAL_VERBOSE(LOG_TAG, "cached sound model size %d, total %zu",
+        model->size, total_size_);
+    mutex_.unlock();
+}
+
 SoundModelInfo::SoundModelInfo() :
     sm_data_(nullptr),
     sm_size_(0),